@@ -0,0 +1,184 @@
+#include "background-cache.h"
+
+#include <plugin-support.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+// Renders of sources no filter asked for in this long are destroyed, so
+// a background that was removed or renamed does not keep its target.
+#define BACKGROUND_CACHE_IDLE_NS 2000000000ULL
+
+struct background_cache_entry {
+	obs_weak_source_t *source;
+	gs_texrender_t *render;
+	enum gs_color_space space;
+	uint32_t width;
+	uint32_t height;
+	// Video frame the texrender holds, valid while `rendered` is set.
+	uint64_t frame_time;
+	bool rendered;
+	// Set while the source renders, so a source that shows itself
+	// through its own background does not recurse.
+	bool rendering;
+	uint64_t last_used;
+};
+
+// Entries are allocated one by one: rendering a background can run other
+// filters that add entries, which must not move the one being rendered.
+// Rendering is single threaded, the lock only guards the list against
+// module unload and the stats.
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct background_cache_entry *) cache_entries;
+static struct background_cache_stats cache_stats;
+
+static void entry_destroy(struct background_cache_entry *entry)
+{
+	gs_texrender_destroy(entry->render);
+	obs_weak_source_release(entry->source);
+	bfree(entry);
+}
+
+// An entry rendered in the current frame is kept however long the
+// filters rendered since took.
+static void evict_idle(uint64_t now, uint64_t frame_time)
+{
+	for (size_t i = cache_entries.num; i > 0; i--) {
+		struct background_cache_entry *entry =
+			cache_entries.array[i - 1];
+		if (entry->rendering ||
+		    (entry->rendered && entry->frame_time == frame_time) ||
+		    now - entry->last_used < BACKGROUND_CACHE_IDLE_NS)
+			continue;
+		entry_destroy(entry);
+		cache_stats.resident--;
+		cache_stats.evictions++;
+		da_erase(cache_entries, i - 1);
+	}
+}
+
+static struct background_cache_entry *find_entry(obs_source_t *source)
+{
+	for (size_t i = 0; i < cache_entries.num; i++) {
+		struct background_cache_entry *entry = cache_entries.array[i];
+		if (obs_weak_source_references_source(entry->source, source))
+			return entry;
+	}
+
+	struct background_cache_entry *entry =
+		bzalloc(sizeof(struct background_cache_entry));
+	entry->source = obs_source_get_weak_source(source);
+	da_push_back(cache_entries, &entry);
+	cache_stats.resident++;
+	return entry;
+}
+
+/*
+ *  Renders `source` into the entry's texrender in `space`, replacing the
+ *  texrender when the format changes.
+ */
+static void render_source(struct background_cache_entry *entry,
+			  obs_source_t *source, uint32_t width,
+			  uint32_t height, enum gs_color_space space)
+{
+	const enum gs_color_format format = gs_get_format_from_space(space);
+	if (entry->render &&
+	    gs_get_format_from_space(entry->space) != format) {
+		gs_texrender_destroy(entry->render);
+		entry->render = NULL;
+	}
+	if (!entry->render)
+		entry->render = gs_texrender_create(format, GS_ZS_NONE);
+	else
+		gs_texrender_reset(entry->render);
+	entry->space = space;
+	entry->width = width;
+	entry->height = height;
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	if (gs_texrender_begin_with_color_space(entry->render, width, height,
+						space)) {
+		uint32_t flags = obs_source_get_output_flags(source);
+		const bool custom_draw = (flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
+		const bool async = (flags & OBS_SOURCE_ASYNC) != 0;
+		struct vec4 clear_color;
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f,
+			 100.0f);
+
+		if (!custom_draw && !async)
+			obs_source_default_render(source);
+		else
+			obs_source_video_render(source);
+		gs_texrender_end(entry->render);
+	}
+	gs_blend_state_pop();
+}
+
+gs_texture_t *background_cache_render(obs_source_t *source,
+				      enum gs_color_space space)
+{
+	const uint32_t width = obs_source_get_base_width(source);
+	const uint32_t height = obs_source_get_base_height(source);
+	if (!width || !height)
+		return NULL;
+
+	const uint64_t frame_time = obs_get_video_frame_time();
+	const uint64_t now = os_gettime_ns();
+
+	pthread_mutex_lock(&cache_mutex);
+	evict_idle(now, frame_time);
+	struct background_cache_entry *entry = find_entry(source);
+	entry->last_used = now;
+	if (entry->rendering) {
+		pthread_mutex_unlock(&cache_mutex);
+		return NULL;
+	}
+	if (entry->rendered && entry->frame_time == frame_time &&
+	    entry->width == width && entry->height == height &&
+	    entry->space == space) {
+		cache_stats.hits++;
+		pthread_mutex_unlock(&cache_mutex);
+		return gs_texrender_get_texture(entry->render);
+	}
+	entry->rendering = true;
+	pthread_mutex_unlock(&cache_mutex);
+
+	render_source(entry, source, width, height, space);
+
+	pthread_mutex_lock(&cache_mutex);
+	entry->rendering = false;
+	entry->rendered = true;
+	entry->frame_time = frame_time;
+	cache_stats.renders++;
+	pthread_mutex_unlock(&cache_mutex);
+	return gs_texrender_get_texture(entry->render);
+}
+
+void background_cache_get_stats(struct background_cache_stats *stats)
+{
+	pthread_mutex_lock(&cache_mutex);
+	*stats = cache_stats;
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+void background_cache_free(void)
+{
+	pthread_mutex_lock(&cache_mutex);
+	obs_log(LOG_INFO,
+		"Background cache: %llu renders, %llu shared, %llu evictions",
+		(unsigned long long)cache_stats.renders,
+		(unsigned long long)cache_stats.hits,
+		(unsigned long long)cache_stats.evictions);
+
+	obs_enter_graphics();
+	for (size_t i = 0; i < cache_entries.num; i++)
+		entry_destroy(cache_entries.array[i]);
+	obs_leave_graphics();
+	da_free(cache_entries);
+	cache_stats.resident = 0;
+	pthread_mutex_unlock(&cache_mutex);
+}
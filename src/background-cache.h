@@ -0,0 +1,24 @@
+#pragma once
+#include <obs-module.h>
+
+struct background_cache_stats {
+	// Requests served by a render earlier in the same video frame, and
+	// renders of a background source.
+	uint64_t hits;
+	uint64_t renders;
+	uint64_t evictions;
+	size_t resident;
+};
+
+// Returns the texture of `source` rendered at its base size in `space`
+// in the current video frame, shared with every filter that composites
+// over the same source.  The source is rendered by the first request of
+// a frame, later ones in the same space reuse that render.  The texture is only valid until the end
+// of the calling video_render and must not be rendered into.  NULL when
+// the source has no size or is being rendered by this call's own
+// background.  Graphics thread only.
+extern gs_texture_t *background_cache_render(obs_source_t *source,
+					     enum gs_color_space space);
+extern void background_cache_get_stats(struct background_cache_stats *stats);
+// Destroys every cached render.
+extern void background_cache_free(void);
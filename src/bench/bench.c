@@ -0,0 +1,1084 @@
+/*
+ *  composite-blur-bench
+ *
+ *  Sweeps blur_algorithm x blur_type x radius x passes x resolution and
+ *  prints one JSON object with, for every configuration, the estimated
+ *  GPU cost (texture fetches per pixel, texrender passes) and the wall
+ *  time of the CPU reference blur.
+ *
+ *  Usage: composite-blur-bench [options] > results.json
+ *    --algorithms LIST   gaussian,box,kawase,recursive (default: all)
+ *    --types LIST        area,directional,zoom,motion,tiltshift
+ *    --resolutions LIST  480p,720p,1080p,1440p,4k (default: all), the
+ *                        checks run at the first
+ *    --radius-step N     radius sweep step over 0-83 (default: 10)
+ *    --radius R          only measure radius R
+ *    --max-passes N      box passes sweep 1..N (default: 5)
+ *    --iterations N      CPU timing iterations per case (default: 1)
+ *    --threads N         CPU reference worker threads (default: all)
+ *    --downsample Q      area blur downsample quality 0-3 (default: 0)
+ *    --no-cpu            only report the cost model, skip CPU timing
+ *    --kernel-cache      instead of the sweep, time gaussian kernel cache
+ *                        lookups against resampling the kernel
+ *    --downsample-check  instead of the sweep, compare downsampled area
+ *                        blurs against full resolution and exit 1 if the
+ *                        error exceeds the bound of a quality level
+ *    --recursive-check   instead of the sweep, compare the recursive
+ *                        gaussian against the discrete kernel and exit 1
+ *                        if the error exceeds its bound
+ *    --kawase-check      instead of the sweep, compare the dual kawase
+ *                        blur against the discrete gaussian and exit 1
+ *                        if the error exceeds its bounds
+ *    --zoom-check        instead of the sweep, compare the zoom passes
+ *                        against the single pass gather of every tap and
+ *                        exit 1 if the error exceeds its bound
+ *    --box-pairs-check   instead of the sweep, compare the paired box
+ *                        taps against sampling every texel and exit 1 if
+ *                        the error exceeds its bound
+ *    --frame-cache       instead of the sweep, estimate from a model of
+ *                        a scene collection the passes skipping unchanged
+ *                        frames saves; nothing is rendered, the pipeline
+ *                        tool checks what the filter actually skips
+ */
+
+#include "reference/blur-reference.h"
+#include "blur/kernel-cache.h"
+#include "blur/downsample-kernel.h"
+#include "blur/kawase-kernel.h"
+
+#include <math.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RADIUS_MAX 83.0f
+#define PASSES_MAX 5
+
+struct named_value {
+	const char *name;
+	int value;
+};
+
+static const struct named_value algorithms[] = {
+	{"gaussian", BLUR_ALGO_GAUSSIAN},
+	{"box", BLUR_ALGO_BOX},
+	{"kawase", BLUR_ALGO_KAWASE},
+	{"recursive", BLUR_ALGO_RECURSIVE},
+};
+
+static const struct named_value types[] = {
+	{"area", BLUR_TYPE_AREA},
+	{"directional", BLUR_TYPE_DIRECTIONAL},
+	{"zoom", BLUR_TYPE_ZOOM},
+	{"motion", BLUR_TYPE_MOTION},
+	{"tiltshift", BLUR_TYPE_TILTSHIFT},
+};
+
+struct resolution {
+	const char *name;
+	uint32_t width;
+	uint32_t height;
+};
+
+static const struct resolution resolutions[] = {
+	{"480p", 854, 480},
+	{"720p", 1280, 720},
+	{"1080p", 1920, 1080},
+	{"1440p", 2560, 1440},
+	{"4k", 3840, 2160},
+};
+
+#define COUNT(x) (sizeof(x) / sizeof(x[0]))
+
+struct bench_options {
+	unsigned algorithms;
+	unsigned types;
+	unsigned resolutions;
+	float radius_step;
+	float radius;
+	int max_passes;
+	int iterations;
+	int downsample_quality;
+	bool cpu;
+	bool kernel_cache;
+	bool downsample_check;
+	bool recursive_check;
+	bool kawase_check;
+	bool zoom_check;
+	bool box_pairs_check;
+	bool frame_cache;
+};
+
+static double now_ms(void)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1.0e6;
+}
+
+// Parses a comma separated list of names into a bitmask of indices.
+static bool parse_list(const char *arg, const char *const *names,
+		       size_t count, unsigned *mask)
+{
+	char copy[256];
+	bool ok = true;
+	*mask = 0;
+	snprintf(copy, sizeof(copy), "%s", arg);
+	for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+		size_t i = 0;
+		while (i < count && strcmp(tok, names[i]) != 0)
+			i++;
+		if (i == count) {
+			fprintf(stderr, "unknown value '%s'\n", tok);
+			ok = false;
+			break;
+		}
+		*mask |= 1u << i;
+	}
+	return ok;
+}
+
+static bool parse_named(const char *arg, const struct named_value *values,
+			size_t count, unsigned *mask)
+{
+	const char *names[8];
+	for (size_t i = 0; i < count; i++)
+		names[i] = values[i].name;
+	return parse_list(arg, names, count, mask);
+}
+
+static bool parse_args(int argc, char **argv, struct bench_options *opts)
+{
+	opts->algorithms = (1u << COUNT(algorithms)) - 1;
+	opts->types = (1u << COUNT(types)) - 1;
+	opts->resolutions = (1u << COUNT(resolutions)) - 1;
+	opts->radius_step = 10.0f;
+	opts->radius = -1.0f;
+	opts->max_passes = PASSES_MAX;
+	opts->iterations = 1;
+	opts->cpu = true;
+	opts->downsample_quality = DOWNSAMPLE_QUALITY_OFF;
+	opts->kernel_cache = false;
+	opts->downsample_check = false;
+	opts->recursive_check = false;
+	opts->kawase_check = false;
+	opts->zoom_check = false;
+	opts->box_pairs_check = false;
+	opts->frame_cache = false;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		bool ok = true;
+
+		if (strcmp(arg, "--no-cpu") == 0) {
+			opts->cpu = false;
+			continue;
+		}
+		if (strcmp(arg, "--kernel-cache") == 0) {
+			opts->kernel_cache = true;
+			continue;
+		}
+		if (strcmp(arg, "--downsample-check") == 0) {
+			opts->downsample_check = true;
+			continue;
+		}
+		if (strcmp(arg, "--recursive-check") == 0) {
+			opts->recursive_check = true;
+			continue;
+		}
+		if (strcmp(arg, "--kawase-check") == 0) {
+			opts->kawase_check = true;
+			continue;
+		}
+		if (strcmp(arg, "--zoom-check") == 0) {
+			opts->zoom_check = true;
+			continue;
+		}
+		if (strcmp(arg, "--box-pairs-check") == 0) {
+			opts->box_pairs_check = true;
+			continue;
+		}
+		if (strcmp(arg, "--frame-cache") == 0) {
+			opts->frame_cache = true;
+			continue;
+		}
+		if (!value) {
+			fprintf(stderr, "missing value for %s\n", arg);
+			return false;
+		}
+		i++;
+		if (strcmp(arg, "--algorithms") == 0) {
+			ok = parse_named(value, algorithms, COUNT(algorithms),
+					 &opts->algorithms);
+		} else if (strcmp(arg, "--types") == 0) {
+			ok = parse_named(value, types, COUNT(types),
+					 &opts->types);
+		} else if (strcmp(arg, "--resolutions") == 0) {
+			const char *names[COUNT(resolutions)];
+			for (size_t r = 0; r < COUNT(resolutions); r++)
+				names[r] = resolutions[r].name;
+			ok = parse_list(value, names, COUNT(resolutions),
+					&opts->resolutions);
+		} else if (strcmp(arg, "--radius-step") == 0) {
+			opts->radius_step = (float)atof(value);
+			ok = opts->radius_step > 0.0f;
+		} else if (strcmp(arg, "--radius") == 0) {
+			opts->radius = (float)atof(value);
+			ok = opts->radius >= 0.0f &&
+			     opts->radius <= RADIUS_MAX;
+		} else if (strcmp(arg, "--max-passes") == 0) {
+			opts->max_passes = atoi(value);
+			ok = opts->max_passes >= 1 &&
+			     opts->max_passes <= PASSES_MAX;
+		} else if (strcmp(arg, "--iterations") == 0) {
+			opts->iterations = atoi(value);
+			ok = opts->iterations >= 1;
+		} else if (strcmp(arg, "--downsample") == 0) {
+			opts->downsample_quality = atoi(value);
+			ok = opts->downsample_quality >=
+				     DOWNSAMPLE_QUALITY_OFF &&
+			     opts->downsample_quality <=
+				     DOWNSAMPLE_QUALITY_PERFORMANCE;
+		} else if (strcmp(arg, "--threads") == 0) {
+			blur_reference_set_threads(atoi(value));
+		} else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			ok = false;
+		}
+		if (!ok) {
+			fprintf(stderr, "invalid value for %s: %s\n", arg,
+				value);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Deterministic test card- hard edged checkers plus a gradient, so the
+// blur has real work to do on every channel.
+static void fill_test_image(struct blur_image *image)
+{
+	uint32_t seed = 1;
+	for (uint32_t y = 0; y < image->height; y++) {
+		for (uint32_t x = 0; x < image->width; x++) {
+			float *px = image->data +
+				    ((size_t)y * image->width + x) * 4;
+			const bool check = ((x / 32) + (y / 32)) % 2 == 0;
+			seed = seed * 1664525u + 1013904223u;
+			px[0] = check ? 0.9f : 0.1f;
+			px[1] = (float)x / (float)image->width;
+			px[2] = (float)(seed >> 24) / 255.0f;
+			px[3] = 1.0f;
+		}
+	}
+}
+
+static void print_case(bool *first, const char *algorithm, const char *type,
+		       const struct resolution *res,
+		       const struct blur_reference_params *params,
+		       const struct blur_reference_cost *cost,
+		       const struct bench_options *opts, double min_ms,
+		       double mean_ms)
+{
+	printf("%s\n    {\"algorithm\": \"%s\", \"type\": \"%s\", "
+	       "\"resolution\": \"%s\", \"width\": %u, \"height\": %u, "
+	       "\"radius\": %.1f, \"passes\": %d, \"downsample\": %d, "
+	       "\"samples_per_pixel\": %.2f, \"samples_per_frame\": %.0f, "
+	       "\"blur_passes\": %d, \"texrender_passes\": %d, "
+	       "\"draws\": %d",
+	       *first ? "" : ",", algorithm, type, res->name, res->width,
+	       res->height, params->radius, params->passes,
+	       params->downsample_quality,
+	       cost->samples_per_pixel,
+	       cost->samples_per_pixel * res->width * res->height,
+	       cost->blur_passes, cost->texrender_passes, cost->draws);
+	if (opts->cpu)
+		printf(", \"cpu_ms_min\": %.3f, \"cpu_ms_mean\": %.3f",
+		       min_ms, mean_ms);
+	printf("}");
+	fflush(stdout);
+	*first = false;
+}
+
+// Measures one configuration.  Returns false if the filter does not offer
+// this algorithm/type pair.
+static bool run_case(bool *first, const struct named_value *algorithm,
+		     const struct named_value *type,
+		     const struct resolution *res, float radius, int passes,
+		     const struct bench_options *opts,
+		     const struct blur_image *src, struct blur_image *dst)
+{
+	struct blur_reference_params params = {
+		.blur_algorithm = algorithm->value,
+		.blur_type = type->value,
+		.radius = radius,
+		.passes = passes,
+		.angle = 30.0f,
+		.center_x = (float)res->width / 2.0f,
+		.center_y = (float)res->height / 2.0f,
+		.tilt_shift_top = 0.4f,
+		.tilt_shift_bottom = 0.4f,
+		.downsample_quality = opts->downsample_quality,
+	};
+	struct blur_reference_cost cost;
+
+	if (!blur_reference_cost(&params, res->width, res->height, &cost))
+		return false;
+
+	double min_ms = 0.0;
+	double total_ms = 0.0;
+	for (int i = 0; opts->cpu && i < opts->iterations; i++) {
+		const double start = now_ms();
+		blur_reference_render(dst, src, &params);
+		const double elapsed = now_ms() - start;
+		total_ms += elapsed;
+		if (i == 0 || elapsed < min_ms)
+			min_ms = elapsed;
+	}
+
+	print_case(first, algorithm->name, type->name, res, &params, &cost,
+		   opts, min_ms, total_ms / opts->iterations);
+	return true;
+}
+
+static void sweep(bool *first, const struct named_value *algorithm,
+		  const struct named_value *type, const struct resolution *res,
+		  const struct bench_options *opts,
+		  const struct blur_image *src, struct blur_image *dst)
+{
+	// Only box exposes the passes setting.
+	const int max_passes =
+		algorithm->value == BLUR_ALGO_BOX ? opts->max_passes : 1;
+	float radius = opts->radius >= 0.0f ? opts->radius : 0.0f;
+
+	for (;;) {
+		for (int passes = 1; passes <= max_passes; passes++) {
+			if (!run_case(first, algorithm, type, res, radius,
+				      passes, opts, src, dst))
+				return;
+		}
+		if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+			break;
+		radius += opts->radius_step;
+		if (radius > RADIUS_MAX)
+			radius = RADIUS_MAX;
+	}
+}
+
+/*
+ *  Replays a radius animation (0 -> 83 -> 0 in slider steps) the way
+ *  update_gaussian sees it, once resampling the kernel on every change
+ *  and once going through the kernel cache.
+ */
+static void kernel_cache_bench(const struct bench_options *opts)
+{
+	const int steps = (int)(RADIUS_MAX * 10.0f);
+	const int frames = 2 * steps * opts->iterations;
+	float weights[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offsets[GAUSSIAN_KERNEL_MAX_SIZE];
+	size_t checksum = 0;
+
+	double start = now_ms();
+	for (int i = 0; i < frames; i++) {
+		const int step = i % (2 * steps);
+		const float radius =
+			(float)(step < steps ? step : 2 * steps - step) / 10.0f;
+		checksum += gaussian_sample_kernel(radius, weights, offsets,
+						   GAUSSIAN_KERNEL_MAX_SIZE);
+	}
+	const double resample_ms = now_ms() - start;
+
+	const struct kernel_cache_entry *held = NULL;
+	start = now_ms();
+	for (int i = 0; i < frames; i++) {
+		const int step = i % (2 * steps);
+		const float radius =
+			(float)(step < steps ? step : 2 * steps - step) / 10.0f;
+		const struct kernel_cache_entry *entry =
+			kernel_cache_acquire_gaussian(radius);
+		kernel_cache_release(held);
+		held = entry;
+		checksum -= entry ? entry->size : 0;
+	}
+	const double cache_ms = now_ms() - start;
+	kernel_cache_release(held);
+
+	struct kernel_cache_stats stats;
+	kernel_cache_get_stats(&stats);
+	kernel_cache_clear();
+
+	printf("{\n  \"kernel_cache\": {\"updates\": %d, "
+	       "\"resample_ns\": %.1f, \"cache_ns\": %.1f, "
+	       "\"hits\": %llu, \"misses\": %llu, \"evictions\": %llu, "
+	       "\"capacity\": %d, \"checksum\": %zu}\n}\n",
+	       frames, resample_ms * 1.0e6 / frames, cache_ms * 1.0e6 / frames,
+	       (unsigned long long)stats.hits,
+	       (unsigned long long)stats.misses,
+	       (unsigned long long)stats.evictions, KERNEL_CACHE_CAPACITY,
+	       checksum);
+}
+
+// The checks run at one resolution, the smallest selected.
+static const struct resolution *
+check_resolution(const struct bench_options *opts)
+{
+	for (size_t r = 0; r < COUNT(resolutions); r++) {
+		if (opts->resolutions & (1u << r))
+			return &resolutions[r];
+	}
+	return &resolutions[0];
+}
+
+// Smooth test card for the checks.  The per-pixel noise channel
+// of fill_test_image is left out- a blur of noise is dominated by how
+// the image border is clamped, which says nothing about upsampling.
+static void fill_structured_image(struct blur_image *image)
+{
+	for (uint32_t y = 0; y < image->height; y++) {
+		for (uint32_t x = 0; x < image->width; x++) {
+			float *px = image->data +
+				    ((size_t)y * image->width + x) * 4;
+			const bool check = ((x / 32) + (y / 32)) % 2 == 0;
+			px[0] = check ? 0.9f : 0.1f;
+			px[1] = (float)x / (float)image->width;
+			px[2] = (float)y / (float)image->height;
+			px[3] = 1.0f;
+		}
+	}
+}
+
+/*
+ *  Renders every area gaussian/box radius of the sweep once at full
+ *  resolution and once per downsample quality, and reports the largest
+ *  per-channel error against the full resolution blur.  Fails if a
+ *  quality level exceeds its bound.
+ */
+static bool downsample_check(const struct bench_options *opts)
+{
+	// Indexed by algorithm, then quality.  The box kernel has hard
+	// edges, which upsampling reconstructs less accurately.
+	static const double max_error_bound[2][4] = {
+		{0.0, 0.015, 0.025, 0.05},
+		{0.0, 0.02, 0.03, 0.06},
+	};
+	const struct resolution *res = check_resolution(opts);
+
+	struct blur_image src = {0};
+	struct blur_image full = {0};
+	struct blur_image reduced = {0};
+	if (!blur_image_init(&src, res->width, res->height)) {
+		fprintf(stderr, "out of memory\n");
+		return false;
+	}
+	fill_structured_image(&src);
+
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"resolution\": \"%s\",\n  \"results\": [",
+	       res->name);
+	for (size_t a = 0; a < 2; a++) {
+		if (!(opts->algorithms & (1u << a)))
+			continue;
+		float radius = opts->radius >= 0.0f ? opts->radius : 0.0f;
+		for (;;) {
+			struct blur_reference_params params = {
+				.blur_algorithm = algorithms[a].value,
+				.blur_type = BLUR_TYPE_AREA,
+				.radius = radius,
+				.passes = 1,
+			};
+			blur_reference_render(&full, &src, &params);
+
+			for (int q = DOWNSAMPLE_QUALITY_HIGH;
+			     q <= DOWNSAMPLE_QUALITY_PERFORMANCE; q++) {
+				struct blur_reference_cost cost;
+				double max_error;
+				double rms_error;
+				params.downsample_quality = q;
+				blur_reference_render(&reduced, &src, &params);
+				blur_reference_cost(&params, res->width,
+						    res->height, &cost);
+				max_error = blur_image_max_error(&full,
+								 &reduced);
+				rms_error = blur_image_rms_error(&full,
+								 &reduced);
+				const bool ok =
+					max_error <= max_error_bound[a][q];
+				pass = pass && ok;
+				printf("%s\n    {\"algorithm\": \"%s\", "
+				       "\"radius\": %.1f, \"downsample\": %d, "
+				       "\"samples_per_pixel\": %.2f, "
+				       "\"max_error\": %.5f, "
+				       "\"rms_error\": %.5f, \"ok\": %s}",
+				       first ? "" : ",", algorithms[a].name,
+				       radius, q, cost.samples_per_pixel,
+				       max_error, rms_error,
+				       ok ? "true" : "false");
+				first = false;
+			}
+			params.downsample_quality = DOWNSAMPLE_QUALITY_OFF;
+
+			if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+				break;
+			radius += opts->radius_step;
+			if (radius > RADIUS_MAX)
+				radius = RADIUS_MAX;
+		}
+	}
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	blur_image_free(&src);
+	blur_image_free(&full);
+	blur_image_free(&reduced);
+	return pass;
+}
+
+/*
+ *  Compares the recursive gaussian against the discrete kernel area
+ *  blur over the radius sweep.  The discrete kernel is truncated at
+ *  3 sigma and the recursive filter is a fitted approximation, so the
+ *  two are expected to differ by a small, bounded amount.  Radii below
+ *  1px are skipped- the discrete kernel is a few linear taps there, not
+ *  a gaussian.
+ */
+static bool recursive_check(const struct bench_options *opts)
+{
+	static const double max_error_bound = 0.05;
+	const struct resolution *res = check_resolution(opts);
+
+	struct blur_image src = {0};
+	struct blur_image discrete = {0};
+	struct blur_image recursive = {0};
+	if (!blur_image_init(&src, res->width, res->height)) {
+		fprintf(stderr, "out of memory\n");
+		return false;
+	}
+	fill_structured_image(&src);
+
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"resolution\": \"%s\",\n  \"results\": [",
+	       res->name);
+	float radius = opts->radius >= 0.0f ? opts->radius : 0.0f;
+	for (;;) {
+		if (radius >= 1.0f) {
+			struct blur_reference_params params = {
+				.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+				.blur_type = BLUR_TYPE_AREA,
+				.radius = radius,
+				.passes = 1,
+			};
+			struct blur_reference_cost discrete_cost;
+			struct blur_reference_cost recursive_cost;
+			blur_reference_render(&discrete, &src, &params);
+			blur_reference_cost(&params, res->width, res->height,
+					    &discrete_cost);
+			params.blur_algorithm = BLUR_ALGO_RECURSIVE;
+			blur_reference_render(&recursive, &src, &params);
+			blur_reference_cost(&params, res->width, res->height,
+					    &recursive_cost);
+
+			const double max_error =
+				blur_image_max_error(&discrete, &recursive);
+			const double rms_error =
+				blur_image_rms_error(&discrete, &recursive);
+			const bool ok = max_error <= max_error_bound;
+			pass = pass && ok;
+			printf("%s\n    {\"radius\": %.1f, "
+			       "\"discrete_samples_per_pixel\": %.2f, "
+			       "\"recursive_samples_per_pixel\": %.2f, "
+			       "\"max_error\": %.5f, \"rms_error\": %.5f, "
+			       "\"ok\": %s}",
+			       first ? "" : ",", radius,
+			       discrete_cost.samples_per_pixel,
+			       recursive_cost.samples_per_pixel, max_error,
+			       rms_error, ok ? "true" : "false");
+			first = false;
+		}
+
+		if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+			break;
+		radius += opts->radius_step;
+		if (radius > RADIUS_MAX)
+			radius = RADIUS_MAX;
+	}
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	blur_image_free(&src);
+	blur_image_free(&discrete);
+	blur_image_free(&recursive);
+	return pass;
+}
+
+/*
+ *  Compares the dual kawase blur against the discrete kernel area
+ *  gaussian over the radius sweep, which holds kawase_params_for_radius
+ *  to its fitted sigma.  The pyramid only approximates a gaussian- the
+ *  taps form a diamond and every level halves the resolution- so the
+ *  bounds are what a viewer tolerates rather than what it measures:
+ *  - rms 0.02, five 8 bit steps averaged over the frame, below what
+ *    shows in a smooth gradient.  A sigma fitted 30% off exceeds it
+ *    while the test card's squares are still larger than the blur.
+ *  - max 0.2 for single texels at hard edges, the squares' and the
+ *    frame border, where the diamond differs most from the round
+ *    kernel.
+ *  Radii below 1px are skipped, as in recursive_check.
+ */
+static bool kawase_check(const struct bench_options *opts)
+{
+	static const double max_error_bound = 0.2;
+	static const double rms_error_bound = 0.02;
+	const struct resolution *res = check_resolution(opts);
+
+	struct blur_image src = {0};
+	struct blur_image discrete = {0};
+	struct blur_image kawase = {0};
+	if (!blur_image_init(&src, res->width, res->height)) {
+		fprintf(stderr, "out of memory\n");
+		return false;
+	}
+	fill_structured_image(&src);
+
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"resolution\": \"%s\",\n  \"results\": [",
+	       res->name);
+	float radius = opts->radius >= 0.0f ? opts->radius : 0.0f;
+	for (;;) {
+		if (radius >= 1.0f) {
+			struct blur_reference_params params = {
+				.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+				.blur_type = BLUR_TYPE_AREA,
+				.radius = radius,
+				.passes = 1,
+			};
+			struct kawase_params kawase_params;
+			kawase_params_for_radius(radius, res->width,
+						 res->height, &kawase_params);
+			blur_reference_render(&discrete, &src, &params);
+			params.blur_algorithm = BLUR_ALGO_KAWASE;
+			blur_reference_render(&kawase, &src, &params);
+
+			const double max_error =
+				blur_image_max_error(&discrete, &kawase);
+			const double rms_error =
+				blur_image_rms_error(&discrete, &kawase);
+			const bool ok = max_error <= max_error_bound &&
+					rms_error <= rms_error_bound;
+			pass = pass && ok;
+			printf("%s\n    {\"radius\": %.1f, \"levels\": %d, "
+			       "\"offset\": %.3f, \"max_error\": %.5f, "
+			       "\"rms_error\": %.5f, \"ok\": %s}",
+			       first ? "" : ",", radius, kawase_params.levels,
+			       kawase_params.offset, max_error, rms_error,
+			       ok ? "true" : "false");
+			first = false;
+		}
+
+		if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+			break;
+		radius += opts->radius_step;
+		if (radius > RADIUS_MAX)
+			radius = RADIUS_MAX;
+	}
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	blur_image_free(&src);
+	blur_image_free(&discrete);
+	blur_image_free(&kawase);
+	return pass;
+}
+
+// Furthest tap of the single pass zoom gather, in steps of
+// 4 * (uv - center) / uv_size.
+static float zoom_gather_extent(int algorithm, float radius)
+{
+	if (algorithm == BLUR_ALGO_GAUSSIAN)
+		return fminf(3.0f * radius, GAUSSIAN_KERNEL_MAX_RADIUS);
+	return radius;
+}
+
+/*
+ *  Compares the zoom passes against the single pass gather of every
+ *  kernel tap over the radius sweep, for box blurs once with a single
+ *  pass and once with --max-passes.  The center is off the middle of the
+ *  frame so neither axis is symmetric.  Rows whose gather steps past the
+ *  center are marked "crosses_center" and held to the same bounds.
+ */
+static bool zoom_check(const struct bench_options *opts)
+{
+	// Both approximate the continuous zoom.  Single texels on the hard
+	// edges of the test card may be off by 0.2, as in kawase_check, the
+	// bulk of the frame is held to the rms bound.
+	static const double max_error_bound = 0.2;
+	static const double rms_error_bound = 0.03;
+	const struct resolution *res = check_resolution(opts);
+
+	struct blur_image src = {0};
+	struct blur_image gather = {0};
+	struct blur_image passes = {0};
+	if (!blur_image_init(&src, res->width, res->height)) {
+		fprintf(stderr, "out of memory\n");
+		return false;
+	}
+	fill_structured_image(&src);
+
+	const uint32_t short_side =
+		res->width < res->height ? res->width : res->height;
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"resolution\": \"%s\",\n"
+	       "  \"max_error_bound\": %.2f,\n  \"rms_error_bound\": %.2f,\n"
+	       "  \"results\": [",
+	       res->name, max_error_bound, rms_error_bound);
+	for (size_t a = 0; a < 2; a++) {
+		if (!(opts->algorithms & (1u << a)))
+			continue;
+		const int repeats = algorithms[a].value == BLUR_ALGO_BOX &&
+						    opts->max_passes > 1
+					    ? 2
+					    : 1;
+		for (int r = 0; r < repeats; r++) {
+			const int box_passes = r == 0 ? 1 : opts->max_passes;
+			float radius = opts->radius >= 0.0f ? opts->radius
+							    : 0.0f;
+			for (;;) {
+				struct blur_reference_params params = {
+					.blur_algorithm = algorithms[a].value,
+					.blur_type = BLUR_TYPE_ZOOM,
+					.radius = radius,
+					.passes = box_passes,
+					.center_x = 0.4f * res->width,
+					.center_y = 0.45f * res->height,
+				};
+				struct blur_reference_cost gather_cost;
+				struct blur_reference_cost passes_cost;
+				blur_reference_render(&passes, &src, &params);
+				blur_reference_cost(&params, res->width,
+						    res->height, &passes_cost);
+				params.zoom_gather = true;
+				blur_reference_render(&gather, &src, &params);
+				blur_reference_cost(&params, res->width,
+						    res->height, &gather_cost);
+
+				const bool crosses =
+					4.0f * zoom_gather_extent(
+						       params.blur_algorithm,
+						       radius) >=
+					(float)short_side;
+				const double max_error =
+					blur_image_max_error(&gather, &passes);
+				const double rms_error =
+					blur_image_rms_error(&gather, &passes);
+				const bool ok = max_error <= max_error_bound &&
+						rms_error <= rms_error_bound;
+				pass = pass && ok;
+				printf("%s\n    {\"algorithm\": \"%s\", "
+				       "\"radius\": %.1f, \"passes\": %d, "
+				       "\"gather_samples_per_pixel\": %.2f, "
+				       "\"zoom_samples_per_pixel\": %.2f, "
+				       "\"zoom_passes\": %d, "
+				       "\"crosses_center\": %s, "
+				       "\"max_error\": %.5f, "
+				       "\"rms_error\": %.5f, \"ok\": %s}",
+				       first ? "" : ",", algorithms[a].name,
+				       radius, box_passes,
+				       gather_cost.samples_per_pixel,
+				       passes_cost.samples_per_pixel,
+				       passes_cost.blur_passes,
+				       crosses ? "true" : "false", max_error,
+				       rms_error, ok ? "true" : "false");
+				first = false;
+
+				if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+					break;
+				radius += opts->radius_step;
+				if (radius > RADIUS_MAX)
+					radius = RADIUS_MAX;
+			}
+		}
+	}
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	blur_image_free(&src);
+	blur_image_free(&gather);
+	blur_image_free(&passes);
+	return pass;
+}
+
+/*
+ *  Compares the paired box taps against sampling every whole texel over
+ *  the radius sweep.  A pair is exact where the taps step one texel
+ *  along an axis, as in area blurs and horizontal directional ones.
+ *  Angled steps and the shortened steps of the tilt-shift fall between
+ *  texels, where one linear sample only approximates two.
+ */
+static bool box_pairs_check(const struct bench_options *opts)
+{
+	static const struct {
+		const char *name;
+		int blur_type;
+		float angle;
+		bool exact;
+	} cases[] = {
+		{"area", BLUR_TYPE_AREA, 0.0f, true},
+		{"directional", BLUR_TYPE_DIRECTIONAL, 0.0f, true},
+		{"directional", BLUR_TYPE_DIRECTIONAL, 30.0f, false},
+		{"tiltshift", BLUR_TYPE_TILTSHIFT, 0.0f, false},
+	};
+	static const double exact_error_bound = 1e-4;
+	static const double max_error_bound = 0.1;
+	static const double rms_error_bound = 0.01;
+	const struct resolution *res = check_resolution(opts);
+
+	struct blur_image src = {0};
+	struct blur_image unpaired = {0};
+	struct blur_image paired = {0};
+	if (!blur_image_init(&src, res->width, res->height)) {
+		fprintf(stderr, "out of memory\n");
+		return false;
+	}
+	fill_structured_image(&src);
+
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"resolution\": \"%s\",\n  \"results\": [",
+	       res->name);
+	for (size_t c = 0; c < COUNT(cases); c++) {
+		float radius = opts->radius >= 0.0f ? opts->radius : 0.0f;
+		for (;;) {
+			struct blur_reference_params params = {
+				.blur_algorithm = BLUR_ALGO_BOX,
+				.blur_type = cases[c].blur_type,
+				.radius = radius,
+				.passes = opts->max_passes,
+				.angle = cases[c].angle,
+				.tilt_shift_top = 0.4f,
+				.tilt_shift_bottom = 0.4f,
+			};
+			struct blur_reference_cost unpaired_cost;
+			struct blur_reference_cost paired_cost;
+			blur_reference_render(&paired, &src, &params);
+			blur_reference_cost(&params, res->width, res->height,
+					    &paired_cost);
+			params.box_unpaired = true;
+			blur_reference_render(&unpaired, &src, &params);
+			blur_reference_cost(&params, res->width, res->height,
+					    &unpaired_cost);
+
+			const double max_error =
+				blur_image_max_error(&unpaired, &paired);
+			const double rms_error =
+				blur_image_rms_error(&unpaired, &paired);
+			const bool ok = cases[c].exact
+						? max_error <= exact_error_bound
+						: max_error <= max_error_bound &&
+							  rms_error <=
+								  rms_error_bound;
+			pass = pass && ok;
+			printf("%s\n    {\"type\": \"%s\", \"angle\": %.1f, "
+			       "\"radius\": %.1f, \"passes\": %d, "
+			       "\"unpaired_samples_per_pixel\": %.2f, "
+			       "\"paired_samples_per_pixel\": %.2f, "
+			       "\"max_error\": %.5f, \"rms_error\": %.5f, "
+			       "\"ok\": %s}",
+			       first ? "" : ",", cases[c].name, cases[c].angle,
+			       radius, params.passes,
+			       unpaired_cost.samples_per_pixel,
+			       paired_cost.samples_per_pixel, max_error,
+			       rms_error, ok ? "true" : "false");
+			first = false;
+
+			if (opts->radius >= 0.0f || radius >= RADIUS_MAX)
+				break;
+			radius += opts->radius_step;
+			if (radius > RADIUS_MAX)
+				radius = RADIUS_MAX;
+		}
+	}
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	blur_image_free(&src);
+	blur_image_free(&unpaired);
+	blur_image_free(&paired);
+	return pass;
+}
+
+// Same as FRAME_FINGERPRINT_MAX_SIZE and FRAME_FINGERPRINT_LATENCY in the
+// plugin.
+#define FINGERPRINT_MAX_SIZE 16
+#define FINGERPRINT_LATENCY 1
+
+// Texels the plugin fetches to fingerprint one width x height frame, in
+// frames- the Hash pass and every Reduce pass fetch 16 texels per texel
+// they write.
+static double fingerprint_frame_reads(uint32_t width, uint32_t height)
+{
+	const double frame = (double)width * height;
+	double fetches = 0.0;
+	do {
+		width = (width + 3) / 4;
+		height = (height + 3) / 4;
+		fetches += 16.0 * width * height;
+	} while (width > FINGERPRINT_MAX_SIZE || height > FINGERPRINT_MAX_SIZE);
+	return fetches / frame;
+}
+
+/*
+ *  A blurred source in a scene collection.  Its content changes
+ *  `changes_per_minute` times, and stays in motion for `change_frames`
+ *  frames every time, 0 meaning it changes every frame.
+ */
+struct cached_source {
+	const char *name;
+	int blur_algorithm;
+	float radius;
+	int changes_per_minute;
+	int change_frames;
+	bool background;
+};
+
+static const struct cached_source scene_collection[] = {
+	{"image", BLUR_ALGO_GAUSSIAN, 20.0f, 0, 0, false},
+	{"text", BLUR_ALGO_BOX, 10.0f, 2, 1, false},
+	{"browser_alerts", BLUR_ALGO_GAUSSIAN, 30.0f, 4, 120, false},
+	{"frosted_panel", BLUR_ALGO_KAWASE, 40.0f, 0, 0, true},
+	{"webcam", BLUR_ALGO_GAUSSIAN, 10.0f, 60, 0, false},
+};
+
+/*
+ *  Models one minute at 60 fps of the scene collection above with
+ *  "skip unchanged frames" on, and reports for every source how many
+ *  frames would reuse the last output, the full-screen blur passes and
+ *  texture fetches that saves, and the fetches spent finding out.  This
+ *  is arithmetic on the change pattern and blur_reference_cost, not a
+ *  measurement- no frame is rendered or fingerprinted.  Fetches are
+ *  counted in whole frames.  The frosted panel blurs a static source
+ *  over a background that changes every frame.
+ *  Fingerprints are read back FRAME_FINGERPRINT_LATENCY frames late, so
+ *  a frame renders when its source moved the frame before.
+ */
+static void frame_cache_report(const struct bench_options *opts)
+{
+	static const int frames = 60 * 60;
+	const struct resolution *res = check_resolution(opts);
+	const double check_reads =
+		fingerprint_frame_reads(res->width, res->height);
+
+	long long total_saved = 0;
+	double total_reads_saved = 0.0;
+	double total_spent = 0.0;
+	printf("{\n  \"model\": true,\n  \"resolution\": \"%s\",\n"
+	       "  \"frames\": %d,\n  \"results\": [",
+	       res->name, frames);
+	for (size_t i = 0; i < COUNT(scene_collection); i++) {
+		const struct cached_source *source = &scene_collection[i];
+		struct blur_reference_params params = {
+			.blur_algorithm = source->blur_algorithm,
+			.blur_type = BLUR_TYPE_AREA,
+			.radius = source->radius,
+			.passes = 1,
+		};
+		struct blur_reference_cost cost;
+		blur_reference_cost(&params, res->width, res->height, &cost);
+
+		const int period = source->changes_per_minute
+					   ? frames / source->changes_per_minute
+					   : 0;
+		int reused = 0;
+		// Until a fingerprint was read back, every frame renders.
+		for (int f = 1 + FINGERPRINT_LATENCY; f < frames; f++) {
+			const int seen = f - FINGERPRINT_LATENCY;
+			const bool moving =
+				source->background ||
+				(period &&
+				 (source->change_frames == 0 ||
+				  seen % period < source->change_frames));
+			if (!moving)
+				reused++;
+		}
+		const int rendered = frames - reused;
+		const int checks = source->background ? 2 : 1;
+		const long long saved = (long long)reused * cost.blur_passes;
+		const double reads_saved = reused * cost.samples_per_pixel;
+		const double spent = (double)frames * checks * check_reads;
+		total_saved += saved;
+		total_reads_saved += reads_saved;
+		total_spent += spent;
+		printf("%s\n    {\"source\": \"%s\", \"blur_passes\": %d, "
+		       "\"frames_reused\": %d, \"frames_rendered\": %d, "
+		       "\"passes_saved\": %lld, \"frame_reads_saved\": %.0f, "
+		       "\"fingerprint_frame_reads\": %.0f}",
+		       i ? "," : "", source->name, cost.blur_passes, reused,
+		       rendered, saved, reads_saved, spent);
+	}
+	printf("\n  ],\n  \"passes_saved\": %lld,\n"
+	       "  \"frame_reads_saved\": %.0f,\n"
+	       "  \"fingerprint_frame_reads\": %.0f\n}\n",
+	       total_saved, total_reads_saved, total_spent);
+}
+
+int main(int argc, char **argv)
+{
+	struct bench_options opts;
+	if (!parse_args(argc, argv, &opts))
+		return 1;
+
+	if (opts.kernel_cache) {
+		kernel_cache_bench(&opts);
+		return 0;
+	}
+	if (opts.downsample_check)
+		return downsample_check(&opts) ? 0 : 1;
+	if (opts.recursive_check)
+		return recursive_check(&opts) ? 0 : 1;
+	if (opts.kawase_check)
+		return kawase_check(&opts) ? 0 : 1;
+	if (opts.zoom_check)
+		return zoom_check(&opts) ? 0 : 1;
+	if (opts.box_pairs_check)
+		return box_pairs_check(&opts) ? 0 : 1;
+	if (opts.frame_cache) {
+		frame_cache_report(&opts);
+		return 0;
+	}
+
+	bool first = true;
+	printf("{\n  \"simd\": \"%s\",\n  \"threads\": %d,\n"
+	       "  \"results\": [",
+	       blur_reference_simd_name(), blur_reference_get_threads());
+
+	for (size_t r = 0; r < COUNT(resolutions); r++) {
+		if (!(opts.resolutions & (1u << r)))
+			continue;
+		const struct resolution *res = &resolutions[r];
+		struct blur_image src = {0};
+		struct blur_image dst = {0};
+		if (opts.cpu) {
+			if (!blur_image_init(&src, res->width, res->height)) {
+				fprintf(stderr, "out of memory\n");
+				return 1;
+			}
+			fill_test_image(&src);
+		}
+
+		for (size_t a = 0; a < COUNT(algorithms); a++) {
+			if (!(opts.algorithms & (1u << a)))
+				continue;
+			for (size_t t = 0; t < COUNT(types); t++) {
+				if (opts.types & (1u << t))
+					sweep(&first, &algorithms[a], &types[t],
+					      res, &opts, &src, &dst);
+			}
+		}
+
+		blur_image_free(&src);
+		blur_image_free(&dst);
+	}
+
+	printf("\n  ]\n}\n");
+	return 0;
+}
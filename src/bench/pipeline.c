@@ -0,0 +1,1141 @@
+/*
+ *  composite-blur-pipeline
+ *
+ *  Runs the filter's render path for a set of blur settings against the
+ *  CPU stand-in for libobs graphics in src/mock, and checks every frame:
+ *
+ *  - blend state pushes and pops, and texrender begins and ends, pair up,
+ *    no texrender is begun twice without a reset, and no draw samples
+ *    its own render target;
+ *  - texrender passes and draws match blur_reference_cost, so an extra
+ *    full screen pass fails;
+ *  - when every draw has a CPU program, the output matches
+ *    blur_reference_render;
+ *  - a second frame renders the same passes, and with skip_unchanged an
+ *    unchanged frame skips the blur passes while a changed one does not,
+ *    once the fingerprints read back FRAME_FINGERPRINT_LATENCY frames
+ *    late caught up;
+ *  - several filters over one background render it once per frame;
+ *  - an update that changes nothing looks no source up and keeps an
+ *    unchanged frame skipped, and the background setting follows a
+ *    rename of its source;
+ *  - a gaussian radius swept across the slider compiles no effect while
+ *    rendering, and releasing the filter frees the effects it held;
+ *  - frames rendered while another thread keeps updating the radius
+ *    each show the output of one of the settings, and the last update
+ *    wins;
+ *  - the filter reports the color space its precision setting picks for
+ *    the source, and keeps its passes out of 8 bit targets above 8 bit
+ *    SDR precision;
+ *  - a temporal trail matches temporal_reference_push over a sequence
+ *    longer than the trail, with the same passes every frame;
+ *  - the fingerprint of a 1080p frame changes with one 8 bit step of a
+ *    single texel.
+ *
+ *  Prints one JSON object and exits 1 if any check failed.
+ *
+ *  Usage: composite-blur-pipeline [options] > results.json
+ *    --size WxH       frame size (default: 128x96)
+ *    --case TEXT      only run cases whose name contains TEXT
+ *    --data DIR       plugin data directory (default: the source tree's)
+ *    --trace          log every pass, draw and state change to stderr
+ *    --verbose        print plugin log messages
+ */
+
+#include "mock/mock-obs.h"
+#include "effect-cache.h"
+#include "frame-fingerprint.h"
+#include "shader-preprocessor.h"
+#include "texrender-pool.h"
+#include "background-cache.h"
+#include "blur/downsample-kernel.h"
+#include "blur/kernel-cache.h"
+#include "blur/temporal-kernel.h"
+
+#include <util/threading.h>
+
+#include <math.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef MOCK_OBS_DATA_PATH
+#define MOCK_OBS_DATA_PATH "data"
+#endif
+
+#define COUNT(x) (sizeof(x) / sizeof((x)[0]))
+
+// 8 bit render targets round every pass, so the output may drift from
+// the float reference by a few steps.
+#define MAX_PIXEL_ERROR 0.02
+
+// Filters sharing one background in the background cache check.
+#define SHARED_FILTERS 3
+
+// Frames rendered while another thread updates the filter.
+#define CONCURRENT_FRAMES 8
+
+// Radius slider range and step of the gaussian sweep, which crosses
+// every gaussian_1d.effect variant.
+#define SWEEP_RADIUS_MAX 83.0
+#define SWEEP_RADIUS_STEP 6.0
+
+extern struct obs_source_info obs_composite_blur;
+
+struct pipeline_case {
+	const char *name;
+	struct blur_reference_params params;
+	// Composites the input over a background source before the blur.
+	bool background;
+	// Region of interest, and whether a mask source opaque on its left
+	// half limits it further.  Without a mask an empty region is none,
+	// with one the mask selects on its own.
+	struct gs_rect roi;
+	bool mask;
+	// Value of the "precision" setting, and the color space the input
+	// source reports.
+	int precision;
+	enum gs_color_space space;
+	// With the background, the input switches between opaque and clear
+	// white in small blocks instead of ramping its alpha.
+	bool alpha_edges;
+};
+
+// Values of the filter's "precision" setting.
+enum precision {
+	PRECISION_AUTO,
+	PRECISION_8BIT,
+	PRECISION_10BIT,
+	PRECISION_16F,
+};
+
+#define AREA(algo, r, p, q)                                             \
+	{                                                               \
+		.blur_algorithm = algo, .blur_type = BLUR_TYPE_AREA,    \
+		.radius = r, .passes = p, .downsample_quality = q,      \
+	}
+
+#define TRAIL(n, mode, memory)                                          \
+	{                                                               \
+		.blur_algorithm = BLUR_ALGO_TEMPORAL,                   \
+		.blur_type = BLUR_TYPE_MOTION, .temporal_frames = n,    \
+		.temporal_mode = mode, .temporal_memory = memory,       \
+	}
+
+static const struct pipeline_case cases[] = {
+	{"gaussian area", AREA(BLUR_ALGO_GAUSSIAN, 6.0f, 1, 0), false},
+	{"gaussian area downsampled",
+	 AREA(BLUR_ALGO_GAUSSIAN, 20.0f, 1, DOWNSAMPLE_QUALITY_PERFORMANCE),
+	 false},
+	{"gaussian area background", AREA(BLUR_ALGO_GAUSSIAN, 4.0f, 1, 0),
+	 true},
+	{"gaussian directional",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_DIRECTIONAL,
+	  .radius = 8.0f,
+	  .angle = 30.0f},
+	 false},
+	{"gaussian zoom",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 8.0f,
+	  .center_x = 64.0f,
+	  .center_y = 48.0f},
+	 false},
+	{"gaussian zoom across center",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 10.0f,
+	  .center_x = 50.0f,
+	  .center_y = 40.0f},
+	 false},
+	{"gaussian motion",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_MOTION,
+	  .radius = 8.0f,
+	  .angle = 30.0f},
+	 false},
+	{"box area", AREA(BLUR_ALGO_BOX, 3.5f, 2, 0), false},
+	{"box area prefix sum", AREA(BLUR_ALGO_BOX, 30.0f, 1, 0), false},
+	{"box area downsampled",
+	 AREA(BLUR_ALGO_BOX, 24.0f, 1, DOWNSAMPLE_QUALITY_BALANCED), false},
+	{"box area prefix sum background", AREA(BLUR_ALGO_BOX, 30.0f, 1, 0),
+	 true},
+	{"box area downsampled background",
+	 AREA(BLUR_ALGO_BOX, 24.0f, 1, DOWNSAMPLE_QUALITY_BALANCED), true},
+	{"box directional",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_DIRECTIONAL,
+	  .radius = 4.0f,
+	  .passes = 2,
+	  .angle = 45.0f},
+	 false},
+	{"box zoom",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 4.0f,
+	  .passes = 1,
+	  .center_x = 64.0f,
+	  .center_y = 48.0f},
+	 false},
+	{"box zoom passes",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 6.5f,
+	  .passes = 3,
+	  .center_x = 40.0f,
+	  .center_y = 60.0f},
+	 false},
+	{"box zoom passes background",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 6.5f,
+	  .passes = 3,
+	  .center_x = 40.0f,
+	  .center_y = 60.0f},
+	 true},
+	{"box zoom copy background",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_ZOOM,
+	  .radius = 0.0f,
+	  .passes = 1,
+	  .center_x = 40.0f,
+	  .center_y = 60.0f},
+	 true},
+	{"box tilt-shift",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_TILTSHIFT,
+	  .radius = 4.0f,
+	  .passes = 1,
+	  .tilt_shift_top = 0.4f,
+	  .tilt_shift_bottom = 0.4f},
+	 false},
+	{"gaussian tilt-shift",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_TILTSHIFT,
+	  .radius = 40.0f,
+	  .tilt_shift_top = 0.4f,
+	  .tilt_shift_bottom = 0.4f},
+	 false},
+	{"gaussian tilt-shift low band",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_TILTSHIFT,
+	  .radius = 60.0f,
+	  .tilt_shift_top = 0.0f,
+	  .tilt_shift_bottom = 0.3f},
+	 true},
+	{"kawase area", AREA(BLUR_ALGO_KAWASE, 10.0f, 1, 0), false},
+	{"kawase area zero radius", AREA(BLUR_ALGO_KAWASE, 0.0f, 1, 0),
+	 false},
+	{"kawase area background", AREA(BLUR_ALGO_KAWASE, 10.0f, 1, 0), true},
+	// Compositing texel by texel matches the composite pass of before.
+	{"gaussian area background alpha edges",
+	 AREA(BLUR_ALGO_GAUSSIAN, 4.0f, 1, 0), true, {0}, false,
+	 PRECISION_AUTO, GS_CS_SRGB, true},
+	{"box area background alpha edges", AREA(BLUR_ALGO_BOX, 3.5f, 2, 0),
+	 true, {0}, false, PRECISION_AUTO, GS_CS_SRGB, true},
+	{"kawase area background alpha edges",
+	 AREA(BLUR_ALGO_KAWASE, 10.0f, 1, 0), true, {0}, false,
+	 PRECISION_AUTO, GS_CS_SRGB, true},
+	{"recursive area", AREA(BLUR_ALGO_RECURSIVE, 12.0f, 1, 0), false},
+	{"recursive area small radius", AREA(BLUR_ALGO_RECURSIVE, 1.5f, 1, 0),
+	 false},
+	{"recursive area background", AREA(BLUR_ALGO_RECURSIVE, 12.0f, 1, 0),
+	 true},
+	{"gaussian area roi", AREA(BLUR_ALGO_GAUSSIAN, 6.0f, 1, 0), false,
+	 {24, 16, 40, 32}},
+	{"gaussian area downsampled roi",
+	 AREA(BLUR_ALGO_GAUSSIAN, 20.0f, 1, DOWNSAMPLE_QUALITY_PERFORMANCE),
+	 false, {70, 40, 30, 40}},
+	{"box area roi mask", AREA(BLUR_ALGO_BOX, 3.5f, 2, 0), false,
+	 {16, 8, 80, 40}, true},
+	{"box area mask", AREA(BLUR_ALGO_BOX, 3.5f, 2, 0), false, {0}, true},
+	{"box directional roi",
+	 {.blur_algorithm = BLUR_ALGO_BOX,
+	  .blur_type = BLUR_TYPE_DIRECTIONAL,
+	  .radius = 4.0f,
+	  .passes = 2,
+	  .angle = 45.0f},
+	 false, {0, 0, 48, 48}},
+	{"gaussian tiltshift roi",
+	 {.blur_algorithm = BLUR_ALGO_GAUSSIAN,
+	  .blur_type = BLUR_TYPE_TILTSHIFT,
+	  .radius = 8.0f,
+	  .tilt_shift_top = 0.0f,
+	  .tilt_shift_bottom = 0.5f},
+	 false, {56, 56, 16, 16}},
+	{"kawase area roi", AREA(BLUR_ALGO_KAWASE, 10.0f, 1, 0), false,
+	 {40, 30, 24, 24}},
+	{"box area prefix sum roi", AREA(BLUR_ALGO_BOX, 30.0f, 1, 0), false,
+	 {40, 30, 24, 24}},
+	{"temporal box", TRAIL(6, TEMPORAL_MODE_BOX, 0), false},
+	{"temporal exponential", TRAIL(6, TEMPORAL_MODE_EXPONENTIAL, 0),
+	 false},
+	{"temporal box background", TRAIL(4, TEMPORAL_MODE_BOX, 0), true},
+	{"temporal box roi", TRAIL(4, TEMPORAL_MODE_BOX, 0), false,
+	 {24, 16, 40, 32}},
+	// 30 frames at 128x96 need 1.4 MB, so the trail turns exponential.
+	{"temporal box over memory limit", TRAIL(30, TEMPORAL_MODE_BOX, 1),
+	 false},
+	{"gaussian area half float", AREA(BLUR_ALGO_GAUSSIAN, 6.0f, 1, 0),
+	 false, {0}, false, PRECISION_16F},
+	{"box area 10 bit", AREA(BLUR_ALGO_BOX, 3.5f, 2, 0), false, {0}, false,
+	 PRECISION_10BIT},
+	{"kawase area hdr", AREA(BLUR_ALGO_KAWASE, 10.0f, 1, 0), false, {0},
+	 false, PRECISION_AUTO, GS_CS_709_EXTENDED},
+	{"recursive area hdr 8 bit", AREA(BLUR_ALGO_RECURSIVE, 12.0f, 1, 0),
+	 false, {0}, false, PRECISION_8BIT, GS_CS_709_EXTENDED},
+};
+
+struct pipeline_options {
+	uint32_t width;
+	uint32_t height;
+	const char *filter;
+	const char *data_path;
+};
+
+struct frame {
+	struct mock_stats stats;
+	struct blur_image output;
+};
+
+static bool parse_args(int argc, char **argv, struct pipeline_options *opts)
+{
+	opts->width = 128;
+	opts->height = 96;
+	opts->filter = NULL;
+	opts->data_path = MOCK_OBS_DATA_PATH;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		if (strcmp(arg, "--size") == 0 && value) {
+			if (sscanf(value, "%ux%u", &opts->width,
+				   &opts->height) != 2 ||
+			    opts->width < 8 || opts->height < 8) {
+				fprintf(stderr, "bad --size: %s\n", value);
+				return false;
+			}
+			i++;
+		} else if (strcmp(arg, "--case") == 0 && value) {
+			opts->filter = value;
+			i++;
+		} else if (strcmp(arg, "--data") == 0 && value) {
+			opts->data_path = value;
+			i++;
+		} else if (strcmp(arg, "--trace") == 0) {
+			mock_set_trace(stderr);
+		} else if (strcmp(arg, "--verbose") == 0) {
+			mock_set_log_level(LOG_INFO);
+		} else {
+			fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Test card like the bench's.  With a background it has a soft alpha
+// ramp, or hard alpha edges, so compositing has something to show.
+static void fill_input(struct blur_image *image,
+		       const struct pipeline_case *test, uint32_t seed)
+{
+	for (uint32_t y = 0; y < image->height; y++) {
+		for (uint32_t x = 0; x < image->width; x++) {
+			float *px = image->data +
+				    ((size_t)y * image->width + x) * 4;
+			const bool check = ((x / 8) + (y / 8)) % 2 == 0;
+			seed = seed * 1664525u + 1013904223u;
+			px[0] = check ? 0.9f : 0.1f;
+			px[1] = (float)x / (float)image->width;
+			px[2] = (float)(seed >> 24) / 255.0f;
+			px[3] = 1.0f;
+			if (test->alpha_edges &&
+			    ((x / 2) + (y / 3)) % 2 == 0) {
+				// White where it is clear, which compositing
+				// must hide.
+				px[0] = px[1] = px[2] = 1.0f;
+				px[3] = 0.0f;
+			} else if (test->background && !test->alpha_edges)
+				px[3] = (float)y / (float)(image->height - 1);
+		}
+	}
+}
+
+// Opaque on the left half, clear on the right.
+static void fill_mask(struct blur_image *image)
+{
+	for (uint32_t y = 0; y < image->height; y++) {
+		for (uint32_t x = 0; x < image->width; x++) {
+			float *px = image->data +
+				    ((size_t)y * image->width + x) * 4;
+			px[0] = px[1] = px[2] = 1.0f;
+			px[3] = x < image->width / 2 ? 1.0f : 0.0f;
+		}
+	}
+}
+
+static bool roi_set(const struct pipeline_case *test)
+{
+	return test->mask || (test->roi.cx > 0 && test->roi.cy > 0);
+}
+
+// Output of roi.effect: the blur inside the region, where the mask is
+// over the threshold, and the input elsewhere.
+static void apply_roi(struct blur_image *blurred,
+		      const struct blur_image *input,
+		      const struct pipeline_case *test)
+{
+	struct gs_rect r = test->roi;
+	if (r.cx <= 0 || r.cy <= 0) {
+		r.x = 0;
+		r.y = 0;
+		r.cx = (int)blurred->width;
+		r.cy = (int)blurred->height;
+	}
+	for (uint32_t y = 0; y < blurred->height; y++) {
+		for (uint32_t x = 0; x < blurred->width; x++) {
+			const bool inside =
+				(int)x >= r.x && (int)y >= r.y &&
+				(int)x < r.x + r.cx && (int)y < r.y + r.cy &&
+				(!test->mask || x < blurred->width / 2);
+			if (inside)
+				continue;
+			const size_t i = ((size_t)y * blurred->width + x) * 4;
+			memcpy(blurred->data + i, input->data + i,
+			       4 * sizeof(float));
+		}
+	}
+}
+
+static void fill_background(struct blur_image *image)
+{
+	for (uint32_t y = 0; y < image->height; y++) {
+		for (uint32_t x = 0; x < image->width; x++) {
+			float *px = image->data +
+				    ((size_t)y * image->width + x) * 4;
+			px[0] = 0.2f;
+			px[1] = (float)y / (float)image->height;
+			px[2] = ((x / 16) % 2) ? 0.8f : 0.3f;
+			px[3] = 1.0f;
+		}
+	}
+}
+
+// What an 8 bit source texture holds of `image`.
+static void quantize(struct blur_image *image)
+{
+	const size_t count = (size_t)image->width * image->height * 4;
+	for (size_t i = 0; i < count; i++)
+		image->data[i] = roundf(image->data[i] * 255.0f) / 255.0f;
+}
+
+// Output of composite.effect.
+static void composite(struct blur_image *image,
+		      const struct blur_image *background)
+{
+	const size_t count = (size_t)image->width * image->height;
+	for (size_t i = 0; i < count; i++) {
+		float *px = image->data + i * 4;
+		const float *bg = background->data + i * 4;
+		for (int c = 0; c < 3; c++)
+			px[c] = px[c] * px[3] + bg[c] * (1.0f - px[3]);
+	}
+}
+
+// The filter output drawn onto a cleared canvas with the default blend
+// state.
+static void draw_on_canvas(struct blur_image *image)
+{
+	const size_t count = (size_t)image->width * image->height;
+	for (size_t i = 0; i < count; i++) {
+		float *px = image->data + i * 4;
+		for (int c = 0; c < 4; c++)
+			px[c] *= px[3];
+	}
+}
+
+static obs_data_t *case_settings(const struct pipeline_case *test,
+				 bool skip_unchanged)
+{
+	const struct blur_reference_params *p = &test->params;
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_int(settings, "blur_algorithm", p->blur_algorithm);
+	obs_data_set_int(settings, "blur_type", p->blur_type);
+	obs_data_set_double(settings, "radius", p->radius);
+	obs_data_set_int(settings, "passes", p->passes > 0 ? p->passes : 1);
+	obs_data_set_int(settings, "downsample_quality",
+			 p->downsample_quality);
+	obs_data_set_double(settings, "angle", p->angle);
+	obs_data_set_double(settings, "center_x", p->center_x);
+	obs_data_set_double(settings, "center_y", p->center_y);
+	obs_data_set_double(settings, "tilt_shift_top", p->tilt_shift_top);
+	obs_data_set_double(settings, "tilt_shift_bottom",
+			    p->tilt_shift_bottom);
+	obs_data_set_int(settings, "temporal_frames", p->temporal_frames);
+	obs_data_set_int(settings, "temporal_mode", p->temporal_mode);
+	obs_data_set_int(settings, "temporal_memory", p->temporal_memory);
+	obs_data_set_string(settings, "background",
+			    test->background ? "background" : "");
+	obs_data_set_bool(settings, "skip_unchanged", skip_unchanged);
+	obs_data_set_bool(settings, "roi_enabled", roi_set(test));
+	obs_data_set_int(settings, "roi_x", test->roi.x);
+	obs_data_set_int(settings, "roi_y", test->roi.y);
+	obs_data_set_int(settings, "roi_width", test->roi.cx);
+	obs_data_set_int(settings, "roi_height", test->roi.cy);
+	obs_data_set_string(settings, "roi_mask", test->mask ? "mask" : "");
+	obs_data_set_double(settings, "roi_mask_threshold", 0.5);
+	obs_data_set_int(settings, "precision", test->precision);
+	return settings;
+}
+
+static void render(obs_source_t *filter, struct frame *frame)
+{
+	mock_reset_stats();
+	mock_filter_render(filter, 1.0f / 60.0f, &frame->output);
+	mock_get_stats(&frame->stats);
+}
+
+// Space the filter blurs in and reports for the case's settings.
+static enum gs_color_space expected_space(const struct pipeline_case *test)
+{
+	switch (test->precision) {
+	case PRECISION_8BIT:
+	case PRECISION_10BIT:
+		return GS_CS_SRGB;
+	case PRECISION_16F:
+		return test->space == GS_CS_SRGB ? GS_CS_SRGB_16F : test->space;
+	default:
+		return test->space;
+	}
+}
+
+// Whether any pass of the case may render into an 8 bit target.  The
+// background and mask sources of SDR work are 8 bit.
+static bool uses_8bit(const struct pipeline_case *test)
+{
+	if (test->precision == PRECISION_10BIT)
+		return test->background || test->mask;
+	return expected_space(test) == GS_CS_SRGB;
+}
+
+static bool same_image(const struct blur_image *a, const struct blur_image *b)
+{
+	return a->width == b->width && a->height == b->height &&
+	       blur_image_max_error(a, b) == 0.0;
+}
+
+static bool check(bool ok, const char *name, const char *what)
+{
+	if (!ok)
+		fprintf(stderr, "%s: %s\n", name, what);
+	return ok;
+}
+
+static bool check_state(const struct pipeline_case *test,
+			const struct mock_stats *stats)
+{
+	bool ok = true;
+	ok &= check(stats->blend_pushes == stats->blend_pops &&
+			    !stats->blend_underflows,
+		    test->name, "blend state pushes and pops differ");
+	ok &= check(stats->texrender_begins == stats->texrender_ends &&
+			    !stats->unbalanced_ends,
+		    test->name, "texrender begins and ends differ");
+	ok &= check(!stats->rejected_begins, test->name,
+		    "texrender begun again without a reset");
+	ok &= check(!stats->feedback_draws, test->name,
+		    "draw samples its own render target");
+	ok &= check(!stats->unreset_scissors, test->name,
+		    "scissor rect left set at the end of the frame");
+	return ok;
+}
+
+static bool check_shared_background(const struct pipeline_case *test,
+				    obs_source_t *input,
+				    const struct frame *single,
+				    uint64_t texrender_passes,
+				    uint64_t composite_passes)
+{
+	obs_source_t *filters[SHARED_FILTERS];
+	struct blur_image outputs[SHARED_FILTERS] = {0};
+	obs_data_t *settings = case_settings(test, false);
+	for (size_t i = 0; i < SHARED_FILTERS; i++)
+		filters[i] = mock_filter_create(&obs_composite_blur, test->name,
+						input, settings);
+	obs_data_release(settings);
+
+	// Each filter blurs, the background renders once.
+	const uint64_t expected =
+		SHARED_FILTERS * (texrender_passes + composite_passes) + 1;
+	bool ok = true;
+	for (int frame = 0; frame < 2; frame++) {
+		struct mock_stats stats;
+		mock_reset_stats();
+		mock_filters_render(filters, SHARED_FILTERS, 1.0f / 60.0f,
+				    outputs);
+		mock_get_stats(&stats);
+		ok &= check_state(test, &stats);
+		ok &= check(stats.texrender_begins == expected, test->name,
+			    "shared background rendered more than once");
+		for (size_t i = 0; i < SHARED_FILTERS; i++)
+			ok &= check(same_image(&outputs[i], &single->output),
+				    test->name,
+				    "shared background shows different pixels");
+	}
+
+	for (size_t i = 0; i < SHARED_FILTERS; i++) {
+		obs_source_release(filters[i]);
+		blur_image_free(&outputs[i]);
+	}
+	return ok;
+}
+
+/*
+ *  Renames the background source: the filter's setting follows, and
+ *  applying the renamed setting neither looks the source up again nor
+ *  renders the unchanged frame again.  The name is restored afterwards.
+ */
+static bool check_renamed_background(const struct pipeline_case *test,
+				     obs_source_t *filter,
+				     obs_source_t *background,
+				     const struct frame *shown)
+{
+	mock_source_set_name(background, "renamed background");
+	obs_data_t *settings = obs_source_get_settings(filter);
+	bool ok = check(strcmp(obs_data_get_string(settings, "background"),
+			       "renamed background") == 0,
+			test->name, "background setting did not follow a rename");
+	obs_source_update(filter, settings);
+	obs_data_release(settings);
+
+	struct frame frame = {0};
+	render(filter, &frame);
+	ok &= check(!frame.stats.source_lookups, test->name,
+		    "renamed background looked up again");
+	ok &= check(frame.stats.texrender_begins <
+			    shown->stats.texrender_begins,
+		    test->name, "renamed background rendered the frame again");
+	ok &= check(same_image(&frame.output, &shown->output), test->name,
+		    "renamed background shows different pixels");
+	blur_image_free(&frame.output);
+
+	mock_source_set_name(background, "background");
+	return ok;
+}
+
+/*
+ *  Sweeps the radius of a fresh filter across the slider, one frame per
+ *  step.  The settings published by each update hold the
+ *  gaussian_1d.effect variants they can draw with, so the renders switch
+ *  between them without compiling, and releasing the filter frees the
+ *  effects only it held.
+ */
+static bool check_radius_sweep(const struct pipeline_case *test,
+			       obs_source_t *input)
+{
+	struct effect_cache_stats created;
+	effect_cache_get_stats(&created);
+	obs_data_t *settings = case_settings(test, false);
+	obs_source_t *filter = mock_filter_create(&obs_composite_blur,
+						  test->name, input, settings);
+	struct frame frame = {0};
+	render(filter, &frame);
+	blur_image_free(&frame.output);
+
+	bool ok = true;
+	uint64_t render_compiles = 0;
+	for (double radius = 1.0; radius <= SWEEP_RADIUS_MAX;
+	     radius += SWEEP_RADIUS_STEP) {
+		// Updated on this thread, as the tick would, ahead of the
+		// render measured.
+		obs_data_set_double(settings, "radius", radius);
+		mock_filter_update(filter, settings);
+		struct effect_cache_stats before;
+		effect_cache_get_stats(&before);
+		render(filter, &frame);
+		struct effect_cache_stats after;
+		effect_cache_get_stats(&after);
+		render_compiles += after.compiles - before.compiles;
+		ok &= check_state(test, &frame.stats);
+		blur_image_free(&frame.output);
+	}
+	ok &= check(render_compiles == 0, test->name,
+		    "radius sweep compiled effects while rendering");
+
+	obs_source_release(filter);
+	obs_data_release(settings);
+	struct effect_cache_stats released;
+	effect_cache_get_stats(&released);
+	ok &= check(released.effects == created.effects &&
+			    released.refs == created.refs,
+		    test->name, "released filter kept effects alive");
+	return ok;
+}
+
+struct update_thread {
+	obs_source_t *filter;
+	obs_data_t *settings[2];
+	volatile bool stop;
+	long updates;
+};
+
+// Alternates between the two settings until told to stop.
+static void *update_loop(void *param)
+{
+	struct update_thread *thread = param;
+	while (!os_atomic_load_bool(&thread->stop)) {
+		mock_filter_update(thread->filter,
+				   thread->settings[thread->updates % 2]);
+		thread->updates++;
+	}
+	return NULL;
+}
+
+/*
+ *  Renders frames while another thread updates the filter as fast as it
+ *  can, between the case's radius and half of it.  Each frame has to
+ *  show what a fresh filter shows for one of them, and once the updates
+ *  stop, the next frame the last one.
+ */
+static bool check_concurrent_updates(const struct pipeline_case *test,
+				     obs_source_t *input)
+{
+	struct update_thread thread = {0};
+	thread.settings[0] = case_settings(test, false);
+	thread.settings[1] = case_settings(test, false);
+	obs_data_set_double(thread.settings[1], "radius",
+			    test->params.radius * 0.5);
+
+	struct frame expected[2] = {0};
+	for (size_t i = 0; i < 2; i++) {
+		obs_source_t *filter = mock_filter_create(
+			&obs_composite_blur, test->name, input,
+			thread.settings[i]);
+		render(filter, &expected[i]);
+		obs_source_release(filter);
+	}
+
+	// The first frame applies the update of the filter's creation, the
+	// update thread is the only one calling update after that.
+	thread.filter = mock_filter_create(&obs_composite_blur, test->name,
+					   input, thread.settings[0]);
+	struct frame frame = {0};
+	render(thread.filter, &frame);
+	blur_image_free(&frame.output);
+
+	bool ok = true;
+	pthread_t updater;
+	if (pthread_create(&updater, NULL, update_loop, &thread) != 0) {
+		ok = check(false, test->name, "no update thread");
+	} else {
+		for (int i = 0; i < CONCURRENT_FRAMES; i++) {
+			render(thread.filter, &frame);
+			ok &= check_state(test, &frame.stats);
+			ok &= check(same_image(&frame.output,
+					       &expected[0].output) ||
+					    same_image(&frame.output,
+						       &expected[1].output),
+				    test->name,
+				    "frame during updates mixes settings");
+			blur_image_free(&frame.output);
+		}
+		os_atomic_set_bool(&thread.stop, true);
+		pthread_join(updater, NULL);
+
+		render(thread.filter, &frame);
+		const struct frame *last =
+			&expected[(thread.updates + 1) % 2];
+		ok &= check(thread.updates == 0 ||
+				    same_image(&frame.output, &last->output),
+			    test->name, "frame after updates missed the last");
+		blur_image_free(&frame.output);
+	}
+
+	obs_source_release(thread.filter);
+	for (size_t i = 0; i < 2; i++) {
+		obs_data_release(thread.settings[i]);
+		blur_image_free(&expected[i].output);
+	}
+	return ok;
+}
+
+/*
+ *  Feeds a fresh filter a different input every frame, past the end of
+ *  the trail so the ring wraps, and compares each output against the
+ *  reference trail.  Every frame renders the passes of the cost model.
+ */
+static bool check_trail(const struct pipeline_case *test,
+			const struct pipeline_options *opts,
+			obs_source_t *input,
+			const struct blur_image *background,
+			uint64_t texrender_passes, double *max_error)
+{
+	struct temporal_params trail;
+	temporal_params_for_frames(test->params.temporal_frames,
+				   test->params.temporal_mode,
+				   test->params.temporal_memory, opts->width,
+				   opts->height, &trail);
+
+	obs_data_t *settings = case_settings(test, false);
+	obs_source_t *filter = mock_filter_create(&obs_composite_blur,
+						  test->name, input, settings);
+	obs_data_release(settings);
+	struct temporal_reference *reference =
+		temporal_reference_create(&test->params);
+
+	struct blur_image image = {0};
+	struct blur_image expected = {0};
+	struct frame frame = {0};
+	blur_image_init(&image, opts->width, opts->height);
+	bool ok = true;
+	for (int i = 0; i < trail.frames + 3; i++) {
+		fill_input(&image, test, 10 + (uint32_t)i);
+		quantize(&image);
+		mock_source_set_image(input, &image);
+		render(filter, &frame);
+		ok &= check_state(test, &frame.stats);
+		ok &= check(frame.stats.texrender_begins == texrender_passes,
+			    test->name, "trail frame renders extra passes");
+
+		if (background->data)
+			composite(&image, background);
+		temporal_reference_push(reference, &expected, &image);
+		if (roi_set(test))
+			apply_roi(&expected, &image, test);
+		draw_on_canvas(&expected);
+		const double error =
+			blur_image_max_error(&frame.output, &expected);
+		if (error > *max_error)
+			*max_error = error;
+	}
+	ok &= check(*max_error <= MAX_PIXEL_ERROR, test->name,
+		    "trail differs from the reference trail");
+
+	temporal_reference_destroy(reference);
+	obs_source_release(filter);
+	blur_image_free(&frame.output);
+	blur_image_free(&image);
+	blur_image_free(&expected);
+	return ok;
+}
+
+static bool run_case(bool *first, const struct pipeline_case *test,
+		     const struct pipeline_options *opts,
+		     obs_source_t *input)
+{
+	struct blur_reference_params params = test->params;
+	if (params.passes <= 0)
+		params.passes = 1;
+	struct blur_reference_cost cost;
+	if (!blur_reference_cost(&params, opts->width, opts->height, &cost)) {
+		fprintf(stderr, "%s: no cost model\n", test->name);
+		return false;
+	}
+
+	// Input and expected output
+	struct blur_image image = {0};
+	struct blur_image background = {0};
+	struct blur_image expected = {0};
+	blur_image_init(&image, opts->width, opts->height);
+	fill_input(&image, test, 1);
+	quantize(&image);
+	mock_source_set_color_space(input, test->space);
+	mock_source_set_image(input, &image);
+
+	obs_source_t *mask_source = NULL;
+	if (test->mask) {
+		struct blur_image mask = {0};
+		blur_image_init(&mask, opts->width, opts->height);
+		fill_mask(&mask);
+		mask_source = mock_source_create("mask", &mask);
+		blur_image_free(&mask);
+	}
+
+	obs_source_t *background_source = NULL;
+	if (test->background) {
+		blur_image_init(&background, opts->width, opts->height);
+		fill_background(&background);
+		quantize(&background);
+		background_source =
+			mock_source_create("background", &background);
+		composite(&image, &background);
+	}
+	const bool have_reference =
+		blur_reference_render(&expected, &image, &params);
+	if (have_reference && roi_set(test))
+		apply_roi(&expected, &image, test);
+	draw_on_canvas(&expected);
+
+	// The background adds its own pass.  The blurs composite in their
+	// first pass, a temporal trail has a composite pass of its own, which
+	// is skipped with the blur on unchanged frames.  A mask is rendered
+	// every frame.
+	const bool temporal = params.blur_algorithm == BLUR_ALGO_TEMPORAL;
+	const uint64_t composite_passes = test->background && temporal ? 1 : 0;
+	const uint64_t extra = (test->background ? 1 : 0) + composite_passes +
+			       (test->mask ? 1 : 0);
+	// The last blur pass draws straight into the canvas, unless the
+	// output is kept- for a region of interest, or a trail, which the
+	// cost model counts already.  The kept output is drawn once more.
+	const uint64_t kept = roi_set(test) && !temporal ? 1 : 0;
+
+	obs_data_t *settings = case_settings(test, false);
+	obs_source_t *filter = mock_filter_create(&obs_composite_blur,
+						  test->name, input, settings);
+	obs_data_release(settings);
+
+	struct frame frames[5] = {0};
+	bool ok = true;
+
+	// 1. First frame, compared against the cost model and reference.
+	render(filter, &frames[0]);
+	const struct mock_stats *stats = &frames[0].stats;
+	ok &= check_state(test, stats);
+	ok &= check(stats->texrender_begins ==
+			    (uint64_t)cost.texrender_passes + extra + kept,
+		    test->name, "texrender passes differ from the cost model");
+	ok &= check(stats->draws == (uint64_t)cost.draws + extra + kept,
+		    test->name, "draws differ from the cost model");
+	ok &= check(obs_source_get_color_space(filter, 0, NULL) ==
+			    expected_space(test),
+		    test->name, "filter reports another color space");
+	if (!uses_8bit(test))
+		ok &= check(!stats->begins_8bit, test->name,
+			    "pass rendered into an 8 bit target");
+
+	const bool executed = !stats->unexecuted_draws && have_reference;
+	double max_error = -1.0;
+	if (executed) {
+		max_error = blur_image_max_error(&frames[0].output, &expected);
+		ok &= check(max_error <= MAX_PIXEL_ERROR, test->name,
+			    "output differs from the reference blur");
+	}
+
+	// 2. Same frame again after an update that changes nothing- same
+	//    passes and pixels, fewer uploads, and no source lookups.
+	settings = case_settings(test, false);
+	obs_source_update(filter, settings);
+	obs_data_release(settings);
+	render(filter, &frames[1]);
+	ok &= check_state(test, &frames[1].stats);
+	ok &= check(!frames[1].stats.source_lookups, test->name,
+		    "update without changes looked up sources");
+	ok &= check(frames[1].stats.texrender_begins ==
+				    stats->texrender_begins &&
+			    frames[1].stats.draws == stats->draws,
+		    test->name, "second frame renders different passes");
+	ok &= check(same_image(&frames[1].output, &frames[0].output),
+		    test->name, "second frame renders different pixels");
+
+	// 3. With skip_unchanged, renders until the fingerprints are read
+	//    back, then an unchanged frame that skips the blur.
+	//    A temporal trail renders until a still input has filled it.
+	struct temporal_params trail = {.settle_frames = 1};
+	if (temporal)
+		temporal_params_for_frames(
+			params.temporal_frames, params.temporal_mode,
+			params.temporal_memory, opts->width, opts->height,
+			&trail);
+	settings = case_settings(test, true);
+	obs_source_update(filter, settings);
+	obs_data_release(settings);
+	render(filter, &frames[2]);
+	for (int i = 1; i < trail.settle_frames + FRAME_FINGERPRINT_LATENCY;
+	     i++)
+		render(filter, &frames[3]);
+	// An update that changes nothing keeps the frame unchanged.
+	settings = case_settings(test, true);
+	obs_source_update(filter, settings);
+	obs_data_release(settings);
+	render(filter, &frames[3]);
+	const uint64_t skipped = frames[2].stats.texrender_begins -
+				 frames[3].stats.texrender_begins;
+	ok &= check_state(test, &frames[3].stats);
+	ok &= check(skipped == (uint64_t)cost.blur_passes + composite_passes,
+		    test->name, "unchanged frame did not skip the blur");
+	ok &= check(same_image(&frames[3].output, &frames[2].output),
+		    test->name, "unchanged frame shows different pixels");
+
+	// 4. A changed input renders again, once its fingerprint was read
+	//    back.
+	fill_input(&image, test, 2);
+	mock_source_set_image(input, &image);
+	for (int i = 0; i <= FRAME_FINGERPRINT_LATENCY; i++)
+		render(filter, &frames[4]);
+	ok &= check(frames[4].stats.texrender_begins ==
+			    frames[2].stats.texrender_begins,
+		    test->name, "changed frame was not rendered");
+
+	// 5. Filters sharing the background in one frame render it once and
+	//    show the same pixels as a single fresh filter does for this
+	//    input.  Unlike the skip_unchanged filter above it draws its last
+	//    pass straight into the canvas, and a trail starts out as the
+	//    input.
+	if (test->background) {
+		struct frame single = {0};
+		settings = case_settings(test, false);
+		obs_source_t *filter_2 = mock_filter_create(
+			&obs_composite_blur, test->name, input, settings);
+		obs_data_release(settings);
+		render(filter_2, &single);
+		obs_source_release(filter_2);
+		ok &= check_shared_background(
+			test, input, &single,
+			(uint64_t)cost.texrender_passes + kept,
+			composite_passes);
+		blur_image_free(&single.output);
+	}
+
+	// 6. A trail over changing frames.
+	if (temporal && executed) {
+		ok &= check_trail(test, opts, input, &background,
+				  (uint64_t)cost.texrender_passes + extra,
+				  &max_error);
+	}
+
+	// 7. The background setting follows a rename of the source.
+	if (test->background && !temporal)
+		ok &= check_renamed_background(test, filter, background_source,
+					       &frames[4]);
+
+	// 8. Settings updated from another thread while frames render.
+	if (!temporal)
+		ok &= check_concurrent_updates(test, input);
+
+	// 9. A gaussian radius sweep, on the plain cases.
+	if (params.blur_algorithm == BLUR_ALGO_GAUSSIAN &&
+	    (params.blur_type == BLUR_TYPE_AREA ||
+	     params.blur_type == BLUR_TYPE_DIRECTIONAL) &&
+	    !test->background && !roi_set(test) && !test->precision)
+		ok &= check_radius_sweep(test, input);
+
+	obs_source_release(filter);
+	obs_source_release(background_source);
+	obs_source_release(mask_source);
+
+	printf("%s\n    {\"case\": \"%s\", \"texrender_passes\": %llu, "
+	       "\"expected_texrender_passes\": %llu, \"draws\": %llu, "
+	       "\"expected_draws\": %llu, \"unexecuted_draws\": %llu, "
+	       "\"frame_writes\": %.2f, \"param_sets\": %llu, "
+	       "\"param_sets_steady\": %llu, \"skipped_passes\": %llu, ",
+	       *first ? "" : ",", test->name,
+	       (unsigned long long)stats->texrender_begins,
+	       (unsigned long long)cost.texrender_passes + extra + kept,
+	       (unsigned long long)stats->draws,
+	       (unsigned long long)cost.draws + extra + kept,
+	       (unsigned long long)stats->unexecuted_draws,
+	       stats->frame_writes, (unsigned long long)stats->param_sets,
+	       (unsigned long long)frames[1].stats.param_sets,
+	       (unsigned long long)skipped);
+	if (executed)
+		printf("\"max_error\": %.5f, ", max_error);
+	else
+		printf("\"max_error\": null, ");
+	printf("\"ok\": %s}", ok ? "true" : "false");
+	fflush(stdout);
+	*first = false;
+
+	for (size_t i = 0; i < COUNT(frames); i++)
+		blur_image_free(&frames[i].output);
+	blur_image_free(&image);
+	blur_image_free(&background);
+	blur_image_free(&expected);
+	return ok;
+}
+
+/*
+ *  Fingerprints of a 1080p frame and of the same frame with one channel
+ *  of one texel an 8 bit step brighter.  The first has to come out
+ *  unchanged once read back, the second changed FRAME_FINGERPRINT_LATENCY
+ *  updates after it is first seen, not sooner.
+ */
+static bool check_fingerprint_step(void)
+{
+	const char *name = "fingerprint";
+	const uint32_t width = 1920;
+	const uint32_t height = 1080;
+	struct blur_image image = {0};
+	blur_image_init(&image, width, height);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			float *texel = image.data + ((size_t)y * width + x) * 4;
+			texel[0] = (float)((x * 7 + y * 3) % 256) / 255.0f;
+			texel[1] = (float)((x + y * 5) % 256) / 255.0f;
+			texel[2] = (float)((x * y) % 256) / 255.0f;
+			texel[3] = 1.0f;
+		}
+	}
+	gs_texture_t *before = mock_texture_create(GS_RGBA, &image);
+	// The first texel of a block at every level, which gets the least
+	// weight of any.
+	image.data[((size_t)512 * width + 1024) * 4 + 1] += 1.0f / 255.0f;
+	gs_texture_t *after = mock_texture_create(GS_RGBA, &image);
+	blur_image_free(&image);
+
+	gs_effect_t *effect =
+		effect_cache_acquire("/shaders/fingerprint.effect", NULL);
+	struct effect_params *params = effect_cache_get_params(effect);
+	struct frame_fingerprint fingerprint = {0};
+	bool ok = check(effect != NULL, name, "effect did not compile");
+
+	obs_enter_graphics();
+	bool changed = false;
+	for (int i = 0; i < FRAME_FINGERPRINT_LATENCY + 2; i++)
+		changed = frame_fingerprint_update(&fingerprint, effect,
+						   params, before);
+	ok &= check(!changed, name, "unchanged frame reported a change");
+	for (int i = 0; i < FRAME_FINGERPRINT_LATENCY; i++)
+		ok &= check(!frame_fingerprint_update(&fingerprint, effect,
+						      params, after),
+			    name, "change reported before it was read back");
+	ok &= check(frame_fingerprint_update(&fingerprint, effect, params,
+					     after),
+		    name, "one step in one texel was not seen");
+	frame_fingerprint_free(&fingerprint);
+	obs_leave_graphics();
+
+	effect_cache_release(effect);
+	mock_texture_destroy(before);
+	mock_texture_destroy(after);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	struct pipeline_options opts;
+	if (!parse_args(argc, argv, &opts))
+		return 1;
+
+	mock_obs_init(opts.data_path);
+	shader_preprocessor_init(NULL);
+
+	struct blur_image blank = {0};
+	blur_image_init(&blank, opts.width, opts.height);
+	obs_source_t *input = mock_source_create("input", &blank);
+	blur_image_free(&blank);
+
+	bool pass = true;
+	bool first = true;
+	printf("{\n  \"width\": %u,\n  \"height\": %u,\n  \"results\": [",
+	       opts.width, opts.height);
+	for (size_t i = 0; i < COUNT(cases); i++) {
+		if (opts.filter && !strstr(cases[i].name, opts.filter))
+			continue;
+		pass &= run_case(&first, &cases[i], &opts, input);
+	}
+	if (!opts.filter || strstr("fingerprint", opts.filter))
+		pass &= check_fingerprint_step();
+	printf("\n  ],\n  \"pass\": %s\n}\n", pass ? "true" : "false");
+
+	obs_source_release(input);
+	// Same teardown as obs_module_unload.
+	effect_cache_free();
+	texrender_pool_free();
+	background_cache_free();
+	shader_preprocessor_free();
+	kernel_cache_clear();
+	mock_obs_free();
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "box-kernel.h"
+
+#include <math.h>
+
+/*
+ *  The one-sided taps of a box of `radius` as linear samples, the way
+ *  gaussian_sample_kernel pairs gaussian taps.  Entry 0 is the center,
+ *  each further entry samples halfway between two whole texel taps with
+ *  their combined weight.  An odd last tap shares its sample with the
+ *  fractional residual tap at the radius- weights 1 and r at n and
+ *  n + r blend texels n and n + 1 as 1 + r - r^2 and r^2, which one
+ *  sample of weight 1 + r at n + r^2 / (1 + r) reads exactly.
+ *
+ *  box_1d.effect and box_tiltshift.effect walk the same entries from the
+ *  radius uniform.  Returns the number of entries written.
+ */
+size_t box_sample_kernel(float radius, float *weights, float *offsets,
+			 size_t max_size)
+{
+	if (max_size == 0)
+		return 0;
+	if (!(radius > 0.0f))
+		radius = 0.0f;
+
+	const float taps = floorf(radius);
+	const float residual = radius - taps;
+	const int pairs = (int)(taps * 0.5f);
+	size_t size = 0;
+
+	weights[size] = 1.0f;
+	offsets[size] = 0.0f;
+	size++;
+	for (int i = 0; i < pairs && size < max_size; i++) {
+		weights[size] = 2.0f;
+		offsets[size] = 2.0f * (float)i + 1.5f;
+		size++;
+	}
+	if (size == max_size)
+		return size;
+	if (taps > 2.0f * (float)pairs) {
+		weights[size] = 1.0f + residual;
+		offsets[size] = taps + residual * residual / (1.0f + residual);
+		size++;
+	} else if (residual > 0.0f) {
+		weights[size] = residual;
+		offsets[size] = radius;
+		size++;
+	}
+	return size;
+}
+
+// Texture fetches per pixel of one 1D box_1d.effect pass- the center,
+// then both sides out to the radius, one sample per pair of taps.
+int box_loop_taps(float radius)
+{
+	if (radius <= 0.0f)
+		return 1;
+	const int taps = (int)ceilf(radius);
+	return 1 + 2 * ((taps + 1) / 2);
+}
+
+int box_scan_passes(uint32_t size)
+{
+	int passes = 1;
+	uint64_t span = BOX_SCAN_RADIX;
+	while (span < size) {
+		span *= BOX_SCAN_RADIX;
+		passes++;
+	}
+	return passes;
+}
+
+int box_prefix_sum_taps(uint32_t size)
+{
+	return BOX_SCAN_RADIX * box_scan_passes(size) + BOX_WINDOW_TAPS;
+}
+
+/*
+ *  Whether a 1D box pass over `size` pixels is cheaper as a prefix sum
+ *  than as the looped shader.  The scan writes a float target per pass,
+ *  so each of its passes is charged like BOX_SCAN_RADIX more taps.
+ */
+bool box_use_prefix_sum(float radius, uint32_t size)
+{
+	const int scan_passes = box_scan_passes(size);
+	return box_loop_taps(radius) >
+	       box_prefix_sum_taps(size) + BOX_SCAN_RADIX * scan_passes;
+}
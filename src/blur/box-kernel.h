@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Each prefix sum scan pass adds up this many texels, so a row of n
+// pixels is summed in ceil(log4(n)) passes.
+#define BOX_SCAN_RADIX 4
+
+// Texture fetches per pixel of the window pass that turns a prefix sum
+// back into a box- 6 for the window and its fractional ends, 3 for the
+// edge texels that extend the sum past the border.
+#define BOX_WINDOW_TAPS 9
+
+// Entries box_sample_kernel writes for the largest radius of the slider.
+#define BOX_KERNEL_MAX_SIZE 64
+
+extern size_t box_sample_kernel(float radius, float *weights, float *offsets,
+				size_t max_size);
+extern int box_loop_taps(float radius);
+extern int box_scan_passes(uint32_t size);
+extern int box_prefix_sum_taps(uint32_t size);
+extern bool box_use_prefix_sum(float radius, uint32_t size);
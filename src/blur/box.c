@@ -33,7 +33,7 @@ void render_video_box(struct composite_blur_filter_data *data)
 		box_directional_blur(data);
 		break;
 	case TYPE_ZOOM:
-		box_zoom_blur(data);
+		zoom_blur(data, ZOOM_KERNEL_BOX);
 		break;
 	case TYPE_TILTSHIFT:
 		box_tilt_shift_blur(data);
@@ -46,12 +46,14 @@ void load_effect_box(struct composite_blur_filter_data *filter)
 	switch (filter->blur_type) {
 	case TYPE_AREA:
 		load_1d_box_effect(filter);
+		load_downsample_effect(filter);
+		load_prefix_sum_box_effect(filter);
 		break;
 	case TYPE_DIRECTIONAL:
 		load_1d_box_effect(filter);
 		break;
 	case TYPE_ZOOM:
-		load_radial_box_effect(filter);
+		load_zoom_effect(filter);
 		break;
 	case TYPE_TILTSHIFT:
 		load_tiltshift_box_effect(filter);
@@ -59,14 +61,114 @@ void load_effect_box(struct composite_blur_filter_data *filter)
 	}
 }
 
+/*
+ *  One 1D box pass as a prefix sum.  Scan passes ping-pong between two
+ *  float targets until every texel holds the sum of its line up to that
+ *  point, then the window pass reads the box sum for any radius from a
+ *  fixed number of texels of it.  The first scan pass composites
+ *  `texture` over `background` when there is one.
+ */
+static void box_prefix_sum_pass(struct composite_blur_filter_data *data,
+				gs_texture_t *texture,
+				gs_texture_t *background,
+				gs_texrender_t *target, uint32_t width,
+				uint32_t height, bool vertical, float radius)
+{
+	gs_effect_t *effect = data->effect_3;
+	struct effect_params *params = data->params_3;
+
+	struct vec2 size;
+	size.x = (float)width;
+	size.y = (float)height;
+	effect_params_set_vec2(params, EFFECT_PARAM_UV_SIZE, &size);
+	struct vec2 axis;
+	axis.x = vertical ? 0.0f : 1.0f;
+	axis.y = vertical ? 1.0f : 0.0f;
+	effect_params_set_vec2(params, EFFECT_PARAM_AXIS, &axis);
+	effect_params_set_float(params, EFFECT_PARAM_RADIUS, radius);
+
+	gs_texrender_t *sums[2];
+	sums[0] = texrender_pool_acquire(GS_RGBA32F, width, height,
+					 data->space);
+	sums[1] = texrender_pool_acquire(GS_RGBA32F, width, height,
+					 data->space);
+
+	// 1. Scan passes, the first one also applies the bias.
+	const int passes = box_scan_passes(vertical ? height : width);
+	float scan_stride = 1.0f;
+	for (int i = 0; i < passes; i++) {
+		gs_texrender_t *sum = sums[i % 2];
+		gs_texrender_reset(sum);
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, i == 0 ? background : NULL, texture);
+		effect_params_set_float(params, EFFECT_PARAM_STRIDE,
+					scan_stride);
+		effect_params_set_float(params, EFFECT_PARAM_BIAS,
+					i == 0 ? 0.5f : 0.0f);
+		if (gs_texrender_begin(sum, width, height)) {
+			while (gs_effect_loop(effect, "Scan"))
+				roi_draw_sprite(data, texture, width, height);
+			gs_texrender_end(sum);
+		}
+		texture = gs_texrender_get_texture(sum);
+		scan_stride *= (float)BOX_SCAN_RADIX;
+	}
+
+	// 2. Window pass into the 8 bit target.
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	composite_bind(params, NULL, NULL);
+	effect_params_set_float(params, EFFECT_PARAM_BIAS, 0.5f);
+	if (target_begin(target, width, height)) {
+		while (gs_effect_loop(effect, "Window"))
+			roi_draw_sprite(data, texture, width, height);
+		target_end(target);
+	}
+
+	texrender_pool_release(sums[0]);
+	texrender_pool_release(sums[1]);
+}
+
+// One 1D pass of an area blur, looped or as a prefix sum depending on
+// which is cheaper for the radius.  Composites `texture` over
+// `background` as it reads it when there is one.
+static void box_area_pass(struct composite_blur_filter_data *data,
+			  gs_texture_t *texture, gs_texture_t *background,
+			  gs_texrender_t *target, uint32_t width,
+			  uint32_t height, bool vertical, float radius)
+{
+	if (data->effect_3 &&
+	    box_use_prefix_sum(radius, vertical ? height : width)) {
+		box_prefix_sum_pass(data, texture, background, target, width,
+				    height, vertical, radius);
+		return;
+	}
+
+	gs_effect_t *effect = data->effect;
+	struct effect_params *params = data->params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	composite_bind(params, background, texture);
+	effect_params_set_float(params, EFFECT_PARAM_RADIUS, radius);
+
+	struct vec2 direction;
+	direction.x = vertical ? 0.0f : 1.0f / width;
+	direction.y = vertical ? 1.0f / height : 0.0f;
+	effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP, &direction);
+
+	if (target_begin(target, width, height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			roi_draw_sprite(data, texture, width, height);
+		target_end(target);
+	}
+}
+
 /*
  *  Performs an area blur using the box kernel.  Blur is
- *  equal in both x and y directions.
+ *  equal in both x and y directions.  Large radii switch to a prefix
+ *  sum, so the cost per pass stops growing with the radius.
  */
 static void box_area_blur(struct composite_blur_filter_data *data)
 {
 	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -74,66 +176,54 @@ static void box_area_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
-
-	for (int i = 0; i < data->passes; i++) {
-		data->render2 = create_or_reset_texrender(data->render2);
-
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
-
-		const float radius = (float)data->radius;
-		gs_eparam_t *radius_param =
-			gs_effect_get_param_by_name(effect, "radius");
-		gs_effect_set_float(radius_param, radius);
-
-		gs_eparam_t *texel_step =
-			gs_effect_get_param_by_name(effect, "texel_step");
-		struct vec2 direction;
+	gs_texture_t *background = composite_background(data);
 
-		// 1. First pass- apply 1D blur kernel to horizontal dir.
+	struct downsample_state ds;
+	texture = downsample_begin(data, texture, &background,
+				   DOWNSAMPLE_KERNEL_BOX, &ds);
 
-		direction.x = 1.0f / data->width;
-		direction.y = 0.0f;
-		gs_effect_set_vec2(texel_step, &direction);
+	gs_texrender_t *scratch = texrender_pool_acquire(
+		data->format, ds.width, ds.height, data->space);
+	// Repeated passes keep the columns of all but the last one here.
+	gs_texrender_t *columns = NULL;
+	if (data->passes > 1) {
+		columns = texrender_pool_acquire(data->format, ds.width,
+						 ds.height, data->space);
+	}
+	const float radius = ds.params.radius;
 
-		set_blending_parameters();
-		//set_render_parameters();
+	set_blending_parameters();
+	//set_render_parameters();
 
-		if (gs_texrender_begin(data->render2, data->width,
-				       data->height)) {
-			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->render2);
-		}
+	for (int i = 0; i < data->passes; i++) {
+		// 1. First pass- apply 1D blur kernel to horizontal dir.  The
+		//    very first one reads the input and composites it.
+		gs_texrender_reset(scratch);
+		box_area_pass(data, texture, i == 0 ? background : NULL,
+			      scratch, ds.width, ds.height, false, radius);
 
 		// 2. Save texture from first pass in variable "texture"
-		texture = gs_texrender_get_texture(data->render2);
+		texture = gs_texrender_get_texture(scratch);
 
 		// 3. Second Pass- Apply 1D blur kernel vertically.
-		image = gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
-
-		direction.x = 0.0f;
-		direction.y = 1.0f / data->height;
-		gs_effect_set_vec2(texel_step, &direction);
-
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
-
-		if (gs_texrender_begin(data->output_texrender, data->width,
-				       data->height)) {
-			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->output_texrender);
+		gs_texrender_t *target = columns;
+		if (i == data->passes - 1) {
+			target = downsample_target(data, &ds);
+		} else {
+			gs_texrender_reset(columns);
 		}
+		box_area_pass(data, texture, NULL, target, ds.width, ds.height,
+			      true, radius);
 
-		texture = gs_texrender_get_texture(data->output_texrender);
-		gs_blend_state_pop();
+		texture = gs_texrender_get_texture(target);
 	}
+
+	gs_blend_state_pop();
+	texrender_pool_release(scratch);
+	texrender_pool_release(columns);
+
+	// 4. Back to full size, if blurred at reduced resolution.
+	downsample_end(data, &ds);
 }
 
 /*
@@ -142,7 +232,6 @@ static void box_area_blur(struct composite_blur_filter_data *data)
 static void box_directional_blur(struct composite_blur_filter_data *data)
 {
 	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -150,120 +239,56 @@ static void box_directional_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
+	gs_texture_t *background = composite_background(data);
+
+	// Passes ping-pong between two pooled scratch targets, the last one
+	// draws to the output.
+	gs_texrender_t *scratch[2] = {NULL, NULL};
+	for (int i = 0; i < 2 && i < data->passes - 1; i++) {
+		scratch[i] = texrender_pool_acquire(data->format, data->width,
+						    data->height, data->space);
+	}
 
 	for (int i = 0; i < data->passes; i++) {
-		gs_texrender_t *tmp = data->render2;
-		data->render2 = data->output_texrender;
-		data->output_texrender = tmp;
+		gs_texrender_t *target;
+		if (i == data->passes - 1) {
+			target = output_target(data);
+		} else {
+			target = scratch[i % 2];
+			gs_texrender_reset(target);
+		}
 
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
+		struct effect_params *params = data->params;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, i == 0 ? background : NULL, texture);
 
 		const float radius = (float)data->radius;
-		gs_eparam_t *radius_param =
-			gs_effect_get_param_by_name(effect, "radius");
-		gs_effect_set_float(radius_param, radius);
+		effect_params_set_float(params, EFFECT_PARAM_RADIUS, radius);
 
-		gs_eparam_t *texel_step =
-			gs_effect_get_param_by_name(effect, "texel_step");
 		struct vec2 direction;
 
 		// 1. Single pass- blur only in one direction
 		float rads = -data->angle * (M_PI / 180.0f);
 		direction.x = (float)cos(rads) / data->width;
 		direction.y = (float)sin(rads) / data->height;
-		gs_effect_set_vec2(texel_step, &direction);
+		effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP,
+				       &direction);
 
 		set_blending_parameters();
 		//set_render_parameters();
 
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
-
-		if (gs_texrender_begin(data->output_texrender, data->width,
-				       data->height)) {
+		if (target_begin(target, data->width, data->height)) {
 			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->output_texrender);
+				roi_draw_sprite(data, texture, data->width,
+						data->height);
+			target_end(target);
 		}
-		texture = gs_texrender_get_texture(data->output_texrender);
+		texture = gs_texrender_get_texture(target);
 		gs_blend_state_pop();
 	}
-}
-
-/*
- *  Performs a zoom blur using the gaussian kernel. Blur for a pixel
- *  is performed in direction of zoom center point.
- */
-static void box_zoom_blur(struct composite_blur_filter_data *data)
-{
-	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
-
-	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
-
-	if (!effect || !texture) {
-		return;
-	}
-
-	texture = blend_composite(texture, data);
-
-	for (int i = 0; i < data->passes; i++) {
-		gs_texrender_t *tmp = data->render2;
-		data->render2 = data->output_texrender;
-		data->output_texrender = tmp;
-
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
-
-		const float radius = (float)data->radius;
-		gs_eparam_t *radius_param =
-			gs_effect_get_param_by_name(effect, "radius");
-		gs_effect_set_float(radius_param, radius);
-
-		gs_eparam_t *texel_step =
-			gs_effect_get_param_by_name(effect, "texel_step");
-
-		gs_eparam_t *radial_center =
-			gs_effect_get_param_by_name(effect, "radial_center");
-
-		struct vec2 coord;
-
-		coord.x = data->center_x;
-		coord.y = data->center_y;
-
-		// 1. Single pass- blur only in one direction
-		gs_effect_set_vec2(radial_center, &coord);
-
-		gs_eparam_t *uv_size =
-			gs_effect_get_param_by_name(effect, "uv_size");
-
-		struct vec2 size;
-		size.x = (float)data->width;
-		size.y = (float)data->height;
-
-		gs_effect_set_vec2(uv_size, &size);
-
-		set_blending_parameters();
-		//set_render_parameters();
-
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
 
-		if (gs_texrender_begin(data->output_texrender, data->width,
-				       data->height)) {
-			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->output_texrender);
-		}
-		texture = gs_texrender_get_texture(data->output_texrender);
-		gs_blend_state_pop();
-	}
+	texrender_pool_release(scratch[0]);
+	texrender_pool_release(scratch[1]);
 }
 
 /*
@@ -273,7 +298,6 @@ static void box_zoom_blur(struct composite_blur_filter_data *data)
 static void box_tilt_shift_blur(struct composite_blur_filter_data *data)
 {
 	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -281,36 +305,35 @@ static void box_tilt_shift_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
+	gs_texture_t *background = composite_background(data);
+
+	gs_texrender_t *scratch = texrender_pool_acquire(
+		data->format, data->width, data->height, data->space);
+	// Repeated passes keep the columns of all but the last one here.
+	gs_texrender_t *columns = NULL;
+	if (data->passes > 1) {
+		columns = texrender_pool_acquire(data->format, data->width,
+						 data->height, data->space);
+	}
 
 	for (int i = 0; i < data->passes; i++) {
-		data->render2 = create_or_reset_texrender(data->render2);
+		gs_texrender_reset(scratch);
 
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
+		struct effect_params *params = data->params;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, i == 0 ? background : NULL, texture);
 		const float radius = (float)data->radius;
-		gs_eparam_t *radius_param =
-			gs_effect_get_param_by_name(effect, "radius");
-		gs_effect_set_float(radius_param, radius);
+		effect_params_set_float(params, EFFECT_PARAM_RADIUS, radius);
 
 		const int radius_i = (int)data->radius;
-		gs_eparam_t *radius_i_param =
-			gs_effect_get_param_by_name(effect, "radius_i");
-		gs_effect_set_int(radius_i_param, radius_i);
+		effect_params_set_int(params, EFFECT_PARAM_RADIUS_I, radius_i);
 
 		const float bottom = 1.0f - (float)data->tilt_shift_bottom;
-		gs_eparam_t *bottom_param =
-			gs_effect_get_param_by_name(effect, "bottom");
-		gs_effect_set_float(bottom_param, bottom);
+		effect_params_set_float(params, EFFECT_PARAM_BOTTOM, bottom);
 
 		const float top = (float)data->tilt_shift_top;
-		gs_eparam_t *top_param =
-			gs_effect_get_param_by_name(effect, "top");
-		gs_effect_set_float(top_param, top);
+		effect_params_set_float(params, EFFECT_PARAM_TOP, top);
 
-		gs_eparam_t *texel_step =
-			gs_effect_get_param_by_name(effect, "texel_step");
 		struct vec2 direction;
 
 		// 1. First pass- apply 1D blur kernel to horizontal dir.
@@ -321,113 +344,76 @@ static void box_tilt_shift_blur(struct composite_blur_filter_data *data)
 		// obs_log(LOG_INFO, "%f, %f, %f, %f, %f", radius, bottom, top,
 		// 	direction.x, direction.y);
 
-		gs_effect_set_vec2(texel_step, &direction);
-
-		gs_eparam_t *uv_size =
-			gs_effect_get_param_by_name(effect, "uv_size");
+		effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP,
+				       &direction);
 
 		struct vec2 size;
 		size.x = (float)data->width;
 		size.y = (float)data->height;
 
-		gs_effect_set_vec2(uv_size, &size);
+		effect_params_set_vec2(params, EFFECT_PARAM_UV_SIZE, &size);
 
 		set_blending_parameters();
 		//set_render_parameters();
 
-		if (gs_texrender_begin(data->render2, data->width,
-				       data->height)) {
+		if (gs_texrender_begin(scratch, data->width, data->height)) {
 			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->render2);
+				roi_draw_sprite(data, texture, data->width,
+						data->height);
+			gs_texrender_end(scratch);
 		}
 
 		// 2. Save texture from first pass in variable "texture"
-		texture = gs_texrender_get_texture(data->render2);
+		texture = gs_texrender_get_texture(scratch);
 
 		// 3. Second Pass- Apply 1D blur kernel vertically.
-		image = gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, NULL, NULL);
 
 		direction.x = 0.0f;
 		direction.y = 1.0f / data->height;
-		gs_effect_set_vec2(texel_step, &direction);
-
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
+		effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP,
+				       &direction);
+
+		gs_texrender_t *target = columns;
+		if (i == data->passes - 1) {
+			target = output_target(data);
+		} else {
+			gs_texrender_reset(columns);
+		}
 
-		if (gs_texrender_begin(data->output_texrender, data->width,
-				       data->height)) {
+		if (target_begin(target, data->width, data->height)) {
 			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->output_texrender);
+				roi_draw_sprite(data, texture, data->width,
+						data->height);
+			target_end(target);
 		}
-		texture = gs_texrender_get_texture(data->output_texrender);
+		texture = gs_texrender_get_texture(target);
 		gs_blend_state_pop();
 	}
+
+	texrender_pool_release(scratch);
+	texrender_pool_release(columns);
 }
 
 static void load_1d_box_effect(struct composite_blur_filter_data *filter)
 {
 	const char *effect_file_path = "/shaders/box_1d.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
-		}
-	}
+	filter->params = effect_cache_get_params(filter->effect);
 }
 
 static void load_tiltshift_box_effect(struct composite_blur_filter_data *filter)
 {
 	const char *effect_file_path = "/shaders/box_tiltshift.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
-		}
-	}
+	filter->params = effect_cache_get_params(filter->effect);
 }
 
-static void load_radial_box_effect(struct composite_blur_filter_data *filter)
+static void
+load_prefix_sum_box_effect(struct composite_blur_filter_data *filter)
 {
-	const char *effect_file_path = "/shaders/box_radial.effect";
-	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
-		}
-	}
-}
\ No newline at end of file
+	filter->effect_3 = load_shader_effect(
+		filter->effect_3, "/shaders/box_prefix_sum.effect");
+	filter->params_3 = effect_cache_get_params(filter->effect_3);
+}
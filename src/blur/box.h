@@ -4,19 +4,33 @@
 #include <obs-module.h>
 #include <obs-utils.h>
 #include <obs-composite-blur-filter.h>
+#include "downsample.h"
+#include "zoom.h"
+#include "box-kernel.h"
+
+struct composite_blur_filter_data;
 
 extern void set_box_blur_types(obs_properties_t *props);
 extern void box_setup_callbacks(struct composite_blur_filter_data *data);
 extern void render_video_box(struct composite_blur_filter_data *data);
 extern void load_effect_box(struct composite_blur_filter_data *filter);
 
+static void box_prefix_sum_pass(struct composite_blur_filter_data *data,
+				gs_texture_t *texture,
+				gs_texture_t *background,
+				gs_texrender_t *target, uint32_t width,
+				uint32_t height, bool vertical, float radius);
+static void box_area_pass(struct composite_blur_filter_data *data,
+			  gs_texture_t *texture, gs_texture_t *background,
+			  gs_texrender_t *target, uint32_t width,
+			  uint32_t height, bool vertical, float radius);
 static void box_area_blur(struct composite_blur_filter_data *data);
 static void box_directional_blur(struct composite_blur_filter_data *data);
-static void box_zoom_blur(struct composite_blur_filter_data *data);
 // static void box_motion_blur(struct composite_blur_filter_data *data);
 static void box_tilt_shift_blur(struct composite_blur_filter_data *data);
 
 static void load_1d_box_effect(struct composite_blur_filter_data *filter);
 static void
 load_tiltshift_box_effect(struct composite_blur_filter_data *filter);
-static void load_radial_box_effect(struct composite_blur_filter_data *filter);
\ No newline at end of file
+static void
+load_prefix_sum_box_effect(struct composite_blur_filter_data *filter);
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "downsample-kernel.h"
+
+#include <math.h>
+
+// Smallest kernel radius, in reduced pixels, each quality setting will
+// accept before giving up a further 2x reduction.  Below ~4px the
+// bilinear footprint of the resampling starts to dominate the shape of
+// the blur.
+static const float min_reduced_radius[] = {0.0f, 16.0f, 8.0f, 4.0f};
+
+// Never reduce the frame below this many pixels on its short side.
+#define DOWNSAMPLE_MIN_SIZE 16
+
+/*
+ *  Kernel radius to use after `levels` 2x reductions.  The gaussian
+ *  radius is reduced so the whole chain keeps the requested sigma
+ *  (= radius)- each halving is a 2x2 box, adding (f^2 - 1) / 12 full
+ *  resolution px^2 of variance in total, and the cubic b-spline upsample
+ *  adds 1/3 reduced px^2.
+ */
+float downsample_reduced_radius(float radius, int levels,
+				enum downsample_kernel kernel)
+{
+	if (levels <= 0)
+		return radius;
+
+	const float factor = (float)(1 << levels);
+	if (kernel == DOWNSAMPLE_KERNEL_GAUSSIAN) {
+		const float reduced = radius / factor;
+		const float variance = reduced * reduced -
+				       (factor * factor - 1.0f) /
+					       (12.0f * factor * factor) -
+				       1.0f / 3.0f;
+		return variance > 0.0f ? sqrtf(variance) : 0.0f;
+	}
+	// Keep the box width, 2r + 1 pixels, in reduced pixels.
+	return ((2.0f * radius + 1.0f) / factor - 1.0f) / 2.0f;
+}
+
+// Picks how many times to halve the frame before blurring, and the
+// kernel radius to use at that size.
+void downsample_params_for_radius(float radius, int quality,
+				  enum downsample_kernel kernel,
+				  uint32_t width, uint32_t height,
+				  struct downsample_params *params)
+{
+	params->levels = 0;
+	params->radius = radius;
+	if (quality <= DOWNSAMPLE_QUALITY_OFF ||
+	    quality > DOWNSAMPLE_QUALITY_PERFORMANCE || radius <= 0.0f)
+		return;
+
+	const float min_radius = min_reduced_radius[quality];
+	while (params->levels < DOWNSAMPLE_MAX_LEVELS) {
+		const int next = params->levels + 1;
+		const float factor = (float)(1 << next);
+		if (radius / factor < min_radius ||
+		    kawase_level_size(width, next) < DOWNSAMPLE_MIN_SIZE ||
+		    kawase_level_size(height, next) < DOWNSAMPLE_MIN_SIZE)
+			break;
+		params->levels = next;
+	}
+	params->radius =
+		downsample_reduced_radius(radius, params->levels, kernel);
+}
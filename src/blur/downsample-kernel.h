@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+// Levels halve the frame the way the kawase pyramid does, see
+// kawase_level_size.
+#include "kawase-kernel.h"
+
+// Largest reduction is 2^3 = 8x in each direction.
+#define DOWNSAMPLE_MAX_LEVELS 3
+
+// Values of the "downsample_quality" setting.  Higher settings blur at a
+// lower resolution for a given radius.
+enum downsample_quality {
+	DOWNSAMPLE_QUALITY_OFF = 0,
+	DOWNSAMPLE_QUALITY_HIGH = 1,
+	DOWNSAMPLE_QUALITY_BALANCED = 2,
+	DOWNSAMPLE_QUALITY_PERFORMANCE = 3,
+};
+
+enum downsample_kernel {
+	DOWNSAMPLE_KERNEL_GAUSSIAN,
+	DOWNSAMPLE_KERNEL_BOX,
+};
+
+struct downsample_params {
+	// Number of 2x reductions, 0 to blur at full resolution.
+	int levels;
+	// Kernel radius to use at the reduced resolution.
+	float radius;
+};
+
+extern void downsample_params_for_radius(float radius, int quality,
+					 enum downsample_kernel kernel,
+					 uint32_t width, uint32_t height,
+					 struct downsample_params *params);
+// Kernel radius to use after `levels` reductions of a blur of `radius`.
+extern float downsample_reduced_radius(float radius, int levels,
+				       enum downsample_kernel kernel);
@@ -0,0 +1,127 @@
+#include "downsample.h"
+
+void set_downsample_quality_list(obs_property_t *p)
+{
+	obs_property_list_add_int(p, obs_module_text(DOWNSAMPLE_OFF_LABEL),
+				  DOWNSAMPLE_QUALITY_OFF);
+	obs_property_list_add_int(p, obs_module_text(DOWNSAMPLE_HIGH_LABEL),
+				  DOWNSAMPLE_QUALITY_HIGH);
+	obs_property_list_add_int(p,
+				  obs_module_text(DOWNSAMPLE_BALANCED_LABEL),
+				  DOWNSAMPLE_QUALITY_BALANCED);
+	obs_property_list_add_int(p,
+				  obs_module_text(DOWNSAMPLE_PERFORMANCE_LABEL),
+				  DOWNSAMPLE_QUALITY_PERFORMANCE);
+}
+
+void load_downsample_effect(struct composite_blur_filter_data *filter)
+{
+	filter->effect_2 = load_shader_effect(
+		filter->effect_2, "/shaders/bspline_upsample.effect");
+	filter->params_2 = effect_cache_get_params(filter->effect_2);
+}
+
+/*
+ *  Picks the blur resolution for this frame and, when it is reduced,
+ *  halves `texture` into pooled targets.  Each halving is a single
+ *  bilinear tap per pixel, which at exactly half size is a 2x2 box.
+ *  The first halving composites over *background and clears it, the
+ *  blur passes then read an input that is composited already.  Returns
+ *  the texture the blur passes should read.
+ */
+gs_texture_t *downsample_begin(struct composite_blur_filter_data *data,
+			       gs_texture_t *texture,
+			       gs_texture_t **background,
+			       enum downsample_kernel kernel,
+			       struct downsample_state *state)
+{
+	memset(state, 0, sizeof(*state));
+	downsample_params_for_radius(data->radius, data->downsample_quality,
+				     kernel, data->width, data->height,
+				     &state->params);
+	if (!data->effect_2)
+		state->params.levels = 0;
+	state->width = data->width;
+	state->height = data->height;
+	if (state->params.levels == 0) {
+		state->params.radius = data->radius;
+		return texture;
+	}
+
+	set_blending_parameters();
+	for (int i = 0; i < state->params.levels; i++) {
+		const uint32_t width = kawase_level_size(data->width, i + 1);
+		const uint32_t height = kawase_level_size(data->height, i + 1);
+		gs_texrender_t *target = texrender_pool_acquire(
+			data->format, width, height, data->space);
+		state->levels[i] = target;
+
+		gs_effect_t *effect = composite_copy_effect(
+			data, texture, i == 0 ? *background : NULL);
+		if (gs_texrender_begin(target, width, height)) {
+			while (gs_effect_loop(effect, "Draw"))
+				roi_draw_sprite(data, texture, width, height);
+			gs_texrender_end(target);
+		}
+		texture = gs_texrender_get_texture(target);
+		state->width = width;
+		state->height = height;
+	}
+	gs_blend_state_pop();
+	*background = NULL;
+
+	return texture;
+}
+
+// Render target for the last blur pass.  Full size blurs go straight to
+// the output, see output_target.
+gs_texrender_t *downsample_target(struct composite_blur_filter_data *data,
+				  struct downsample_state *state)
+{
+	if (state->params.levels == 0) {
+		return output_target(data);
+	}
+	if (!state->blurred) {
+		state->blurred = texrender_pool_acquire(
+			data->format, state->width, state->height, data->space);
+	} else {
+		gs_texrender_reset(state->blurred);
+	}
+	return state->blurred;
+}
+
+/*
+ *  B-spline upsamples the reduced blur into the output and hands the
+ *  pooled targets back.  Nothing to do for full size blurs.
+ */
+void downsample_end(struct composite_blur_filter_data *data,
+		    struct downsample_state *state)
+{
+	if (state->params.levels == 0)
+		return;
+
+	gs_effect_t *effect = data->effect_2;
+	gs_texture_t *texture = gs_texrender_get_texture(state->blurred);
+	if (texture) {
+		struct effect_params *params = data->params_2;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		struct vec2 size;
+		size.x = (float)state->width;
+		size.y = (float)state->height;
+		effect_params_set_vec2(params, EFFECT_PARAM_UV_SIZE, &size);
+
+		set_blending_parameters();
+		gs_texrender_t *target = output_target(data);
+		if (target_begin(target, data->width, data->height)) {
+			while (gs_effect_loop(effect, "Draw"))
+				roi_draw_sprite(data, texture, data->width,
+						data->height);
+			target_end(target);
+		}
+		gs_blend_state_pop();
+	}
+
+	for (int i = 0; i < state->params.levels; i++)
+		texrender_pool_release(state->levels[i]);
+	texrender_pool_release(state->blurred);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <obs-module.h>
+#include <obs-utils.h>
+#include <obs-composite-blur-filter.h>
+#include "downsample-kernel.h"
+
+struct composite_blur_filter_data;
+
+// Reduced resolution state of one area blur frame.
+struct downsample_state {
+	struct downsample_params params;
+	// Size the blur passes run at.
+	uint32_t width;
+	uint32_t height;
+	gs_texrender_t *levels[DOWNSAMPLE_MAX_LEVELS];
+	gs_texrender_t *blurred;
+};
+
+extern void set_downsample_quality_list(obs_property_t *p);
+extern void load_downsample_effect(struct composite_blur_filter_data *filter);
+extern gs_texture_t *downsample_begin(struct composite_blur_filter_data *data,
+				      gs_texture_t *texture,
+				      gs_texture_t **background,
+				      enum downsample_kernel kernel,
+				      struct downsample_state *state);
+extern gs_texrender_t *
+downsample_target(struct composite_blur_filter_data *data,
+		  struct downsample_state *state);
+extern void downsample_end(struct composite_blur_filter_data *data,
+			   struct downsample_state *state);
@@ -1,2 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+// Size of the weight/offset uniform arrays in the gaussian shaders
+// (WEIGHT_SIZE float4s).
+#define GAUSSIAN_KERNEL_MAX_SIZE 128
+// Largest kernel extent in pixels, i.e. 3 * radius is clamped to this.
+#define GAUSSIAN_KERNEL_MAX_RADIUS 250.0f
+
+// Center-right half of a normalized gaussian, generated at build time by
+// composite-blur-kernel-gen.
 extern const float gaussian_kernel[];
-extern size_t gaussian_kernel_size;
\ No newline at end of file
+extern const size_t gaussian_kernel_size;
+
+// Tap counts gaussian_1d.effect is compiled for with a fixed loop, as
+// KERNEL_TAPS.  The taps a kernel is padded with have zero weight, but
+// are still fetched, so past 16 the variants are about 1.5x apart.
+#define GAUSSIAN_KERNEL_VARIANTS \
+	{4, 8, 12, 16, 24, 32, 48, 64, 96, GAUSSIAN_KERNEL_MAX_SIZE}
+
+// Smallest variant covering a kernel of `size` taps, 0 for none.
+extern size_t gaussian_kernel_variant(size_t size);
+extern size_t gaussian_sample_kernel(float radius, float *weights,
+				     float *offsets, size_t max_size);
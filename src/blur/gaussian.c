@@ -13,28 +13,22 @@ void set_gaussian_blur_types(obs_properties_t *props)
 				  TYPE_ZOOM);
 	obs_property_list_add_int(p, obs_module_text(TYPE_MOTION_LABEL),
 				  TYPE_MOTION);
-	// obs_property_list_add_int(p,
-	// 			  obs_module_text(TYPE_TILTSHIFT_LABEL),
-	// 			  TYPE_TILTSHIFT);
+	obs_property_list_add_int(p, obs_module_text(TYPE_TILTSHIFT_LABEL),
+				  TYPE_TILTSHIFT);
 }
 
 void gaussian_setup_callbacks(struct composite_blur_filter_data *data)
 {
 	data->video_render = render_video_gaussian;
 	data->load_effect = load_effect_gaussian;
-	data->update = update_gaussian;
-}
-
-void update_gaussian(struct composite_blur_filter_data *data)
-{
-	if (data->radius != data->radius_last) {
-		data->radius_last = data->radius;
-		sample_kernel(data->radius, data);
-	}
+	data->update = NULL;
 }
 
 void render_video_gaussian(struct composite_blur_filter_data *data)
 {
+	if (!data->kernel) {
+		return;
+	}
 	switch (data->blur_type) {
 	case TYPE_AREA:
 		gaussian_area_blur(data);
@@ -43,40 +37,73 @@ void render_video_gaussian(struct composite_blur_filter_data *data)
 		gaussian_directional_blur(data);
 		break;
 	case TYPE_ZOOM:
-		gaussian_zoom_blur(data);
+		zoom_blur(data, ZOOM_KERNEL_GAUSSIAN);
 		break;
 	case TYPE_MOTION:
 		gaussian_motion_blur(data);
 		break;
+	case TYPE_TILTSHIFT:
+		gaussian_tilt_shift_blur(data);
+		break;
 	}
 }
 
 void load_effect_gaussian(struct composite_blur_filter_data *filter)
 {
+	// The applied snapshot's kernel picks the 1D effect variant.
+	const size_t taps = filter->kernel ? filter->kernel->size : 0;
+
 	switch (filter->blur_type) {
 	case TYPE_AREA:
-		load_1d_gaussian_effect(filter);
+		load_1d_gaussian_effect(filter, taps);
+		load_downsample_effect(filter);
 		break;
 	case TYPE_DIRECTIONAL:
-		load_1d_gaussian_effect(filter);
+		load_1d_gaussian_effect(filter, taps);
 		break;
 	case TYPE_ZOOM:
-		load_radial_gaussian_effect(filter);
+		load_zoom_effect(filter);
 		break;
 	case TYPE_MOTION:
 		load_motion_gaussian_effect(filter);
 		break;
+	case TYPE_TILTSHIFT: {
+		// The pyramid levels are blurred by a fixed small kernel.
+		const struct kernel_cache_entry *level =
+			kernel_cache_acquire_gaussian(TILTSHIFT_LEVEL_RADIUS);
+		load_1d_gaussian_effect(filter, level ? level->size : 0);
+		kernel_cache_release(level);
+		load_tiltshift_gaussian_effect(filter);
+		break;
+	}
+	}
+}
+
+// Kernel for the reduced radius of a downsampled area blur.  Only used
+// from the render thread.
+static const struct kernel_cache_entry *
+reduced_kernel(struct composite_blur_filter_data *data, float radius)
+{
+	if (!data->reduced_kernel || data->reduced_radius != radius) {
+		const struct kernel_cache_entry *kernel =
+			kernel_cache_acquire_gaussian(radius);
+		if (kernel) {
+			kernel_cache_release(data->reduced_kernel);
+			data->reduced_kernel = kernel;
+			data->reduced_radius = radius;
+		}
 	}
+	return data->reduced_kernel ? data->reduced_kernel : data->kernel;
 }
 
 /*
  *  Performs an area blur using the gaussian kernel.  Blur is
- *  equal in both x and y directions.
+ *  equal in both x and y directions.  With downsample_quality set,
+ *  large radii are blurred at reduced resolution and upsampled.
  */
 static void gaussian_area_blur(struct composite_blur_filter_data *data)
 {
 	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -84,68 +111,66 @@ static void gaussian_area_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
-
-	data->render2 = create_or_reset_texrender(data->render2);
+	gs_texture_t *background = composite_background(data);
 
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
+	struct downsample_state ds;
+	texture = downsample_begin(data, texture, &background,
+				   DOWNSAMPLE_KERNEL_GAUSSIAN, &ds);
+	const struct kernel_cache_entry *kernel =
+		ds.params.levels > 0 ? reduced_kernel(data, ds.params.radius)
+				     : data->kernel;
+	effect = gaussian_1d_effect(data, kernel);
 
-	gs_eparam_t *weight = gs_effect_get_param_by_name(effect, "weight");
+	gs_texrender_t *scratch = texrender_pool_acquire(
+		data->format, ds.width, ds.height, data->space);
 
-	gs_effect_set_val(weight, data->kernel.array,
-			  data->kernel.num * sizeof(float));
+	struct effect_params *params = data->params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	effect_params_set_kernel(params, kernel);
 
-	gs_eparam_t *offset = gs_effect_get_param_by_name(effect, "offset");
-	gs_effect_set_val(offset, data->offset.array,
-			  data->offset.num * sizeof(float));
-
-	const int k_size = (int)data->kernel_size;
-	gs_eparam_t *kernel_size =
-		gs_effect_get_param_by_name(effect, "kernel_size");
-	gs_effect_set_int(kernel_size, k_size);
-
-	gs_eparam_t *texel_step =
-		gs_effect_get_param_by_name(effect, "texel_step");
 	struct vec2 direction;
 
-	// 1. First pass- apply 1D blur kernel to horizontal dir.
+	// 1. First pass- apply 1D blur kernel to horizontal dir, compositing
+	//    the input over the background as it is read.
+	composite_bind(params, background, texture);
 
-	direction.x = 1.0f / data->width;
+	direction.x = 1.0f / ds.width;
 	direction.y = 0.0f;
-	gs_effect_set_vec2(texel_step, &direction);
+	effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP, &direction);
 
 	set_blending_parameters();
 	//set_render_parameters();
 
-	if (gs_texrender_begin(data->render2, data->width, data->height)) {
+	if (gs_texrender_begin(scratch, ds.width, ds.height)) {
 		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->render2);
+			roi_draw_sprite(data, texture, ds.width, ds.height);
+		gs_texrender_end(scratch);
 	}
 
 	// 2. Save texture from first pass in variable "texture"
-	texture = gs_texrender_get_texture(data->render2);
+	texture = gs_texrender_get_texture(scratch);
 
 	// 3. Second Pass- Apply 1D blur kernel vertically.
-	image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	composite_bind(params, NULL, NULL);
 
 	direction.x = 0.0f;
-	direction.y = 1.0f / data->height;
-	gs_effect_set_vec2(texel_step, &direction);
+	direction.y = 1.0f / ds.height;
+	effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP, &direction);
 
-	data->output_texrender =
-		create_or_reset_texrender(data->output_texrender);
+	gs_texrender_t *target = downsample_target(data, &ds);
 
-	if (gs_texrender_begin(data->output_texrender, data->width,
-			       data->height)) {
+	if (target_begin(target, ds.width, ds.height)) {
 		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->output_texrender);
+			roi_draw_sprite(data, texture, ds.width, ds.height);
+		target_end(target);
 	}
 
 	gs_blend_state_pop();
+	texrender_pool_release(scratch);
+
+	// 4. Back to full size, if blurred at reduced resolution.
+	downsample_end(data, &ds);
 }
 
 /*
@@ -153,8 +178,7 @@ static void gaussian_area_blur(struct composite_blur_filter_data *data)
  */
 static void gaussian_directional_blur(struct composite_blur_filter_data *data)
 {
-	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
+	gs_effect_t *effect = gaussian_1d_effect(data, data->kernel);
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -162,46 +186,29 @@ static void gaussian_directional_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
-
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
-
-	gs_eparam_t *weight = gs_effect_get_param_by_name(effect, "weight");
+	struct effect_params *params = data->params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	composite_bind(params, composite_background(data), texture);
+	effect_params_set_kernel(params, data->kernel);
 
-	gs_effect_set_val(weight, data->kernel.array,
-			  data->kernel.num * sizeof(float));
-
-	gs_eparam_t *offset = gs_effect_get_param_by_name(effect, "offset");
-	gs_effect_set_val(offset, data->offset.array,
-			  data->offset.num * sizeof(float));
-
-	const int k_size = (int)data->kernel_size;
-	gs_eparam_t *kernel_size =
-		gs_effect_get_param_by_name(effect, "kernel_size");
-	gs_effect_set_int(kernel_size, k_size);
-
-	gs_eparam_t *texel_step =
-		gs_effect_get_param_by_name(effect, "texel_step");
 	struct vec2 direction;
 
 	// 1. Single pass- blur only in one direction
 	float rads = -data->angle * (M_PI / 180.0f);
 	direction.x = (float)cos(rads) / data->width;
 	direction.y = (float)sin(rads) / data->height;
-	gs_effect_set_vec2(texel_step, &direction);
+	effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP, &direction);
 
 	set_blending_parameters();
 	//set_render_parameters();
 
-	data->output_texrender =
-		create_or_reset_texrender(data->output_texrender);
+	gs_texrender_t *target = output_target(data);
 
-	if (gs_texrender_begin(data->output_texrender, data->width,
-			       data->height)) {
+	if (target_begin(target, data->width, data->height)) {
 		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->output_texrender);
+			roi_draw_sprite(data, texture, data->width,
+					data->height);
+		target_end(target);
 	}
 
 	gs_blend_state_pop();
@@ -213,7 +220,6 @@ static void gaussian_directional_blur(struct composite_blur_filter_data *data)
 static void gaussian_motion_blur(struct composite_blur_filter_data *data)
 {
 	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
 
 	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
@@ -221,297 +227,341 @@ static void gaussian_motion_blur(struct composite_blur_filter_data *data)
 		return;
 	}
 
-	texture = blend_composite(texture, data);
-
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
-
-	gs_eparam_t *weight = gs_effect_get_param_by_name(effect, "weight");
-
-	gs_effect_set_val(weight, data->kernel.array,
-			  data->kernel.num * sizeof(float));
+	struct effect_params *params = data->params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	composite_bind(params, composite_background(data), texture);
+	effect_params_set_kernel(params, data->kernel);
 
-	gs_eparam_t *offset = gs_effect_get_param_by_name(effect, "offset");
-	gs_effect_set_val(offset, data->offset.array,
-			  data->offset.num * sizeof(float));
-
-	const int k_size = (int)data->kernel_size;
-	gs_eparam_t *kernel_size =
-		gs_effect_get_param_by_name(effect, "kernel_size");
-	gs_effect_set_int(kernel_size, k_size);
-
-	gs_eparam_t *texel_step =
-		gs_effect_get_param_by_name(effect, "texel_step");
 	struct vec2 direction;
 
 	// 1. Single pass- blur only in one direction
 	float rads = -data->angle * (M_PI / 180.0f);
 	direction.x = (float)cos(rads) / data->width;
 	direction.y = (float)sin(rads) / data->height;
-	gs_effect_set_vec2(texel_step, &direction);
+	effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP, &direction);
 
 	set_blending_parameters();
 	//set_render_parameters();
 
-	data->output_texrender =
-		create_or_reset_texrender(data->output_texrender);
+	gs_texrender_t *target = output_target(data);
 
-	if (gs_texrender_begin(data->output_texrender, data->width,
-			       data->height)) {
+	if (target_begin(target, data->width, data->height)) {
 		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->output_texrender);
+			roi_draw_sprite(data, texture, data->width,
+					data->height);
+		target_end(target);
 	}
 
 	gs_blend_state_pop();
 }
 
-/*
- *  Performs a zoom blur using the gaussian kernel. Blur for a pixel
- *  is performed in direction of zoom center point.
- */
-static void gaussian_zoom_blur(struct composite_blur_filter_data *data)
+// Draws rows [first, end) of a width x height target, within `roi`
+// when the region of interest limits the pass.
+static void tiltshift_draw_rows(gs_texture_t *texture, uint32_t width,
+				uint32_t height, uint32_t first, uint32_t end,
+				const struct gs_rect *roi)
 {
-	gs_effect_t *effect = data->effect;
-	gs_effect_t *composite_effect = data->composite_effect;
-
-	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
-
-	if (!effect || !texture) {
+	if (!roi && first == 0 && end >= height) {
+		gs_draw_sprite(texture, 0, width, height);
 		return;
 	}
 
-	texture = blend_composite(texture, data);
-
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
-
-	gs_eparam_t *weight = gs_effect_get_param_by_name(effect, "weight");
-
-	gs_effect_set_val(weight, data->kernel.array,
-			  data->kernel.num * sizeof(float));
-
-	gs_eparam_t *offset = gs_effect_get_param_by_name(effect, "offset");
-	gs_effect_set_val(offset, data->offset.array,
-			  data->offset.num * sizeof(float));
+	struct gs_rect rect = {0, (int)first, (int)width, (int)(end - first)};
+	if (roi) {
+		const int left = roi->x;
+		const int top = rect.y > roi->y ? rect.y : roi->y;
+		const int right = roi->x + roi->cx;
+		const int bottom = rect.y + rect.cy < roi->y + roi->cy
+					   ? rect.y + rect.cy
+					   : roi->y + roi->cy;
+		rect.x = left;
+		rect.y = top;
+		rect.cx = right - left;
+		rect.cy = bottom > top ? bottom - top : 0;
+	}
+	gs_set_scissor_rect(&rect);
+	gs_draw_sprite(texture, 0, width, height);
+	gs_set_scissor_rect(NULL);
+}
 
-	const int k_size = (int)data->kernel_size;
-	gs_eparam_t *kernel_size =
-		gs_effect_get_param_by_name(effect, "kernel_size");
-	gs_effect_set_int(kernel_size, k_size);
+/*
+ *  Draws one tilt-shift pyramid pass into `target`, scissored to the
+ *  rows outside the in-focus band that later passes read, and to the
+ *  region of interest.  The final pass covers every row, so it can draw
+ *  to the filter's target.
+ */
+static void tiltshift_draw(struct composite_blur_filter_data *data,
+			   gs_effect_t *effect, gs_texrender_t *target,
+			   gs_texture_t *texture,
+			   const struct tiltshift_params *ts,
+			   enum tiltshift_pass pass, int level)
+{
+	const uint32_t width = kawase_level_size(ts->width, level);
+	const uint32_t height = kawase_level_size(ts->height, level);
+	uint32_t top_end;
+	uint32_t bottom_start;
+	tiltshift_pass_rows(ts, pass, level, &top_end, &bottom_start);
+	struct gs_rect roi_rect;
+	const struct gs_rect *roi =
+		roi_target_rect(data, width, height, &roi_rect) ? &roi_rect
+								: NULL;
+
+	if (!target_begin(target, width, height))
+		return;
+	while (gs_effect_loop(effect, "Draw")) {
+		if (top_end >= height) {
+			tiltshift_draw_rows(texture, width, height, 0, height,
+					    roi);
+			continue;
+		}
+		if (top_end > 0)
+			tiltshift_draw_rows(texture, width, height, 0, top_end,
+					    roi);
+		if (bottom_start < height)
+			tiltshift_draw_rows(texture, width, height,
+					    bottom_start, height, roi);
+	}
+	target_end(target);
+}
 
-	gs_eparam_t *radial_center =
-		gs_effect_get_param_by_name(effect, "radial_center");
+// Straight copy for a tilt-shift that is in focus everywhere.
+static void tiltshift_copy(gs_texture_t *texture, gs_texture_t *background,
+			   struct composite_blur_filter_data *data)
+{
+	gs_effect_t *effect = composite_copy_effect(data, texture, background);
 
-	struct vec2 coord;
+	gs_texrender_t *target = output_target(data);
+	if (target_begin(target, data->width, data->height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(texture, 0, data->width, data->height);
+		target_end(target);
+	}
+}
 
-	coord.x = data->center_x;
-	coord.y = data->center_y;
+/*
+ *  Performs a tilt-shift blur on a gaussian pyramid.  Each level is the
+ *  one above it halved and blurred by a small fixed kernel, and every row
+ *  blends the two levels around its sigma on the way back up, so the
+ *  cost per pixel does not grow with the radius.  Rows in the in-focus
+ *  band are never blurred- pyramid passes are scissored to the rows
+ *  that use them, and the final pass copies band rows with one fetch.
+ */
+static void gaussian_tilt_shift_blur(struct composite_blur_filter_data *data)
+{
+	gs_effect_t *effect = data->effect;
+	gs_effect_t *collapse_effect = data->effect_2;
 
-	// 1. Single pass- blur only in one direction
-	gs_effect_set_vec2(radial_center, &coord);
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
-	gs_eparam_t *uv_size = gs_effect_get_param_by_name(effect, "uv_size");
+	if (!effect || !collapse_effect || !texture) {
+		return;
+	}
 
-	struct vec2 size;
-	size.x = (float)data->width;
-	size.y = (float)data->height;
+	gs_texture_t *background = composite_background(data);
+	gs_texture_t *input = texture;
 
-	gs_effect_set_vec2(uv_size, &size);
+	struct tiltshift_params ts;
+	tiltshift_params_for_radius(data->radius, data->tilt_shift_top,
+				    1.0f - data->tilt_shift_bottom, data->width,
+				    data->height, &ts);
 
 	set_blending_parameters();
-	//set_render_parameters();
-
-	data->output_texrender =
-		create_or_reset_texrender(data->output_texrender);
-
-	if (gs_texrender_begin(data->output_texrender, data->width,
-			       data->height)) {
-		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->output_texrender);
+	if (ts.levels == 0) {
+		tiltshift_copy(texture, background, data);
+		gs_blend_state_pop();
+		return;
 	}
 
-	gs_blend_state_pop();
-}
+	gs_texrender_t *levels[TILTSHIFT_MAX_LEVELS + 1] = {0};
+	gs_texrender_t *scratch[TILTSHIFT_MAX_LEVELS + 1] = {0};
+	struct effect_params *params = data->params;
+	effect_params_set_kernel(params,
+				 reduced_kernel(data, TILTSHIFT_LEVEL_RADIUS));
+
+	// 1. Build the pyramid- halve and blur horizontally into scratch,
+	//    then blur vertically into the level.  The first halving reads
+	//    the input and composites it over the background.
+	for (int i = 1; i <= ts.levels; i++) {
+		const uint32_t width = kawase_level_size(data->width, i);
+		const uint32_t height = kawase_level_size(data->height, i);
+		scratch[i] = texrender_pool_acquire(data->format, width,
+						    height, data->space);
+		levels[i] = texrender_pool_acquire(data->format, width, height,
+						   data->space);
+
+		struct vec2 direction;
+		direction.x = 1.0f / (float)width;
+		direction.y = 0.0f;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, i == 1 ? background : NULL, texture);
+		effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP,
+				       &direction);
+		tiltshift_draw(data, effect, scratch[i], texture, &ts,
+			       TILTSHIFT_PASS_DOWN, i);
+		texture = gs_texrender_get_texture(scratch[i]);
+
+		direction.x = 0.0f;
+		direction.y = 1.0f / (float)height;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, NULL, NULL);
+		effect_params_set_vec2(params, EFFECT_PARAM_TEXEL_STEP,
+				       &direction);
+		tiltshift_draw(data, effect, levels[i], texture, &ts,
+			       TILTSHIFT_PASS_BLUR, i);
+		texture = gs_texrender_get_texture(levels[i]);
+	}
 
-static void load_1d_gaussian_effect(struct composite_blur_filter_data *filter)
-{
-	const char *effect_file_path = "/shaders/gaussian_1d.effect";
-	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
+	// 2. Collapse from the smallest level up.  Each level's scratch
+	//    target is free again and takes its result.
+	params = data->params_2;
+	effect_params_set_float(params, EFFECT_PARAM_TOP, ts.top);
+	effect_params_set_float(params, EFFECT_PARAM_BOTTOM, ts.bottom);
+	effect_params_set_float(params, EFFECT_PARAM_RADIUS, ts.radius);
+	effect_params_set_float(params, EFFECT_PARAM_LEVEL_VARIANCE,
+				TILTSHIFT_LEVEL_VARIANCE);
+
+	for (int i = ts.levels - 1; i >= 0; i--) {
+		struct vec2 size;
+		size.x = (float)kawase_level_size(data->width, i + 1);
+		size.y = (float)kawase_level_size(data->height, i + 1);
+		effect_params_set_texture(
+			params, EFFECT_PARAM_IMAGE,
+			i > 0 ? gs_texrender_get_texture(levels[i]) : input);
+		composite_bind(params, i > 0 ? NULL : background, input);
+		effect_params_set_texture(params, EFFECT_PARAM_UPPER, texture);
+		effect_params_set_vec2(params, EFFECT_PARAM_UPPER_SIZE, &size);
+		effect_params_set_float(params, EFFECT_PARAM_LEVEL, (float)i);
+
+		gs_texrender_t *target;
+		if (i > 0) {
+			target = scratch[i];
+			gs_texrender_reset(target);
+		} else {
+			target = output_target(data);
 		}
+		tiltshift_draw(data, collapse_effect, target, texture, &ts,
+			       TILTSHIFT_PASS_COLLAPSE, i);
+		texture = gs_texrender_get_texture(target);
 	}
-}
+	gs_blend_state_pop();
 
-static void
-load_motion_gaussian_effect(struct composite_blur_filter_data *filter)
-{
-	const char *effect_file_path = "/shaders/gaussian_motion.effect";
-	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
-		}
+	for (int i = 1; i <= ts.levels; i++) {
+		texrender_pool_release(scratch[i]);
+		texrender_pool_release(levels[i]);
 	}
 }
 
-static void
-load_radial_gaussian_effect(struct composite_blur_filter_data *filter)
+// gaussian_1d.effect with its loop fixed to the smallest variant covering
+// `taps`, or looping up to kernel_size for 0 taps.
+static void gaussian_1d_defines(struct dstr *defines, size_t variant)
 {
-	const char *effect_file_path = "/shaders/gaussian_radial.effect";
-	filter->effect = load_shader_effect(filter->effect, effect_file_path);
-	if (filter->effect) {
-		size_t effect_count = gs_effect_get_num_params(filter->effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
-				filter->param_uv_size = param;
-			} else if (strcmp(info.name, "dir") == 0) {
-				filter->param_dir = param;
-			}
-		}
+	dstr_free(defines);
+	if (variant > 0) {
+		dstr_printf(defines, "#define KERNEL_TAPS %zu\n", variant);
 	}
 }
 
-static void sample_kernel(float radius,
-			  struct composite_blur_filter_data *filter)
+/*
+ *  Acquires the gaussian_1d.effect variants a filter with settings `s`
+ *  may draw with- that of `kernel`, and for an area blur those of the
+ *  reduced kernels at every level count downsampling may pick, whatever
+ *  the frame size.  Called when settings are published, so they compile
+ *  there, and a render switching variants only takes another handle.
+ */
+void gaussian_acquire_variants(const struct blur_settings *s,
+			       const struct kernel_cache_entry *kernel,
+			       gs_effect_t *variants[GAUSSIAN_HELD_VARIANTS])
 {
-	const size_t max_size = 128;
-	const float max_radius = 250.0;
-	const float min_radius = 0.0;
-	size_t d_kernel_size = 0;
-
-	fDarray d_weights;
-	da_init(d_weights);
-
-	fDarray weights;
-	da_init(weights);
-
-	radius *= 3.0f;
-	radius = max(min(radius, max_radius), min_radius);
-
-	// 1. Calculate discrete weights
-	const float bins_per_pixel =
-		((2.f * (float)gaussian_kernel_size - 1.f)) /
-		(1.f + 2.f * radius);
-	size_t current_bin = 0;
-	float fractional_bin = 0.5f;
-	float ceil_radius = (radius - (float)floor(radius)) < 0.001f
-				    ? radius
-				    : (float)ceil(radius);
-	float fractional_extra = 1.0f - (ceil_radius - radius);
-
-	for (int i = 0; i <= (int)ceil_radius; i++) {
-		float cur_radius = (float)i;
-		float fractional_pixel = i < (int)ceil_radius ? 1.0f
-					 : fractional_extra < 0.002f
-						 ? 1.0f
-						 : fractional_extra;
-		float bpp_mult = i == 0 ? 0.5f : 1.0f;
-		float weight = 1.0f / bpp_mult * fractional_bin *
-			       gaussian_kernel[current_bin];
-		float remaining_bins =
-			bpp_mult * fractional_pixel * bins_per_pixel -
-			fractional_bin;
-		while ((int)floor(remaining_bins) > 0) {
-			current_bin++;
-			weight +=
-				1.0f / bpp_mult * gaussian_kernel[current_bin];
-			remaining_bins -= 1.f;
+	size_t taps[GAUSSIAN_HELD_VARIANTS] = {0};
+	size_t count = 0;
+	switch (s->blur_type) {
+	case TYPE_AREA: {
+		taps[count++] = kernel ? kernel->size : 0;
+		struct downsample_params ds;
+		downsample_params_for_radius(s->radius, s->downsample_quality,
+					     DOWNSAMPLE_KERNEL_GAUSSIAN,
+					     UINT32_MAX, UINT32_MAX, &ds);
+		for (int levels = 1; levels <= ds.levels; levels++) {
+			const struct kernel_cache_entry *reduced =
+				kernel_cache_acquire_gaussian(
+					downsample_reduced_radius(
+						s->radius, levels,
+						DOWNSAMPLE_KERNEL_GAUSSIAN));
+			taps[count++] = reduced ? reduced->size : 0;
+			kernel_cache_release(reduced);
 		}
-		current_bin++;
-		if (remaining_bins > 1.e-6f) {
-			weight += 1.0f / bpp_mult *
-				  gaussian_kernel[current_bin] * remaining_bins;
-			fractional_bin = 1.0f - remaining_bins;
-		} else {
-			fractional_bin = 1.0f;
-		}
-		if (weight > 1.0001f || weight < 0.0f) {
-			obs_log(LOG_WARNING,
-				"   === BAD WEIGHT VALUE FOR GAUSSIAN === [%d] %f",
-				weights.num + 1, weight);
-			weight = 0.0;
-		}
-		da_push_back(d_weights, &weight);
+		break;
 	}
-
-	fDarray offsets;
-	da_init(offsets);
-
-	fDarray d_offsets;
-	da_init(d_offsets);
-
-	// 2. Calculate discrete offsets
-	for (int i = 0; i <= (int)ceil_radius; i++) {
-		float val = (float)i;
-		da_push_back(d_offsets, &val);
+	case TYPE_DIRECTIONAL:
+		taps[count++] = kernel ? kernel->size : 0;
+		break;
+	case TYPE_TILTSHIFT: {
+		const struct kernel_cache_entry *level =
+			kernel_cache_acquire_gaussian(TILTSHIFT_LEVEL_RADIUS);
+		taps[count++] = level ? level->size : 0;
+		kernel_cache_release(level);
+		break;
 	}
-
-	// 3. Calculate linear sampled weights and offsets
-	da_push_back(weights, &d_weights.array[0]);
-	da_push_back(offsets, &d_offsets.array[0]);
-
-	for (size_t i = 1; i < d_weights.num - 1; i += 2) {
-		const float weight =
-			d_weights.array[i] + d_weights.array[i + 1];
-		da_push_back(weights, &weight);
-		const float offset =
-			(d_offsets.array[i] * d_weights.array[i] +
-			 d_offsets.array[i + 1] * d_weights.array[i + 1]) /
-			weight;
-		da_push_back(offsets, &offset);
 	}
-	if (d_weights.num % 2 == 0) {
-		const float weight = d_weights.array[d_weights.num - 1];
-		const float offset = d_offsets.array[d_offsets.num - 1];
-		da_push_back(weights, &weight);
-		da_push_back(offsets, &offset);
+
+	struct dstr defines = {0};
+	for (size_t i = 0; i < GAUSSIAN_HELD_VARIANTS; i++) {
+		variants[i] = NULL;
+		if (i >= count)
+			continue;
+		const size_t variant =
+			taps[i] > 0 ? gaussian_kernel_variant(taps[i]) : 0;
+		gaussian_1d_defines(&defines, variant);
+		variants[i] = effect_cache_acquire(
+			"/shaders/gaussian_1d.effect", defines.array);
 	}
+	dstr_free(&defines);
+}
 
-	// 4. Pad out kernel arrays to length of max_size
-	const size_t padding = max_size - weights.num;
-	filter->kernel_size = weights.num;
+static void load_1d_gaussian_effect(struct composite_blur_filter_data *filter,
+				    size_t taps)
+{
+	const char *effect_file_path = "/shaders/gaussian_1d.effect";
+	const size_t variant = taps > 0 ? gaussian_kernel_variant(taps) : 0;
+	struct dstr defines = {0};
+	gaussian_1d_defines(&defines, variant);
+	filter->effect = load_shader_effect_defines(
+		filter->effect, effect_file_path, defines.array);
+	filter->params = effect_cache_get_params(filter->effect);
+	filter->kernel_variant = variant;
+	dstr_free(&defines);
+}
 
-	for (size_t i = 0; i < padding; i++) {
-		float pad = 0.0f;
-		da_push_back(weights, &pad);
+/*
+ *  The 1D effect for a pass drawn with `kernel`, switched to the variant
+ *  covering its taps.  A downsampled area blur draws with the much
+ *  smaller reduced kernel, and padding taps are fetched all the same.
+ *  The applied snapshot holds every variant its settings can reach, see
+ *  gaussian_acquire_variants, so switching compiles nothing.
+ */
+static gs_effect_t *gaussian_1d_effect(struct composite_blur_filter_data *data,
+				       const struct kernel_cache_entry *kernel)
+{
+	if (kernel && gaussian_kernel_variant(kernel->size) !=
+			      data->kernel_variant) {
+		load_1d_gaussian_effect(data, kernel->size);
 	}
-	da_free(filter->kernel);
-	filter->kernel = weights;
+	return data->effect;
+}
 
-	for (size_t i = 0; i < padding; i++) {
-		float pad = 0.0f;
-		da_push_back(offsets, &pad);
-	}
+static void
+load_motion_gaussian_effect(struct composite_blur_filter_data *filter)
+{
+	const char *effect_file_path = "/shaders/gaussian_motion.effect";
+	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	filter->params = effect_cache_get_params(filter->effect);
+}
 
-	da_free(filter->offset);
-	filter->offset = offsets;
-}
\ No newline at end of file
+static void
+load_tiltshift_gaussian_effect(struct composite_blur_filter_data *filter)
+{
+	const char *effect_file_path = "/shaders/gaussian_tiltshift.effect";
+	filter->effect_2 = load_shader_effect(filter->effect_2,
+					      effect_file_path);
+	filter->params_2 = effect_cache_get_params(filter->effect_2);
+}
@@ -5,22 +5,32 @@
 #include <obs-utils.h>
 #include <obs-composite-blur-filter.h>
 #include "gaussian-kernel.h"
+#include "kernel-cache.h"
+#include "downsample.h"
+#include "zoom.h"
+#include "tiltshift-kernel.h"
+
+struct composite_blur_filter_data;
 
 extern void set_gaussian_blur_types(obs_properties_t *props);
 extern void gaussian_setup_callbacks(struct composite_blur_filter_data *data);
 extern void render_video_gaussian(struct composite_blur_filter_data *data);
 extern void load_effect_gaussian(struct composite_blur_filter_data *filter);
-extern void update_gaussian(struct composite_blur_filter_data *data);
+extern void gaussian_acquire_variants(
+	const struct blur_settings *s, const struct kernel_cache_entry *kernel,
+	gs_effect_t *variants[GAUSSIAN_HELD_VARIANTS]);
 
 static void gaussian_area_blur(struct composite_blur_filter_data *data);
 static void gaussian_directional_blur(struct composite_blur_filter_data *data);
-static void gaussian_zoom_blur(struct composite_blur_filter_data *data);
 static void gaussian_motion_blur(struct composite_blur_filter_data *data);
+static void gaussian_tilt_shift_blur(struct composite_blur_filter_data *data);
 
-static void load_1d_gaussian_effect(struct composite_blur_filter_data *filter);
+static void load_1d_gaussian_effect(struct composite_blur_filter_data *filter,
+				    size_t taps);
+static void gaussian_1d_defines(struct dstr *defines, size_t variant);
+static gs_effect_t *gaussian_1d_effect(struct composite_blur_filter_data *data,
+				       const struct kernel_cache_entry *kernel);
 static void
 load_motion_gaussian_effect(struct composite_blur_filter_data *filter);
 static void
-load_radial_gaussian_effect(struct composite_blur_filter_data *filter);
-static void sample_kernel(float radius,
-			  struct composite_blur_filter_data *filter);
\ No newline at end of file
+load_tiltshift_gaussian_effect(struct composite_blur_filter_data *filter);
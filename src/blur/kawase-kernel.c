@@ -0,0 +1,56 @@
+#include "kawase-kernel.h"
+
+#include <math.h>
+
+// Largest offset used before moving to the next pyramid level.  Offsets
+// much past 2 start to show the diamond shaped tap pattern, and at 2.25
+// the blur width of level n meets that of level n + 1 at offset 1.
+#define KAWASE_MAX_OFFSET 2.25f
+
+// Measured spread of one dual-kawase round trip, expressed as
+// sigma = 2^levels * (base + slope * offset).  Levels 1 and 2 are
+// dominated by the bilinear footprint and get their own fit; past
+// level 3 the ratio is stable.
+static const float kawase_base[] = {0.137f, 0.153f, 0.158f};
+static const float kawase_slope[] = {0.585f, 0.654f, 0.674f};
+
+uint32_t kawase_level_size(uint32_t size, int level)
+{
+	for (int i = 0; i < level; i++)
+		size = size > 1 ? size / 2 : 1;
+	return size;
+}
+
+/*
+ *  Picks the number of pyramid levels and the sample offset that most
+ *  closely match the spread of the gaussian kernel for `radius`.  The
+ *  gaussian table spans +/- 3 sigma over 6 * radius pixels, so the
+ *  target sigma is simply `radius`.
+ */
+void kawase_params_for_radius(float radius, uint32_t width, uint32_t height,
+			      struct kawase_params *params)
+{
+	params->levels = 0;
+	params->offset = 0.0f;
+	if (radius <= 0.0f || width < 2 || height < 2)
+		return;
+
+	int max_levels = 0;
+	while (max_levels < KAWASE_MAX_LEVELS &&
+	       kawase_level_size(width, max_levels + 1) > 1 &&
+	       kawase_level_size(height, max_levels + 1) > 1)
+		max_levels++;
+
+	for (int level = 1; level <= max_levels; level++) {
+		const int fit = level < 3 ? level - 1 : 2;
+		const float scale = (float)(1 << level);
+		const float offset =
+			(radius / scale - kawase_base[fit]) / kawase_slope[fit];
+		params->levels = level;
+		params->offset = offset;
+		if (offset <= KAWASE_MAX_OFFSET)
+			break;
+	}
+	if (params->offset < 0.0f)
+		params->offset = 0.0f;
+}
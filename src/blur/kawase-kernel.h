@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+// Maximum number of downsample levels in the dual-kawase pyramid.  At 8
+// levels the smallest mip of a 4K frame is 15x8 pixels, which already
+// covers the largest radius exposed in the UI.
+#define KAWASE_MAX_LEVELS 8
+
+struct kawase_params {
+	int levels;
+	float offset;
+};
+
+extern void kawase_params_for_radius(float radius, uint32_t width,
+				     uint32_t height,
+				     struct kawase_params *params);
+extern uint32_t kawase_level_size(uint32_t size, int level);
@@ -0,0 +1,174 @@
+#include "kawase.h"
+
+void set_kawase_blur_types(obs_properties_t *props)
+{
+	obs_property_t *p = obs_properties_get(props, "blur_type");
+	obs_property_list_clear(p);
+	obs_property_list_add_int(p, obs_module_text(TYPE_AREA_LABEL),
+				  TYPE_AREA);
+}
+
+void kawase_setup_callbacks(struct composite_blur_filter_data *data)
+{
+	data->video_render = render_video_kawase;
+	data->load_effect = load_effect_kawase;
+	data->update = NULL;
+}
+
+void render_video_kawase(struct composite_blur_filter_data *data)
+{
+	switch (data->blur_type) {
+	case TYPE_AREA:
+		kawase_area_blur(data);
+		break;
+	}
+}
+
+void load_effect_kawase(struct composite_blur_filter_data *filter)
+{
+	switch (filter->blur_type) {
+	case TYPE_AREA:
+		load_dual_kawase_effects(filter);
+		break;
+	}
+}
+
+/*
+ *  Performs an area blur using the dual-kawase method.  The image is
+ *  downsampled by 2x per level into pooled targets, then upsampled back
+ *  up the same chain.  Every level costs a quarter of the one above it,
+ *  so total cost stays roughly constant as the radius grows, and only
+ *  the number of levels and the sample offset change.
+ */
+static void kawase_area_blur(struct composite_blur_filter_data *data)
+{
+	gs_effect_t *down_effect = data->effect;
+	gs_effect_t *up_effect = data->effect_2;
+
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
+
+	if (!down_effect || !up_effect || !texture) {
+		return;
+	}
+
+	gs_texture_t *background = composite_background(data);
+
+	struct kawase_params params;
+	kawase_params_for_radius(data->radius, data->width, data->height,
+				 &params);
+
+	set_blending_parameters();
+
+	if (params.levels == 0) {
+		kawase_copy(texture, background, data);
+		gs_blend_state_pop();
+		return;
+	}
+
+	gs_texrender_t *pyramid[KAWASE_MAX_LEVELS] = {0};
+	struct vec2 texel_step;
+	uint32_t src_width = data->width;
+	uint32_t src_height = data->height;
+
+	// 1. Downsample chain- each level is half the size of the last.  The
+	//    first level composites the input over the background.
+	struct effect_params *down_params = data->params;
+	effect_params_set_float(down_params, EFFECT_PARAM_OFFSET,
+				params.offset);
+
+	for (int i = 0; i < params.levels; i++) {
+		const uint32_t width = kawase_level_size(data->width, i + 1);
+		const uint32_t height = kawase_level_size(data->height, i + 1);
+
+		effect_params_set_texture(down_params, EFFECT_PARAM_IMAGE,
+					  texture);
+		composite_bind(down_params, i == 0 ? background : NULL,
+			       texture);
+		texel_step.x = 1.0f / (float)src_width;
+		texel_step.y = 1.0f / (float)src_height;
+		effect_params_set_vec2(down_params, EFFECT_PARAM_TEXEL_STEP,
+				       &texel_step);
+
+		pyramid[i] = texrender_pool_acquire(data->format, width,
+						    height, data->space);
+		if (gs_texrender_begin(pyramid[i], width, height)) {
+			while (gs_effect_loop(down_effect, "Draw"))
+				roi_draw_sprite(data, texture, width, height);
+			gs_texrender_end(pyramid[i]);
+		}
+
+		texture = gs_texrender_get_texture(pyramid[i]);
+		src_width = width;
+		src_height = height;
+	}
+
+	// 2. Upsample chain- levels already consumed by the downsample
+	//    are re-used as render targets on the way back up.
+	struct effect_params *up_params = data->params_2;
+	effect_params_set_float(up_params, EFFECT_PARAM_OFFSET, params.offset);
+
+	for (int i = params.levels - 1; i >= 0; i--) {
+		gs_texrender_t *target;
+		uint32_t width;
+		uint32_t height;
+		if (i > 0) {
+			gs_texrender_reset(pyramid[i - 1]);
+			target = pyramid[i - 1];
+			width = kawase_level_size(data->width, i);
+			height = kawase_level_size(data->height, i);
+		} else {
+			target = output_target(data);
+			width = data->width;
+			height = data->height;
+		}
+
+		effect_params_set_texture(up_params, EFFECT_PARAM_IMAGE,
+					  texture);
+		texel_step.x = 1.0f / (float)src_width;
+		texel_step.y = 1.0f / (float)src_height;
+		effect_params_set_vec2(up_params, EFFECT_PARAM_TEXEL_STEP,
+				       &texel_step);
+
+		if (target_begin(target, width, height)) {
+			while (gs_effect_loop(up_effect, "Draw"))
+				roi_draw_sprite(data, texture, width, height);
+			target_end(target);
+		}
+
+		texture = gs_texrender_get_texture(target);
+		src_width = width;
+		src_height = height;
+	}
+
+	for (int i = 0; i < params.levels; i++)
+		texrender_pool_release(pyramid[i]);
+	gs_blend_state_pop();
+}
+
+/*
+ *  Radius of zero- copies the input straight to the output texrender,
+ *  composited over `background` when there is one.
+ */
+static void kawase_copy(gs_texture_t *texture, gs_texture_t *background,
+			struct composite_blur_filter_data *data)
+{
+	gs_effect_t *effect = composite_copy_effect(data, texture, background);
+
+	gs_texrender_t *target = output_target(data);
+	if (target_begin(target, data->width, data->height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			roi_draw_sprite(data, texture, data->width,
+					data->height);
+		target_end(target);
+	}
+}
+
+static void load_dual_kawase_effects(struct composite_blur_filter_data *filter)
+{
+	filter->effect = load_shader_effect(filter->effect,
+					    "/shaders/kawase_down.effect");
+	filter->effect_2 = load_shader_effect(filter->effect_2,
+					      "/shaders/kawase_up.effect");
+	filter->params = effect_cache_get_params(filter->effect);
+	filter->params_2 = effect_cache_get_params(filter->effect_2);
+}
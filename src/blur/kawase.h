@@ -0,0 +1,20 @@
+#pragma once
+
+#include <math.h>
+#include <obs-module.h>
+#include <obs-utils.h>
+#include <obs-composite-blur-filter.h>
+#include "kawase-kernel.h"
+
+struct composite_blur_filter_data;
+
+extern void set_kawase_blur_types(obs_properties_t *props);
+extern void kawase_setup_callbacks(struct composite_blur_filter_data *data);
+extern void render_video_kawase(struct composite_blur_filter_data *data);
+extern void load_effect_kawase(struct composite_blur_filter_data *filter);
+
+static void kawase_area_blur(struct composite_blur_filter_data *data);
+static void kawase_copy(gs_texture_t *texture, gs_texture_t *background,
+			struct composite_blur_filter_data *data);
+
+static void load_dual_kawase_effects(struct composite_blur_filter_data *filter);
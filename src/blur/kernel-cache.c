@@ -0,0 +1,184 @@
+#include "kernel-cache.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+#define cache_lock_enter() AcquireSRWLockExclusive(&cache_lock)
+#define cache_lock_leave() ReleaseSRWLockExclusive(&cache_lock)
+#else
+#include <pthread.h>
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define cache_lock_enter() pthread_mutex_lock(&cache_lock)
+#define cache_lock_leave() pthread_mutex_unlock(&cache_lock)
+#endif
+
+#define HASH_BUCKETS 1024
+
+// Process-wide cache.  Also touched by the benchmark harness, so it has no
+// libobs dependency.
+static struct {
+	struct kernel_cache_entry *buckets[HASH_BUCKETS];
+	// Most recently used first.
+	struct kernel_cache_entry *lru_head;
+	struct kernel_cache_entry *lru_tail;
+	struct kernel_cache_stats stats;
+} cache;
+
+static inline uint32_t key_hash(struct kernel_cache_key key)
+{
+	uint32_t h = key.value * 2654435761u ^ key.kind * 40503u;
+	return (h >> 16) % HASH_BUCKETS;
+}
+
+static inline bool key_equal(struct kernel_cache_key a,
+			     struct kernel_cache_key b)
+{
+	return a.kind == b.kind && a.value == b.value;
+}
+
+static void lru_unlink(struct kernel_cache_entry *entry)
+{
+	if (entry->lru_prev)
+		entry->lru_prev->lru_next = entry->lru_next;
+	else
+		cache.lru_head = entry->lru_next;
+	if (entry->lru_next)
+		entry->lru_next->lru_prev = entry->lru_prev;
+	else
+		cache.lru_tail = entry->lru_prev;
+	entry->lru_prev = NULL;
+	entry->lru_next = NULL;
+}
+
+static void lru_push_front(struct kernel_cache_entry *entry)
+{
+	entry->lru_prev = NULL;
+	entry->lru_next = cache.lru_head;
+	if (cache.lru_head)
+		cache.lru_head->lru_prev = entry;
+	cache.lru_head = entry;
+	if (!cache.lru_tail)
+		cache.lru_tail = entry;
+}
+
+static void hash_remove(struct kernel_cache_entry *entry)
+{
+	struct kernel_cache_entry **link = &cache.buckets[key_hash(entry->key)];
+	while (*link && *link != entry)
+		link = &(*link)->hash_next;
+	if (*link)
+		*link = entry->hash_next;
+	entry->hash_next = NULL;
+}
+
+// Removes the entry from the cache and drops the cache's reference.
+static void evict(struct kernel_cache_entry *entry)
+{
+	hash_remove(entry);
+	lru_unlink(entry);
+	entry->cached = false;
+	cache.stats.entries--;
+	if (--entry->refs == 0)
+		free(entry);
+}
+
+static struct kernel_cache_entry *acquire(struct kernel_cache_key key,
+					  float radius)
+{
+	const uint32_t bucket = key_hash(key);
+
+	cache_lock_enter();
+	struct kernel_cache_entry *entry = cache.buckets[bucket];
+	while (entry && !key_equal(entry->key, key))
+		entry = entry->hash_next;
+
+	if (entry) {
+		cache.stats.hits++;
+		entry->refs++;
+		if (entry != cache.lru_head) {
+			lru_unlink(entry);
+			lru_push_front(entry);
+		}
+		cache_lock_leave();
+		return entry;
+	}
+	cache.stats.misses++;
+	cache_lock_leave();
+
+	// Sample outside the lock, the table walk is the slow part.
+	struct kernel_cache_entry *created =
+		calloc(1, sizeof(struct kernel_cache_entry));
+	if (!created)
+		return NULL;
+	created->key = key;
+	created->size = gaussian_sample_kernel(radius, created->weight,
+					       created->offset,
+					       GAUSSIAN_KERNEL_MAX_SIZE);
+
+	cache_lock_enter();
+	// Another thread may have inserted the same key meanwhile.
+	entry = cache.buckets[bucket];
+	while (entry && !key_equal(entry->key, key))
+		entry = entry->hash_next;
+	if (entry) {
+		entry->refs++;
+		cache_lock_leave();
+		free(created);
+		return entry;
+	}
+
+	created->refs = 2; // cache + caller
+	created->cached = true;
+	created->hash_next = cache.buckets[bucket];
+	cache.buckets[bucket] = created;
+	lru_push_front(created);
+	cache.stats.entries++;
+	while (cache.stats.entries > KERNEL_CACHE_CAPACITY) {
+		evict(cache.lru_tail);
+		cache.stats.evictions++;
+	}
+	cache_lock_leave();
+	return created;
+}
+
+const struct kernel_cache_entry *kernel_cache_acquire_gaussian(float radius)
+{
+	if (!(radius > 0.0f))
+		radius = 0.0f;
+	const uint32_t steps =
+		(uint32_t)lroundf(radius * (float)KERNEL_CACHE_RADIUS_STEPS);
+	const struct kernel_cache_key key = {KERNEL_CACHE_GAUSSIAN_RADIUS,
+					     steps};
+	return acquire(key, (float)steps / (float)KERNEL_CACHE_RADIUS_STEPS);
+}
+
+void kernel_cache_release(const struct kernel_cache_entry *entry)
+{
+	if (!entry)
+		return;
+	struct kernel_cache_entry *e = (struct kernel_cache_entry *)entry;
+	cache_lock_enter();
+	const bool last = --e->refs == 0;
+	cache_lock_leave();
+	if (last)
+		free(e);
+}
+
+void kernel_cache_get_stats(struct kernel_cache_stats *stats)
+{
+	cache_lock_enter();
+	*stats = cache.stats;
+	cache_lock_leave();
+}
+
+void kernel_cache_clear(void)
+{
+	cache_lock_enter();
+	while (cache.lru_head)
+		evict(cache.lru_head);
+	cache_lock_leave();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gaussian-kernel.h"
+
+// Radius is quantized to 1/KERNEL_CACHE_RADIUS_STEPS of a pixel before
+// lookup, well below the 0.1 step of the radius slider.
+#define KERNEL_CACHE_RADIUS_STEPS 100
+// Least recently used entries past this count are dropped from the cache.
+// Each entry is ~1KB, enough to hold every slider step of 0-100px.
+#define KERNEL_CACHE_CAPACITY 1024
+
+enum kernel_cache_kind {
+	KERNEL_CACHE_GAUSSIAN_RADIUS,
+};
+
+struct kernel_cache_key {
+	uint32_t kind;
+	uint32_t value;
+};
+
+/*
+ *  Linear sampled kernel shared by every filter that uses the same key.
+ *  weight/offset/size never change once an entry has been handed out.
+ *  The remaining fields belong to the cache and are only touched with
+ *  the cache lock held.
+ */
+struct kernel_cache_entry {
+	struct kernel_cache_key key;
+	size_t size;
+	float weight[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offset[GAUSSIAN_KERNEL_MAX_SIZE];
+
+	long refs;
+	bool cached;
+	struct kernel_cache_entry *hash_next;
+	struct kernel_cache_entry *lru_prev;
+	struct kernel_cache_entry *lru_next;
+};
+
+struct kernel_cache_stats {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	size_t entries;
+};
+
+// Returns a referenced entry for the gaussian kernel of `radius`, sampling
+// it on a miss.  Pair every acquire with kernel_cache_release.  Returns
+// NULL only if allocation fails.
+extern const struct kernel_cache_entry *
+kernel_cache_acquire_gaussian(float radius);
+extern void kernel_cache_release(const struct kernel_cache_entry *entry);
+extern void kernel_cache_get_stats(struct kernel_cache_stats *stats);
+// Drops every cached entry.  Entries still referenced by a filter are freed
+// by their last release.
+extern void kernel_cache_clear(void);
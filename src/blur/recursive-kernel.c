@@ -0,0 +1,135 @@
+#include "recursive-kernel.h"
+
+#include <math.h>
+
+struct cpx {
+	double re;
+	double im;
+};
+
+static struct cpx cpx_mul(struct cpx a, struct cpx b)
+{
+	struct cpx r = {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+	return r;
+}
+
+static struct cpx cpx_div(struct cpx a, struct cpx b)
+{
+	const double d = b.re * b.re + b.im * b.im;
+	struct cpx r = {(a.re * b.re + a.im * b.im) / d,
+			(a.im * b.re - a.re * b.im) / d};
+	return r;
+}
+
+// 1 - p / q
+static struct cpx one_minus_ratio(struct cpx p, struct cpx q)
+{
+	struct cpx r = cpx_div(p, q);
+	r.re = 1.0 - r.re;
+	r.im = -r.im;
+	return r;
+}
+
+// (1 - p * a) (1 - p * b) (1 - p * c)
+static struct cpx symmetric_product(struct cpx p, struct cpx a, struct cpx b,
+				    struct cpx c)
+{
+	const struct cpx poles[3] = {a, b, c};
+	struct cpx r = {1.0, 0.0};
+	for (int i = 0; i < 3; i++) {
+		struct cpx f = cpx_mul(p, poles[i]);
+		f.re = 1.0 - f.re;
+		f.im = -f.im;
+		r = cpx_mul(r, f);
+	}
+	return r;
+}
+
+/*
+ *  Coefficients from Young & van Vliet, "Recursive implementation of
+ *  the Gaussian filter" (1995), with sigma = radius like the discrete
+ *  kernel.  The poles are the roots of z^3 - a0 z^2 - a1 z - a2- one
+ *  real root, found with Newton's method from z = 1, and a complex
+ *  conjugate pair from the remaining quadratic.
+ */
+void recursive_gaussian_coefficients(float sigma, struct recursive_gaussian *c)
+{
+	c->enabled = sigma >= RECURSIVE_MIN_SIGMA;
+	if (!c->enabled) {
+		c->support = 0;
+		return;
+	}
+
+	const double s = sigma;
+	const double q = s >= 2.5 ? 0.98711 * s - 0.96330
+				  : 3.97156 - 4.14554 * sqrt(1.0 - 0.26891 * s);
+	const double q2 = q * q;
+	const double q3 = q2 * q;
+	const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+	const double a0 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+	const double a1 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+	const double a2 = 0.422205 * q3 / b0;
+	const double b = 1.0 - (a0 + a1 + a2);
+
+	// 1. Real pole.  All poles are inside the unit circle, so Newton's
+	// method from z = 1 walks down to the only real root.
+	double r = 1.0;
+	for (int i = 0; i < 64; i++) {
+		const double f = ((r - a0) * r - a1) * r - a2;
+		const double df = (3.0 * r - 2.0 * a0) * r - a1;
+		const double step = f / df;
+		r -= step;
+		if (fabs(step) < 1e-15)
+			break;
+	}
+
+	// 2. Complex pair, from z^2 + (r - a0) z + (r (r - a0) - a1).
+	const double lin = r - a0;
+	const double con = r * lin - a1;
+	const double re = -lin / 2.0;
+	const double disc = con - re * re;
+	const double im = disc > 0.0 ? sqrt(disc) : 0.0;
+
+	const struct cpx p0 = {r, 0.0};
+	const struct cpx p1 = {re, im};
+	const struct cpx p2 = {re, -im};
+	const struct cpx gain = {b * b, 0.0};
+
+	// 3. Residues of the symmetric filter b^2 / prod((1 - p_i / z) *
+	// (1 - p_i * z)) at z = p_i.
+	const struct cpx r0 = cpx_div(
+		gain, cpx_mul(cpx_mul(one_minus_ratio(p1, p0),
+				      one_minus_ratio(p2, p0)),
+			      symmetric_product(p0, p0, p1, p2)));
+	const struct cpx r1 = cpx_div(
+		gain, cpx_mul(cpx_mul(one_minus_ratio(p0, p1),
+				      one_minus_ratio(p2, p1)),
+			      symmetric_product(p1, p0, p1, p2)));
+
+	c->real_pole = (float)r;
+	c->real_residue = (float)r0.re;
+	c->complex_pole[0] = (float)re;
+	c->complex_pole[1] = (float)im;
+	c->complex_residue[0] = (float)r1.re;
+	c->complex_residue[1] = (float)r1.im;
+
+	const double magnitude = fmax(fabs(r), sqrt(re * re + im * im));
+	const double support = magnitude > 0.0 ? log(1e-6) / log(magnitude)
+					       : 1.0;
+	c->support = support < 4294967295.0 ? (uint32_t)ceil(support) + 1
+					    : UINT32_MAX;
+}
+
+// Scan passes needed to sum a line of `size` terms, or the filter's
+// support if that is shorter.
+int recursive_scan_passes(const struct recursive_gaussian *c, uint32_t size)
+{
+	const uint64_t terms = c->support < size ? c->support : size;
+	int passes = 1;
+	uint64_t span = RECURSIVE_SCAN_RADIX;
+	while (span < terms) {
+		span *= RECURSIVE_SCAN_RADIX;
+		passes++;
+	}
+	return passes;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Each scan pass of the GPU recursive filter adds up this many terms.
+#define RECURSIVE_SCAN_RADIX 4
+
+// Smallest sigma the Young-van Vliet fit covers.  Below it the filter
+// is a copy.
+#define RECURSIVE_MIN_SIGMA 0.5f
+
+/*
+ *  Young-van Vliet recursive gaussian.  The filter is a third order
+ *  recursion run forward along a line and then backward over the
+ *  result.  Split into partial fractions, that symmetric six pole
+ *  filter is the sum of one first order recursion per pole, forward
+ *  and backward over the same input:
+ *
+ *    z[n] = x[n] + p * z[n-1]   (and z[n+1] for the backward one)
+ *    y[n] = sum over poles of residue * (z_fwd[n] + z_bwd[n] - x[n])
+ *
+ *  Each recursion stays well conditioned in float, unlike the direct
+ *  form, and past either end of the line it only needs the edge texel
+ *  repeated, so the result matches clamp addressing exactly.  The
+ *  poles are one real pole and a complex conjugate pair.
+ */
+struct recursive_gaussian {
+	bool enabled;
+	float real_pole;
+	float real_residue;
+	// Complex values are {re, im}.  The conjugate pole and its residue
+	// are implied, so this pole is counted as 2 * Re(residue * z).
+	float complex_pole[2];
+	float complex_residue[2];
+	// Terms after which the impulse response has decayed below 1e-6.
+	uint32_t support;
+};
+
+extern void recursive_gaussian_coefficients(float sigma,
+					    struct recursive_gaussian *c);
+extern int recursive_scan_passes(const struct recursive_gaussian *c,
+				 uint32_t size);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <math.h>
+#include <obs-module.h>
+#include <obs-utils.h>
+#include <obs-composite-blur-filter.h>
+#include "recursive-kernel.h"
+
+struct composite_blur_filter_data;
+
+extern void set_recursive_blur_types(obs_properties_t *props);
+extern void recursive_setup_callbacks(struct composite_blur_filter_data *data);
+extern void render_video_recursive(struct composite_blur_filter_data *data);
+extern void load_effect_recursive(struct composite_blur_filter_data *filter);
+
+static void recursive_area_blur(struct composite_blur_filter_data *data);
+static void recursive_direction(struct composite_blur_filter_data *data,
+				gs_texture_t *texture,
+				gs_texture_t *background,
+				gs_texture_t *forward, gs_texrender_t *target,
+				bool vertical, bool reverse);
+static gs_texrender_t *
+recursive_scan(struct composite_blur_filter_data *data, gs_texture_t *texture,
+	       gs_texture_t *background, const char *technique, float pole_re,
+	       float pole_im, uint32_t length, float channel_pair);
+static void recursive_copy(gs_texture_t *texture, gs_texture_t *background,
+			   struct composite_blur_filter_data *data);
+
+static void
+load_recursive_gaussian_effect(struct composite_blur_filter_data *filter);
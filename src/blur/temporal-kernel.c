@@ -0,0 +1,61 @@
+#include "temporal-kernel.h"
+
+#include <math.h>
+
+// Largest difference to a still input a settled trail may keep, half an
+// 8 bit step.
+#define TEMPORAL_SETTLE_ERROR (1.0 / 512.0)
+
+void temporal_params_for_frames(int frames, enum temporal_mode mode,
+				int memory_mb, uint32_t width, uint32_t height,
+				struct temporal_params *params)
+{
+	if (frames < 1)
+		frames = 1;
+	if (frames > TEMPORAL_MAX_FRAMES)
+		frames = TEMPORAL_MAX_FRAMES;
+	if (memory_mb <= 0)
+		memory_mb = TEMPORAL_DEFAULT_MEMORY_MB;
+
+	params->mode = mode;
+	params->frames = frames;
+	params->slots = 0;
+	params->ring_bytes = 0;
+	// Same mean age, (frames - 1) / 2, as a box of `frames` frames.
+	params->alpha = 2.0f / (float)(frames + 1);
+
+	// One frame is a copy either way, and needs no ring.
+	if (frames == 1)
+		params->mode = TEMPORAL_MODE_EXPONENTIAL;
+
+	const uint64_t slot_bytes = (uint64_t)width * height * 4;
+	const uint64_t budget = (uint64_t)memory_mb * 1024 * 1024;
+	if (params->mode == TEMPORAL_MODE_BOX &&
+	    slot_bytes * (uint64_t)frames > budget)
+		params->mode = TEMPORAL_MODE_EXPONENTIAL;
+
+	if (params->mode == TEMPORAL_MODE_BOX) {
+		params->slots = frames;
+		params->ring_bytes = slot_bytes * (uint64_t)frames;
+		params->settle_frames = frames;
+	} else if (frames == 1) {
+		params->settle_frames = 1;
+	} else {
+		params->settle_frames = (int)ceil(
+			log(TEMPORAL_SETTLE_ERROR) /
+			log(1.0 - (double)params->alpha));
+	}
+}
+
+float temporal_weight(const struct temporal_params *params, int count,
+		      bool *subtract_oldest)
+{
+	*subtract_oldest = false;
+	const float average = 1.0f / (float)(count + 1);
+	if (params->mode == TEMPORAL_MODE_EXPONENTIAL)
+		return average > params->alpha ? average : params->alpha;
+	if (count < params->frames)
+		return average;
+	*subtract_oldest = true;
+	return 1.0f / (float)params->frames;
+}
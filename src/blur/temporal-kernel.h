@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Longest trail, in frames, the settings offer.
+#define TEMPORAL_MAX_FRAMES 120
+// Memory the ring of a box trail may hold when the setting is left at 0.
+#define TEMPORAL_DEFAULT_MEMORY_MB 512
+
+// How the trail weighs the frames in it.
+enum temporal_mode {
+	// Mean of the last `frames` frames.
+	TEMPORAL_MODE_BOX = 0,
+	// Exponential moving average with the same mean age as the box.
+	TEMPORAL_MODE_EXPONENTIAL = 1,
+};
+
+/*
+ *  Running accumulation of a temporal trail.  Every frame updates the
+ *  accumulator once:
+ *
+ *    acc = acc + (frame - oldest) * weight
+ *
+ *  A box trail subtracts the frame leaving its ring with weight
+ *  1 / frames.  An exponential one subtracts the accumulator itself
+ *  with weight alpha, and needs no ring.  Until a trail has seen
+ *  `frames` frames it averages the ones it has, so it starts out as a
+ *  copy of the first frame.
+ */
+struct temporal_params {
+	// Mode in effect, exponential when a box ring does not fit.
+	enum temporal_mode mode;
+	// Frames in the trail as set, at least 1.
+	int frames;
+	// Frames the ring keeps, 0 for exponential trails.
+	int slots;
+	float alpha;
+	// Frames after which a still input has filled the trail, so the
+	// accumulator matches it to 8 bits.
+	int settle_frames;
+	// Bytes of the 8 bit ring.
+	uint64_t ring_bytes;
+};
+
+// Picks the mode and ring size of a trail of `frames` frames of width x
+// height pixels.  A box ring over `memory_mb` falls back to exponential,
+// and `memory_mb` <= 0 uses TEMPORAL_DEFAULT_MEMORY_MB.
+extern void temporal_params_for_frames(int frames, enum temporal_mode mode,
+				       int memory_mb, uint32_t width,
+				       uint32_t height,
+				       struct temporal_params *params);
+// Weight of the frame accumulated when the trail already holds `count`
+// frames, and whether it replaces the oldest ring slot instead of
+// blending with the accumulator.
+extern float temporal_weight(const struct temporal_params *params, int count,
+			     bool *subtract_oldest);
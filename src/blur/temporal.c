@@ -0,0 +1,251 @@
+#include <obs-composite-blur-filter.h>
+#include "temporal.h"
+
+void set_temporal_blur_types(obs_properties_t *props)
+{
+	obs_property_t *p = obs_properties_get(props, "blur_type");
+	obs_property_list_clear(p);
+	obs_property_list_add_int(p, obs_module_text(TYPE_MOTION_LABEL),
+				  TYPE_MOTION);
+}
+
+void temporal_setup_callbacks(struct composite_blur_filter_data *data)
+{
+	data->video_render = render_video_temporal;
+	data->load_effect = load_effect_temporal;
+	data->update = NULL;
+}
+
+void render_video_temporal(struct composite_blur_filter_data *data)
+{
+	switch (data->blur_type) {
+	case TYPE_MOTION:
+		temporal_motion_blur(data);
+		break;
+	}
+}
+
+void load_effect_temporal(struct composite_blur_filter_data *filter)
+{
+	switch (filter->blur_type) {
+	case TYPE_MOTION:
+		load_temporal_accumulate_effect(filter);
+		break;
+	}
+}
+
+void temporal_video_tick(struct composite_blur_filter_data *filter)
+{
+	filter->temporal.new_frame = true;
+}
+
+void temporal_begin_frame(struct composite_blur_filter_data *filter)
+{
+	struct temporal_trail *t = &filter->temporal;
+	if (filter->blur_algorithm != ALGO_TEMPORAL) {
+		if (t->configured) {
+			// The float output goes with the trail, the next
+			// algorithm creates an 8 bit one.
+			temporal_free(filter);
+			gs_texrender_destroy(filter->output_texrender);
+			filter->output_texrender = NULL;
+		}
+		return;
+	}
+
+	temporal_configure(filter);
+	if (!t->new_frame || !t->pending) {
+		return;
+	}
+
+	// The slot of the frame leaving the trail becomes the capture
+	// target, which resets it.
+	t->head = (t->head + 1) % t->params.slots;
+	gs_texrender_t *frame = *t->pending;
+	*t->pending = t->ring[t->head];
+	t->ring[t->head] = frame;
+	t->pending = NULL;
+}
+
+bool temporal_settled(struct composite_blur_filter_data *filter,
+		      bool input_changed)
+{
+	struct temporal_trail *t = &filter->temporal;
+	if (filter->blur_algorithm != ALGO_TEMPORAL) {
+		return true;
+	}
+	if (input_changed) {
+		t->still_frames = 0;
+	}
+	return t->configured && t->still_frames >= t->params.settle_frames;
+}
+
+void temporal_free(struct composite_blur_filter_data *filter)
+{
+	struct temporal_trail *t = &filter->temporal;
+	for (int i = 0; i < TEMPORAL_MAX_FRAMES; i++) {
+		gs_texrender_destroy(t->ring[i]);
+		t->ring[i] = NULL;
+	}
+	gs_texrender_destroy(t->accumulator);
+	t->accumulator = NULL;
+	gs_texrender_destroy(t->composited);
+	t->composited = NULL;
+	t->pending = NULL;
+	t->head = 0;
+	t->count = 0;
+	t->still_frames = 0;
+	t->configured = false;
+}
+
+/*
+ *  Starts a new trail when the settings or the frame size changed.  A
+ *  box ring over the memory limit falls back to an exponential trail of
+ *  the same mean age.
+ */
+static void temporal_configure(struct composite_blur_filter_data *data)
+{
+	struct temporal_trail *t = &data->temporal;
+	if (t->configured && t->frames == data->temporal_frames &&
+	    t->mode == data->temporal_mode &&
+	    t->memory_mb == data->temporal_memory &&
+	    t->width == data->width && t->height == data->height) {
+		return;
+	}
+
+	temporal_free(data);
+	t->configured = true;
+	t->frames = data->temporal_frames;
+	t->mode = data->temporal_mode;
+	t->memory_mb = data->temporal_memory;
+	t->width = data->width;
+	t->height = data->height;
+	temporal_params_for_frames(t->frames, (enum temporal_mode)t->mode,
+				   t->memory_mb, t->width, t->height,
+				   &t->params);
+	if (t->mode == TEMPORAL_MODE_BOX &&
+	    t->params.mode != TEMPORAL_MODE_BOX && t->params.frames > 1) {
+		obs_log(LOG_INFO,
+			"Temporal trail of %d frames at %ux%u is over the "
+			"%d MB limit, using exponential accumulation",
+			t->params.frames, t->width, t->height,
+			t->memory_mb > 0 ? t->memory_mb
+					 : TEMPORAL_DEFAULT_MEMORY_MB);
+	}
+
+	// A box trail adds each frame and takes it out again frames later,
+	// which only cancels in float.
+	gs_texrender_destroy(data->output_texrender);
+	data->output_texrender = gs_texrender_create(GS_RGBA32F, GS_ZS_NONE);
+	t->accumulator = gs_texrender_create(GS_RGBA32F, GS_ZS_NONE);
+}
+
+/*
+ *  Adds the frame to the trail and takes out the one leaving it, in one
+ *  pass from the accumulator output_texrender shows into the other one.
+ *  The capture target of the frame joins the ring at the start of the
+ *  next frame, so the frame is never copied.
+ */
+static void temporal_motion_blur(struct composite_blur_filter_data *data)
+{
+	struct temporal_trail *t = &data->temporal;
+	gs_effect_t *effect = data->effect;
+
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
+
+	if (!effect || !texture || !t->configured) {
+		return;
+	}
+
+	// Drawn again within the same video frame, the trail holds it
+	// already.
+	if (!t->new_frame && t->count > 0) {
+		return;
+	}
+	t->new_frame = false;
+
+	gs_texture_t *background = composite_background(data);
+	gs_texture_t *frame = texture;
+	gs_texrender_t **capture = &data->input_texrender;
+	if (background) {
+		frame = temporal_composite(data, texture, background);
+		capture = &t->composited;
+	}
+
+	bool subtract_oldest;
+	const float weight =
+		temporal_weight(&t->params, t->count, &subtract_oldest);
+	// The first frame averages with itself, the accumulators hold
+	// nothing yet.
+	gs_texture_t *accumulated =
+		t->count > 0 ? gs_texrender_get_texture(data->output_texrender)
+			     : frame;
+	gs_texture_t *oldest = accumulated;
+	if (subtract_oldest) {
+		const int slot = (t->head + 1) % t->params.slots;
+		oldest = gs_texrender_get_texture(t->ring[slot]);
+	}
+
+	struct effect_params *params = data->params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, frame);
+	effect_params_set_texture(params, EFFECT_PARAM_ACCUMULATOR,
+				  accumulated);
+	effect_params_set_texture(params, EFFECT_PARAM_OLDEST, oldest);
+	effect_params_set_float(params, EFFECT_PARAM_TRAIL_WEIGHT, weight);
+
+	set_blending_parameters();
+
+	gs_texrender_reset(t->accumulator);
+	if (gs_texrender_begin(t->accumulator, data->width, data->height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(frame, 0, data->width, data->height);
+		gs_texrender_end(t->accumulator);
+	}
+
+	gs_blend_state_pop();
+
+	gs_texrender_t *shown = t->accumulator;
+	t->accumulator = data->output_texrender;
+	data->output_texrender = shown;
+
+	t->pending = t->params.slots > 0 ? capture : NULL;
+	if (t->count < t->params.frames) {
+		t->count++;
+	}
+	if (t->still_frames < t->params.settle_frames) {
+		t->still_frames++;
+	}
+}
+
+/*
+ *  Composites the frame over the background into its own capture target.
+ *  Unlike the blurs the trail cannot fold this into its pass- frames
+ *  leave the trail composited over the background they were captured
+ *  with, so they are stored that way.
+ */
+static gs_texture_t *
+temporal_composite(struct composite_blur_filter_data *data,
+		   gs_texture_t *texture, gs_texture_t *background)
+{
+	struct temporal_trail *t = &data->temporal;
+	gs_effect_t *effect = composite_copy_effect(data, texture, background);
+
+	t->composited = create_or_reset_texrender(t->composited, data->format);
+	set_blending_parameters();
+	if (gs_texrender_begin(t->composited, data->width, data->height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			roi_draw_sprite(data, texture, data->width,
+					data->height);
+		gs_texrender_end(t->composited);
+	}
+	gs_blend_state_pop();
+	return gs_texrender_get_texture(t->composited);
+}
+
+static void
+load_temporal_accumulate_effect(struct composite_blur_filter_data *filter)
+{
+	filter->effect = load_shader_effect(
+		filter->effect, "/shaders/temporal_accumulate.effect");
+	filter->params = effect_cache_get_params(filter->effect);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <obs-module.h>
+#include "temporal-kernel.h"
+
+struct composite_blur_filter_data;
+
+/*
+ *  Ring and accumulators of a temporal trail, graphics thread only.  The
+ *  ring takes over the filter's capture targets instead of copying
+ *  frames into its own, so each frame costs the one accumulation pass
+ *  however long the trail is.
+ */
+struct temporal_trail {
+	// Settings and frame size the trail was set up for.
+	bool configured;
+	int frames;
+	int mode;
+	int memory_mb;
+	uint32_t width;
+	uint32_t height;
+	struct temporal_params params;
+
+	// The last params.slots frames, newest at `head`.
+	gs_texrender_t *ring[TEMPORAL_MAX_FRAMES];
+	int head;
+	// Frames in the accumulator, up to params.frames.
+	int count;
+	// The float accumulator not shown this frame, output_texrender
+	// holds the other.
+	gs_texrender_t *accumulator;
+	// Capture target of the frame accumulated last.  It joins the ring
+	// before the next frame is captured.
+	gs_texrender_t **pending;
+	// Capture target of frames composited over a background.
+	gs_texrender_t *composited;
+
+	// Set by video_tick.  The trail moves once per video frame, however
+	// many views draw the filter.
+	bool new_frame;
+	// Accumulations since the input last changed.
+	int still_frames;
+};
+
+extern void set_temporal_blur_types(obs_properties_t *props);
+extern void temporal_setup_callbacks(struct composite_blur_filter_data *data);
+extern void render_video_temporal(struct composite_blur_filter_data *data);
+extern void load_effect_temporal(struct composite_blur_filter_data *filter);
+
+extern void temporal_video_tick(struct composite_blur_filter_data *filter);
+// Sets the trail up for the current settings and moves the last frame
+// into the ring.  Call before the input is captured.  Frees the trail
+// once another algorithm is selected.
+extern void temporal_begin_frame(struct composite_blur_filter_data *filter);
+// False while a trail is still moving toward a still input, so the frame
+// has to render even though the input did not change.
+extern bool temporal_settled(struct composite_blur_filter_data *filter,
+			     bool input_changed);
+extern void temporal_free(struct composite_blur_filter_data *filter);
+
+static void temporal_motion_blur(struct composite_blur_filter_data *data);
+static gs_texture_t *
+temporal_composite(struct composite_blur_filter_data *data,
+		   gs_texture_t *texture, gs_texture_t *background);
+static void temporal_configure(struct composite_blur_filter_data *data);
+static void load_temporal_accumulate_effect(
+	struct composite_blur_filter_data *filter);
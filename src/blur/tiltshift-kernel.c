@@ -0,0 +1,128 @@
+#include "tiltshift-kernel.h"
+#include "downsample-kernel.h"
+
+#include <math.h>
+
+// Never halve the frame below this many pixels on either side.
+#define TILTSHIFT_MIN_SIZE 4
+
+// Rows of the frame, in frame pixels, above `top` and below `bottom`.
+struct row_span {
+	float top;
+	float bottom;
+};
+
+float tiltshift_lod(float sigma)
+{
+	return 0.5f * log2f(1.0f + sigma * sigma / TILTSHIFT_LEVEL_VARIANCE);
+}
+
+/*
+ *  Picks the number of pyramid levels that reaches the sigma of the row
+ *  furthest from the band.  Rows past the top level get its blur.
+ */
+void tiltshift_params_for_radius(float radius, float top, float bottom,
+				 uint32_t width, uint32_t height,
+				 struct tiltshift_params *params)
+{
+	params->levels = 0;
+	params->top = top;
+	params->bottom = bottom;
+	params->radius = radius;
+	params->width = width;
+	params->height = height;
+
+	const float reach = fmaxf(top, 1.0f - bottom);
+	if (radius <= 0.0f || reach <= 0.0f)
+		return;
+
+	const float lod = tiltshift_lod(radius * reach);
+	while (params->levels < TILTSHIFT_MAX_LEVELS &&
+	       (float)params->levels < lod &&
+	       kawase_level_size(width, params->levels + 1) >=
+		       TILTSHIFT_MIN_SIZE &&
+	       kawase_level_size(height, params->levels + 1) >=
+		       TILTSHIFT_MIN_SIZE)
+		params->levels++;
+}
+
+static struct row_span grow(struct row_span span, float pixels)
+{
+	span.top += pixels;
+	span.bottom -= pixels;
+	return span;
+}
+
+static struct row_span join(struct row_span a, struct row_span b)
+{
+	a.top = fmaxf(a.top, b.top);
+	a.bottom = fminf(a.bottom, b.bottom);
+	return a;
+}
+
+// Rows whose blur reaches past level - 1, so they read `level`.
+static struct row_span blurred_rows(const struct tiltshift_params *params,
+				    int level)
+{
+	const float below = (float)(1 << (2 * (level - 1))) - 1.0f;
+	const float sigma = sqrtf(TILTSHIFT_LEVEL_VARIANCE * below);
+	const float dist = sigma / params->radius;
+	const float height = (float)params->height;
+	struct row_span span = {(params->top - dist) * height,
+				(params->bottom + dist) * height};
+	return span;
+}
+
+/*
+ *  Rows level `level` has to hold.  The collapse into the level above
+ *  reads 2 texels around the rows that use it, and the next level's
+ *  passes read 4 texels of their scratch target plus the 2x2 box of
+ *  the halving.
+ */
+static struct row_span level_rows(const struct tiltshift_params *params,
+				  int level)
+{
+	struct row_span span = grow(blurred_rows(params, params->levels),
+				    2.0f * (float)(1 << params->levels));
+	for (int i = params->levels - 1; i >= level; i--) {
+		const float scale = (float)(1 << i);
+		span = join(grow(blurred_rows(params, i), 2.0f * scale),
+			    grow(span, 9.0f * scale));
+	}
+	return span;
+}
+
+void tiltshift_pass_rows(const struct tiltshift_params *params,
+			 enum tiltshift_pass pass, int level,
+			 uint32_t *top_end, uint32_t *bottom_start)
+{
+	const uint32_t height = kawase_level_size(params->height, level);
+	*top_end = height;
+	*bottom_start = height;
+	if (level == 0)
+		return;
+
+	const float scale = (float)(1 << level);
+	struct row_span span;
+	switch (pass) {
+	case TILTSHIFT_PASS_DOWN:
+		span = grow(level_rows(params, level), 4.0f * scale);
+		break;
+	case TILTSHIFT_PASS_BLUR:
+		span = level_rows(params, level);
+		break;
+	default:
+		span = grow(blurred_rows(params, level), 2.0f * scale);
+		break;
+	}
+
+	// To level rows, rounded out by a texel.
+	const float to_level = (float)height / (float)params->height;
+	const float top = span.top > 0.0f ? ceilf(span.top * to_level) + 1.0f
+					  : 0.0f;
+	const float bottom = floorf(span.bottom * to_level) - 1.0f;
+	if (top >= bottom)
+		return;
+	*top_end = top < (float)height ? (uint32_t)top : height;
+	*bottom_start = bottom < (float)height ? (uint32_t)bottom : height;
+}
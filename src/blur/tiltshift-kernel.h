@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+// Most blur pyramid levels of a gaussian tilt-shift.  Level k is 2^k
+// times smaller than the frame.
+#define TILTSHIFT_MAX_LEVELS 8
+// Gaussian kernel radius, in level pixels, each level is blurred with on
+// top of the 2x2 box of the halving.
+#define TILTSHIFT_LEVEL_RADIUS 1.0f
+// Variance, in frame px^2, that the halving and blur of one level add,
+// per frame px^2 of texel area of the level above.  Level k holds about
+// TILTSHIFT_LEVEL_VARIANCE * (4^k - 1) in total.
+#define TILTSHIFT_LEVEL_VARIANCE (4.25f / 3.0f)
+
+struct tiltshift_params {
+	int levels;
+	// Edges of the in-focus band in uv.  Rows with top < v < bottom are
+	// sharp, the others get a sigma of radius times their distance to
+	// the band, in frame pixels.
+	float top;
+	float bottom;
+	float radius;
+	uint32_t width;
+	uint32_t height;
+};
+
+// Passes of each pyramid level, in render order.
+enum tiltshift_pass {
+	// Halves level - 1 and blurs it horizontally into a scratch target.
+	TILTSHIFT_PASS_DOWN,
+	// Blurs the scratch target vertically into the level.
+	TILTSHIFT_PASS_BLUR,
+	// Blends the level with the upsampled result of the level below it.
+	TILTSHIFT_PASS_COLLAPSE,
+};
+
+extern void tiltshift_params_for_radius(float radius, float top,
+					float bottom, uint32_t width,
+					uint32_t height,
+					struct tiltshift_params *params);
+// Fractional pyramid level whose blur is closest to `sigma` frame pixels.
+extern float tiltshift_lod(float sigma);
+// Rows of a level-sized target that `pass` of `level` has to shade:
+// [0, *top_end) above the band and [*bottom_start, level height) below.
+// Both ranges cover the whole target when they meet.
+extern void tiltshift_pass_rows(const struct tiltshift_params *params,
+				enum tiltshift_pass pass, int level,
+				uint32_t *top_end, uint32_t *bottom_start);
@@ -0,0 +1,468 @@
+#include "zoom-kernel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -log of the size of the scale a tap `offset` steps toward the center
+// samples at, and whether that is past the center.
+static double axis_log_scale(double offset, uint32_t size, bool *crosses)
+{
+	double scale = 1.0 - 4.0 * offset / (double)size;
+	*crosses = scale < 0.0;
+	scale = fabs(scale);
+	if (scale < ZOOM_MIN_SCALE)
+		scale = ZOOM_MIN_SCALE;
+	return -log(scale);
+}
+
+// Log scales, toward the center, of a tap on both axes, how far an error
+// in them moves the sample at the frame edge, and the ZOOM_CROSS_* axes
+// it steps past the center on.
+struct zoom_tap {
+	double weight;
+	double log_x;
+	double log_y;
+	double reach_x;
+	double reach_y;
+	int side;
+};
+
+// Position along the grid line log_y = slope * log_x closest to the tap.
+static double tap_position(const struct zoom_tap *tap, double slope)
+{
+	const double a = tap->reach_x * tap->reach_x;
+	const double b = tap->reach_y * tap->reach_y;
+	return (a * tap->log_x + b * slope * tap->log_y) /
+	       (a + b * slope * slope);
+}
+
+static double line_error(const struct zoom_tap *taps, size_t count,
+			 double slope)
+{
+	double error = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const struct zoom_tap *tap = &taps[i];
+		if (tap->side)
+			continue;
+		const double p = tap_position(tap, slope);
+		const double dx = (p - tap->log_x) * tap->reach_x;
+		const double dy = (slope * p - tap->log_y) * tap->reach_y;
+		error += tap->weight * (dx * dx + dy * dy);
+	}
+	return error;
+}
+
+/*
+ *  Composed passes scale both axes by the same power of their pass
+ *  scales, so their taps lie on a line through the origin in log scale.
+ *  The gather's taps do not- with a frame that is not square, the short
+ *  axis reaches the center first.  Picks the slope of the line that
+ *  moves the taps the fewest pixels, weighted by their kernel weights.
+ *  Taps past the center turn back on the axis they crossed and are left
+ *  out, zoom_fit places them.
+ */
+static double fit_slope(const struct zoom_tap *taps, size_t count)
+{
+	double lo = 0.0;
+	double hi = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		if (taps[i].log_x <= 0.0 || taps[i].side)
+			continue;
+		const double slope = taps[i].log_y / taps[i].log_x;
+		if (lo == 0.0 || slope < lo)
+			lo = slope;
+		if (slope > hi)
+			hi = slope;
+	}
+	if (lo == 0.0)
+		return 1.0;
+
+	// The error has a single minimum between the slopes of the taps.
+	for (int i = 0; i < 40; i++) {
+		const double a = lo + (hi - lo) / 3.0;
+		const double b = hi - (hi - lo) / 3.0;
+		if (line_error(taps, count, a) < line_error(taps, count, b))
+			hi = b;
+		else
+			lo = a;
+	}
+	return 0.5 * (lo + hi);
+}
+
+// Weight of the taps on every side of the center and grid point, and the
+// weighted sums of their log scales.
+struct zoom_grid {
+	double weight[ZOOM_SIDES][ZOOM_GRID_MAX];
+	double log_x[ZOOM_SIDES][ZOOM_GRID_MAX];
+	double log_y[ZOOM_SIDES][ZOOM_GRID_MAX];
+};
+
+static void grid_add(struct zoom_grid *grid, int side, int n, double weight,
+		     double log_x, double log_y)
+{
+	grid->weight[side][n] += weight;
+	grid->log_x[side][n] += weight * log_x;
+	grid->log_y[side][n] += weight * log_y;
+}
+
+/*
+ *  Repeated gathers compose their scales, which adds grid positions and
+ *  log scales, and crosses back over the center on an axis crossed
+ *  twice.
+ */
+static void grid_compose(struct zoom_grid *next, const struct zoom_grid *grid,
+			 const struct zoom_grid *single, int support,
+			 int steps)
+{
+	memset(next, 0, sizeof(*next));
+	for (int a = 0; a < ZOOM_SIDES; a++) {
+		for (int n = 0; n <= steps; n++) {
+			const double gw = grid->weight[a][n];
+			if (gw <= 0.0)
+				continue;
+			for (int b = 0; b < ZOOM_SIDES; b++) {
+				for (int s = 0; s <= support; s++) {
+					const double sw = single->weight[b][s];
+					if (sw <= 0.0)
+						continue;
+					const int m = n + s < steps ? n + s
+								    : steps;
+					next->weight[a ^ b][m] += gw * sw;
+					next->log_x[a ^ b][m] +=
+						sw * grid->log_x[a][n] +
+						gw * single->log_x[b][s];
+					next->log_y[a ^ b][m] +=
+						sw * grid->log_y[a][n] +
+						gw * single->log_y[b][s];
+				}
+			}
+		}
+	}
+}
+
+// Index into the log scales zoom_fit solves for of the tap of pass j
+// a grid point takes.  The last pass indexes its cross taps after its
+// own.
+static int fit_index(const struct zoom_params *params, const int *cross_tap,
+		     int side, int n, int j)
+{
+	int stride = 1;
+	for (int k = 0; k < j; k++)
+		stride *= ZOOM_TAPS;
+	const int d = (n / stride) % ZOOM_TAPS;
+	if (j == params->passes - 1 && side != 0)
+		return (j + 1) * ZOOM_TAPS + cross_tap[side * ZOOM_TAPS + d];
+	return j * ZOOM_TAPS + d;
+}
+
+// Rounds over every pass, the fit barely moves after the first few.
+#define ZOOM_FIT_ROUNDS 8
+
+// Solves for the log scales of the taps of pass j on one axis, holding
+// those of the other passes.
+static void fit_pass(const struct zoom_grid *grid,
+		     const double (*log_scale)[ZOOM_GRID_MAX], int steps,
+		     const int *cross_tap, const struct zoom_params *params,
+		     int j, double *fit)
+{
+	double num[2 * ZOOM_TAPS] = {0};
+	double den[2 * ZOOM_TAPS] = {0};
+	for (int s = 0; s < ZOOM_SIDES; s++) {
+		for (int n = 0; n <= steps; n++) {
+			const double w = grid->weight[s][n];
+			if (w <= 0.0)
+				continue;
+			const double mean = log_scale[s][n] / w;
+			double rest = mean;
+			int own = 0;
+			for (int k = 0; k < params->passes; k++) {
+				const int i =
+					fit_index(params, cross_tap, s, n, k);
+				if (k == j)
+					own = i - j * ZOOM_TAPS;
+				else
+					rest -= fit[i];
+			}
+			const double m = w * exp(-2.0 * mean);
+			num[own] += m * rest;
+			den[own] += m;
+		}
+	}
+	for (int t = 1; t < 2 * ZOOM_TAPS; t++) {
+		if (den[t] > 0.0)
+			fit[j * ZOOM_TAPS + t] = num[t] / den[t];
+	}
+}
+
+/*
+ *  The log scale of a grid point is the sum of those of the taps of each
+ *  pass it takes, on each axis.  Starting from the fitted line, solves
+ *  for the log scales of the taps that put the grid points closest to
+ *  the mean log scale of the gather's taps on them, weighted by how far
+ *  an error moves the sample, one pass at a time.  Tap 0 of a pass is
+ *  the frame itself and stays at scale 1.
+ */
+static void zoom_fit(const struct zoom_grid *grid,
+		     const double (*log_scale)[ZOOM_GRID_MAX], int steps,
+		     const int *cross_tap, const struct zoom_params *params,
+		     double *fit)
+{
+	for (int round = 0; round < ZOOM_FIT_ROUNDS; round++) {
+		for (int j = 0; j < params->passes; j++)
+			fit_pass(grid, log_scale, steps, cross_tap, params, j,
+				 fit);
+	}
+}
+
+void zoom_params_for_taps(const float *weight, const float *offset,
+			  size_t count, int repeat, uint32_t width,
+			  uint32_t height, struct zoom_params *params)
+{
+	struct zoom_tap taps[ZOOM_GATHER_MAX_TAPS];
+
+	if (repeat < 1)
+		repeat = 1;
+	if (count > ZOOM_GATHER_MAX_TAPS)
+		count = ZOOM_GATHER_MAX_TAPS;
+
+	float extent = 0.0f;
+	size_t used = 0;
+	if (width > 0 && height > 0) {
+		for (size_t i = 0; i < count; i++) {
+			if (weight[i] <= 0.0f)
+				continue;
+			if (offset[i] > extent)
+				extent = offset[i];
+			struct zoom_tap *tap = &taps[used++];
+			bool cross_x;
+			bool cross_y;
+			tap->weight = weight[i];
+			tap->log_x = axis_log_scale(offset[i], width, &cross_x);
+			tap->log_y =
+				axis_log_scale(offset[i], height, &cross_y);
+			tap->reach_x = exp(-tap->log_x) * 0.5 * width;
+			tap->reach_y = exp(-tap->log_y) * 0.5 * height;
+			tap->side = (cross_x ? ZOOM_CROSS_X : 0) |
+				    (cross_y ? ZOOM_CROSS_Y : 0);
+		}
+	}
+
+	// Every tap at scale 1 is the frame itself, leave it to a copy.
+	params->passes = 0;
+	params->crosses = false;
+	if (extent <= 0.0f)
+		return;
+
+	// Out of memory leaves a copy.
+	struct zoom_grid *single = calloc(1, sizeof(*single));
+	struct zoom_grid *grid = calloc(1, sizeof(*grid));
+	struct zoom_grid *next = calloc(1, sizeof(*next));
+	if (!single || !grid || !next) {
+		free(single);
+		free(grid);
+		free(next);
+		return;
+	}
+
+	// One grid point per step of the repeated gather at least.
+	const double needed = ceil((double)repeat * extent) + 1.0;
+	int points = ZOOM_TAPS;
+	params->passes = 1;
+	while (points < needed && params->passes < ZOOM_MAX_PASSES) {
+		points *= ZOOM_TAPS;
+		params->passes++;
+	}
+	const int steps = points - 1;
+	const int last = params->passes - 1;
+
+	const double slope = fit_slope(taps, used);
+	double span = 0.0;
+	for (size_t i = 0; i < used; i++) {
+		const double p = tap_position(&taps[i], slope);
+		if (p > span)
+			span = p;
+	}
+	span *= repeat;
+
+	// Spread every tap over the two grid points around it, on its side
+	// of the center.
+	double total = 0.0;
+	for (size_t i = 0; i < used; i++) {
+		const struct zoom_tap *tap = &taps[i];
+		double pos = 0.0;
+		if (span > 0.0)
+			pos = tap_position(tap, slope) / span * steps;
+		pos = fmin(fmax(pos, 0.0), (double)steps);
+		const int n = (int)pos;
+		const double f = pos - n;
+		grid_add(single, tap->side, n, tap->weight * (1.0 - f),
+			 tap->log_x, tap->log_y);
+		grid_add(single, tap->side, n < steps ? n + 1 : n,
+			 tap->weight * f, tap->log_x, tap->log_y);
+		total += tap->weight;
+	}
+	if (total <= 0.0) {
+		grid_add(single, 0, 0, 1.0, 0.0, 0.0);
+		total = 1.0;
+	}
+	int support = 0;
+	for (int s = 0; s < ZOOM_SIDES; s++) {
+		for (int n = 0; n <= steps; n++) {
+			single->weight[s][n] /= total;
+			single->log_x[s][n] /= total;
+			single->log_y[s][n] /= total;
+			if (single->weight[s][n] > 0.0 && n > support)
+				support = n;
+		}
+	}
+	*grid = *single;
+	for (int r = 1; r < repeat; r++) {
+		grid_compose(next, grid, single, support, steps);
+		struct zoom_grid *swap = grid;
+		grid = next;
+		next = swap;
+	}
+
+	// Pass j takes the j-th base ZOOM_TAPS digit of the grid position,
+	// the last pass also the side.
+	double digit[ZOOM_MAX_PASSES][ZOOM_TAPS] = {0};
+	double cross[ZOOM_SIDES][ZOOM_TAPS] = {0};
+	int stride = 1;
+	for (int j = 0; j < params->passes; j++) {
+		for (int s = 0; s < ZOOM_SIDES; s++) {
+			for (int n = 0; n <= steps; n++) {
+				const int d = (n / stride) % ZOOM_TAPS;
+				if (j < last || s == 0)
+					digit[j][d] += grid->weight[s][n];
+				else
+					cross[s][d] += grid->weight[s][n];
+			}
+		}
+		if (j < last)
+			stride *= ZOOM_TAPS;
+	}
+
+	// The heaviest sides and last digits past the center get the cross
+	// taps, the rest go to the nearest digit kept on the same side, or
+	// any.
+	int cross_tap[ZOOM_SIDES * ZOOM_TAPS];
+	int kept_side[ZOOM_TAPS] = {0};
+	int kept_digit[ZOOM_TAPS] = {0};
+	double cross_weight[ZOOM_TAPS] = {0};
+	int kept = 0;
+	for (int t = 0; t < ZOOM_SIDES * ZOOM_TAPS; t++)
+		cross_tap[t] = -1;
+	for (; kept < ZOOM_TAPS; kept++) {
+		double heaviest = 0.0;
+		for (int s = 1; s < ZOOM_SIDES; s++) {
+			for (int d = 0; d < ZOOM_TAPS; d++) {
+				if (cross[s][d] <= heaviest)
+					continue;
+				heaviest = cross[s][d];
+				kept_side[kept] = s;
+				kept_digit[kept] = d;
+			}
+		}
+		if (heaviest <= 0.0)
+			break;
+		cross[kept_side[kept]][kept_digit[kept]] = 0.0;
+		cross_tap[kept_side[kept] * ZOOM_TAPS + kept_digit[kept]] =
+			kept;
+	}
+	for (int s = 1; s < ZOOM_SIDES; s++) {
+		for (int d = 0; d < ZOOM_TAPS; d++) {
+			if (cross_tap[s * ZOOM_TAPS + d] >= 0)
+				continue;
+			int nearest = 0;
+			int distance = 2 * ZOOM_TAPS;
+			for (int t = 0; t < kept; t++) {
+				int away = abs(kept_digit[t] - d);
+				if (kept_side[t] != s)
+					away += ZOOM_TAPS;
+				if (away < distance) {
+					distance = away;
+					nearest = t;
+				}
+			}
+			cross_tap[s * ZOOM_TAPS + d] = nearest;
+		}
+	}
+	for (int s = 1; s < ZOOM_SIDES; s++) {
+		for (int n = 0; n <= steps; n++) {
+			const int d = (n / stride) % ZOOM_TAPS;
+			cross_weight[cross_tap[s * ZOOM_TAPS + d]] +=
+				grid->weight[s][n];
+		}
+	}
+
+	// Log scales of the taps, starting from the fitted line.
+	double fit_x[(ZOOM_MAX_PASSES + 1) * ZOOM_TAPS];
+	double fit_y[(ZOOM_MAX_PASSES + 1) * ZOOM_TAPS];
+	stride = 1;
+	for (int j = 0; j <= params->passes; j++) {
+		for (int d = 0; d < ZOOM_TAPS; d++) {
+			const int k = j < params->passes ? d * stride
+							 : kept_digit[d] *
+								   (stride /
+								    ZOOM_TAPS);
+			const double step = (double)k / steps;
+			fit_x[j * ZOOM_TAPS + d] = span * step;
+			fit_y[j * ZOOM_TAPS + d] = span * slope * step;
+		}
+		stride *= ZOOM_TAPS;
+	}
+	zoom_fit(grid, grid->log_x, steps, cross_tap, params, fit_x);
+	zoom_fit(grid, grid->log_y, steps, cross_tap, params, fit_y);
+
+	for (int j = 0; j <= params->passes; j++) {
+		struct zoom_pass *pass = j < params->passes ? &params->pass[j]
+							    : &params->cross;
+		for (int d = 0; d < ZOOM_TAPS; d++) {
+			const int k = j * ZOOM_TAPS + d;
+			pass->scale_x[d] = (float)exp(-fit_x[k]);
+			pass->scale_y[d] = (float)exp(-fit_y[k]);
+			if (j < params->passes) {
+				pass->weight[d] = (float)digit[j][d];
+				continue;
+			}
+			pass->weight[d] = (float)cross_weight[d];
+			if (d >= kept)
+				continue;
+			if (kept_side[d] & ZOOM_CROSS_X)
+				pass->scale_x[d] = -pass->scale_x[d];
+			if (kept_side[d] & ZOOM_CROSS_Y)
+				pass->scale_y[d] = -pass->scale_y[d];
+		}
+	}
+	params->crosses = kept > 0;
+
+	free(single);
+	free(grid);
+	free(next);
+}
+
+void zoom_params_for_box(float radius, int passes, uint32_t width,
+			 uint32_t height, struct zoom_params *params)
+{
+	float weight[ZOOM_GATHER_MAX_TAPS];
+	float offset[ZOOM_GATHER_MAX_TAPS];
+	size_t count = 0;
+
+	if (radius < 0.0f)
+		radius = 0.0f;
+	const int taps = (int)radius;
+	for (int i = 0; i <= taps && count < ZOOM_GATHER_MAX_TAPS - 1; i++) {
+		weight[count] = 1.0f;
+		offset[count] = (float)i;
+		count++;
+	}
+	const float residual = radius - floorf(radius);
+	if (residual > 0.0f) {
+		weight[count] = residual;
+		offset[count] = radius;
+		count++;
+	}
+	zoom_params_for_taps(weight, offset, count, passes, width, height,
+			     params);
+}
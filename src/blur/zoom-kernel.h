@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Taps of one zoom pass, the float4 scale and weight uniforms of
+// zoom_pass.effect.
+#define ZOOM_TAPS 4
+// Passes cover up to 4^5 grid points, enough for 5 box passes of the
+// largest radius.
+#define ZOOM_MAX_PASSES 5
+#define ZOOM_GRID_MAX 1024
+// Most taps of the single pass gather the passes stand in for.
+#define ZOOM_GATHER_MAX_TAPS 256
+// Smallest scale toward the center a tap reaches, on either side of it.
+#define ZOOM_MIN_SCALE (1.0f / 16.0f)
+// Sides of the center a tap can land on- the single pass gather of a
+// large radius on a small frame steps past the center on the short axis
+// first, then on both.
+#define ZOOM_CROSS_X 1
+#define ZOOM_CROSS_Y 2
+#define ZOOM_SIDES 4
+
+enum zoom_kernel {
+	ZOOM_KERNEL_GAUSSIAN,
+	ZOOM_KERNEL_BOX,
+};
+
+// Tap i samples the frame at center + (uv - center) * scale[i].  A
+// negative scale samples across the center.
+struct zoom_pass {
+	float scale_x[ZOOM_TAPS];
+	float scale_y[ZOOM_TAPS];
+	float weight[ZOOM_TAPS];
+};
+
+/*
+ *  A zoom blur as a few passes of ZOOM_TAPS taps.  The taps of all passes
+ *  together land on a grid of 4^passes scales, running in log scale from
+ *  1 down to about the smallest scale of the single pass gather, and pass
+ *  j steps 4^j grid points per tap.  Each pass weights its taps by the
+ *  share of the gather's weight on the grid points with that digit, which
+ *  is exact for a box and close for a gaussian.  The scales of the taps
+ *  are fitted so the grid points land where the gather's taps on them
+ *  sample, on both axes.
+ *
+ *  Taps of the gather that step past the center keep their grid point
+ *  and the side they land on.  The last pass samples those across the
+ *  center with the `cross` taps, weighted by the share of the gather's
+ *  weight on each side and last digit.
+ */
+struct zoom_params {
+	// 0 when the gather samples only the frame itself, a straight copy.
+	int passes;
+	struct zoom_pass pass[ZOOM_MAX_PASSES];
+	// Whether the last pass also runs the `cross` taps.
+	bool crosses;
+	struct zoom_pass cross;
+};
+
+// Passes standing in for `repeat` single pass gathers of the one-sided
+// taps in weight/offset, with offsets in steps of 4 * (uv - center) /
+// uv_size as in the single pass shaders.
+extern void zoom_params_for_taps(const float *weight, const float *offset,
+				 size_t count, int repeat, uint32_t width,
+				 uint32_t height, struct zoom_params *params);
+// Same for the box gather of `radius`, repeated `passes` times.
+extern void zoom_params_for_box(float radius, int passes, uint32_t width,
+				uint32_t height, struct zoom_params *params);
@@ -0,0 +1,161 @@
+#include <obs-composite-blur-filter.h>
+#include "zoom.h"
+
+void load_zoom_effect(struct composite_blur_filter_data *filter)
+{
+	filter->effect = load_shader_effect(filter->effect,
+					    "/shaders/zoom_pass.effect");
+	filter->params = effect_cache_get_params(filter->effect);
+}
+
+static const struct zoom_params *
+zoom_params(struct composite_blur_filter_data *data, enum zoom_kernel kernel)
+{
+	struct zoom_state *zoom = &data->zoom;
+	const int repeat = kernel == ZOOM_KERNEL_BOX ? data->passes : 1;
+	if (zoom->valid && zoom->kernel == kernel &&
+	    zoom->radius == data->radius && zoom->repeat == repeat &&
+	    zoom->width == data->width && zoom->height == data->height) {
+		return &zoom->params;
+	}
+
+	if (kernel == ZOOM_KERNEL_GAUSSIAN) {
+		if (!data->kernel) {
+			return NULL;
+		}
+		zoom_params_for_taps(data->kernel->weight,
+				     data->kernel->offset, data->kernel->size,
+				     repeat, data->width, data->height,
+				     &zoom->params);
+	} else {
+		zoom_params_for_box(data->radius, repeat, data->width,
+				    data->height, &zoom->params);
+	}
+	zoom->valid = true;
+	zoom->kernel = kernel;
+	zoom->radius = data->radius;
+	zoom->repeat = repeat;
+	zoom->width = data->width;
+	zoom->height = data->height;
+	return &zoom->params;
+}
+
+/*
+ *  Radius of zero- copies the input straight to the output texrender,
+ *  composited over `background` when there is one.
+ */
+static void zoom_copy(gs_texture_t *texture, gs_texture_t *background,
+		      struct composite_blur_filter_data *data)
+{
+	gs_effect_t *effect = composite_copy_effect(data, texture, background);
+
+	gs_texrender_t *target = output_target(data);
+	if (target_begin(target, data->width, data->height)) {
+		while (gs_effect_loop(effect, "Draw"))
+			roi_draw_sprite(data, texture, data->width,
+					data->height);
+		target_end(target);
+	}
+}
+
+static void zoom_set_taps(struct effect_params *params,
+			  const struct zoom_pass *pass, enum effect_param_id x,
+			  enum effect_param_id y, enum effect_param_id weight)
+{
+	struct vec4 value;
+	vec4_set(&value, pass->scale_x[0], pass->scale_x[1], pass->scale_x[2],
+		 pass->scale_x[3]);
+	effect_params_set_vec4(params, x, &value);
+	vec4_set(&value, pass->scale_y[0], pass->scale_y[1], pass->scale_y[2],
+		 pass->scale_y[3]);
+	effect_params_set_vec4(params, y, &value);
+	vec4_set(&value, pass->weight[0], pass->weight[1], pass->weight[2],
+		 pass->weight[3]);
+	effect_params_set_vec4(params, weight, &value);
+}
+
+/*
+ *  Performs a zoom blur toward the center point as a few passes of
+ *  ZOOM_TAPS taps, each stepping 4x further than the one before, instead
+ *  of one pass gathering every tap of the kernel.  Passes ping-pong
+ *  between two pooled scratch targets, the last one draws to the output
+ *  and, when the kernel steps past the center, samples across it too.
+ */
+void zoom_blur(struct composite_blur_filter_data *data,
+	       enum zoom_kernel kernel)
+{
+	gs_effect_t *effect = data->effect;
+
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
+
+	const struct zoom_params *zoom = zoom_params(data, kernel);
+	if (!effect || !texture || !zoom) {
+		return;
+	}
+
+	gs_texture_t *background = composite_background(data);
+
+	if (zoom->passes == 0) {
+		set_blending_parameters();
+		zoom_copy(texture, background, data);
+		gs_blend_state_pop();
+		return;
+	}
+
+	struct effect_params *params = data->params;
+	struct vec2 coord;
+	coord.x = data->center_x;
+	coord.y = data->center_y;
+	effect_params_set_vec2(params, EFFECT_PARAM_RADIAL_CENTER, &coord);
+
+	struct vec2 size;
+	size.x = (float)data->width;
+	size.y = (float)data->height;
+	effect_params_set_vec2(params, EFFECT_PARAM_UV_SIZE, &size);
+
+	gs_texrender_t *scratch[2] = {NULL, NULL};
+	for (int i = 0; i < 2 && i < zoom->passes - 1; i++) {
+		scratch[i] = texrender_pool_acquire(data->format, data->width,
+						    data->height, data->space);
+	}
+
+	set_blending_parameters();
+
+	for (int i = 0; i < zoom->passes; i++) {
+		const struct zoom_pass *pass = &zoom->pass[i];
+		gs_texrender_t *target;
+		if (i == zoom->passes - 1) {
+			target = output_target(data);
+		} else {
+			target = scratch[i % 2];
+			gs_texrender_reset(target);
+		}
+
+		const bool cross = zoom->crosses && i == zoom->passes - 1;
+		effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+		composite_bind(params, i == 0 ? background : NULL, texture);
+		zoom_set_taps(params, pass, EFFECT_PARAM_ZOOM_SCALE_X,
+			      EFFECT_PARAM_ZOOM_SCALE_Y,
+			      EFFECT_PARAM_ZOOM_WEIGHT);
+		if (cross) {
+			zoom_set_taps(params, &zoom->cross,
+				      EFFECT_PARAM_ZOOM_CROSS_X,
+				      EFFECT_PARAM_ZOOM_CROSS_Y,
+				      EFFECT_PARAM_ZOOM_CROSS_WEIGHT);
+		}
+
+		if (target_begin(target, data->width, data->height)) {
+			while (gs_effect_loop(effect,
+					      cross ? "DrawCross" : "Draw"))
+				roi_draw_sprite(data, texture, data->width,
+						data->height);
+			target_end(target);
+		}
+		texture = gs_texrender_get_texture(target);
+	}
+
+	gs_blend_state_pop();
+
+	texrender_pool_release(scratch[0]);
+	texrender_pool_release(scratch[1]);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <obs-module.h>
+#include <effect-params.h>
+#include "zoom-kernel.h"
+
+struct composite_blur_filter_data;
+
+// Zoom passes of the last frame, recomputed when the kernel, the box
+// passes or the frame size change.
+struct zoom_state {
+	bool valid;
+	enum zoom_kernel kernel;
+	float radius;
+	int repeat;
+	uint32_t width;
+	uint32_t height;
+	struct zoom_params params;
+};
+
+extern void load_zoom_effect(struct composite_blur_filter_data *filter);
+extern void zoom_blur(struct composite_blur_filter_data *data,
+		      enum zoom_kernel kernel);
+
+static const struct zoom_params *
+zoom_params(struct composite_blur_filter_data *data, enum zoom_kernel kernel);
+static void zoom_copy(gs_texture_t *texture, gs_texture_t *background,
+		      struct composite_blur_filter_data *data);
+static void zoom_set_taps(struct effect_params *params,
+			  const struct zoom_pass *pass, enum effect_param_id x,
+			  enum effect_param_id y, enum effect_param_id weight);
@@ -0,0 +1,205 @@
+#include "effect-cache.h"
+
+#include <plugin-support.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include "shader-preprocessor.h"
+
+struct effect_cache_entry {
+	// Path and defines, separated by a newline.
+	char *key;
+	gs_effect_t *effect;
+	struct effect_params *params;
+	size_t refs;
+};
+
+// Held across compiles, so two filters asking for the same effect at the
+// same time still compile it once.  Never held while waiting for the
+// graphics context, which video_render holds while it acquires.
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct effect_cache_entry) cache_entries;
+static struct effect_cache_stats cache_stats;
+
+static gs_effect_t *compile_effect(const char *effect_file_path,
+				   const char *defines,
+				   struct effect_params *params)
+{
+	struct dstr filename = {0};
+	dstr_cat(&filename, obs_get_module_data_path(obs_current_module()));
+	dstr_cat(&filename, effect_file_path);
+	char *shader_text = shader_preprocess(filename.array, defines);
+	if (!shader_text) {
+		dstr_free(&filename);
+		return NULL;
+	}
+
+	char *errors = NULL;
+	const uint64_t start = os_gettime_ns();
+	gs_effect_t *effect =
+		gs_effect_create(shader_text, filename.array, &errors);
+	if (effect)
+		effect_params_init(params, effect);
+	cache_stats.compile_ns += os_gettime_ns() - start;
+	cache_stats.compiles++;
+	bfree(shader_text);
+	dstr_free(&filename);
+
+	if (effect == NULL) {
+		obs_log(LOG_WARNING,
+			"[obs-composite-blur] Unable to load %s.  Errors:\n%s",
+			effect_file_path,
+			(errors == NULL || strlen(errors) == 0 ? "(None)"
+							       : errors));
+	}
+	bfree(errors);
+	return effect;
+}
+
+// Takes another handle on the effect cached under `key`, with
+// cache_mutex held.
+static gs_effect_t *acquire_cached(const char *key)
+{
+	for (size_t i = 0; i < cache_entries.num; i++) {
+		struct effect_cache_entry *entry = &cache_entries.array[i];
+		if (strcmp(entry->key, key) == 0) {
+			entry->refs++;
+			cache_stats.hits++;
+			cache_stats.refs++;
+			return entry->effect;
+		}
+	}
+	return NULL;
+}
+
+gs_effect_t *effect_cache_acquire(const char *effect_file_path,
+				  const char *defines)
+{
+	struct dstr key = {0};
+	dstr_copy(&key, effect_file_path);
+	dstr_cat(&key, "\n");
+	if (defines)
+		dstr_cat(&key, defines);
+
+	// A compiled effect is shared without the graphics context.
+	pthread_mutex_lock(&cache_mutex);
+	gs_effect_t *effect = acquire_cached(key.array);
+	pthread_mutex_unlock(&cache_mutex);
+	if (effect) {
+		dstr_free(&key);
+		return effect;
+	}
+
+	obs_enter_graphics();
+	pthread_mutex_lock(&cache_mutex);
+	// Another thread may have compiled it while this one waited.
+	effect = acquire_cached(key.array);
+	if (!effect) {
+		struct effect_params *params =
+			bzalloc(sizeof(struct effect_params));
+		effect = compile_effect(effect_file_path, defines, params);
+		if (effect) {
+			struct effect_cache_entry *entry =
+				da_push_back_new(cache_entries);
+			entry->key = key.array;
+			entry->effect = effect;
+			entry->params = params;
+			entry->refs = 1;
+			cache_stats.effects++;
+			cache_stats.refs++;
+			key.array = NULL;
+		} else {
+			bfree(params);
+		}
+	}
+	pthread_mutex_unlock(&cache_mutex);
+	obs_leave_graphics();
+
+	dstr_free(&key);
+	return effect;
+}
+
+void effect_cache_release(gs_effect_t *effect)
+{
+	if (!effect)
+		return;
+
+	struct effect_cache_entry released = {0};
+	pthread_mutex_lock(&cache_mutex);
+	for (size_t i = 0; i < cache_entries.num; i++) {
+		struct effect_cache_entry *entry = &cache_entries.array[i];
+		if (entry->effect == effect && entry->refs > 0) {
+			entry->refs--;
+			cache_stats.refs--;
+			if (entry->refs == 0) {
+				released = *entry;
+				da_erase(cache_entries, i);
+				cache_stats.effects--;
+			}
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	// No longer found by an acquire, so it is destroyed unlocked.
+	if (released.effect) {
+		obs_enter_graphics();
+		gs_effect_destroy(released.effect);
+		obs_leave_graphics();
+		bfree(released.key);
+		bfree(released.params);
+	}
+}
+
+struct effect_params *effect_cache_get_params(gs_effect_t *effect)
+{
+	struct effect_params *params = NULL;
+	pthread_mutex_lock(&cache_mutex);
+	for (size_t i = 0; i < cache_entries.num; i++) {
+		if (cache_entries.array[i].effect == effect) {
+			params = cache_entries.array[i].params;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cache_mutex);
+	return params;
+}
+
+void effect_cache_get_stats(struct effect_cache_stats *stats)
+{
+	pthread_mutex_lock(&cache_mutex);
+	*stats = cache_stats;
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+void effect_cache_free(void)
+{
+	pthread_mutex_lock(&cache_mutex);
+	obs_log(LOG_INFO,
+		"Effect cache: %llu compiles in %.1f ms, %llu shared loads",
+		(unsigned long long)cache_stats.compiles,
+		(double)cache_stats.compile_ns / 1.0e6,
+		(unsigned long long)cache_stats.hits);
+
+	struct effect_params_stats params_stats;
+	effect_params_get_stats(&params_stats);
+	obs_log(LOG_INFO,
+		"Effect params: %llu lookups, %llu uploads, %llu unchanged",
+		(unsigned long long)params_stats.lookups,
+		(unsigned long long)params_stats.uploads,
+		(unsigned long long)params_stats.skipped);
+
+	obs_enter_graphics();
+	for (size_t i = 0; i < cache_entries.num; i++) {
+		gs_effect_destroy(cache_entries.array[i].effect);
+		bfree(cache_entries.array[i].key);
+		bfree(cache_entries.array[i].params);
+	}
+	obs_leave_graphics();
+	da_free(cache_entries);
+	cache_stats.effects = 0;
+	cache_stats.refs = 0;
+	pthread_mutex_unlock(&cache_mutex);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <obs-module.h>
+
+#include "effect-params.h"
+
+struct effect_cache_stats {
+	// Effects compiled since load, and how long those compiles took.
+	uint64_t compiles;
+	uint64_t compile_ns;
+	// Acquires served from an already compiled effect.
+	uint64_t hits;
+	// Effects alive, and the handles held on them.
+	size_t effects;
+	size_t refs;
+};
+
+// Returns the effect for the module data file `effect_file_path`
+// (e.g. "/shaders/gaussian_1d.effect") compiled with `defines` prepended,
+// compiling it only when no handle on it is held.  `defines` may be
+// NULL.  Every non-NULL result must be given back with
+// effect_cache_release.  Only a compile enters the graphics context, so
+// it may be called from inside it, as video_render does, or outside it.
+extern gs_effect_t *effect_cache_acquire(const char *effect_file_path,
+					 const char *defines);
+// Drops one handle, destroying the effect with its last one.  Filters
+// hold the effects they may switch to while rendering, so a switch does
+// not compile.
+extern void effect_cache_release(gs_effect_t *effect);
+// Binding table of an effect returned by effect_cache_acquire, valid while
+// the caller holds it.  NULL for any other effect.
+extern struct effect_params *effect_cache_get_params(gs_effect_t *effect);
+extern void effect_cache_get_stats(struct effect_cache_stats *stats);
+// Logs the compile statistics and destroys anything still alive.
+extern void effect_cache_free(void);
@@ -0,0 +1,174 @@
+#include "effect-params.h"
+
+#include <string.h>
+
+static const char *const param_names[EFFECT_PARAM_COUNT] = {
+	[EFFECT_PARAM_IMAGE] = "image",
+	[EFFECT_PARAM_WEIGHT] = "weight",
+	[EFFECT_PARAM_OFFSET] = "offset",
+	[EFFECT_PARAM_KERNEL_SIZE] = "kernel_size",
+	[EFFECT_PARAM_TEXEL_STEP] = "texel_step",
+	[EFFECT_PARAM_RADIUS] = "radius",
+	[EFFECT_PARAM_RADIUS_I] = "radius_i",
+	[EFFECT_PARAM_UV_SIZE] = "uv_size",
+	[EFFECT_PARAM_IMAGE_SIZE] = "image_size",
+	[EFFECT_PARAM_RADIAL_CENTER] = "radial_center",
+	[EFFECT_PARAM_TOP] = "top",
+	[EFFECT_PARAM_BOTTOM] = "bottom",
+	[EFFECT_PARAM_BACKGROUND] = "background",
+	[EFFECT_PARAM_COMPOSITE_BACKGROUND] = "composite_background",
+	[EFFECT_PARAM_INPUT_SIZE] = "input_size",
+	[EFFECT_PARAM_AXIS] = "axis",
+	[EFFECT_PARAM_STRIDE] = "stride",
+	[EFFECT_PARAM_BIAS] = "bias",
+	[EFFECT_PARAM_REVERSE] = "reverse",
+	[EFFECT_PARAM_FIRST] = "first",
+	[EFFECT_PARAM_CHANNEL_PAIR] = "channel_pair",
+	[EFFECT_PARAM_POLE_STRIDE_1] = "pole_stride_1",
+	[EFFECT_PARAM_POLE_STRIDE_2] = "pole_stride_2",
+	[EFFECT_PARAM_POLE_STRIDE_3] = "pole_stride_3",
+	[EFFECT_PARAM_REAL_SUM] = "real_sum",
+	[EFFECT_PARAM_RG_SUM] = "rg_sum",
+	[EFFECT_PARAM_BA_SUM] = "ba_sum",
+	[EFFECT_PARAM_FORWARD] = "forward",
+	[EFFECT_PARAM_REAL_POLE] = "real_pole",
+	[EFFECT_PARAM_REAL_RESIDUE] = "real_residue",
+	[EFFECT_PARAM_COMPLEX_POLE] = "complex_pole",
+	[EFFECT_PARAM_COMPLEX_RESIDUE] = "complex_residue",
+	[EFFECT_PARAM_ORIGINAL] = "original",
+	[EFFECT_PARAM_MASK] = "mask",
+	[EFFECT_PARAM_MASK_THRESHOLD] = "mask_threshold",
+	[EFFECT_PARAM_ROI] = "roi",
+	[EFFECT_PARAM_UPPER] = "upper",
+	[EFFECT_PARAM_UPPER_SIZE] = "upper_size",
+	[EFFECT_PARAM_LEVEL] = "level",
+	[EFFECT_PARAM_LEVEL_VARIANCE] = "level_variance",
+	[EFFECT_PARAM_ACCUMULATOR] = "accumulator",
+	[EFFECT_PARAM_OLDEST] = "oldest",
+	[EFFECT_PARAM_TRAIL_WEIGHT] = "trail_weight",
+	[EFFECT_PARAM_ZOOM_SCALE_X] = "zoom_scale_x",
+	[EFFECT_PARAM_ZOOM_SCALE_Y] = "zoom_scale_y",
+	[EFFECT_PARAM_ZOOM_WEIGHT] = "zoom_weight",
+	[EFFECT_PARAM_ZOOM_CROSS_X] = "zoom_cross_x",
+	[EFFECT_PARAM_ZOOM_CROSS_Y] = "zoom_cross_y",
+	[EFFECT_PARAM_ZOOM_CROSS_WEIGHT] = "zoom_cross_weight",
+};
+
+// Only touched from the graphics thread.
+static struct effect_params_stats params_stats;
+
+void effect_params_init(struct effect_params *params, gs_effect_t *effect)
+{
+	memset(params, 0, sizeof(*params));
+	for (int id = 0; id < EFFECT_PARAM_COUNT; id++) {
+		params->bindings[id].param =
+			gs_effect_get_param_by_name(effect, param_names[id]);
+		params_stats.lookups++;
+	}
+}
+
+static struct effect_param_binding *binding(struct effect_params *params,
+					    enum effect_param_id id)
+{
+	if (!params || !params->bindings[id].param)
+		return NULL;
+	return &params->bindings[id];
+}
+
+// True if `value` differs from what the effect holds, which becomes
+// `value`.
+static bool changed(struct effect_param_binding *b, const void *value,
+		    size_t size)
+{
+	if (b->set && memcmp(b->value, value, size) == 0) {
+		params_stats.skipped++;
+		return false;
+	}
+	memcpy(b->value, value, size);
+	b->set = true;
+	b->kernel = NULL;
+	params_stats.uploads++;
+	return true;
+}
+
+void effect_params_set_texture(struct effect_params *params,
+			       enum effect_param_id id, gs_texture_t *texture)
+{
+	// Textures change every pass and a freed texture's address can
+	// come back as a new one, so they are always set.
+	struct effect_param_binding *b = binding(params, id);
+	if (!b)
+		return;
+	gs_effect_set_texture(b->param, texture);
+	params_stats.uploads++;
+}
+
+void effect_params_set_float(struct effect_params *params,
+			     enum effect_param_id id, float value)
+{
+	struct effect_param_binding *b = binding(params, id);
+	if (b && changed(b, &value, sizeof(value)))
+		gs_effect_set_float(b->param, value);
+}
+
+void effect_params_set_int(struct effect_params *params,
+			   enum effect_param_id id, int value)
+{
+	struct effect_param_binding *b = binding(params, id);
+	if (b && changed(b, &value, sizeof(value)))
+		gs_effect_set_int(b->param, value);
+}
+
+void effect_params_set_vec2(struct effect_params *params,
+			    enum effect_param_id id, const struct vec2 *value)
+{
+	const float xy[2] = {value->x, value->y};
+	struct effect_param_binding *b = binding(params, id);
+	if (b && changed(b, xy, sizeof(xy)))
+		gs_effect_set_vec2(b->param, value);
+}
+
+void effect_params_set_vec4(struct effect_params *params,
+			    enum effect_param_id id, const struct vec4 *value)
+{
+	const float xyzw[4] = {value->x, value->y, value->z, value->w};
+	struct effect_param_binding *b = binding(params, id);
+	if (b && changed(b, xyzw, sizeof(xyzw)))
+		gs_effect_set_vec4(b->param, value);
+}
+
+static void set_kernel_array(struct effect_params *params,
+			     enum effect_param_id id,
+			     const struct kernel_cache_entry *kernel,
+			     const float *array)
+{
+	struct effect_param_binding *b = binding(params, id);
+	if (!b)
+		return;
+	if (b->set && b->kernel == kernel &&
+	    b->kernel_key.kind == kernel->key.kind &&
+	    b->kernel_key.value == kernel->key.value) {
+		params_stats.skipped++;
+		return;
+	}
+	gs_effect_set_val(b->param, array,
+			  GAUSSIAN_KERNEL_MAX_SIZE * sizeof(float));
+	b->set = true;
+	b->kernel = kernel;
+	b->kernel_key = kernel->key;
+	params_stats.uploads++;
+}
+
+void effect_params_set_kernel(struct effect_params *params,
+			      const struct kernel_cache_entry *kernel)
+{
+	set_kernel_array(params, EFFECT_PARAM_WEIGHT, kernel, kernel->weight);
+	set_kernel_array(params, EFFECT_PARAM_OFFSET, kernel, kernel->offset);
+	effect_params_set_int(params, EFFECT_PARAM_KERNEL_SIZE,
+			      (int)kernel->size);
+}
+
+void effect_params_get_stats(struct effect_params_stats *stats)
+{
+	*stats = params_stats;
+}
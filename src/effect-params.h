@@ -0,0 +1,115 @@
+#pragma once
+#include <obs-module.h>
+
+#include "blur/kernel-cache.h"
+
+// Every shader parameter the blur passes set each frame.  A table holds
+// the resolved handle of each one that exists in its effect.
+enum effect_param_id {
+	EFFECT_PARAM_IMAGE,
+	EFFECT_PARAM_WEIGHT,
+	EFFECT_PARAM_OFFSET,
+	EFFECT_PARAM_KERNEL_SIZE,
+	EFFECT_PARAM_TEXEL_STEP,
+	EFFECT_PARAM_RADIUS,
+	EFFECT_PARAM_RADIUS_I,
+	EFFECT_PARAM_UV_SIZE,
+	EFFECT_PARAM_IMAGE_SIZE,
+	EFFECT_PARAM_RADIAL_CENTER,
+	EFFECT_PARAM_TOP,
+	EFFECT_PARAM_BOTTOM,
+	EFFECT_PARAM_BACKGROUND,
+	EFFECT_PARAM_COMPOSITE_BACKGROUND,
+	EFFECT_PARAM_INPUT_SIZE,
+	EFFECT_PARAM_AXIS,
+	EFFECT_PARAM_STRIDE,
+	EFFECT_PARAM_BIAS,
+	EFFECT_PARAM_REVERSE,
+	EFFECT_PARAM_FIRST,
+	EFFECT_PARAM_CHANNEL_PAIR,
+	EFFECT_PARAM_POLE_STRIDE_1,
+	EFFECT_PARAM_POLE_STRIDE_2,
+	EFFECT_PARAM_POLE_STRIDE_3,
+	EFFECT_PARAM_REAL_SUM,
+	EFFECT_PARAM_RG_SUM,
+	EFFECT_PARAM_BA_SUM,
+	EFFECT_PARAM_FORWARD,
+	EFFECT_PARAM_REAL_POLE,
+	EFFECT_PARAM_REAL_RESIDUE,
+	EFFECT_PARAM_COMPLEX_POLE,
+	EFFECT_PARAM_COMPLEX_RESIDUE,
+	EFFECT_PARAM_ORIGINAL,
+	EFFECT_PARAM_MASK,
+	EFFECT_PARAM_MASK_THRESHOLD,
+	EFFECT_PARAM_ROI,
+	EFFECT_PARAM_UPPER,
+	EFFECT_PARAM_UPPER_SIZE,
+	EFFECT_PARAM_LEVEL,
+	EFFECT_PARAM_LEVEL_VARIANCE,
+	EFFECT_PARAM_ACCUMULATOR,
+	EFFECT_PARAM_OLDEST,
+	EFFECT_PARAM_TRAIL_WEIGHT,
+	EFFECT_PARAM_ZOOM_SCALE_X,
+	EFFECT_PARAM_ZOOM_SCALE_Y,
+	EFFECT_PARAM_ZOOM_WEIGHT,
+	EFFECT_PARAM_ZOOM_CROSS_X,
+	EFFECT_PARAM_ZOOM_CROSS_Y,
+	EFFECT_PARAM_ZOOM_CROSS_WEIGHT,
+	EFFECT_PARAM_COUNT,
+};
+
+/*
+ *  A resolved parameter and the last value set through it.  Values up to
+ *  16 bytes are kept by copy.  Kernel arrays are kept by their cache
+ *  entry and key- the same entry and key always hold the same kernel.
+ */
+struct effect_param_binding {
+	gs_eparam_t *param;
+	bool set;
+	uint8_t value[16];
+	const struct kernel_cache_entry *kernel;
+	struct kernel_cache_key kernel_key;
+};
+
+/*
+ *  Binding table of one compiled effect.  Effects are shared between
+ *  filters through the effect cache, and so is their table, so the last
+ *  value seen by the table is always the one the effect holds.  Only
+ *  set values of a shared effect through its table.
+ */
+struct effect_params {
+	struct effect_param_binding bindings[EFFECT_PARAM_COUNT];
+};
+
+struct effect_params_stats {
+	// Parameters resolved by name, and values handed to the effect or
+	// skipped because the effect already holds them.
+	uint64_t lookups;
+	uint64_t uploads;
+	uint64_t skipped;
+};
+
+// Resolves every parameter of `effect` by name.  Graphics context only.
+extern void effect_params_init(struct effect_params *params,
+			       gs_effect_t *effect);
+
+// Setters are no-ops for a NULL table or a parameter the effect lacks.
+// Render thread only.
+extern void effect_params_set_texture(struct effect_params *params,
+				      enum effect_param_id id,
+				      gs_texture_t *texture);
+extern void effect_params_set_float(struct effect_params *params,
+				    enum effect_param_id id, float value);
+extern void effect_params_set_int(struct effect_params *params,
+				  enum effect_param_id id, int value);
+extern void effect_params_set_vec2(struct effect_params *params,
+				   enum effect_param_id id,
+				   const struct vec2 *value);
+extern void effect_params_set_vec4(struct effect_params *params,
+				   enum effect_param_id id,
+				   const struct vec4 *value);
+// Sets weight, offset and kernel_size from `kernel`.
+extern void effect_params_set_kernel(struct effect_params *params,
+				     const struct kernel_cache_entry *kernel);
+
+extern void effect_params_get_stats(struct effect_params_stats *stats);
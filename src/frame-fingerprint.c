@@ -0,0 +1,156 @@
+#include "frame-fingerprint.h"
+#include "texrender-pool.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+// One pass of `technique` into a pooled float target a quarter of the
+// size.
+static gs_texrender_t *reduce(gs_effect_t *effect,
+			      struct effect_params *params,
+			      const char *technique, gs_texture_t *texture,
+			      uint32_t width, uint32_t height)
+{
+	const uint32_t reduced_width = (width + 3) / 4;
+	const uint32_t reduced_height = (height + 3) / 4;
+	gs_texrender_t *render = texrender_pool_acquire(
+		GS_RGBA32F, reduced_width, reduced_height, GS_CS_SRGB);
+
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	struct vec2 size;
+	size.x = (float)width;
+	size.y = (float)height;
+	effect_params_set_vec2(params, EFFECT_PARAM_IMAGE_SIZE, &size);
+	size.x = (float)reduced_width;
+	size.y = (float)reduced_height;
+	effect_params_set_vec2(params, EFFECT_PARAM_UV_SIZE, &size);
+
+	if (gs_texrender_begin(render, reduced_width, reduced_height)) {
+		while (gs_effect_loop(effect, technique))
+			gs_draw_sprite(texture, 0, reduced_width,
+				       reduced_height);
+		gs_texrender_end(render);
+	}
+	return render;
+}
+
+bool frame_fingerprint_update(struct frame_fingerprint *fingerprint,
+			      gs_effect_t *effect, struct effect_params *params,
+			      gs_texture_t *texture)
+{
+	if (!effect || !texture) {
+		frame_fingerprint_reset(fingerprint);
+		return true;
+	}
+
+	const uint32_t texture_width = gs_texture_get_width(texture);
+	const uint32_t texture_height = gs_texture_get_height(texture);
+	uint32_t width = texture_width;
+	uint32_t height = texture_height;
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	// Hash the frame into residues first, so the read back copy is
+	// float and never the size of the frame, then fold them further.
+	gs_texrender_t *level = NULL;
+	do {
+		gs_texrender_t *next = reduce(effect, params,
+					      level ? "Reduce" : "Hash",
+					      texture, width, height);
+		texrender_pool_release(level);
+		level = next;
+		texture = gs_texrender_get_texture(level);
+		width = (width + 3) / 4;
+		height = (height + 3) / 4;
+	} while (width > FRAME_FINGERPRINT_MAX_SIZE ||
+		 height > FRAME_FINGERPRINT_MAX_SIZE);
+
+	gs_blend_state_pop();
+
+	// Stage this frame's reduction.
+	const size_t slot = fingerprint->next;
+	gs_stagesurf_t *stage = fingerprint->stages[slot];
+	if (stage && (gs_stagesurface_get_width(stage) != width ||
+		      gs_stagesurface_get_height(stage) != height)) {
+		gs_stagesurface_destroy(stage);
+		stage = NULL;
+	}
+	if (!stage) {
+		stage = gs_stagesurface_create(width, height, GS_RGBA32F);
+		fingerprint->stages[slot] = stage;
+	}
+	fingerprint->staged_width[slot] = 0;
+	fingerprint->staged_height[slot] = 0;
+	if (stage && texture) {
+		gs_stage_texture(stage, texture);
+		fingerprint->staged_width[slot] = texture_width;
+		fingerprint->staged_height[slot] = texture_height;
+	}
+	texrender_pool_release(level);
+	fingerprint->next = (slot + 1) % FRAME_FINGERPRINT_STAGES;
+
+	// Read back the oldest one, staged FRAME_FINGERPRINT_LATENCY
+	// updates ago.
+	const size_t oldest = fingerprint->next;
+	stage = fingerprint->stages[oldest];
+	bool mapped = false;
+	uint8_t *data;
+	uint32_t linesize;
+	uint64_t hash = FNV_OFFSET_BASIS;
+	if (stage && fingerprint->staged_width[oldest]) {
+		hash = hash_bytes(hash, &fingerprint->staged_width[oldest],
+				  sizeof(uint32_t));
+		hash = hash_bytes(hash, &fingerprint->staged_height[oldest],
+				  sizeof(uint32_t));
+		mapped = gs_stagesurface_map(stage, &data, &linesize);
+	}
+	if (mapped) {
+		const size_t row_bytes = (size_t)gs_stagesurface_get_width(
+						 stage) *
+					 4 * sizeof(float);
+		const uint32_t rows = gs_stagesurface_get_height(stage);
+		for (uint32_t y = 0; y < rows; y++)
+			hash = hash_bytes(hash, data + (size_t)y * linesize,
+					  row_bytes);
+		gs_stagesurface_unmap(stage);
+	}
+
+	if (!mapped) {
+		fingerprint->valid = false;
+		return true;
+	}
+
+	const bool changed = !fingerprint->valid || hash != fingerprint->hash;
+	fingerprint->hash = hash;
+	fingerprint->valid = true;
+	return changed;
+}
+
+void frame_fingerprint_reset(struct frame_fingerprint *fingerprint)
+{
+	for (size_t i = 0; i < FRAME_FINGERPRINT_STAGES; i++) {
+		fingerprint->staged_width[i] = 0;
+		fingerprint->staged_height[i] = 0;
+	}
+	fingerprint->valid = false;
+}
+
+void frame_fingerprint_free(struct frame_fingerprint *fingerprint)
+{
+	for (size_t i = 0; i < FRAME_FINGERPRINT_STAGES; i++) {
+		gs_stagesurface_destroy(fingerprint->stages[i]);
+		fingerprint->stages[i] = NULL;
+	}
+	frame_fingerprint_reset(fingerprint);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <obs-module.h>
+
+#include "effect-params.h"
+
+// Largest side of the reduced copy that gets read back and hashed.
+#define FRAME_FINGERPRINT_MAX_SIZE 16
+
+// Staging surfaces a fingerprint reads back through.  Each update stages
+// into one and maps the one staged FRAME_FINGERPRINT_LATENCY updates ago.
+#define FRAME_FINGERPRINT_STAGES 2
+#define FRAME_FINGERPRINT_LATENCY (FRAME_FINGERPRINT_STAGES - 1)
+
+// Cheap content hash of a texture, used to tell whether a frame changed
+// since the last time the same fingerprint was updated.
+struct frame_fingerprint {
+	gs_stagesurf_t *stages[FRAME_FINGERPRINT_STAGES];
+	// Size of the texture staged in each surface, none staged when 0.
+	uint32_t staged_width[FRAME_FINGERPRINT_STAGES];
+	uint32_t staged_height[FRAME_FINGERPRINT_STAGES];
+	size_t next;
+	uint64_t hash;
+	bool valid;
+};
+
+// Reduces `texture` to at most FRAME_FINGERPRINT_MAX_SIZE texels a side
+// with the Hash and Reduce techniques of `effect`, whose binding table is
+// `params`, and stages it for read back.  Any one channel of any one
+// texel changing by a step of a 16 bit format changes the result.  Hashes the reduction staged by the
+// update FRAME_FINGERPRINT_LATENCY before, which the GPU finished long
+// ago, so mapping it never waits.  A change is thereby seen a frame late.
+// Returns true when that hash differs from the one before, or when there
+// was none.  Graphics thread only.
+extern bool frame_fingerprint_update(struct frame_fingerprint *fingerprint,
+				     gs_effect_t *effect,
+				     struct effect_params *params,
+				     gs_texture_t *texture);
+// Forgets the last hash and anything staged, so the next updates report
+// a change until one has been read back.
+extern void frame_fingerprint_reset(struct frame_fingerprint *fingerprint);
+// Graphics thread only.
+extern void frame_fingerprint_free(struct frame_fingerprint *fingerprint);
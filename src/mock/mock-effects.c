@@ -0,0 +1,798 @@
+#include "mock-internal.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+ *  CPU programs of the effects, one per technique, written line for line
+ *  after the pixel shaders.  Effects without one here (the motion and box
+ *  tilt-shift shaders) still count passes and state, but leave their
+ *  targets black.
+ */
+
+static void uv(const struct mock_draw *draw, uint32_t x, uint32_t y,
+	       float *u, float *v)
+{
+	*u = ((float)x + 0.5f) / (float)draw->width;
+	*v = ((float)y + 0.5f) / (float)draw->height;
+}
+
+// image.Sample with a linear, clamped sampler
+static void sample(const struct mock_draw *draw, const char *name, float u,
+		   float v, float *color)
+{
+	const gs_texture_t *texture = mock_param_texture(draw->effect, name);
+	if (!texture || !texture->image.data) {
+		memset(color, 0, 4 * sizeof(float));
+		return;
+	}
+	blur_image_sample(&texture->image, u, v, color);
+}
+
+// image.Load, zero outside the texture
+static void load(const struct mock_draw *draw, const char *name, int x, int y,
+		 float *color)
+{
+	const gs_texture_t *texture = mock_param_texture(draw->effect, name);
+	if (!texture || x < 0 || y < 0 || (uint32_t)x >= texture->image.width ||
+	    (uint32_t)y >= texture->image.height) {
+		memset(color, 0, 4 * sizeof(float));
+		return;
+	}
+	memcpy(color,
+	       texture->image.data +
+		       ((size_t)y * texture->image.width + (size_t)x) * 4,
+	       4 * sizeof(float));
+}
+
+static float param(const struct mock_draw *draw, const char *name)
+{
+	return mock_param_float(draw->effect, name, 0);
+}
+
+static void param_vec2(const struct mock_draw *draw, const char *name,
+		       float *xy)
+{
+	xy[0] = mock_param_float(draw->effect, name, 0);
+	xy[1] = mock_param_float(draw->effect, name, 1);
+}
+
+static void madd(float *acc, const float *color, float weight)
+{
+	for (int c = 0; c < 4; c++)
+		acc[c] += color[c] * weight;
+}
+
+static void scale(float *color, float s)
+{
+	for (int c = 0; c < 4; c++)
+		color[c] *= s;
+}
+
+// composite_over_background of composite_input.inc
+static void composite_input(const struct mock_draw *draw, float u, float v,
+			    float *color)
+{
+	float background[4];
+	if (!mock_param_int(draw->effect, "composite_background"))
+		return;
+	sample(draw, "background", u, v, background);
+	for (int c = 0; c < 3; c++)
+		color[c] = color[c] * color[3] +
+			   background[c] * (1.0f - color[3]);
+}
+
+// composite_texel of composite_input.inc
+static void composite_texel(const struct mock_draw *draw, const float *size,
+			    int x, int y, float *color)
+{
+	const int last_x = (int)size[0] - 1;
+	const int last_y = (int)size[1] - 1;
+	x = x < 0 ? 0 : (x > last_x ? last_x : x);
+	y = y < 0 ? 0 : (y > last_y ? last_y : y);
+	load(draw, "image", x, y, color);
+	composite_input(draw, ((float)x + 0.5f) / size[0],
+			((float)y + 0.5f) / size[1], color);
+}
+
+// sample_input of composite_input.inc
+static void sample_input(const struct mock_draw *draw, float u, float v,
+			 float *color)
+{
+	if (!mock_param_int(draw->effect, "composite_background")) {
+		sample(draw, "image", u, v, color);
+		return;
+	}
+	float size[2];
+	param_vec2(draw, "input_size", size);
+	const float x = u * size[0] - 0.5f;
+	const float y = v * size[1] - 0.5f;
+	const float base_x = floorf(x);
+	const float base_y = floorf(y);
+	const float fx = x - base_x;
+	const float fy = y - base_y;
+	const int tx = (int)base_x;
+	const int ty = (int)base_y;
+	float corners[4][4];
+	composite_texel(draw, size, tx, ty, corners[0]);
+	composite_texel(draw, size, tx + 1, ty, corners[1]);
+	composite_texel(draw, size, tx, ty + 1, corners[2]);
+	composite_texel(draw, size, tx + 1, ty + 1, corners[3]);
+	memset(color, 0, 4 * sizeof(float));
+	madd(color, corners[0], (1.0f - fx) * (1.0f - fy));
+	madd(color, corners[1], fx * (1.0f - fy));
+	madd(color, corners[2], (1.0f - fx) * fy);
+	madd(color, corners[3], fx * fy);
+}
+
+// load_input of composite_input.inc, for a target the size of the input
+static void load_input(const struct mock_draw *draw, int x, int y,
+		       float *color)
+{
+	load(draw, "image", x, y, color);
+	composite_input(draw, ((float)x + 0.5f) / (float)draw->width,
+			((float)y + 0.5f) / (float)draw->height, color);
+}
+
+// default.effect of libobs
+static void default_draw(const struct mock_draw *draw, uint32_t x, uint32_t y,
+			 float *color)
+{
+	float u, v;
+	uv(draw, x, y, &u, &v);
+	sample(draw, "image", u, v, color);
+}
+
+static void composite_draw(const struct mock_draw *draw, uint32_t x,
+			   uint32_t y, float *color)
+{
+	float u, v;
+	uv(draw, x, y, &u, &v);
+	sample_input(draw, u, v, color);
+}
+
+static void gaussian_1d_draw(const struct mock_draw *draw, uint32_t x,
+			     uint32_t y, float *color)
+{
+	float u, v;
+	float step[2];
+	float tap[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "texel_step", step);
+
+	const float weight_0 = mock_param_float(draw->effect, "weight", 0);
+	sample_input(draw, u, v, tap);
+	memset(color, 0, 4 * sizeof(float));
+	madd(color, tap, weight_0);
+	float total_weight = weight_0;
+
+	const int kernel_size = mock_param_int(draw->effect, "kernel_size");
+	for (int i = 1; i < kernel_size; i++) {
+		const float weight = mock_param_float(draw->effect, "weight", i);
+		const float offset = mock_param_float(draw->effect, "offset", i);
+		total_weight += 2.0f * weight;
+		sample_input(draw, u + offset * step[0],
+			     v + offset * step[1], tap);
+		madd(color, tap, weight);
+		sample_input(draw, u - offset * step[0],
+			     v - offset * step[1], tap);
+		madd(color, tap, weight);
+	}
+	scale(color, 1.0f / total_weight);
+}
+
+static void box_1d_draw(const struct mock_draw *draw, uint32_t x, uint32_t y,
+			float *color)
+{
+	float u, v;
+	float step[2];
+	float tap[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "texel_step", step);
+	const float radius = param(draw, "radius");
+
+	sample_input(draw, u, v, color);
+	const float taps = floorf(radius);
+	const float residual = radius - taps;
+	const int pairs = (int)(taps * 0.5f);
+	for (int i = 0; i < pairs; i++) {
+		const float offset = 2.0f * (float)i + 1.5f;
+		sample_input(draw, u + offset * step[0],
+			     v + offset * step[1], tap);
+		madd(color, tap, 2.0f);
+		sample_input(draw, u - offset * step[0],
+			     v - offset * step[1], tap);
+		madd(color, tap, 2.0f);
+	}
+	float end_weight = residual;
+	float end_offset = radius;
+	if (taps > 2.0f * (float)pairs) {
+		end_weight = 1.0f + residual;
+		end_offset = taps + residual * residual / end_weight;
+	}
+	if (end_weight > 0.0f) {
+		sample_input(draw, u + end_offset * step[0],
+			     v + end_offset * step[1], tap);
+		madd(color, tap, end_weight);
+		sample_input(draw, u - end_offset * step[0],
+			     v - end_offset * step[1], tap);
+		madd(color, tap, end_weight);
+	}
+	scale(color, 1.0f / (2.0f * radius + 1.0f));
+}
+
+static void box_prefix_sum_scan(const struct mock_draw *draw, uint32_t x,
+				uint32_t y, float *color)
+{
+	float axis[2];
+	float tap[4];
+	param_vec2(draw, "axis", axis);
+	const float stride = param(draw, "stride");
+	const float bias = param(draw, "bias");
+	const float pos = axis[0] > 0.0f ? (float)x : (float)y;
+
+	memset(color, 0, 4 * sizeof(float));
+	for (int i = 0; i < 4; i++) {
+		const float offset = (float)i * stride;
+		if (pos - offset >= 0.0f) {
+			load_input(draw, (int)((float)x - offset * axis[0]),
+				   (int)((float)y - offset * axis[1]), tap);
+			for (int c = 0; c < 4; c++)
+				color[c] += tap[c] - bias;
+		}
+	}
+}
+
+struct prefix_line {
+	const struct mock_draw *draw;
+	float base[2];
+	float axis[2];
+	float last;
+	float first_texel[4];
+	float last_texel[4];
+	float total[4];
+};
+
+static void prefix(const struct prefix_line *line, float k, float *color)
+{
+	if (k < 0.0f) {
+		for (int c = 0; c < 4; c++)
+			color[c] = (k + 1.0f) * line->first_texel[c];
+	} else if (k > line->last) {
+		for (int c = 0; c < 4; c++)
+			color[c] = line->total[c] +
+				   (k - line->last) * line->last_texel[c];
+	} else {
+		load(line->draw, "image",
+		     (int)(line->base[0] + k * line->axis[0]),
+		     (int)(line->base[1] + k * line->axis[1]), color);
+	}
+}
+
+// prefix(a) - prefix(b)
+static void prefix_difference(const struct prefix_line *line, float a,
+			      float b, float *color)
+{
+	float sub[4];
+	prefix(line, a, color);
+	prefix(line, b, sub);
+	for (int c = 0; c < 4; c++)
+		color[c] -= sub[c];
+}
+
+static void box_prefix_sum_window(const struct mock_draw *draw, uint32_t x,
+				  uint32_t y, float *color)
+{
+	struct prefix_line line = {.draw = draw};
+	float size[2];
+	param_vec2(draw, "axis", line.axis);
+	param_vec2(draw, "uv_size", size);
+	const float radius = param(draw, "radius");
+	const float bias = param(draw, "bias");
+
+	const float pos = line.axis[0] > 0.0f ? (float)x : (float)y;
+	line.base[0] = (float)x - pos * line.axis[0];
+	line.base[1] = (float)y - pos * line.axis[1];
+	line.last = size[0] * line.axis[0] + size[1] * line.axis[1] - 1.0f;
+
+	// 1. Edge texels, to extend the sum past the border.
+	load(draw, "image", (int)line.base[0], (int)line.base[1],
+	     line.first_texel);
+	load(draw, "image", (int)(line.base[0] + line.last * line.axis[0]),
+	     (int)(line.base[1] + line.last * line.axis[1]), line.total);
+	memcpy(line.last_texel, line.total, sizeof(line.total));
+	if (line.last >= 1.0f) {
+		float before[4];
+		load(draw, "image",
+		     (int)(line.base[0] + (line.last - 1.0f) * line.axis[0]),
+		     (int)(line.base[1] + (line.last - 1.0f) * line.axis[1]),
+		     before);
+		for (int c = 0; c < 4; c++)
+			line.last_texel[c] -= before[c];
+	}
+
+	// 2. Whole taps of the window.
+	const float n = floorf(radius);
+	const float residual = radius - n;
+	prefix_difference(&line, pos + n, pos - n - 1.0f, color);
+
+	// 3. Residual taps.
+	if (residual > 0.0f) {
+		float p_n[4], p_n1[4], m_n[4], m_n1[4];
+		prefix_difference(&line, pos + n, pos + n - 1.0f, p_n);
+		prefix_difference(&line, pos + n + 1.0f, pos + n, p_n1);
+		prefix_difference(&line, pos - n, pos - n - 1.0f, m_n);
+		prefix_difference(&line, pos - n - 1.0f, pos - n - 2.0f, m_n1);
+		for (int c = 0; c < 4; c++)
+			color[c] += residual *
+				    (p_n[c] + (p_n1[c] - p_n[c]) * residual +
+				     m_n[c] + (m_n1[c] - m_n[c]) * residual);
+	}
+
+	// 4. Normalize, and restore the bias of every tap.
+	for (int c = 0; c < 4; c++)
+		color[c] = color[c] / (2.0f * radius + 1.0f) + bias;
+}
+
+static void kawase_down_draw(const struct mock_draw *draw, uint32_t x,
+			     uint32_t y, float *color)
+{
+	float u, v;
+	float step[2];
+	float tap[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "texel_step", step);
+	const float offset = param(draw, "offset");
+	const float hx = 0.5f * step[0] * offset;
+	const float hy = 0.5f * step[1] * offset;
+
+	sample_input(draw, u, v, color);
+	scale(color, 4.0f);
+	sample_input(draw, u - hx, v - hy, tap);
+	madd(color, tap, 1.0f);
+	sample_input(draw, u + hx, v + hy, tap);
+	madd(color, tap, 1.0f);
+	sample_input(draw, u + hx, v - hy, tap);
+	madd(color, tap, 1.0f);
+	sample_input(draw, u - hx, v + hy, tap);
+	madd(color, tap, 1.0f);
+	scale(color, 1.0f / 8.0f);
+}
+
+static void kawase_up_draw(const struct mock_draw *draw, uint32_t x,
+			   uint32_t y, float *color)
+{
+	static const float taps[8][3] = {
+		{-2.0f, 0.0f, 1.0f}, {-1.0f, 1.0f, 2.0f}, {0.0f, 2.0f, 1.0f},
+		{1.0f, 1.0f, 2.0f},  {2.0f, 0.0f, 1.0f},  {1.0f, -1.0f, 2.0f},
+		{0.0f, -2.0f, 1.0f}, {-1.0f, -1.0f, 2.0f},
+	};
+	float u, v;
+	float step[2];
+	float tap[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "texel_step", step);
+	const float offset = param(draw, "offset");
+	const float hx = 0.5f * step[0] * offset;
+	const float hy = 0.5f * step[1] * offset;
+
+	memset(color, 0, 4 * sizeof(float));
+	for (int i = 0; i < 8; i++) {
+		sample(draw, "image", u + taps[i][0] * hx, v + taps[i][1] * hy,
+		       tap);
+		madd(color, tap, taps[i][2]);
+	}
+	scale(color, 1.0f / 12.0f);
+}
+
+// Cubic b-spline upsample of texture `name`, `size` pixels large.
+static void bspline(const struct mock_draw *draw, const char *name,
+		    const float *size, float u, float v, float *color)
+{
+	const float uvs[2] = {u, v};
+	float g0[2], g1[2], h0[2], h1[2];
+	float tap[4];
+
+	for (int a = 0; a < 2; a++) {
+		const float p = uvs[a] * size[a] - 0.5f;
+		const float i = floorf(p);
+		const float t = p - i;
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+		const float w0 = (1.0f - 3.0f * t + 3.0f * t2 - t3) / 6.0f;
+		const float w1 = (4.0f - 6.0f * t2 + 3.0f * t3) / 6.0f;
+		const float w2 = (1.0f + 3.0f * t + 3.0f * t2 - 3.0f * t3) /
+				 6.0f;
+		const float w3 = t3 / 6.0f;
+		g0[a] = w0 + w1;
+		g1[a] = w2 + w3;
+		h0[a] = (i - 0.5f + w1 / g0[a]) / size[a];
+		h1[a] = (i + 1.5f + w3 / g1[a]) / size[a];
+	}
+
+	memset(color, 0, 4 * sizeof(float));
+	sample(draw, name, h0[0], h0[1], tap);
+	madd(color, tap, g0[0] * g0[1]);
+	sample(draw, name, h1[0], h0[1], tap);
+	madd(color, tap, g1[0] * g0[1]);
+	sample(draw, name, h0[0], h1[1], tap);
+	madd(color, tap, g0[0] * g1[1]);
+	sample(draw, name, h1[0], h1[1], tap);
+	madd(color, tap, g1[0] * g1[1]);
+}
+
+static void bspline_upsample_draw(const struct mock_draw *draw, uint32_t x,
+				  uint32_t y, float *color)
+{
+	float u, v;
+	float size[2];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "uv_size", size);
+	bspline(draw, "image", size, u, v, color);
+}
+
+static void gaussian_tiltshift_draw(const struct mock_draw *draw, uint32_t x,
+				    uint32_t y, float *color)
+{
+	float u, v;
+	float size[2];
+	float upper[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "upper_size", size);
+
+	sample_input(draw, u, v, color);
+	const float dist =
+		fmaxf(param(draw, "top") - v, v - param(draw, "bottom"));
+	const float sigma = param(draw, "radius") * fmaxf(dist, 0.0f);
+	const float variance = param(draw, "level_variance");
+	const float lod = 0.5f * log2f(1.0f + sigma * sigma / variance);
+	const float t = fminf(fmaxf(lod - param(draw, "level"), 0.0f), 1.0f);
+	if (t <= 0.0f)
+		return;
+
+	bspline(draw, "upper", size, u, v, upper);
+	for (int c = 0; c < 4; c++)
+		color[c] += (upper[c] - color[c]) * t;
+}
+
+static void zoom_taps(const struct mock_draw *draw, uint32_t x, uint32_t y,
+		      const char *scale_x_name, const char *scale_y_name,
+		      const char *weight_name, float *color)
+{
+	float u, v;
+	float size[2];
+	float center[2];
+	float tap[4];
+	uv(draw, x, y, &u, &v);
+	param_vec2(draw, "uv_size", size);
+	param_vec2(draw, "radial_center", center);
+	center[0] /= size[0];
+	center[1] /= size[1];
+
+	for (size_t i = 0; i < 4; i++) {
+		const float scale_x =
+			mock_param_float(draw->effect, scale_x_name, i);
+		const float scale_y =
+			mock_param_float(draw->effect, scale_y_name, i);
+		sample_input(draw, center[0] + (u - center[0]) * scale_x,
+			     center[1] + (v - center[1]) * scale_y, tap);
+		madd(color, tap,
+		     mock_param_float(draw->effect, weight_name, i));
+	}
+}
+
+static void zoom_pass_draw(const struct mock_draw *draw, uint32_t x,
+			   uint32_t y, float *color)
+{
+	memset(color, 0, 4 * sizeof(float));
+	zoom_taps(draw, x, y, "zoom_scale_x", "zoom_scale_y", "zoom_weight",
+		  color);
+}
+
+static void zoom_pass_draw_cross(const struct mock_draw *draw, uint32_t x,
+				 uint32_t y, float *color)
+{
+	zoom_pass_draw(draw, x, y, color);
+	zoom_taps(draw, x, y, "zoom_cross_x", "zoom_cross_y",
+		  "zoom_cross_weight", color);
+}
+
+static void temporal_accumulate_draw(const struct mock_draw *draw,
+				     uint32_t x, uint32_t y, float *color)
+{
+	float u, v;
+	float acc[4];
+	float old[4];
+	uv(draw, x, y, &u, &v);
+	sample(draw, "image", u, v, color);
+	sample(draw, "accumulator", u, v, acc);
+	sample(draw, "oldest", u, v, old);
+	const float weight = param(draw, "trail_weight");
+	for (int c = 0; c < 4; c++)
+		color[c] = acc[c] + (color[c] - old[c]) * weight;
+}
+
+#define HASH_PRIME 65521.0f
+#define HASH_STEPS 65535.0f
+#define HASH_RANGE 128.0f
+
+// line_index and line_step of recursive_gaussian.effect
+static float recursive_line(const struct mock_draw *draw, uint32_t x,
+			    uint32_t y, float *step)
+{
+	float axis[2];
+	float size[2];
+	param_vec2(draw, "axis", axis);
+	param_vec2(draw, "uv_size", size);
+	const bool reverse = param(draw, "reverse") > 0.5f;
+	const float n = (float)x * axis[0] + (float)y * axis[1];
+	step[0] = reverse ? -axis[0] : axis[0];
+	step[1] = reverse ? -axis[1] : axis[1];
+	return reverse ? size[0] * axis[0] + size[1] * axis[1] - 1.0f - n : n;
+}
+
+static void cmul(const float *a, const float *b, float *r)
+{
+	const float re = a[0] * b[0] - a[1] * b[1];
+	const float im = a[0] * b[1] + a[1] * b[0];
+	r[0] = re;
+	r[1] = im;
+}
+
+static void complex_texel(const struct mock_draw *draw, int x, int y,
+			  float *color)
+{
+	load_input(draw, x, y, color);
+	if (param(draw, "first") > 0.5f) {
+		const bool ba = param(draw, "channel_pair") > 0.5f;
+		const float a = ba ? color[2] : color[0];
+		const float b = ba ? color[3] : color[1];
+		color[0] = a;
+		color[1] = 0.0f;
+		color[2] = b;
+		color[3] = 0.0f;
+	}
+}
+
+static void recursive_scan(const struct mock_draw *draw, uint32_t x,
+			   uint32_t y, float *color, bool complex)
+{
+	static const char *const powers[3] = {
+		"pole_stride_1",
+		"pole_stride_2",
+		"pole_stride_3",
+	};
+	float step[2];
+	const float n = recursive_line(draw, x, y, step);
+	const float stride = param(draw, "stride");
+
+	if (complex)
+		complex_texel(draw, (int)x, (int)y, color);
+	else
+		load_input(draw, (int)x, (int)y, color);
+	for (int m = 1; m <= 3; m++) {
+		if (n < (float)m * stride)
+			break;
+		const int tx = (int)((float)x - (float)m * stride * step[0]);
+		const int ty = (int)((float)y - (float)m * stride * step[1]);
+		float power[2];
+		float tap[4];
+		param_vec2(draw, powers[m - 1], power);
+		if (complex) {
+			complex_texel(draw, tx, ty, tap);
+			cmul(power, tap, tap);
+			cmul(power, tap + 2, tap + 2);
+			madd(color, tap, 1.0f);
+		} else {
+			load_input(draw, tx, ty, tap);
+			madd(color, tap, power[0]);
+		}
+	}
+}
+
+static void recursive_scan_real(const struct mock_draw *draw, uint32_t x,
+				uint32_t y, float *color)
+{
+	recursive_scan(draw, x, y, color, false);
+}
+
+static void recursive_scan_complex(const struct mock_draw *draw, uint32_t x,
+				   uint32_t y, float *color)
+{
+	recursive_scan(draw, x, y, color, true);
+}
+
+static void recursive_pole_sum(const struct mock_draw *draw, uint32_t x,
+			       uint32_t y, float *color)
+{
+	float step[2];
+	const float n = recursive_line(draw, x, y, step);
+	float x0[4];
+	load_input(draw, (int)((float)x - n * step[0]),
+		   (int)((float)y - n * step[1]), x0);
+	const float e = n + 1.0f;
+
+	// 1. Real pole.
+	const float real_pole = param(draw, "real_pole");
+	float z0[4];
+	load(draw, "real_sum", (int)x, (int)y, z0);
+	madd(z0, x0, powf(real_pole, e) / (1.0f - real_pole));
+
+	// 2. Complex pole.
+	float pole[2];
+	param_vec2(draw, "complex_pole", pole);
+	const float magnitude = powf(hypotf(pole[0], pole[1]), e);
+	const float angle = e * atan2f(pole[1], pole[0]);
+	const float p_e[2] = {magnitude * cosf(angle), magnitude * sinf(angle)};
+	const float conj[2] = {1.0f - pole[0], pole[1]};
+	const float norm = conj[0] * conj[0] + conj[1] * conj[1];
+	float gain[2];
+	cmul(p_e, conj, gain);
+	gain[0] /= norm;
+	gain[1] /= norm;
+	float rg[4];
+	float ba[4];
+	load(draw, "rg_sum", (int)x, (int)y, rg);
+	load(draw, "ba_sum", (int)x, (int)y, ba);
+	for (int i = 0; i < 2; i++) {
+		rg[i] += gain[i] * x0[0];
+		rg[2 + i] += gain[i] * x0[1];
+		ba[i] += gain[i] * x0[2];
+		ba[2 + i] += gain[i] * x0[3];
+	}
+
+	// 3. Residues.
+	const float real_residue = param(draw, "real_residue");
+	float residue[2];
+	param_vec2(draw, "complex_residue", residue);
+	const float re[4] = {rg[0], rg[2], ba[0], ba[2]};
+	const float im[4] = {rg[1], rg[3], ba[1], ba[3]};
+	for (int c = 0; c < 4; c++)
+		color[c] = real_residue * z0[c] +
+			   2.0f * (residue[0] * re[c] - residue[1] * im[c]);
+}
+
+static void recursive_combine_forward(const struct mock_draw *draw,
+				      uint32_t x, uint32_t y, float *color)
+{
+	float pole_sum[4];
+	float center[4];
+	recursive_pole_sum(draw, x, y, pole_sum);
+	load_input(draw, (int)x, (int)y, center);
+	float residue[2];
+	param_vec2(draw, "complex_residue", residue);
+	const float weight = param(draw, "real_residue") + 2.0f * residue[0];
+	for (int c = 0; c < 4; c++)
+		color[c] = pole_sum[c] - weight * center[c];
+}
+
+static void recursive_combine_backward(const struct mock_draw *draw,
+				       uint32_t x, uint32_t y, float *color)
+{
+	float forward[4];
+	recursive_pole_sum(draw, x, y, color);
+	load(draw, "forward", (int)x, (int)y, forward);
+	madd(color, forward, 1.0f);
+}
+
+static float mod_prime(float x)
+{
+	float r = x - HASH_PRIME * floorf(x / HASH_PRIME);
+	if (r < 0.0f)
+		r += HASH_PRIME;
+	if (r >= HASH_PRIME)
+		r -= HASH_PRIME;
+	return r;
+}
+
+static void fingerprint_fold(const struct mock_draw *draw, uint32_t x,
+			     uint32_t y, bool first, float *color)
+{
+	float image_size[2];
+	float tap[4];
+	param_vec2(draw, "image_size", image_size);
+
+	memset(color, 0, 4 * sizeof(float));
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) {
+			const float px = fminf((float)(x * 4 + i),
+					       image_size[0] - 1.0f);
+			const float py = fminf((float)(y * 4 + j),
+					       image_size[1] - 1.0f);
+			load(draw, "image", (int)px, (int)py, tap);
+			for (int c = 0; first && c < 4; c++)
+				tap[c] = mod_prime(roundf(
+					fminf(fmaxf(tap[c], -HASH_RANGE),
+					      HASH_RANGE) *
+					HASH_STEPS));
+			madd(color, tap, (float)(1 + i + 4 * j));
+		}
+	}
+	for (int c = 0; c < 4; c++)
+		color[c] = mod_prime(color[c]);
+}
+
+static void fingerprint_hash(const struct mock_draw *draw, uint32_t x,
+			     uint32_t y, float *color)
+{
+	fingerprint_fold(draw, x, y, true, color);
+}
+
+static void fingerprint_reduce(const struct mock_draw *draw, uint32_t x,
+			       uint32_t y, float *color)
+{
+	fingerprint_fold(draw, x, y, false, color);
+}
+
+struct mock_program {
+	const char *effect;
+	const char *technique;
+	mock_shader_t shader;
+};
+
+static bool inside_roi(const struct mock_draw *draw, float u, float v)
+{
+	return u >= mock_param_float(draw->effect, "roi", 0) &&
+	       v >= mock_param_float(draw->effect, "roi", 1) &&
+	       u < mock_param_float(draw->effect, "roi", 2) &&
+	       v < mock_param_float(draw->effect, "roi", 3);
+}
+
+static void roi_draw(const struct mock_draw *draw, uint32_t x, uint32_t y,
+		     float *color)
+{
+	float u, v;
+	uv(draw, x, y, &u, &v);
+	sample(draw, inside_roi(draw, u, v) ? "image" : "original", u, v,
+	       color);
+}
+
+static void roi_draw_mask(const struct mock_draw *draw, uint32_t x,
+			  uint32_t y, float *color)
+{
+	float u, v;
+	float mask[4];
+	uv(draw, x, y, &u, &v);
+	sample(draw, "mask", u, v, mask);
+	const bool blurred = inside_roi(draw, u, v) &&
+			     mask[3] > param(draw, "mask_threshold");
+	sample(draw, blurred ? "image" : "original", u, v, color);
+}
+
+static const struct mock_program programs[] = {
+	{"default.effect", "Draw", default_draw},
+	{"composite.effect", "Draw", composite_draw},
+	{"gaussian_1d.effect", "Draw", gaussian_1d_draw},
+	{"box_1d.effect", "Draw", box_1d_draw},
+	{"box_prefix_sum.effect", "Scan", box_prefix_sum_scan},
+	{"box_prefix_sum.effect", "Window", box_prefix_sum_window},
+	{"kawase_down.effect", "Draw", kawase_down_draw},
+	{"kawase_up.effect", "Draw", kawase_up_draw},
+	{"bspline_upsample.effect", "Draw", bspline_upsample_draw},
+	{"gaussian_tiltshift.effect", "Draw", gaussian_tiltshift_draw},
+	{"zoom_pass.effect", "Draw", zoom_pass_draw},
+	{"zoom_pass.effect", "DrawCross", zoom_pass_draw_cross},
+	{"temporal_accumulate.effect", "Draw", temporal_accumulate_draw},
+	{"recursive_gaussian.effect", "ScanReal", recursive_scan_real},
+	{"recursive_gaussian.effect", "ScanComplex", recursive_scan_complex},
+	{"recursive_gaussian.effect", "CombineForward",
+	 recursive_combine_forward},
+	{"recursive_gaussian.effect", "CombineBackward",
+	 recursive_combine_backward},
+	{"fingerprint.effect", "Hash", fingerprint_hash},
+	{"fingerprint.effect", "Reduce", fingerprint_reduce},
+	{"roi.effect", "Draw", roi_draw},
+	{"roi.effect", "DrawMask", roi_draw_mask},
+};
+
+mock_shader_t mock_find_shader(const char *effect, const char *technique)
+{
+	if (!effect || !technique)
+		return NULL;
+	for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++) {
+		if (strcmp(programs[i].effect, effect) == 0 &&
+		    strcmp(programs[i].technique, technique) == 0)
+			return programs[i].shader;
+	}
+	return NULL;
+}
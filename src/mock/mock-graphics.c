@@ -0,0 +1,849 @@
+#include "mock-internal.h"
+
+#include <util/bmem.h>
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+struct gs_texture_render {
+	enum gs_color_format format;
+	gs_texture_t *texture;
+	bool rendered;
+};
+
+struct gs_stage_surface {
+	enum gs_color_format format;
+	uint32_t width;
+	uint32_t height;
+	uint8_t *data;
+	uint32_t linesize;
+};
+
+struct blend_state {
+	bool enabled;
+	enum gs_blend_type src;
+	enum gs_blend_type dest;
+};
+
+struct render_target {
+	gs_texrender_t *texrender;
+	gs_texture_t *texture;
+};
+
+#define MAX_RENDER_TARGETS 16
+#define MAX_BLEND_STATES 64
+
+static struct mock_stats stats;
+static FILE *trace_file;
+
+static struct render_target targets[MAX_RENDER_TARGETS];
+static int num_targets;
+static struct blend_state blend;
+static struct blend_state blend_stack[MAX_BLEND_STATES];
+static int blend_depth;
+static gs_effect_t *current_effect;
+static gs_texture_t *canvas;
+static const gs_texture_t *draw_target;
+static bool scissor_enabled;
+static struct gs_rect scissor;
+static bool draw_feedback;
+
+void mock_get_stats(struct mock_stats *out)
+{
+	*out = stats;
+}
+
+void mock_reset_stats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+void mock_count_source_lookup(void)
+{
+	stats.source_lookups++;
+}
+
+void mock_set_trace(FILE *file)
+{
+	trace_file = file;
+}
+
+void mock_trace(const char *format, ...)
+{
+	if (!trace_file)
+		return;
+	va_list args;
+	va_start(args, format);
+	vfprintf(trace_file, format, args);
+	va_end(args);
+	fputc('\n', trace_file);
+}
+
+static const char *format_name(enum gs_color_format format)
+{
+	switch (format) {
+	case GS_RGBA:
+		return "rgba";
+	case GS_R10G10B10A2:
+		return "r10g10b10a2";
+	case GS_RGBA16F:
+		return "rgba16f";
+	case GS_RGBA32F:
+		return "rgba32f";
+	default:
+		return "other";
+	}
+}
+
+static bool format_is_8bit(enum gs_color_format format)
+{
+	return format == GS_RGBA || format == GS_BGRA || format == GS_BGRX ||
+	       format == GS_RGBA_UNORM || format == GS_BGRA_UNORM ||
+	       format == GS_BGRX_UNORM;
+}
+
+// Bits of `channel` in a normalized integer format, 0 for float formats.
+static int channel_bits(enum gs_color_format format, int channel)
+{
+	if (format_is_8bit(format))
+		return 8;
+	if (format == GS_R10G10B10A2)
+		return channel < 3 ? 10 : 2;
+	return 0;
+}
+
+// What the render target format keeps of a shaded value.
+static float store_channel(enum gs_color_format format, int channel,
+			   float value)
+{
+	const int bits = channel_bits(format, channel);
+	if (!bits)
+		return value;
+	if (value <= 0.0f)
+		return 0.0f;
+	if (value >= 1.0f)
+		return 1.0f;
+	const float levels = (float)((1 << bits) - 1);
+	return roundf(value * levels) / levels;
+}
+
+gs_texture_t *mock_texture_create(enum gs_color_format format,
+				  const struct blur_image *image)
+{
+	gs_texture_t *texture = bzalloc(sizeof(gs_texture_t));
+	texture->format = format;
+	if (image) {
+		blur_image_copy(&texture->image, image);
+		const size_t count = (size_t)image->width * image->height * 4;
+		for (size_t i = 0; i < count; i++)
+			texture->image.data[i] = store_channel(
+				format, (int)(i % 4), texture->image.data[i]);
+	}
+	return texture;
+}
+
+void mock_texture_destroy(gs_texture_t *texture)
+{
+	if (!texture)
+		return;
+	blur_image_free(&texture->image);
+	bfree(texture);
+}
+
+static bool texture_resize(gs_texture_t *texture, uint32_t width,
+			   uint32_t height)
+{
+	if (texture->image.data && texture->image.width == width &&
+	    texture->image.height == height)
+		return true;
+	blur_image_free(&texture->image);
+	return blur_image_init(&texture->image, width, height);
+}
+
+uint32_t gs_texture_get_width(const gs_texture_t *tex)
+{
+	return tex ? tex->image.width : 0;
+}
+
+uint32_t gs_texture_get_height(const gs_texture_t *tex)
+{
+	return tex ? tex->image.height : 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Effects                                                                   */
+
+// Copies the identifier at `p` into `out`, returns the end of it.
+static const char *read_identifier(const char *p, char *out, size_t size)
+{
+	size_t len = 0;
+	while (isalnum((unsigned char)*p) || *p == '_') {
+		if (len + 1 < size)
+			out[len++] = *p;
+		p++;
+	}
+	out[len] = 0;
+	return p;
+}
+
+static const char *skip_blank(const char *p)
+{
+	while (*p == ' ' || *p == '\t')
+		p++;
+	return p;
+}
+
+// True if `p` starts with the keyword `word` followed by a blank.
+static bool is_keyword(const char *p, const char *word)
+{
+	const size_t len = strlen(word);
+	return strncmp(p, word, len) == 0 && (p[len] == ' ' || p[len] == '\t');
+}
+
+/*
+ *  Reads the `uniform <type> <name>` and `technique <name>` lines of an
+ *  effect.  That is all the mock needs- the programs are C, and only the
+ *  names of the parameters are looked up.
+ */
+static void parse_effect(gs_effect_t *effect, const char *text)
+{
+	size_t capacity = 0;
+	for (const char *line = text; line && *line;) {
+		const char *p = skip_blank(line);
+		char name[MOCK_NAME_SIZE];
+		if (is_keyword(p, "uniform")) {
+			char type[MOCK_NAME_SIZE];
+			p = read_identifier(skip_blank(p + 7), type,
+					    sizeof(type));
+			read_identifier(skip_blank(p), name, sizeof(name));
+			if (*name) {
+				if (effect->num_params == capacity) {
+					capacity = capacity ? capacity * 2 : 8;
+					effect->params = brealloc(
+						effect->params,
+						capacity *
+							sizeof(*effect->params));
+				}
+				struct gs_effect_param *param =
+					&effect->params[effect->num_params++];
+				memset(param, 0, sizeof(*param));
+				strcpy(param->name, name);
+			}
+		} else if (is_keyword(p, "technique") &&
+			   effect->num_techniques < MOCK_MAX_TECHNIQUES) {
+			read_identifier(skip_blank(p + 9), name, sizeof(name));
+			strcpy(effect->techniques[effect->num_techniques++],
+			       name);
+		}
+		line = strchr(line, '\n');
+		if (line)
+			line++;
+	}
+}
+
+gs_effect_t *gs_effect_create(const char *effect_string, const char *filename,
+			      char **error_string)
+{
+	if (error_string)
+		*error_string = NULL;
+	if (!effect_string)
+		return NULL;
+
+	gs_effect_t *effect = bzalloc(sizeof(gs_effect_t));
+	if (filename) {
+		const char *slash = strrchr(filename, '/');
+		const char *base = slash ? slash + 1 : filename;
+		snprintf(effect->name, sizeof(effect->name), "%s", base);
+	}
+	parse_effect(effect, effect_string);
+	stats.effect_creates++;
+	mock_trace("effect_create %s params=%zu", effect->name,
+		   effect->num_params);
+	return effect;
+}
+
+void gs_effect_destroy(gs_effect_t *effect)
+{
+	if (!effect)
+		return;
+	if (current_effect == effect)
+		current_effect = NULL;
+	bfree(effect->params);
+	bfree(effect);
+}
+
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *effect,
+					 const char *name)
+{
+	if (!effect)
+		return NULL;
+	for (size_t i = 0; i < effect->num_params; i++) {
+		if (strcmp(effect->params[i].name, name) == 0)
+			return &effect->params[i];
+	}
+	return NULL;
+}
+
+bool gs_effect_loop(gs_effect_t *effect, const char *name)
+{
+	if (!effect)
+		return false;
+	if (effect->technique) {
+		// Second call of the loop- the technique has one pass.
+		effect->technique = NULL;
+		current_effect = NULL;
+		return false;
+	}
+	for (size_t i = 0; i < effect->num_techniques; i++) {
+		if (strcmp(effect->techniques[i], name) == 0) {
+			effect->technique = effect->techniques[i];
+			current_effect = effect;
+			return true;
+		}
+	}
+	mock_trace("missing technique %s:%s", effect->name, name);
+	return false;
+}
+
+static void set_param(gs_eparam_t *param, const void *value, size_t size)
+{
+	if (!param)
+		return;
+	if (size > MOCK_PARAM_MAX_SIZE)
+		size = MOCK_PARAM_MAX_SIZE;
+	memset(param->value, 0, sizeof(param->value));
+	memcpy(param->value, value, size);
+	stats.param_sets++;
+	mock_trace("param %s", param->name);
+}
+
+void gs_effect_set_texture(gs_eparam_t *param, gs_texture_t *val)
+{
+	if (!param)
+		return;
+	param->texture = val;
+	stats.param_sets++;
+	mock_trace("param %s", param->name);
+}
+
+void gs_effect_set_val(gs_eparam_t *param, const void *val, size_t size)
+{
+	set_param(param, val, size);
+}
+
+void gs_effect_set_int(gs_eparam_t *param, int val)
+{
+	set_param(param, &val, sizeof(val));
+}
+
+void gs_effect_set_float(gs_eparam_t *param, float val)
+{
+	set_param(param, &val, sizeof(val));
+}
+
+void gs_effect_set_vec2(gs_eparam_t *param, const struct vec2 *val)
+{
+	const float xy[2] = {val->x, val->y};
+	set_param(param, xy, sizeof(xy));
+}
+
+void gs_effect_set_vec4(gs_eparam_t *param, const struct vec4 *val)
+{
+	const float xyzw[4] = {val->x, val->y, val->z, val->w};
+	set_param(param, xyzw, sizeof(xyzw));
+}
+
+const gs_texture_t *mock_param_texture(const gs_effect_t *effect,
+				       const char *name)
+{
+	const gs_eparam_t *param = gs_effect_get_param_by_name(effect, name);
+	if (!param)
+		return NULL;
+	if (param->texture && param->texture == draw_target)
+		draw_feedback = true;
+	return param->texture;
+}
+
+float mock_param_float(const gs_effect_t *effect, const char *name,
+		       size_t index)
+{
+	const gs_eparam_t *param = gs_effect_get_param_by_name(effect, name);
+	float value = 0.0f;
+	if (param && (index + 1) * sizeof(float) <= MOCK_PARAM_MAX_SIZE)
+		memcpy(&value, param->value + index * sizeof(float),
+		       sizeof(float));
+	return value;
+}
+
+int mock_param_int(const gs_effect_t *effect, const char *name)
+{
+	const gs_eparam_t *param = gs_effect_get_param_by_name(effect, name);
+	int value = 0;
+	if (param)
+		memcpy(&value, param->value, sizeof(int));
+	return value;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Render targets                                                            */
+
+gs_texrender_t *gs_texrender_create(enum gs_color_format format,
+				    enum gs_zstencil_format zsformat)
+{
+	UNUSED_PARAMETER(zsformat);
+	gs_texrender_t *texrender = bzalloc(sizeof(gs_texrender_t));
+	texrender->format = format;
+	return texrender;
+}
+
+enum gs_color_format gs_texrender_get_format(const gs_texrender_t *texrender)
+{
+	return texrender ? texrender->format : GS_UNKNOWN;
+}
+
+void gs_texrender_destroy(gs_texrender_t *texrender)
+{
+	if (!texrender)
+		return;
+	mock_texture_destroy(texrender->texture);
+	bfree(texrender);
+}
+
+bool gs_texrender_begin_with_color_space(gs_texrender_t *texrender,
+					 uint32_t cx, uint32_t cy,
+					 enum gs_color_space space)
+{
+	UNUSED_PARAMETER(space);
+	if (!texrender || !cx || !cy)
+		return false;
+	if (texrender->rendered) {
+		stats.rejected_begins++;
+		mock_trace("begin rejected %ux%u, not reset", cx, cy);
+		return false;
+	}
+	if (num_targets == MAX_RENDER_TARGETS)
+		return false;
+
+	if (!texrender->texture)
+		texrender->texture = mock_texture_create(texrender->format,
+							 NULL);
+	if (!texture_resize(texrender->texture, cx, cy))
+		return false;
+
+	targets[num_targets].texrender = texrender;
+	targets[num_targets].texture = texrender->texture;
+	num_targets++;
+	stats.texrender_begins++;
+	if (format_is_8bit(texrender->format))
+		stats.begins_8bit++;
+	mock_trace("begin %ux%u %s", cx, cy, format_name(texrender->format));
+	return true;
+}
+
+bool gs_texrender_begin(gs_texrender_t *texrender, uint32_t cx, uint32_t cy)
+{
+	return gs_texrender_begin_with_color_space(texrender, cx, cy,
+						   GS_CS_SRGB);
+}
+
+void gs_texrender_end(gs_texrender_t *texrender)
+{
+	if (!texrender || !num_targets ||
+	    targets[num_targets - 1].texrender != texrender) {
+		stats.unbalanced_ends++;
+		mock_trace("end without begin");
+		return;
+	}
+	num_targets--;
+	texrender->rendered = true;
+	stats.texrender_ends++;
+	mock_trace("end");
+}
+
+void gs_texrender_reset(gs_texrender_t *texrender)
+{
+	if (texrender)
+		texrender->rendered = false;
+}
+
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender)
+{
+	return texrender ? texrender->texture : NULL;
+}
+
+void mock_canvas_begin(uint32_t width, uint32_t height)
+{
+	if (!canvas)
+		canvas = mock_texture_create(GS_RGBA, NULL);
+	texture_resize(canvas, width, height);
+	memset(canvas->image.data, 0,
+	       (size_t)width * height * 4 * sizeof(float));
+
+	num_targets = 1;
+	targets[0].texrender = NULL;
+	targets[0].texture = canvas;
+	blend_depth = 0;
+	gs_reset_blend_state();
+	scissor_enabled = false;
+}
+
+void mock_canvas_end(struct blur_image *output)
+{
+	if (num_targets != 1)
+		mock_trace("frame ended with %d render targets bound",
+			   num_targets);
+	if (scissor_enabled)
+		stats.unreset_scissors++;
+	num_targets = 0;
+	if (output)
+		blur_image_copy(output, &canvas->image);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Blending                                                                  */
+
+void gs_blend_state_push(void)
+{
+	if (blend_depth < MAX_BLEND_STATES)
+		blend_stack[blend_depth] = blend;
+	blend_depth++;
+	if (blend_depth > stats.max_blend_depth)
+		stats.max_blend_depth = blend_depth;
+	stats.blend_pushes++;
+	mock_trace("blend push");
+}
+
+void gs_blend_state_pop(void)
+{
+	stats.blend_pops++;
+	mock_trace("blend pop");
+	if (!blend_depth) {
+		stats.blend_underflows++;
+		return;
+	}
+	blend_depth--;
+	if (blend_depth < MAX_BLEND_STATES)
+		blend = blend_stack[blend_depth];
+}
+
+void gs_reset_blend_state(void)
+{
+	blend.enabled = true;
+	blend.src = GS_BLEND_SRCALPHA;
+	blend.dest = GS_BLEND_INVSRCALPHA;
+}
+
+void gs_enable_blending(bool enable)
+{
+	blend.enabled = enable;
+}
+
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest)
+{
+	blend.src = src;
+	blend.dest = dest;
+}
+
+static float blend_factor(enum gs_blend_type type, const float *src,
+			  const float *dst, int c)
+{
+	switch (type) {
+	case GS_BLEND_ZERO:
+		return 0.0f;
+	case GS_BLEND_ONE:
+		return 1.0f;
+	case GS_BLEND_SRCCOLOR:
+		return src[c];
+	case GS_BLEND_INVSRCCOLOR:
+		return 1.0f - src[c];
+	case GS_BLEND_SRCALPHA:
+		return src[3];
+	case GS_BLEND_INVSRCALPHA:
+		return 1.0f - src[3];
+	case GS_BLEND_DSTCOLOR:
+		return dst[c];
+	case GS_BLEND_INVDSTCOLOR:
+		return 1.0f - dst[c];
+	case GS_BLEND_DSTALPHA:
+		return dst[3];
+	case GS_BLEND_INVDSTALPHA:
+		return 1.0f - dst[3];
+	case GS_BLEND_SRCALPHASAT:
+		return c == 3 ? 1.0f : fminf(src[3], 1.0f - dst[3]);
+	}
+	return 1.0f;
+}
+
+// State the plugin sets but the CPU programs do not depend on.
+
+void gs_ortho(float left, float right, float top, float bottom, float znear,
+	      float zfar)
+{
+	UNUSED_PARAMETER(left);
+	UNUSED_PARAMETER(right);
+	UNUSED_PARAMETER(top);
+	UNUSED_PARAMETER(bottom);
+	UNUSED_PARAMETER(znear);
+	UNUSED_PARAMETER(zfar);
+}
+
+void gs_set_cull_mode(enum gs_cull_mode mode)
+{
+	UNUSED_PARAMETER(mode);
+}
+
+void gs_enable_color(bool red, bool green, bool blue, bool alpha)
+{
+	UNUSED_PARAMETER(red);
+	UNUSED_PARAMETER(green);
+	UNUSED_PARAMETER(blue);
+	UNUSED_PARAMETER(alpha);
+}
+
+void gs_set_scissor_rect(const struct gs_rect *rect)
+{
+	scissor_enabled = rect != NULL;
+	if (rect) {
+		scissor = *rect;
+		mock_trace("scissor %d,%d %dx%d", rect->x, rect->y, rect->cx,
+			   rect->cy);
+	} else {
+		mock_trace("scissor off");
+	}
+}
+
+void gs_enable_depth_test(bool enable)
+{
+	UNUSED_PARAMETER(enable);
+}
+
+void gs_depth_function(enum gs_depth_test test)
+{
+	UNUSED_PARAMETER(test);
+}
+
+void gs_enable_stencil_test(bool enable)
+{
+	UNUSED_PARAMETER(enable);
+}
+
+void gs_enable_stencil_write(bool enable)
+{
+	UNUSED_PARAMETER(enable);
+}
+
+void gs_stencil_function(enum gs_stencil_side side, enum gs_depth_test test)
+{
+	UNUSED_PARAMETER(side);
+	UNUSED_PARAMETER(test);
+}
+
+void gs_stencil_op(enum gs_stencil_side side, enum gs_stencil_op_type fail,
+		   enum gs_stencil_op_type zfail,
+		   enum gs_stencil_op_type zpass)
+{
+	UNUSED_PARAMETER(side);
+	UNUSED_PARAMETER(fail);
+	UNUSED_PARAMETER(zfail);
+	UNUSED_PARAMETER(zpass);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Drawing                                                                   */
+
+static void write_pixel(gs_texture_t *target, uint32_t x, uint32_t y,
+			float *color)
+{
+	float *dst = target->image.data +
+		     ((size_t)y * target->image.width + x) * 4;
+	float out[4];
+	for (int c = 0; c < 4; c++) {
+		out[c] = color[c];
+		if (blend.enabled)
+			out[c] = color[c] * blend_factor(blend.src, color,
+							 dst, c) +
+				 dst[c] * blend_factor(blend.dest, color, dst,
+						       c);
+	}
+	for (int c = 0; c < 4; c++)
+		dst[c] = store_channel(target->format, c, out[c]);
+}
+
+void gs_clear(uint32_t clear_flags, const struct vec4 *color, float depth,
+	      uint8_t stencil)
+{
+	UNUSED_PARAMETER(depth);
+	UNUSED_PARAMETER(stencil);
+	if (!(clear_flags & GS_CLEAR_COLOR) || !num_targets)
+		return;
+	gs_texture_t *target = targets[num_targets - 1].texture;
+	const float value[4] = {color->x, color->y, color->z, color->w};
+	const size_t count =
+		(size_t)target->image.width * target->image.height;
+	for (size_t i = 0; i < count; i++) {
+		for (int c = 0; c < 4; c++)
+			target->image.data[i * 4 + c] =
+				store_channel(target->format, c, value[c]);
+	}
+}
+
+static uint32_t clip(int value, uint32_t size)
+{
+	if (value < 0)
+		return 0;
+	return (uint32_t)value > size ? size : (uint32_t)value;
+}
+
+/*
+ *  Shades every pixel of the bound target with the program of the effect
+ *  being looped.  The sprite always covers the target the way the plugin
+ *  draws it, so texture coordinates are the target pixel centers.  Only
+ *  pixels inside the scissor rect, if one is set, are shaded.  A draw
+ *  counts as feedback when its program reads the target itself; without
+ *  a program only `image` is checked.
+ */
+void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width,
+		    uint32_t height)
+{
+	UNUSED_PARAMETER(tex);
+	UNUSED_PARAMETER(flip);
+	stats.draws++;
+	if (!num_targets) {
+		stats.unexecuted_draws++;
+		mock_trace("draw without a render target");
+		return;
+	}
+
+	gs_texture_t *target = targets[num_targets - 1].texture;
+	const gs_effect_t *effect = current_effect;
+	mock_shader_t shader =
+		effect ? mock_find_shader(effect->name, effect->technique)
+		       : NULL;
+	mock_trace("draw %s:%s %ux%u into %ux%u",
+		   effect ? effect->name : "(none)",
+		   effect ? effect->technique : "", width, height,
+		   target->image.width, target->image.height);
+
+	draw_target = target;
+	if (!shader) {
+		stats.unexecuted_draws++;
+		if (effect)
+			mock_param_texture(effect, "image");
+	}
+
+	const struct mock_draw draw = {
+		.effect = effect,
+		.width = target->image.width,
+		.height = target->image.height,
+	};
+	// Like the rasterizer, the scissor rect clips to the target.
+	uint32_t x0 = 0, y0 = 0, x1 = draw.width, y1 = draw.height;
+	if (scissor_enabled) {
+		x0 = clip(scissor.x, draw.width);
+		y0 = clip(scissor.y, draw.height);
+		x1 = clip(scissor.x + scissor.cx, draw.width);
+		y1 = clip(scissor.y + scissor.cy, draw.height);
+		if (x1 < x0)
+			x1 = x0;
+		if (y1 < y0)
+			y1 = y0;
+	}
+	for (uint32_t y = y0; y < y1; y++) {
+		for (uint32_t x = x0; x < x1; x++) {
+			float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			if (shader)
+				shader(&draw, x, y, color);
+			write_pixel(target, x, y, color);
+		}
+	}
+	if (draw_feedback)
+		stats.feedback_draws++;
+	draw_target = NULL;
+	draw_feedback = false;
+
+	if (canvas && canvas->image.width && canvas->image.height)
+		stats.frame_writes +=
+			(double)(x1 - x0) * (y1 - y0) /
+			((double)canvas->image.width * canvas->image.height);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Staging                                                                   */
+
+gs_stagesurf_t *gs_stagesurface_create(uint32_t width, uint32_t height,
+				       enum gs_color_format color_format)
+{
+	gs_stagesurf_t *stage = bzalloc(sizeof(gs_stagesurf_t));
+	stage->format = color_format;
+	stage->width = width;
+	stage->height = height;
+	stage->linesize = width * (format_is_8bit(color_format) ? 4 : 16);
+	stage->data = bzalloc((size_t)stage->linesize * height);
+	return stage;
+}
+
+void gs_stagesurface_destroy(gs_stagesurf_t *stagesurf)
+{
+	if (!stagesurf)
+		return;
+	bfree(stagesurf->data);
+	bfree(stagesurf);
+}
+
+uint32_t gs_stagesurface_get_width(const gs_stagesurf_t *stagesurf)
+{
+	return stagesurf ? stagesurf->width : 0;
+}
+
+uint32_t gs_stagesurface_get_height(const gs_stagesurf_t *stagesurf)
+{
+	return stagesurf ? stagesurf->height : 0;
+}
+
+void gs_stage_texture(gs_stagesurf_t *dst, gs_texture_t *src)
+{
+	if (!dst || !src || src->image.width != dst->width ||
+	    src->image.height != dst->height)
+		return;
+	stats.stage_copies++;
+	mock_trace("stage %ux%u", dst->width, dst->height);
+	for (uint32_t y = 0; y < dst->height; y++) {
+		const float *in =
+			src->image.data + (size_t)y * src->image.width * 4;
+		uint8_t *row = dst->data + (size_t)y * dst->linesize;
+		if (format_is_8bit(dst->format)) {
+			for (uint32_t i = 0; i < dst->width * 4; i++)
+				row[i] = (uint8_t)roundf(
+					store_channel(GS_RGBA, 0, in[i]) *
+					255.0f);
+		} else {
+			memcpy(row, in, (size_t)dst->width * 16);
+		}
+	}
+}
+
+bool gs_stagesurface_map(gs_stagesurf_t *stagesurf, uint8_t **data,
+			 uint32_t *linesize)
+{
+	if (!stagesurf)
+		return false;
+	*data = stagesurf->data;
+	*linesize = stagesurf->linesize;
+	return true;
+}
+
+void gs_stagesurface_unmap(gs_stagesurf_t *stagesurf)
+{
+	UNUSED_PARAMETER(stagesurf);
+}
+
+void mock_graphics_free(void)
+{
+	mock_texture_destroy(canvas);
+	canvas = NULL;
+	num_targets = 0;
+	blend_depth = 0;
+	current_effect = NULL;
+}
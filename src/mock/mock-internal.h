@@ -0,0 +1,61 @@
+#pragma once
+
+#include "mock-obs.h"
+
+// Largest uniform the mock stores, float4 weight[32].
+#define MOCK_PARAM_MAX_SIZE 512
+#define MOCK_MAX_TECHNIQUES 8
+#define MOCK_NAME_SIZE 64
+
+struct gs_texture {
+	enum gs_color_format format;
+	struct blur_image image;
+};
+
+struct gs_effect_param {
+	char name[MOCK_NAME_SIZE];
+	gs_texture_t *texture;
+	uint8_t value[MOCK_PARAM_MAX_SIZE];
+};
+
+struct gs_effect {
+	// File name without directories, e.g. "box_1d.effect"
+	char name[MOCK_NAME_SIZE];
+	struct gs_effect_param *params;
+	size_t num_params;
+	char techniques[MOCK_MAX_TECHNIQUES][MOCK_NAME_SIZE];
+	size_t num_techniques;
+	// Technique of the gs_effect_loop in progress
+	const char *technique;
+};
+
+// Target of the draw being shaded.
+struct mock_draw {
+	const gs_effect_t *effect;
+	uint32_t width;
+	uint32_t height;
+};
+
+// Computes the color of target pixel x, y.
+typedef void (*mock_shader_t)(const struct mock_draw *draw, uint32_t x,
+			      uint32_t y, float *color);
+
+// NULL if the effect/technique has no CPU program.
+extern mock_shader_t mock_find_shader(const char *effect,
+				      const char *technique);
+
+// Uniform values as the shaders see them.  Missing uniforms read as zero.
+extern const gs_texture_t *mock_param_texture(const gs_effect_t *effect,
+					      const char *name);
+extern float mock_param_float(const gs_effect_t *effect, const char *name,
+			      size_t index);
+extern int mock_param_int(const gs_effect_t *effect, const char *name);
+
+// Canvas the filter output is drawn onto.
+extern void mock_canvas_begin(uint32_t width, uint32_t height);
+extern void mock_canvas_end(struct blur_image *output);
+
+extern void mock_trace(const char *format, ...);
+// Counts an obs_get_source_by_name call in the stats.
+extern void mock_count_source_lookup(void);
+extern void mock_graphics_free(void);
@@ -0,0 +1,792 @@
+#include "mock-internal.h"
+
+#include <util/bmem.h>
+
+#include <string.h>
+
+struct obs_data_item {
+	char *name;
+	long long int_value;
+	double double_value;
+	bool is_double;
+	char *string;
+	struct obs_data_item *next;
+};
+
+struct obs_data {
+	long refs;
+	struct obs_data_item *items;
+};
+
+struct obs_weak_source {
+	long refs;
+	obs_source_t *source;
+};
+
+struct obs_source {
+	long refs;
+	char *name;
+	obs_weak_source_t *weak;
+	obs_data_t *settings;
+	// Image sources
+	gs_texture_t *texture;
+	enum gs_color_space space;
+	// Filters
+	const struct obs_source_info *info;
+	void *data;
+	obs_source_t *parent;
+	bool update_pending;
+	struct obs_source *next;
+};
+
+struct obs_module {
+	const char *data_path;
+};
+
+struct signal_connection {
+	char *signal;
+	signal_callback_t callback;
+	void *data;
+	struct signal_connection *next;
+};
+
+struct signal_handler {
+	struct signal_connection *connections;
+};
+
+static struct obs_module module;
+static obs_source_t *sources;
+static signal_handler_t global_signals;
+static gs_effect_t *default_effect;
+// obs_get_video_frame_time, moved ahead by every rendered frame.
+static uint64_t video_frame_time;
+
+/* ------------------------------------------------------------------------- */
+/* Settings                                                                  */
+
+obs_data_t *obs_data_create(void)
+{
+	obs_data_t *data = bzalloc(sizeof(obs_data_t));
+	data->refs = 1;
+	return data;
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+	if (data)
+		data->refs++;
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	if (!data || --data->refs > 0)
+		return;
+	struct obs_data_item *item = data->items;
+	while (item) {
+		struct obs_data_item *next = item->next;
+		bfree(item->name);
+		bfree(item->string);
+		bfree(item);
+		item = next;
+	}
+	bfree(data);
+}
+
+static struct obs_data_item *find_item(obs_data_t *data, const char *name)
+{
+	for (struct obs_data_item *item = data ? data->items : NULL; item;
+	     item = item->next) {
+		if (strcmp(item->name, name) == 0)
+			return item;
+	}
+	return NULL;
+}
+
+static struct obs_data_item *set_item(obs_data_t *data, const char *name)
+{
+	struct obs_data_item *item = find_item(data, name);
+	if (!item) {
+		item = bzalloc(sizeof(struct obs_data_item));
+		item->name = bstrdup(name);
+		item->next = data->items;
+		data->items = item;
+	}
+	bfree(item->string);
+	item->string = NULL;
+	return item;
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	struct obs_data_item *item = set_item(data, name);
+	item->int_value = val;
+	item->is_double = false;
+}
+
+void obs_data_set_double(obs_data_t *data, const char *name, double val)
+{
+	struct obs_data_item *item = set_item(data, name);
+	item->double_value = val;
+	item->is_double = true;
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	obs_data_set_int(data, name, val ? 1 : 0);
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	set_item(data, name)->string = bstrdup(val ? val : "");
+}
+
+// Defaults are the items get_defaults sets before the filter's own
+// settings are applied over them.
+void obs_data_set_default_int(obs_data_t *data, const char *name,
+			      long long val)
+{
+	if (!find_item(data, name))
+		obs_data_set_int(data, name, val);
+}
+
+// Numbers convert between int and double like obs_data does.
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	const struct obs_data_item *item = find_item(data, name);
+	if (!item)
+		return 0;
+	return item->is_double ? (long long)item->double_value
+			       : item->int_value;
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	const struct obs_data_item *item = find_item(data, name);
+	if (!item)
+		return 0.0;
+	return item->is_double ? item->double_value
+			       : (double)item->int_value;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	return obs_data_get_int(data, name) != 0;
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	const struct obs_data_item *item = find_item(data, name);
+	return item && item->string ? item->string : "";
+}
+
+// Copies every item of `src` into `dst`, as obs_data_apply.
+static void apply_data(obs_data_t *dst, obs_data_t *src)
+{
+	for (struct obs_data_item *item = src ? src->items : NULL; item;
+	     item = item->next) {
+		if (item->string)
+			obs_data_set_string(dst, item->name, item->string);
+		else if (item->is_double)
+			obs_data_set_double(dst, item->name,
+					    item->double_value);
+		else
+			obs_data_set_int(dst, item->name, item->int_value);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* Signals                                                                   */
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+	return &global_signals;
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+			    signal_callback_t callback, void *data)
+{
+	struct signal_connection *connection =
+		bzalloc(sizeof(struct signal_connection));
+	connection->signal = bstrdup(signal);
+	connection->callback = callback;
+	connection->data = data;
+	connection->next = handler->connections;
+	handler->connections = connection;
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+			       signal_callback_t callback, void *data)
+{
+	for (struct signal_connection **link = &handler->connections; *link;
+	     link = &(*link)->next) {
+		struct signal_connection *connection = *link;
+		if (connection->callback == callback &&
+		    connection->data == data &&
+		    strcmp(connection->signal, signal) == 0) {
+			*link = connection->next;
+			bfree(connection->signal);
+			bfree(connection);
+			return;
+		}
+	}
+}
+
+void signal_handler_signal(signal_handler_t *handler, const char *signal,
+			   calldata_t *params)
+{
+	struct signal_connection *connection = handler->connections;
+	while (connection) {
+		// The callback may disconnect itself.
+		struct signal_connection *next = connection->next;
+		if (strcmp(connection->signal, signal) == 0)
+			connection->callback(connection->data, params);
+		connection = next;
+	}
+}
+
+static void source_signal(const char *signal, obs_source_t *source,
+			  const char *new_name, const char *prev_name)
+{
+	calldata_t params;
+	calldata_init(&params);
+	calldata_set_ptr(&params, "source", source);
+	if (new_name) {
+		calldata_set_string(&params, "new_name", new_name);
+		calldata_set_string(&params, "prev_name", prev_name);
+	}
+	signal_handler_signal(&global_signals, signal, &params);
+	calldata_free(&params);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Sources                                                                   */
+
+static obs_source_t *source_create(const char *name)
+{
+	obs_source_t *source = bzalloc(sizeof(obs_source_t));
+	source->refs = 1;
+	source->name = bstrdup(name ? name : "");
+	source->settings = obs_data_create();
+	source->weak = bzalloc(sizeof(obs_weak_source_t));
+	source->weak->refs = 1;
+	source->weak->source = source;
+	source->next = sources;
+	sources = source;
+	return source;
+}
+
+obs_source_t *mock_source_create(const char *name,
+				 const struct blur_image *image)
+{
+	obs_source_t *source = source_create(name);
+	source->texture = mock_texture_create(GS_RGBA, image);
+	source_signal("source_create", source, NULL, NULL);
+	return source;
+}
+
+void mock_source_set_name(obs_source_t *source, const char *name)
+{
+	char *prev_name = source->name;
+	source->name = bstrdup(name);
+	source_signal("source_rename", source, source->name, prev_name);
+	bfree(prev_name);
+}
+
+void mock_source_remove(obs_source_t *source)
+{
+	source_signal("source_remove", source, NULL, NULL);
+}
+
+void mock_source_set_image(obs_source_t *source,
+			   const struct blur_image *image)
+{
+	mock_texture_destroy(source->texture);
+	source->texture = mock_texture_create(
+		gs_get_format_from_space(source->space), image);
+}
+
+void mock_source_set_color_space(obs_source_t *source,
+				 enum gs_color_space space)
+{
+	source->space = space;
+}
+
+obs_source_t *mock_filter_create(const struct obs_source_info *info,
+				 const char *name, obs_source_t *parent,
+				 obs_data_t *settings)
+{
+	obs_source_t *filter = source_create(name);
+	filter->info = info;
+	filter->parent = parent;
+	parent->refs++;
+	if (info->get_defaults)
+		info->get_defaults(filter->settings);
+	apply_data(filter->settings, settings);
+	filter->data = info->create(filter->settings, filter);
+	source_signal("source_create", filter, NULL, NULL);
+	return filter;
+}
+
+void mock_filter_update(obs_source_t *filter, obs_data_t *settings)
+{
+	filter->info->update(filter->data, settings);
+}
+
+void obs_source_release(obs_source_t *source)
+{
+	if (!source || --source->refs > 0)
+		return;
+
+	if (source->info && source->info->destroy)
+		source->info->destroy(source->data);
+	for (obs_source_t **link = &sources; *link; link = &(*link)->next) {
+		if (*link == source) {
+			*link = source->next;
+			break;
+		}
+	}
+	source->weak->source = NULL;
+	obs_weak_source_release(source->weak);
+	obs_source_release(source->parent);
+	obs_data_release(source->settings);
+	mock_texture_destroy(source->texture);
+	bfree(source->name);
+	bfree(source);
+}
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+	mock_count_source_lookup();
+	for (obs_source_t *source = sources; source; source = source->next) {
+		if (!source->info && strcmp(source->name, name) == 0) {
+			source->refs++;
+			return source;
+		}
+	}
+	return NULL;
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+	if (!source)
+		return NULL;
+	source->weak->refs++;
+	return source->weak;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+	if (!weak || !weak->source)
+		return NULL;
+	weak->source->refs++;
+	return weak->source;
+}
+
+bool obs_weak_source_references_source(obs_weak_source_t *weak,
+					obs_source_t *source)
+{
+	return weak && source && weak->source == source;
+}
+
+bool obs_weak_source_expired(obs_weak_source_t *weak)
+{
+	return !weak || !weak->source;
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+	if (weak && --weak->refs == 0)
+		bfree(weak);
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->name : NULL;
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+// Like libobs, video sources apply updates on their next tick.
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	if (settings != source->settings)
+		apply_data(source->settings, settings);
+	source->update_pending = true;
+}
+
+void obs_source_update_properties(obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+uint32_t obs_source_get_base_width(obs_source_t *source)
+{
+	if (source->info)
+		return source->info->get_width(source->data);
+	return source->texture ? source->texture->image.width : 0;
+}
+
+uint32_t obs_source_get_base_height(obs_source_t *source)
+{
+	if (source->info)
+		return source->info->get_height(source->data);
+	return source->texture ? source->texture->image.height : 0;
+}
+
+uint32_t obs_source_get_output_flags(const obs_source_t *source)
+{
+	return source->info ? source->info->output_flags : OBS_SOURCE_VIDEO;
+}
+
+enum gs_color_space
+obs_source_get_color_space(obs_source_t *source, size_t count,
+			   const enum gs_color_space *preferred_spaces)
+{
+	if (!source)
+		return GS_CS_SRGB;
+	if (source->info && source->info->video_get_color_space)
+		return source->info->video_get_color_space(
+			source->data, count, preferred_spaces);
+	if (source->info)
+		return obs_source_get_color_space(source->parent, count,
+						  preferred_spaces);
+	return source->space;
+}
+
+obs_source_t *obs_filter_get_target(const obs_source_t *filter)
+{
+	return filter->parent;
+}
+
+gs_effect_t *obs_get_base_effect(enum obs_base_effect effect)
+{
+	UNUSED_PARAMETER(effect);
+	if (!default_effect)
+		default_effect = gs_effect_create(
+			"uniform float4x4 ViewProj;\n"
+			"uniform texture2d image;\n"
+			"technique Draw\n",
+			"default.effect", NULL);
+	return default_effect;
+}
+
+// Draws the image of `source` with the default effect.
+static void draw_image(obs_source_t *source, gs_effect_t *effect)
+{
+	gs_effect_t *pass_through = effect ? effect
+					    : obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(pass_through,
+							  "image"),
+			      source->texture);
+	while (gs_effect_loop(pass_through, "Draw"))
+		gs_draw_sprite(source->texture, 0,
+			       gs_texture_get_width(source->texture),
+			       gs_texture_get_height(source->texture));
+}
+
+void obs_source_default_render(obs_source_t *source)
+{
+	draw_image(source, NULL);
+}
+
+void obs_source_video_render(obs_source_t *source)
+{
+	if (source->info)
+		source->info->video_render(source->data, NULL);
+	else
+		draw_image(source, NULL);
+}
+
+/*
+ *  Filters always render their parent directly, so process_filter_end
+ *  is a single draw of the parent with the filter's effect.
+ */
+bool obs_source_process_filter_begin(obs_source_t *filter,
+				     enum gs_color_format format,
+				     enum obs_allow_direct_render allow_direct)
+{
+	return obs_source_process_filter_begin_with_color_space(
+		filter, format, GS_CS_SRGB, allow_direct);
+}
+
+// Sources keep their pixels in every space, there is no conversion.
+bool obs_source_process_filter_begin_with_color_space(
+	obs_source_t *filter, enum gs_color_format format,
+	enum gs_color_space space, enum obs_allow_direct_render allow_direct)
+{
+	UNUSED_PARAMETER(format);
+	UNUSED_PARAMETER(space);
+	UNUSED_PARAMETER(allow_direct);
+	return filter && filter->parent;
+}
+
+void obs_source_process_filter_end(obs_source_t *filter, gs_effect_t *effect,
+				   uint32_t width, uint32_t height)
+{
+	UNUSED_PARAMETER(width);
+	UNUSED_PARAMETER(height);
+	draw_image(filter->parent, effect);
+}
+
+void obs_source_skip_video_filter(obs_source_t *filter)
+{
+	obs_source_video_render(filter->parent);
+}
+
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	for (obs_source_t *source = sources; source; source = source->next) {
+		if (!source->info && !enum_proc(param, source))
+			break;
+	}
+}
+
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	UNUSED_PARAMETER(enum_proc);
+	UNUSED_PARAMETER(param);
+}
+
+uint64_t obs_get_video_frame_time(void)
+{
+	return video_frame_time;
+}
+
+bool mock_filters_render(obs_source_t *const *filters, size_t count,
+			 float seconds, struct blur_image *outputs)
+{
+	video_frame_time += (uint64_t)((double)seconds * 1000000000.0);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_source_t *filter = filters[i];
+		const struct obs_source_info *info = filter->info;
+		if (!info)
+			return false;
+
+		if (filter->update_pending && info->update) {
+			filter->update_pending = false;
+			info->update(filter->data, filter->settings);
+		}
+		if (info->video_tick)
+			info->video_tick(filter->data, seconds);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		obs_source_t *filter = filters[i];
+		const struct obs_source_info *info = filter->info;
+		uint32_t width = info->get_width(filter->data);
+		uint32_t height = info->get_height(filter->data);
+		if (!width || !height) {
+			width = obs_source_get_base_width(filter->parent);
+			height = obs_source_get_base_height(filter->parent);
+		}
+
+		mock_canvas_begin(width, height);
+		info->video_render(filter->data, NULL);
+		mock_canvas_end(&outputs[i]);
+	}
+	return true;
+}
+
+bool mock_filter_render(obs_source_t *filter, float seconds,
+			struct blur_image *output)
+{
+	return mock_filters_render(&filter, 1, seconds, output);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Module                                                                    */
+
+obs_module_t *obs_current_module(void)
+{
+	return &module;
+}
+
+const char *obs_get_module_data_path(obs_module_t *m)
+{
+	return m ? m->data_path : NULL;
+}
+
+const char *obs_module_text(const char *lookup_string)
+{
+	return lookup_string;
+}
+
+void obs_enter_graphics(void) {}
+
+void obs_leave_graphics(void) {}
+
+void mock_obs_init(const char *data_path)
+{
+	module.data_path = data_path;
+	mock_reset_stats();
+}
+
+void mock_obs_free(void)
+{
+	while (sources) {
+		// Drop the harness references, filters first since they
+		// hold their parents.
+		obs_source_t *source = sources;
+		source->refs = 1;
+		obs_source_release(source);
+	}
+	gs_effect_destroy(default_effect);
+	default_effect = NULL;
+	mock_graphics_free();
+}
+
+/* ------------------------------------------------------------------------- */
+/* Properties are only built for the UI, which the harness never shows.      */
+
+obs_properties_t *obs_properties_create(void)
+{
+	return NULL;
+}
+
+void obs_properties_set_param(obs_properties_t *props, void *param,
+			      void (*destroy)(void *param))
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(param);
+	UNUSED_PARAMETER(destroy);
+}
+
+obs_property_t *obs_properties_get(obs_properties_t *props,
+				   const char *property)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(property);
+	return NULL;
+}
+
+obs_property_t *obs_properties_add_list(obs_properties_t *props,
+					const char *name,
+					const char *description,
+					enum obs_combo_type type,
+					enum obs_combo_format format)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(type);
+	UNUSED_PARAMETER(format);
+	return NULL;
+}
+
+obs_property_t *obs_properties_add_float_slider(obs_properties_t *props,
+						const char *name,
+						const char *description,
+						double min, double max,
+						double step)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(min);
+	UNUSED_PARAMETER(max);
+	UNUSED_PARAMETER(step);
+	return NULL;
+}
+
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *props,
+					      const char *name,
+					      const char *description, int min,
+					      int max, int step)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(min);
+	UNUSED_PARAMETER(max);
+	UNUSED_PARAMETER(step);
+	return NULL;
+}
+
+obs_property_t *obs_properties_add_bool(obs_properties_t *props,
+					const char *name,
+					const char *description)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	return NULL;
+}
+
+obs_property_t *obs_properties_add_group(obs_properties_t *props,
+					 const char *name,
+					 const char *description,
+					 enum obs_group_type type,
+					 obs_properties_t *group)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(type);
+	UNUSED_PARAMETER(group);
+	return NULL;
+}
+
+size_t obs_property_list_add_int(obs_property_t *p, const char *name,
+				 long long val)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(val);
+	return 0;
+}
+
+size_t obs_property_list_add_string(obs_property_t *p, const char *name,
+				    const char *val)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(val);
+	return 0;
+}
+
+void obs_property_list_clear(obs_property_t *p)
+{
+	UNUSED_PARAMETER(p);
+}
+
+void obs_property_set_modified_callback2(obs_property_t *p,
+					 obs_property_modified2_t modified,
+					 void *priv)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(modified);
+	UNUSED_PARAMETER(priv);
+}
+
+void obs_property_set_enabled(obs_property_t *p, bool enabled)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(enabled);
+}
+
+void obs_property_set_visible(obs_property_t *p, bool visible)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(visible);
+}
+
+void obs_property_set_long_description(obs_property_t *p,
+				       const char *long_description)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(long_description);
+}
+
+void obs_property_float_set_limits(obs_property_t *p, double min, double max,
+				   double step)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(min);
+	UNUSED_PARAMETER(max);
+	UNUSED_PARAMETER(step);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <stdio.h>
+
+#include "reference/blur-reference.h"
+
+/*
+ *  CPU stand-in for the libobs graphics and source API the plugin renders
+ *  with.  Linked in place of libobs, it runs every draw through a CPU
+ *  program of its .effect file and records the state changes, so the
+ *  render path can be checked for pass counts, state balance and pixels
+ *  without a graphics device.
+ *
+ *  - Textures hold blur_image pixels.  GS_RGBA targets are rounded to 8
+ *    bits when written, GS_R10G10B10A2 to 10 bits and 2 bits of alpha,
+ *    float formats keep full precision.  Color spaces are recorded, but
+ *    nothing is converted between them.
+ *  - Effects are identified by the file name passed to gs_effect_create.
+ *    A draw with an effect or technique that has no CPU program fills
+ *    its target with zero and counts as unexecuted.
+ *  - Filters get the deferred obs_source_update of libobs: settings
+ *    reach the update callback on the next frame.
+ *
+ *  Not thread safe; the whole harness runs on one thread.
+ */
+
+struct mock_stats {
+	// gs_texrender_begin calls that started a pass, and their ends.
+	uint64_t texrender_begins;
+	uint64_t texrender_ends;
+	// Of the begins, those into 8 bit targets.
+	uint64_t begins_8bit;
+	// Begins refused because the texrender was not reset since it was
+	// last rendered.  libobs drops the pass silently.
+	uint64_t rejected_begins;
+	// Ends without a matching begin.
+	uint64_t unbalanced_ends;
+	uint64_t draws;
+	uint64_t unexecuted_draws;
+	// Draws that sample the texture they render into.
+	uint64_t feedback_draws;
+	// Full frame texels written by draws, in units of the output size.
+	double frame_writes;
+	// Frames that ended with a scissor rect still set.
+	uint64_t unreset_scissors;
+	uint64_t param_sets;
+	uint64_t blend_pushes;
+	uint64_t blend_pops;
+	// Pops of an empty blend state stack.
+	uint64_t blend_underflows;
+	int max_blend_depth;
+	uint64_t stage_copies;
+	uint64_t effect_creates;
+	// obs_get_source_by_name calls.
+	uint64_t source_lookups;
+};
+
+// `data_path` is returned by obs_get_module_data_path.
+extern void mock_obs_init(const char *data_path);
+extern void mock_obs_free(void);
+
+extern void mock_get_stats(struct mock_stats *stats);
+extern void mock_reset_stats(void);
+// Writes one line per pass, draw and state change to `file`, or stops
+// tracing when NULL.
+extern void mock_set_trace(FILE *file);
+// blog messages at or below `level` are printed to stderr.
+extern void mock_set_log_level(int level);
+
+// Texture holding `image` as `format` keeps it, for checks that draw
+// with an effect directly.  `image` may be NULL for an empty one.
+extern gs_texture_t *mock_texture_create(enum gs_color_format format,
+					 const struct blur_image *image);
+extern void mock_texture_destroy(gs_texture_t *texture);
+
+// Image source showing `image`, which is copied.  Sources are found by
+// name through obs_get_source_by_name.
+extern obs_source_t *mock_source_create(const char *name,
+					const struct blur_image *image);
+extern void mock_source_set_image(obs_source_t *source,
+				  const struct blur_image *image);
+// Renames the source or removes it from the scene collection, with the
+// global signals libobs sends.
+extern void mock_source_set_name(obs_source_t *source, const char *name);
+extern void mock_source_remove(obs_source_t *source);
+// Color space the source reports, SRGB by default.  Images set after
+// this are stored in the format of the space.
+extern void mock_source_set_color_space(obs_source_t *source,
+					enum gs_color_space space);
+// Creates a filter of type `info` on `parent`.  Release with
+// obs_source_release.
+extern obs_source_t *mock_filter_create(const struct obs_source_info *info,
+					const char *name, obs_source_t *parent,
+					obs_data_t *settings);
+// Calls the filter's update with `settings` right away on the calling
+// thread, for checks that update from another thread while frames
+// render.  The filter's own settings are left alone.
+extern void mock_filter_update(obs_source_t *filter, obs_data_t *settings);
+
+/*
+ *  Runs one frame of `filter`: pending updates, video_tick, then
+ *  video_render onto a cleared canvas of the filter size with the default
+ *  blend state, which is copied to `output`.  obs_get_video_frame_time
+ *  moves ahead by `seconds`.
+ */
+extern bool mock_filter_render(obs_source_t *filter, float seconds,
+			       struct blur_image *output);
+// One frame of several filters, like a scene showing each of them: every
+// filter is updated and ticked, then each renders onto its own canvas
+// within the same video frame time.  `outputs` holds `count` images.
+extern bool mock_filters_render(obs_source_t *const *filters, size_t count,
+				float seconds, struct blur_image *outputs);
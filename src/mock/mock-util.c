@@ -0,0 +1,284 @@
+#define _XOPEN_SOURCE 700
+
+#include "mock-internal.h"
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/*
+ *  The exported parts of libobs/util the plugin links against.  The
+ *  inline helpers of the headers (darray, bzalloc, dstr_cat...) build on
+ *  these.
+ */
+
+static int log_level = LOG_WARNING;
+
+void mock_set_log_level(int level)
+{
+	log_level = level;
+}
+
+void *bmalloc(size_t size)
+{
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		fprintf(stderr, "out of memory allocating %zu bytes\n", size);
+		abort();
+	}
+	return ptr;
+}
+
+void *brealloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size ? size : 1);
+	if (!ptr) {
+		fprintf(stderr, "out of memory allocating %zu bytes\n", size);
+		abort();
+	}
+	return ptr;
+}
+
+void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+void blogva(int level, const char *format, va_list args)
+{
+	if (level > log_level)
+		return;
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+}
+
+void blog(int level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	blogva(level, format, args);
+	va_end(args);
+}
+
+/* ------------------------------------------------------------------------- */
+/* dstr                                                                      */
+
+static void dstr_reserve(struct dstr *dst, size_t size)
+{
+	if (size <= dst->capacity)
+		return;
+	size_t capacity = dst->capacity ? dst->capacity * 2 : 16;
+	while (capacity < size)
+		capacity *= 2;
+	dst->array = brealloc(dst->array, capacity);
+	dst->capacity = capacity;
+}
+
+void dstr_ncopy(struct dstr *dst, const char *array, const size_t len)
+{
+	dst->len = 0;
+	dstr_ncat(dst, array, len);
+}
+
+void dstr_copy(struct dstr *dst, const char *array)
+{
+	dstr_ncopy(dst, array, array ? strlen(array) : 0);
+}
+
+void dstr_ncat(struct dstr *dst, const char *array, const size_t len)
+{
+	dstr_reserve(dst, dst->len + len + 1);
+	if (len)
+		memcpy(dst->array + dst->len, array, len);
+	dst->len += len;
+	dst->array[dst->len] = 0;
+}
+
+void dstr_vcatf(struct dstr *dst, const char *format, va_list args)
+{
+	va_list copy;
+	va_copy(copy, args);
+	const int len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (len < 0)
+		return;
+	dstr_reserve(dst, dst->len + (size_t)len + 1);
+	vsnprintf(dst->array + dst->len, (size_t)len + 1, format, args);
+	dst->len += (size_t)len;
+}
+
+void dstr_vprintf(struct dstr *dst, const char *format, va_list args)
+{
+	dst->len = 0;
+	dstr_reserve(dst, 1);
+	dst->array[0] = 0;
+	dstr_vcatf(dst, format, args);
+}
+
+void dstr_printf(struct dstr *dst, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	dstr_vprintf(dst, format, args);
+	va_end(args);
+}
+
+void dstr_catf(struct dstr *dst, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	dstr_vcatf(dst, format, args);
+	va_end(args);
+}
+
+/* ------------------------------------------------------------------------- */
+/* platform                                                                  */
+
+uint64_t os_gettime_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+char *os_quick_read_utf8_file(const char *path)
+{
+	FILE *file = path ? fopen(path, "rb") : NULL;
+	if (!file)
+		return NULL;
+
+	struct dstr text = {0};
+	char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		dstr_ncat(&text, buffer, read);
+	fclose(file);
+
+	if (!text.array)
+		dstr_copy(&text, "");
+	// Skip a UTF-8 byte order mark like libobs does.
+	if (text.len >= 3 && memcmp(text.array, "\xEF\xBB\xBF", 3) == 0) {
+		memmove(text.array, text.array + 3, text.len - 2);
+		text.len -= 3;
+	}
+	return text.array;
+}
+
+bool os_quick_write_utf8_file(const char *path, const char *str, size_t len,
+			      bool marker)
+{
+	FILE *file = path ? fopen(path, "wb") : NULL;
+	if (!file)
+		return false;
+	bool ok = !marker || fwrite("\xEF\xBB\xBF", 1, 3, file) == 3;
+	ok = ok && fwrite(str, 1, len, file) == len;
+	return fclose(file) == 0 && ok;
+}
+
+int os_stat(const char *file, struct stat *st)
+{
+	return stat(file, st);
+}
+
+int os_mkdirs(const char *path)
+{
+	struct dstr dir = {0};
+	dstr_copy(&dir, path);
+	for (char *p = dir.array + 1; p && *p; p++) {
+		if (*p != '/')
+			continue;
+		*p = 0;
+		mkdir(dir.array, 0755);
+		*p = '/';
+	}
+	int result = MKDIR_SUCCESS;
+	if (mkdir(dir.array, 0755) != 0)
+		result = errno == EEXIST ? MKDIR_EXISTS : MKDIR_ERROR;
+	bfree(dir.array);
+	return result;
+}
+
+char *os_get_abs_path_ptr(const char *path)
+{
+	char *abs = realpath(path, NULL);
+	if (!abs)
+		return NULL;
+	struct dstr copy = {0};
+	dstr_copy(&copy, abs);
+	free(abs);
+	return copy.array;
+}
+
+/*
+ *  Call data as a list of entries- the name with its terminator, the
+ *  size of the value, and the value.  Only the harness reads it back, so
+ *  it need not match the libobs layout.
+ */
+static uint8_t *calldata_find(const calldata_t *data, const char *name,
+			      size_t *size)
+{
+	size_t pos = 0;
+	while (data->stack && pos < data->size) {
+		const char *entry = (const char *)data->stack + pos;
+		pos += strlen(entry) + 1;
+		size_t value_size;
+		memcpy(&value_size, data->stack + pos, sizeof(value_size));
+		pos += sizeof(value_size);
+		if (strcmp(entry, name) == 0) {
+			*size = value_size;
+			return data->stack + pos;
+		}
+		pos += value_size;
+	}
+	return NULL;
+}
+
+bool calldata_get_data(const calldata_t *data, const char *name, void *out,
+		       size_t size)
+{
+	size_t value_size;
+	const uint8_t *value = calldata_find(data, name, &value_size);
+	if (!value || value_size != size)
+		return false;
+	memcpy(out, value, size);
+	return true;
+}
+
+bool calldata_get_string(const calldata_t *data, const char *name,
+			 const char **str)
+{
+	size_t value_size;
+	uint8_t *value = calldata_find(data, name, &value_size);
+	*str = value && value_size ? (const char *)value : NULL;
+	return value != NULL;
+}
+
+// Values are only ever set once per name by the harness.
+void calldata_set_data(calldata_t *data, const char *name, const void *in,
+		       size_t new_size)
+{
+	const size_t name_size = strlen(name) + 1;
+	const size_t size =
+		data->size + name_size + sizeof(new_size) + new_size;
+	if (size > data->capacity) {
+		data->stack = brealloc(data->stack, size);
+		data->capacity = size;
+	}
+	uint8_t *pos = data->stack + data->size;
+	memcpy(pos, name, name_size);
+	pos += name_size;
+	memcpy(pos, &new_size, sizeof(new_size));
+	pos += sizeof(new_size);
+	if (new_size)
+		memcpy(pos, in, new_size);
+	data->size = size;
+}
@@ -10,9 +10,11 @@ struct obs_source_info obs_composite_blur = {
 	.update = composite_blur_update,
 	.video_render = composite_blur_video_render,
 	.video_tick = composite_blur_video_tick,
+	.video_get_color_space = composite_blur_get_color_space,
 	.get_width = composite_blur_width,
 	.get_height = composite_blur_height,
-	.get_properties = composite_blur_properties};
+	.get_properties = composite_blur_properties,
+	.get_defaults = composite_blur_defaults};
 
 static const char *composite_blur_name(void *unused)
 {
@@ -26,25 +28,36 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 		bzalloc(sizeof(struct composite_blur_filter_data));
 	filter->context = source;
 	filter->radius = 0.0f;
-	filter->radius_last = -1.0f;
 	filter->angle = 0.0f;
 	filter->center_x = 0.0f;
 	filter->center_y = 0.0f;
 	filter->blur_algorithm = ALGO_NONE;
-	filter->blur_algorithm_last = -1;
+	filter->format = GS_RGBA;
+	filter->space = GS_CS_SRGB;
 	filter->blur_type = TYPE_NONE;
-	filter->blur_type_last = -1;
 	filter->rendering = false;
-	filter->reload = true;
-	filter->param_uv_size = NULL;
-	filter->param_dir = NULL;
-	filter->param_radius = NULL;
-	filter->param_background = NULL;
+	filter->params = NULL;
+	filter->params_2 = NULL;
+	filter->params_3 = NULL;
+	filter->composite_params = NULL;
+	filter->fingerprint_params = NULL;
 	filter->video_render = NULL;
 	filter->load_effect = NULL;
 	filter->update = NULL;
 
-	da_init(filter->kernel);
+	filter->kernel = NULL;
+	filter->reduced_kernel = NULL;
+	settings_buffer_init(&filter->snapshots);
+
+	source_ref_init(&filter->background);
+	source_ref_init(&filter->roi_mask);
+	signal_handler_t *signals = obs_get_signal_handler();
+	signal_handler_connect(signals, "source_rename",
+			       composite_blur_source_renamed, filter);
+	signal_handler_connect(signals, "source_remove",
+			       composite_blur_source_removed, filter);
+	signal_handler_connect(signals, "source_create",
+			       composite_blur_source_created, filter);
 
 	obs_source_update(source, settings);
 
@@ -55,19 +68,41 @@ static void composite_blur_destroy(void *data)
 {
 	struct composite_blur_filter_data *filter = data;
 
-	obs_enter_graphics();
-	if (filter->effect) {
-		gs_effect_destroy(filter->effect);
-	}
-	if (filter->composite_effect) {
-		gs_effect_destroy(filter->composite_effect);
+	signal_handler_t *signals = obs_get_signal_handler();
+	signal_handler_disconnect(signals, "source_rename",
+				  composite_blur_source_renamed, filter);
+	signal_handler_disconnect(signals, "source_remove",
+				  composite_blur_source_removed, filter);
+	signal_handler_disconnect(signals, "source_create",
+				  composite_blur_source_created, filter);
+
+	effect_cache_release(filter->effect);
+	effect_cache_release(filter->effect_2);
+	effect_cache_release(filter->effect_3);
+	effect_cache_release(filter->composite_effect);
+	effect_cache_release(filter->fingerprint_effect);
+	effect_cache_release(filter->roi_effect);
+
+	if (filter->skip_unchanged) {
+		obs_log(LOG_INFO,
+			"Unchanged frames: %llu reused, %llu rendered",
+			(unsigned long long)filter->frames_reused,
+			(unsigned long long)filter->frames_rendered);
 	}
+	obs_log(LOG_DEBUG,
+		"Updates: %llu, %llu settings changed, %llu source lookups",
+		(unsigned long long)filter->updates,
+		(unsigned long long)filter->settings_changed,
+		(unsigned long long)(filter->background.lookups +
+				     filter->roi_mask.lookups));
+
+	obs_enter_graphics();
+	frame_fingerprint_free(&filter->input_fingerprint);
+	frame_fingerprint_free(&filter->background_fingerprint);
+	temporal_free(filter);
 	if (filter->render) {
 		gs_texrender_destroy(filter->render);
 	}
-	if (filter->render2) {
-		gs_texrender_destroy(filter->render2);
-	}
 
 	if (filter->input_texrender) {
 		gs_texrender_destroy(filter->input_texrender);
@@ -77,6 +112,10 @@ static void composite_blur_destroy(void *data)
 	}
 
 	obs_leave_graphics();
+	source_ref_free(&filter->background);
+	source_ref_free(&filter->roi_mask);
+	settings_buffer_free(&filter->snapshots);
+	kernel_cache_release(filter->reduced_kernel);
 	bfree(filter);
 }
 
@@ -92,75 +131,234 @@ static uint32_t composite_blur_height(void *data)
 	return filter->height;
 }
 
+/*
+ *  Reads the settings that changed since the last update and publishes
+ *  them to the render thread.  Transitions animating the radius call
+ *  this many times a second, so unchanged settings cost a compare each,
+ *  the background is only looked up by name when the name changes, and
+ *  nothing is published when nothing changed.  Nothing here touches
+ *  what the render thread uses, effects are reloaded by apply_settings.
+ */
 static void composite_blur_update(void *data, obs_data_t *settings)
 {
 	struct composite_blur_filter_data *filter = data;
-	obs_log(LOG_INFO, "Composite Blur Update");
-
-	filter->blur_algorithm =
-		(int)obs_data_get_int(settings, "blur_algorithm");
-
-	if (filter->blur_algorithm != filter->blur_algorithm_last) {
-		obs_log(LOG_INFO, "Blur algorithm changed.");
-		filter->blur_algorithm_last = filter->blur_algorithm;
-		filter->reload = true;
+	struct blur_settings *s = &filter->updated;
+	const bool first = filter->updates == 0;
+	filter->updates++;
+
+	int changed = 0;
+	const bool algorithm_changed = update_int(
+		&s->blur_algorithm,
+		(int)obs_data_get_int(settings, "blur_algorithm"));
+	if (algorithm_changed) {
+		obs_log(LOG_DEBUG, "Blur algorithm changed.");
+	}
+	const bool type_changed = update_int(
+		&s->blur_type, (int)obs_data_get_int(settings, "blur_type"));
+	if (type_changed) {
+		obs_log(LOG_DEBUG, "Blur type changed.");
+	}
+	changed += algorithm_changed + type_changed;
+
+	changed += update_float(&s->radius,
+				(float)obs_data_get_double(settings, "radius"));
+	changed += update_int(&s->passes,
+			      (int)obs_data_get_int(settings, "passes"));
+	changed += update_int(
+		&s->downsample_quality,
+		(int)obs_data_get_int(settings, "downsample_quality"));
+
+	changed += update_float(
+		&s->center_x, (float)obs_data_get_double(settings, "center_x"));
+	changed += update_float(
+		&s->center_y, (float)obs_data_get_double(settings, "center_y"));
+
+	changed += update_float(&s->angle,
+				(float)obs_data_get_double(settings, "angle"));
+	changed += update_float(
+		&s->tilt_shift_bottom,
+		(float)obs_data_get_double(settings, "tilt_shift_bottom"));
+	changed += update_float(
+		&s->tilt_shift_top,
+		(float)obs_data_get_double(settings, "tilt_shift_top"));
+	changed += update_int(
+		&s->temporal_frames,
+		(int)obs_data_get_int(settings, "temporal_frames"));
+	changed += update_int(&s->temporal_mode,
+			      (int)obs_data_get_int(settings, "temporal_mode"));
+	changed += update_int(
+		&s->temporal_memory,
+		(int)obs_data_get_int(settings, "temporal_memory"));
+	changed += update_bool(&s->skip_unchanged,
+			       obs_data_get_bool(settings, "skip_unchanged"));
+	changed += update_int(&s->precision,
+			      (int)obs_data_get_int(settings, "precision"));
+
+	changed += source_ref_set_name(&filter->background,
+				       obs_data_get_string(settings,
+							   "background"));
+
+	changed += roi_update(filter, settings);
+
+	filter->settings_changed += changed;
+	obs_log(LOG_DEBUG, "Update, %d settings changed", changed);
+	if (!changed && !first) {
+		return;
 	}
 
-	filter->blur_type = (int)obs_data_get_int(settings, "blur_type");
-
-	if (filter->blur_type != filter->blur_type_last) {
-		obs_log(LOG_INFO, "Blur type changed.");
-		filter->blur_type_last = filter->blur_type;
-		filter->reload = true;
+	if (algorithm_changed || type_changed) {
+		obs_source_update_properties(filter->context);
 	}
+	publish_settings(filter);
+}
 
-	filter->radius = (float)obs_data_get_double(settings, "radius");
-	filter->passes = (int)obs_data_get_int(settings, "passes");
+/*
+ *  Publishes the settings read by the last update, with the kernel or
+ *  coefficients the algorithm derives from them and the effects it can
+ *  draw with, which are computed and compiled here rather than on the
+ *  render thread.
+ */
+static void publish_settings(struct composite_blur_filter_data *filter)
+{
+	const struct blur_settings *s = &filter->updated;
+	struct settings_snapshot *snapshot =
+		settings_buffer_back(&filter->snapshots);
+
+	// The render thread does not hold the back snapshot, so its kernel
+	// can go.
+	const struct kernel_cache_entry *kernel =
+		s->blur_algorithm == ALGO_GAUSSIAN
+			? kernel_cache_acquire_gaussian(s->radius)
+			: NULL;
+	kernel_cache_release(snapshot->kernel);
+	snapshot->kernel = kernel;
+
+	// Acquired before the old ones go, so variants held only here are
+	// not destroyed and compiled again.
+	gs_effect_t *variants[GAUSSIAN_HELD_VARIANTS] = {0};
+	if (s->blur_algorithm == ALGO_GAUSSIAN)
+		gaussian_acquire_variants(s, kernel, variants);
+	for (size_t i = 0; i < GAUSSIAN_HELD_VARIANTS; i++) {
+		effect_cache_release(snapshot->variants[i]);
+		snapshot->variants[i] = variants[i];
+	}
 
-	filter->center_x = (float)obs_data_get_double(settings, "center_x");
-	filter->center_y = (float)obs_data_get_double(settings, "center_y");
+	if (s->blur_algorithm == ALGO_RECURSIVE) {
+		recursive_gaussian_coefficients(s->radius,
+						&snapshot->recursive);
+	}
+	snapshot->settings = *s;
 
-	filter->angle = (float)obs_data_get_double(settings, "angle");
-	filter->tilt_shift_bottom =
-		(float)obs_data_get_double(settings, "tilt_shift_bottom");
-	filter->tilt_shift_top =
-		(float)obs_data_get_double(settings, "tilt_shift_top");
+	settings_buffer_publish(&filter->snapshots);
+}
 
-	const char *source_name = obs_data_get_string(settings, "background");
-	obs_source_t *source = (source_name && strlen(source_name))
-				       ? obs_get_source_by_name(source_name)
-				       : NULL;
-	if (source) {
-		obs_weak_source_release(filter->background);
-		filter->background = obs_source_get_weak_source(source);
-		obs_source_release(source);
-	} else {
-		filter->background = NULL;
+/*
+ *  Copies the newest published settings into the filter at the start of
+ *  a frame, and reloads the effects they need.  Only the render thread
+ *  writes the copies, so a frame sees one snapshot throughout.
+ */
+static void apply_settings(struct composite_blur_filter_data *filter)
+{
+	bool fresh;
+	const struct settings_snapshot *snapshot =
+		settings_buffer_take(&filter->snapshots, &fresh);
+	if (!fresh) {
+		return;
 	}
 
-	obs_log(LOG_INFO, "UPDATE, Algo: %i", filter->blur_algorithm);
-	if (filter->reload) {
-		filter->reload = false;
-		obs_log(LOG_INFO, "UPDATE, reload: %i", filter->reload);
+	const struct blur_settings *s = &snapshot->settings;
+	const bool reload = s->blur_algorithm != filter->blur_algorithm ||
+			    s->blur_type != filter->blur_type;
+	filter->blur_algorithm = s->blur_algorithm;
+	filter->blur_type = s->blur_type;
+	filter->radius = s->radius;
+	filter->passes = s->passes;
+	filter->downsample_quality = s->downsample_quality;
+	filter->center_x = s->center_x;
+	filter->center_y = s->center_y;
+	filter->angle = s->angle;
+	filter->tilt_shift_bottom = s->tilt_shift_bottom;
+	filter->tilt_shift_top = s->tilt_shift_top;
+	filter->temporal_frames = s->temporal_frames;
+	filter->temporal_mode = s->temporal_mode;
+	filter->temporal_memory = s->temporal_memory;
+	filter->skip_unchanged = s->skip_unchanged;
+	filter->precision = s->precision;
+	filter->roi_enabled = s->roi_enabled;
+	filter->roi = s->roi;
+	filter->roi_masked = s->roi_masked;
+	filter->roi_mask_threshold = s->roi_mask_threshold;
+	filter->kernel = snapshot->kernel;
+	filter->recursive = snapshot->recursive;
+
+	if (reload) {
+		obs_log(LOG_DEBUG, "Applying settings, reloading effects");
 		composite_blur_reload_effect(filter);
-		obs_source_update_properties(filter->context);
+	} else if (filter->update) {
+		filter->update(filter);
 	}
 
-	if (filter->update) {
-		filter->update(filter);
+	// New settings may change the result, so the frame renders.
+	filter->settings_generation++;
+}
+
+/*
+ *  Global source signals, which keep the background and mask references
+ *  current without looking them up by name.  A renamed source keeps its
+ *  place in the settings under its new name.
+ */
+static void composite_blur_source_renamed(void *data, calldata_t *cd)
+{
+	struct composite_blur_filter_data *filter = data;
+	obs_source_t *source = calldata_ptr(cd, "source");
+	const char *new_name = calldata_string(cd, "new_name");
+
+	const bool background =
+		source_ref_renamed(&filter->background, source, new_name);
+	const bool mask =
+		source_ref_renamed(&filter->roi_mask, source, new_name);
+	if (!background && !mask) {
+		return;
 	}
+
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	if (background) {
+		obs_data_set_string(settings, "background", new_name);
+	}
+	if (mask) {
+		obs_data_set_string(settings, "roi_mask", new_name);
+	}
+	obs_data_release(settings);
+}
+
+static void composite_blur_source_removed(void *data, calldata_t *cd)
+{
+	struct composite_blur_filter_data *filter = data;
+	obs_source_t *source = calldata_ptr(cd, "source");
+	source_ref_removed(&filter->background, source);
+	source_ref_removed(&filter->roi_mask, source);
+}
+
+static void composite_blur_source_created(void *data, calldata_t *cd)
+{
+	struct composite_blur_filter_data *filter = data;
+	obs_source_t *source = calldata_ptr(cd, "source");
+	source_ref_created(&filter->background, source);
+	source_ref_created(&filter->roi_mask, source);
 }
 
 static void get_input_source(struct composite_blur_filter_data *filter)
 {
 	gs_effect_t *pass_through = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 
-	filter->input_texrender =
-		create_or_reset_texrender(filter->input_texrender);
-	if (obs_source_process_filter_begin(filter->context, GS_RGBA,
-					    OBS_ALLOW_DIRECT_RENDERING) &&
-	    gs_texrender_begin(filter->input_texrender, filter->width,
-			       filter->height)) {
+	filter->input_texrender = create_or_reset_texrender(
+		filter->input_texrender, filter->format);
+	if (obs_source_process_filter_begin_with_color_space(
+		    filter->context, filter->format, filter->space,
+		    OBS_ALLOW_DIRECT_RENDERING) &&
+	    gs_texrender_begin_with_color_space(filter->input_texrender,
+						filter->width, filter->height,
+						filter->space)) {
 
 		set_blending_parameters();
 		//set_render_parameters();
@@ -179,6 +377,9 @@ static void draw_output_to_source(struct composite_blur_filter_data *filter)
 {
 	gs_texture_t *texture =
 		gs_texrender_get_texture(filter->output_texrender);
+	if (roi_draw_output(filter, texture)) {
+		return;
+	}
 	gs_effect_t *pass_through = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 	gs_eparam_t *param = gs_effect_get_param_by_name(pass_through, "image");
 	gs_effect_set_texture(param, texture);
@@ -200,15 +401,35 @@ static void composite_blur_video_render(void *data, gs_effect_t *effect)
 
 	filter->rendering = true;
 
+	apply_settings(filter);
+	// A temporal trail keeps the last capture target in its ring, and
+	// gives the input a free one.
+	temporal_begin_frame(filter);
+	negotiate_format(filter);
+
 	if (filter->video_render) {
 		// 1. Get the input source as a texture renderer:
 		get_input_source(filter);
+		roi_begin_frame(filter);
+
+		// 2. Apply effect to texture, and render texture to video,
+		//    unless nothing changed since the output was rendered.
+		filter->output_direct = !output_kept(filter);
+		if (frame_unchanged(filter)) {
+			filter->frames_reused++;
+		} else {
+			const uint64_t generation =
+				filter->settings_generation;
+			filter->video_render(filter);
+			filter->rendered_generation = generation;
+			filter->frames_rendered++;
+		}
 
-		// 2. Apply effect to texture, and render texture to video
-		filter->video_render(filter);
-
-		// 3. Draw result (filter->output_texrender) to source
-		draw_output_to_source(filter);
+		// 3. Draw result (filter->output_texrender) to source, unless
+		//    the last pass drew it there already.
+		if (!filter->output_direct) {
+			draw_output_to_source(filter);
+		}
 	}
 
 	filter->rendering = false;
@@ -233,6 +454,16 @@ static obs_properties_t *composite_blur_properties(void *data)
 	obs_property_list_add_int(blur_algorithms,
 				  obs_module_text(ALGO_KAWASE_LABEL),
 				  ALGO_KAWASE);
+	obs_property_list_add_int(blur_algorithms,
+				  obs_module_text(ALGO_RECURSIVE_LABEL),
+				  ALGO_RECURSIVE);
+	obs_property_list_add_int(blur_algorithms,
+				  obs_module_text(ALGO_TEMPORAL_LABEL),
+				  ALGO_TEMPORAL);
+	obs_property_set_long_description(
+		blur_algorithms,
+		obs_module_text(
+			"CompositeBlurFilter.BlurAlgorithm.Description"));
 	obs_property_set_modified_callback2(
 		blur_algorithms, setting_blur_algorithm_modified, data);
 
@@ -257,12 +488,21 @@ static obs_properties_t *composite_blur_properties(void *data)
 
 	obs_properties_add_float_slider(
 		props, "radius", obs_module_text("CompositeBlurFilter.Radius"),
-		0.0, 83.0, 0.1);
+		0.0, RADIUS_MAX, 0.1);
 
 	obs_properties_add_int_slider(
 		props, "passes", obs_module_text("CompositeBlurFilter.Passes"),
 		1, 5, 1);
 
+	obs_property_t *downsample = obs_properties_add_list(
+		props, "downsample_quality",
+		obs_module_text("CompositeBlurFilter.Downsample"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	set_downsample_quality_list(downsample);
+	obs_property_set_long_description(
+		downsample,
+		obs_module_text("CompositeBlurFilter.Downsample.Description"));
+
 	obs_properties_add_float_slider(
 		props, "angle", obs_module_text("CompositeBlurFilter.Angle"),
 		-360.0, 360.0, 0.1);
@@ -299,6 +539,35 @@ static obs_properties_t *composite_blur_properties(void *data)
 		obs_module_text("CompositeBlurFilter.TiltShift"),
 		OBS_GROUP_NORMAL, tilt_shift_bounds);
 
+	obs_properties_t *temporal = obs_properties_create();
+	obs_properties_add_int_slider(
+		temporal, "temporal_frames",
+		obs_module_text("CompositeBlurFilter.Temporal.Frames"), 1,
+		TEMPORAL_MAX_FRAMES, 1);
+	obs_property_t *temporal_mode = obs_properties_add_list(
+		temporal, "temporal_mode",
+		obs_module_text("CompositeBlurFilter.Temporal.Mode"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(temporal_mode,
+				  obs_module_text(TEMPORAL_MODE_BOX_LABEL),
+				  TEMPORAL_MODE_BOX);
+	obs_property_list_add_int(
+		temporal_mode, obs_module_text(TEMPORAL_MODE_EXPONENTIAL_LABEL),
+		TEMPORAL_MODE_EXPONENTIAL);
+	obs_property_t *temporal_memory = obs_properties_add_int_slider(
+		temporal, "temporal_memory",
+		obs_module_text("CompositeBlurFilter.Temporal.Memory"), 0, 4096,
+		64);
+	obs_property_set_long_description(
+		temporal_memory,
+		obs_module_text(
+			"CompositeBlurFilter.Temporal.Memory.Description"));
+
+	obs_properties_add_group(
+		props, "temporal",
+		obs_module_text("CompositeBlurFilter.Temporal"),
+		OBS_GROUP_NORMAL, temporal);
+
 	struct dstr sources_name = {0};
 
 	obs_property_t *p = obs_properties_add_list(
@@ -309,9 +578,76 @@ static obs_properties_t *composite_blur_properties(void *data)
 	obs_enum_sources(add_source_to_list, p);
 	obs_enum_scenes(add_source_to_list, p);
 
+	obs_properties_t *roi = obs_properties_create();
+	obs_properties_add_int_slider(
+		roi, "roi_x", obs_module_text("CompositeBlurFilter.Roi.X"), 0,
+		ROI_MAX_WIDTH, 1);
+	obs_properties_add_int_slider(
+		roi, "roi_y", obs_module_text("CompositeBlurFilter.Roi.Y"), 0,
+		ROI_MAX_HEIGHT, 1);
+	obs_properties_add_int_slider(
+		roi, "roi_width",
+		obs_module_text("CompositeBlurFilter.Roi.Width"), 0,
+		ROI_MAX_WIDTH, 1);
+	obs_properties_add_int_slider(
+		roi, "roi_height",
+		obs_module_text("CompositeBlurFilter.Roi.Height"), 0,
+		ROI_MAX_HEIGHT, 1);
+
+	obs_property_t *roi_mask = obs_properties_add_list(
+		roi, "roi_mask",
+		obs_module_text("CompositeBlurFilter.Roi.Mask"),
+		OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(roi_mask, "None", "");
+	obs_enum_sources(add_source_to_list, roi_mask);
+	obs_enum_scenes(add_source_to_list, roi_mask);
+	obs_property_set_long_description(
+		roi_mask,
+		obs_module_text("CompositeBlurFilter.Roi.Mask.Description"));
+	obs_properties_add_float_slider(
+		roi, "roi_mask_threshold",
+		obs_module_text("CompositeBlurFilter.Roi.MaskThreshold"), 0.0,
+		1.0, 0.01);
+
+	obs_properties_add_group(props, "roi_enabled",
+				 obs_module_text("CompositeBlurFilter.Roi"),
+				 OBS_GROUP_CHECKABLE, roi);
+
+	obs_property_t *precision = obs_properties_add_list(
+		props, "precision",
+		obs_module_text("CompositeBlurFilter.Precision"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(precision,
+				  obs_module_text(PRECISION_AUTO_LABEL),
+				  PRECISION_AUTO);
+	obs_property_list_add_int(precision,
+				  obs_module_text(PRECISION_8BIT_LABEL),
+				  PRECISION_8BIT);
+	obs_property_list_add_int(precision,
+				  obs_module_text(PRECISION_10BIT_LABEL),
+				  PRECISION_10BIT);
+	obs_property_list_add_int(precision,
+				  obs_module_text(PRECISION_16F_LABEL),
+				  PRECISION_16F);
+	obs_property_set_long_description(
+		precision,
+		obs_module_text("CompositeBlurFilter.Precision.Description"));
+
+	obs_property_t *skip_unchanged = obs_properties_add_bool(
+		props, "skip_unchanged",
+		obs_module_text("CompositeBlurFilter.SkipUnchanged"));
+	obs_property_set_long_description(
+		skip_unchanged,
+		obs_module_text("CompositeBlurFilter.SkipUnchanged.Description"));
+
 	return props;
 }
 
+static void composite_blur_defaults(obs_data_t *settings)
+{
+	roi_defaults(settings);
+}
+
 static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 					    obs_property_t *p,
 					    obs_data_t *settings)
@@ -329,8 +665,24 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		break;
 	case ALGO_KAWASE:
 		setting_visibility("passes", false, props);
+		set_kawase_blur_types(props);
+		break;
+	case ALGO_RECURSIVE:
+		setting_visibility("passes", false, props);
+		set_recursive_blur_types(props);
+		break;
+	case ALGO_TEMPORAL:
+		setting_visibility("passes", false, props);
+		set_temporal_blur_types(props);
 		break;
 	}
+	// The recursive gaussian is not limited by a kernel size.
+	obs_property_float_set_limits(obs_properties_get(props, "radius"), 0.0,
+				      blur_algorithm == ALGO_RECURSIVE
+					      ? RECURSIVE_RADIUS_MAX
+					      : RADIUS_MAX,
+				      0.1);
+	setting_downsample_visibility(props, settings);
 	return true;
 }
 
@@ -339,7 +691,10 @@ static bool setting_blur_types_modified(void *data, obs_properties_t *props,
 {
 	struct composite_blur_filter_data *filter = data;
 	int blur_type = (int)obs_data_get_int(settings, "blur_type");
-	if (blur_type == TYPE_AREA) {
+	setting_downsample_visibility(props, settings);
+	if (obs_data_get_int(settings, "blur_algorithm") == ALGO_TEMPORAL) {
+		return settings_blur_temporal(props);
+	} else if (blur_type == TYPE_AREA) {
 		return settings_blur_area(props);
 	} else if (blur_type == TYPE_DIRECTIONAL) {
 		return settings_blur_directional(props);
@@ -361,6 +716,21 @@ static void setting_visibility(const char *prop_name, bool visible,
 	obs_property_set_visible(p, visible);
 }
 
+// Downsampling is offered for gaussian and box area blurs.  Kawase
+// already works on a pyramid.
+static void setting_downsample_visibility(obs_properties_t *props,
+					  obs_data_t *settings)
+{
+	const int blur_algorithm =
+		(int)obs_data_get_int(settings, "blur_algorithm");
+	const int blur_type = (int)obs_data_get_int(settings, "blur_type");
+	setting_visibility("downsample_quality",
+			   blur_type == TYPE_AREA &&
+				   (blur_algorithm == ALGO_GAUSSIAN ||
+				    blur_algorithm == ALGO_BOX),
+			   props);
+}
+
 static bool settings_blur_area(obs_properties_t *props)
 {
 	setting_visibility("radius", true, props);
@@ -368,6 +738,7 @@ static bool settings_blur_area(obs_properties_t *props)
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
+	setting_visibility("temporal", false, props);
 	return true;
 }
 
@@ -378,6 +749,7 @@ static bool settings_blur_directional(obs_properties_t *props)
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
+	setting_visibility("temporal", false, props);
 	return true;
 }
 
@@ -388,6 +760,7 @@ static bool settings_blur_zoom(obs_properties_t *props)
 	setting_visibility("center_coordinate", true, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
+	setting_visibility("temporal", false, props);
 	return true;
 }
 
@@ -398,6 +771,20 @@ static bool settings_blur_tilt_shift(obs_properties_t *props)
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", true, props);
+	setting_visibility("temporal", false, props);
+	return true;
+}
+
+// The trail replaces the radius, a frame is blurred with the ones
+// before it.
+static bool settings_blur_temporal(obs_properties_t *props)
+{
+	setting_visibility("radius", false, props);
+	setting_visibility("angle", false, props);
+	setting_visibility("center_coordinate", false, props);
+	setting_visibility("background", true, props);
+	setting_visibility("tilt_shift_bounds", false, props);
+	setting_visibility("temporal", true, props);
 	return true;
 }
 
@@ -408,149 +795,270 @@ static void composite_blur_video_tick(void *data, float seconds)
 	if (!target) {
 		return;
 	}
-	filter->width = (uint32_t)obs_source_get_base_width(target);
-	filter->height = (uint32_t)obs_source_get_base_height(target);
+	const uint32_t width = (uint32_t)obs_source_get_base_width(target);
+	const uint32_t height = (uint32_t)obs_source_get_base_height(target);
+	if (width != filter->width || height != filter->height) {
+		filter->settings_generation++;
+	}
+	filter->width = width;
+	filter->height = height;
 	filter->uv_size.x = (float)filter->width;
 	filter->uv_size.y = (float)filter->height;
+	temporal_video_tick(filter);
+}
+
+// The blur hands on its frame in the space it works in, libobs converts
+// from there to the space the caller prefers.
+static enum gs_color_space
+composite_blur_get_color_space(void *data, size_t count,
+			       const enum gs_color_space *preferred_spaces)
+{
+	UNUSED_PARAMETER(count);
+	UNUSED_PARAMETER(preferred_spaces);
+	struct composite_blur_filter_data *filter = data;
+	return intermediate_space(filter->precision,
+				  source_color_space(filter));
 }
 
 static void
 composite_blur_reload_effect(struct composite_blur_filter_data *filter)
 {
-	obs_log(LOG_INFO, "Reload...");
-	filter->reload = false;
-	obs_data_t *settings = obs_source_get_settings(filter->context);
-	filter->param_uv_size = NULL;
-
 	if (filter->blur_algorithm == ALGO_GAUSSIAN) {
 		gaussian_setup_callbacks(filter);
 	} else if (filter->blur_algorithm == ALGO_BOX) {
 		box_setup_callbacks(filter);
+	} else if (filter->blur_algorithm == ALGO_KAWASE) {
+		kawase_setup_callbacks(filter);
+	} else if (filter->blur_algorithm == ALGO_RECURSIVE) {
+		recursive_setup_callbacks(filter);
+	} else if (filter->blur_algorithm == ALGO_TEMPORAL) {
+		temporal_setup_callbacks(filter);
 	}
 
 	if (filter->load_effect) {
 		filter->load_effect(filter);
 		load_composite_effect(filter);
+		load_roi_effect(filter);
+		filter->fingerprint_effect = load_shader_effect(
+			filter->fingerprint_effect, "/shaders/fingerprint.effect");
+		filter->fingerprint_params =
+			effect_cache_get_params(filter->fingerprint_effect);
 	}
-
-	obs_data_release(settings);
 }
 
 static void load_composite_effect(struct composite_blur_filter_data *filter)
 {
-	if (filter->composite_effect != NULL) {
-		obs_enter_graphics();
-		gs_effect_destroy(filter->composite_effect);
-		filter->composite_effect = NULL;
-		obs_leave_graphics();
+	filter->composite_effect = load_shader_effect(
+		filter->composite_effect, "/shaders/composite.effect");
+	filter->composite_params =
+		effect_cache_get_params(filter->composite_effect);
+}
+
+/*
+ *  Texture of the background source in the current frame, rendered once
+ *  per frame for every filter using that source.  NULL when there is no
+ *  background.  The blurs composite the input over it in the first pass
+ *  that reads the input, see composite_bind.
+ */
+gs_texture_t *composite_background(struct composite_blur_filter_data *filter)
+{
+	obs_source_t *source = source_ref_get(&filter->background);
+	if (!source) {
+		return NULL;
 	}
 
-	char *shader_text = NULL;
-	struct dstr filename = {0};
-	dstr_cat(&filename, obs_get_module_data_path(obs_current_module()));
-	dstr_cat(&filename, "/shaders/composite.effect");
-	shader_text = load_shader_from_file(filename.array);
-	char *errors = NULL;
+	gs_texture_t *texture = background_cache_render(source, filter->space);
+	obs_source_release(source);
+	return texture;
+}
 
-	obs_enter_graphics();
-	filter->composite_effect = gs_effect_create(shader_text, NULL, &errors);
-	obs_leave_graphics();
+/*
+ *  True when output_texrender already holds this frame: it was rendered
+ *  with the current settings, and neither the input nor the background
+ *  hash changed.  Both hashes are updated on every call, so they stay
+ *  current across frames that do render.
+ */
+static bool frame_unchanged(struct composite_blur_filter_data *filter)
+{
+	if (!filter->skip_unchanged || !filter->fingerprint_effect) {
+		frame_fingerprint_reset(&filter->input_fingerprint);
+		frame_fingerprint_reset(&filter->background_fingerprint);
+		return false;
+	}
 
-	bfree(shader_text);
-	if (filter->composite_effect == NULL) {
-		obs_log(LOG_WARNING,
-			"[obs-composite-blur] Unable to load composite.effect file.  Errors:\n%s",
-			(errors == NULL || strlen(errors) == 0 ? "(None)"
-							       : errors));
-		bfree(errors);
-	} else {
-		size_t effect_count =
-			gs_effect_get_num_params(filter->composite_effect);
-		for (size_t effect_index = 0; effect_index < effect_count;
-		     effect_index++) {
-			gs_eparam_t *param = gs_effect_get_param_by_idx(
-				filter->composite_effect, effect_index);
-			struct gs_effect_param_info info;
-			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "background") == 0) {
-				filter->param_background = param;
-			}
+	bool changed = !filter->output_texrender ||
+		       filter->rendered_generation !=
+			       filter->settings_generation;
+
+	gs_texture_t *input = gs_texrender_get_texture(filter->input_texrender);
+	bool input_changed = frame_fingerprint_update(
+		&filter->input_fingerprint, filter->fingerprint_effect,
+		filter->fingerprint_params, input);
+
+	// The blur gets the same render from the background cache.
+	gs_texture_t *background = composite_background(filter);
+	if (background) {
+		if (frame_fingerprint_update(&filter->background_fingerprint,
+					     filter->fingerprint_effect,
+					     filter->fingerprint_params,
+					     background)) {
+			input_changed = true;
 		}
+	} else {
+		frame_fingerprint_reset(&filter->background_fingerprint);
+	}
+
+	// A temporal trail keeps moving toward a still input until the
+	// frames before it have left the trail.
+	if (input_changed || !temporal_settled(filter, input_changed)) {
+		changed = true;
 	}
+
+	return !changed;
 }
 
-gs_texture_t *blend_composite(gs_texture_t *texture,
-			      struct composite_blur_filter_data *data)
-{
-	// Get source
-	obs_source_t *source =
-		data->background ? obs_weak_source_get_source(data->background)
-				 : NULL;
-
-	gs_effect_t *composite_effect = data->composite_effect;
-	if (source) {
-		const enum gs_color_space preferred_spaces[] = {
-			GS_CS_SRGB,
-			GS_CS_SRGB_16F,
-			GS_CS_709_EXTENDED,
-		};
-		const enum gs_color_space space = obs_source_get_color_space(
-			source, OBS_COUNTOF(preferred_spaces),
-			preferred_spaces);
-		const enum gs_color_format format =
-			gs_get_format_from_space(space);
-
-		// Set up a tex renderer for source
-		gs_texrender_t *source_render =
-			gs_texrender_create(format, GS_ZS_NONE);
-		uint32_t base_width = obs_source_get_base_width(source);
-		uint32_t base_height = obs_source_get_base_height(source);
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		if (gs_texrender_begin_with_color_space(
-			    source_render, base_width, base_height, space)) {
-			const float w = (float)base_width;
-			const float h = (float)base_height;
-			uint32_t flags = obs_source_get_output_flags(source);
-			const bool custom_draw =
-				(flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
-			const bool async = (flags & OBS_SOURCE_ASYNC) != 0;
-			struct vec4 clear_color;
-
-			vec4_zero(&clear_color);
-			gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
-			gs_ortho(0.0f, w, 0.0f, h, -100.0f, 100.0f);
-
-			if (!custom_draw && !async)
-				obs_source_default_render(source);
-			else
-				obs_source_video_render(source);
-			gs_texrender_end(source_render);
-		}
-		gs_blend_state_pop();
-		obs_source_release(source);
-		gs_texture_t *tex = gs_texrender_get_texture(source_render);
-
-		gs_eparam_t *background = gs_effect_get_param_by_name(
-			composite_effect, "background");
-		gs_effect_set_texture(background, tex);
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(composite_effect, "image");
-		gs_effect_set_texture(image, texture);
+static enum gs_color_space
+source_color_space(const struct composite_blur_filter_data *filter)
+{
+	const enum gs_color_space preferred_spaces[] = {
+		GS_CS_SRGB,
+		GS_CS_SRGB_16F,
+		GS_CS_709_EXTENDED,
+	};
+	obs_source_t *target = obs_filter_get_target(filter->context);
+	if (!target) {
+		return GS_CS_SRGB;
+	}
+	return obs_source_get_color_space(
+		target, OBS_COUNTOF(preferred_spaces), preferred_spaces);
+}
 
-		data->composite_render =
-			create_or_reset_texrender(data->composite_render);
-		set_blending_parameters();
-		if (gs_texrender_begin(data->composite_render, data->width,
-				       data->height)) {
-			while (gs_effect_loop(composite_effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->composite_render);
-		}
-		texture = gs_texrender_get_texture(data->composite_render);
-		gs_texrender_destroy(source_render);
-		gs_blend_state_pop();
+/*
+ *  Color space the blur works in for a source in `source_space`.  The 8
+ *  and 10 bit precisions have libobs convert HDR sources to SDR.  Half
+ *  float keeps the range of HDR sources, and SDR sources are blurred in
+ *  linear light.
+ */
+static enum gs_color_space intermediate_space(int precision,
+					      enum gs_color_space source_space)
+{
+	switch (precision) {
+	case PRECISION_8BIT:
+	case PRECISION_10BIT:
+		return GS_CS_SRGB;
+	case PRECISION_16F:
+		return source_space == GS_CS_SRGB ? GS_CS_SRGB_16F
+						  : source_space;
+	default:
+		return source_space;
 	}
-	return texture;
-}
\ No newline at end of file
+}
+
+/*
+ *  Picks this frame's format and color space for the input capture and
+ *  the passes.  A change renders the frame again, output_texrender holds
+ *  the old format.
+ */
+static void negotiate_format(struct composite_blur_filter_data *filter)
+{
+	const enum gs_color_space space =
+		intermediate_space(filter->precision,
+				   source_color_space(filter));
+	const enum gs_color_format format =
+		filter->precision == PRECISION_10BIT
+			? GS_R10G10B10A2
+			: gs_get_format_from_space(space);
+	if (format != filter->format || space != filter->space) {
+		filter->settings_generation++;
+	}
+	filter->format = format;
+	filter->space = space;
+}
+
+/*
+ *  Whether the blurred frame has to stay in output_texrender after it is
+ *  drawn: to show it again on unchanged frames, to blend it with the
+ *  input around a region of interest, or as the temporal accumulator.
+ */
+static bool output_kept(const struct composite_blur_filter_data *filter)
+{
+	return filter->skip_unchanged || filter->roi_enabled ||
+	       filter->blur_algorithm == ALGO_TEMPORAL;
+}
+
+// Target of the last blur pass- output_texrender, reset, or NULL when
+// the pass draws straight into the filter's target.
+gs_texrender_t *output_target(struct composite_blur_filter_data *data)
+{
+	if (data->output_direct) {
+		return NULL;
+	}
+	data->output_texrender =
+		create_or_reset_texrender(data->output_texrender, data->format);
+	return data->output_texrender;
+}
+
+/*
+ *  Begins a pass into `target`, or into the filter's target for NULL.
+ *  Passes run with set_blending_parameters pushed, the filter's target
+ *  gets the blend state underneath it, the one the output would have
+ *  been drawn with.  Ends with target_end when this returns true.
+ */
+bool target_begin(gs_texrender_t *target, uint32_t width, uint32_t height)
+{
+	if (target) {
+		return gs_texrender_begin(target, width, height);
+	}
+	gs_blend_state_pop();
+	gs_blend_state_push();
+	return true;
+}
+
+void target_end(gs_texrender_t *target)
+{
+	if (target) {
+		gs_texrender_end(target);
+		return;
+	}
+	gs_reset_blend_state();
+	gs_enable_blending(false);
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+}
+
+// Sets the composite_input.inc uniforms of a pass reading `input`.  A
+// NULL background turns compositing off, for the passes that no longer
+// read the input, and `input` may then be NULL.
+void composite_bind(struct effect_params *params, gs_texture_t *background,
+		    gs_texture_t *input)
+{
+	effect_params_set_texture(params, EFFECT_PARAM_BACKGROUND, background);
+	effect_params_set_int(params, EFFECT_PARAM_COMPOSITE_BACKGROUND,
+			      background ? 1 : 0);
+	if (background && input) {
+		struct vec2 size;
+		size.x = (float)gs_texture_get_width(input);
+		size.y = (float)gs_texture_get_height(input);
+		effect_params_set_vec2(params, EFFECT_PARAM_INPUT_SIZE, &size);
+	}
+}
+
+/*
+ *  Effect for a pass that only copies or resizes `texture`, compositing
+ *  it over `background` on the way when there is one.
+ */
+gs_effect_t *composite_copy_effect(struct composite_blur_filter_data *data,
+				   gs_texture_t *texture,
+				   gs_texture_t *background)
+{
+	gs_effect_t *effect = data->composite_effect;
+	if (!effect) {
+		effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+		gs_effect_set_texture(image, texture);
+		return effect;
+	}
+	effect_params_set_texture(data->composite_params, EFFECT_PARAM_IMAGE,
+				  texture);
+	composite_bind(data->composite_params, background, texture);
+	return effect;
+}
@@ -10,8 +10,20 @@
 #include <stdio.h>
 
 #include "obs-utils.h"
+#include "effect-cache.h"
+#include "texrender-pool.h"
+#include "background-cache.h"
+#include "source-ref.h"
+#include "settings-buffer.h"
+#include "frame-fingerprint.h"
+#include "roi.h"
 #include "blur/gaussian.h"
 #include "blur/box.h"
+#include "blur/kawase.h"
+#include "blur/kawase-kernel.h"
+#include "blur/recursive.h"
+#include "blur/recursive-kernel.h"
+#include "blur/temporal.h"
 
 #define ALGO_NONE 0
 #define ALGO_NONE_LABEL "None"
@@ -21,6 +33,15 @@
 #define ALGO_BOX_LABEL "CompositeBlurFilter.Algorithm.Box"
 #define ALGO_KAWASE 3
 #define ALGO_KAWASE_LABEL "CompositeBlurFilter.Algorithm.Kawase"
+#define ALGO_RECURSIVE 4
+#define ALGO_RECURSIVE_LABEL "CompositeBlurFilter.Algorithm.Recursive"
+#define ALGO_TEMPORAL 5
+#define ALGO_TEMPORAL_LABEL "CompositeBlurFilter.Algorithm.Temporal"
+
+// Radius slider range.  The kernel based algorithms top out where the
+// gaussian kernel reaches GAUSSIAN_KERNEL_MAX_RADIUS.
+#define RADIUS_MAX 83.0
+#define RECURSIVE_RADIUS_MAX 500.0
 
 #define TYPE_NONE 0
 #define TYPE_NONE_LABEL "None"
@@ -35,6 +56,28 @@
 #define TYPE_TILTSHIFT 5
 #define TYPE_TILTSHIFT_LABEL "CompositeBlurFilter.Type.TiltShift"
 
+#define DOWNSAMPLE_OFF_LABEL "CompositeBlurFilter.Downsample.Off"
+#define DOWNSAMPLE_HIGH_LABEL "CompositeBlurFilter.Downsample.High"
+#define DOWNSAMPLE_BALANCED_LABEL "CompositeBlurFilter.Downsample.Balanced"
+#define DOWNSAMPLE_PERFORMANCE_LABEL \
+	"CompositeBlurFilter.Downsample.Performance"
+
+#define TEMPORAL_MODE_BOX_LABEL "CompositeBlurFilter.Temporal.Mode.Box"
+#define TEMPORAL_MODE_EXPONENTIAL_LABEL \
+	"CompositeBlurFilter.Temporal.Mode.Exponential"
+
+// Values of the "precision" setting, the format the input is captured
+// and blurred in.  Auto keeps SDR sources in 8 bits and HDR sources in
+// half float.
+#define PRECISION_AUTO 0
+#define PRECISION_AUTO_LABEL "CompositeBlurFilter.Precision.Auto"
+#define PRECISION_8BIT 1
+#define PRECISION_8BIT_LABEL "CompositeBlurFilter.Precision.8Bit"
+#define PRECISION_10BIT 2
+#define PRECISION_10BIT_LABEL "CompositeBlurFilter.Precision.10Bit"
+#define PRECISION_16F 3
+#define PRECISION_16F_LABEL "CompositeBlurFilter.Precision.16F"
+
 typedef DARRAY(float) fDarray;
 
 struct composite_blur_filter_data {
@@ -42,51 +85,114 @@ struct composite_blur_filter_data {
 
 	// Effects
 	gs_effect_t *effect;
+	gs_effect_t *effect_2;
+	gs_effect_t *effect_3;
 	gs_effect_t *composite_effect;
+	gs_effect_t *fingerprint_effect;
 
 	// Render pipeline
 	bool input_rendered;
 	gs_texrender_t *input_texrender;
 	bool output_rendered;
 	gs_texrender_t *output_texrender;
+	// This frame's last blur pass draws straight into the filter's
+	// target, output_texrender is only rendered when the output is kept.
+	bool output_direct;
+	// PRECISION_* setting, and the format and color space the input is
+	// captured and blurred in, negotiated with the source every frame.
+	int precision;
+	enum gs_color_format format;
+	enum gs_color_space space;
 
 	gs_texrender_t *render;
-	gs_texrender_t *render2;
-	gs_texrender_t *composite_render;
 
-	gs_eparam_t *param_uv_size;
-	gs_eparam_t *param_dir;
-	gs_eparam_t *param_radius;
-	gs_eparam_t *param_background;
+	// Binding tables of the effects, shared through the effect cache
+	struct effect_params *params;
+	struct effect_params *params_2;
+	struct effect_params *params_3;
+	struct effect_params *composite_params;
+	struct effect_params *fingerprint_params;
 
 	bool rendering;
-	bool reload;
 
 	struct vec2 uv_size;
 
+	// Settings as composite_blur_update last read them, only touched by
+	// the thread calling it, and the snapshots it publishes.  The render
+	// thread copies the newest snapshot into the settings below at the
+	// start of a frame, nothing else writes them.
+	struct blur_settings updated;
+	struct settings_buffer snapshots;
+
 	float center_x;
 	float center_y;
 
 	float radius;
-	float radius_last;
 	float angle;
 	float tilt_shift_bottom;
 	float tilt_shift_top;
 	int blur_algorithm;
-	int blur_algorithm_last;
 	int blur_type;
-	int blur_type_last;
 	int passes;
-	obs_weak_source_t *background;
+	int downsample_quality;
+	struct source_ref background;
 	uint32_t width;
 	uint32_t height;
 
-	// Gaussian Kernel
-	fDarray kernel;
-	fDarray offset;
-	size_t kernel_size;
+	// Gaussian kernel of the applied snapshot, which holds the reference,
+	// and the gaussian_1d.effect variant the effect was loaded for.
+	const struct kernel_cache_entry *kernel;
+	size_t kernel_variant;
+	// Kernel of a downsampled area blur, owned by the render thread
+	const struct kernel_cache_entry *reduced_kernel;
+	float reduced_radius;
+	// Zoom passes for the current settings, owned by the render thread
+	struct zoom_state zoom;
+
+	// Recursive gaussian coefficients for the current radius
+	struct recursive_gaussian recursive;
+
+	// Temporal trail length in frames, TEMPORAL_MODE_* and the ring
+	// memory limit in MB, and the trail itself.
+	int temporal_frames;
+	int temporal_mode;
+	int temporal_memory;
+	struct temporal_trail temporal;
+
+	// Reuse of output_texrender while the input, background and settings
+	// stay the same.  settings_generation counts applied snapshots, size
+	// and format changes, rendered_generation is the one output_texrender
+	// shows.
+	bool skip_unchanged;
+	uint64_t settings_generation;
+	uint64_t rendered_generation;
+	struct frame_fingerprint input_fingerprint;
+	struct frame_fingerprint background_fingerprint;
+	uint64_t frames_reused;
+	uint64_t frames_rendered;
+
+	// Calls to composite_blur_update and the settings they changed.  The
+	// source references count their own lookups by name.
+	uint64_t updates;
+	uint64_t settings_changed;
+
+	// Region of interest in source pixels.  Outside it the input shows
+	// through, and blurs of bounded reach only shade the region plus
+	// the pixels it reads, roi_scissor_rect, during their passes.
+	// roi_frame is the region clamped to this frame.
+	bool roi_enabled;
+	struct gs_rect roi;
+	bool roi_masked;
+	struct source_ref roi_mask;
+	float roi_mask_threshold;
+	struct gs_rect roi_frame;
+	bool roi_scissor;
+	struct gs_rect roi_scissor_rect;
+	gs_effect_t *roi_effect;
+	struct effect_params *roi_params;
 
-	// Callback Functions
+	// Callback Functions.  update runs on the render thread when it has
+	// applied new settings.
 	void (*video_render)(struct composite_blur_filter_data *filter);
 	void (*load_effect)(struct composite_blur_filter_data *filter);
 	void (*update)(struct composite_blur_filter_data *filter);
@@ -100,12 +206,37 @@ static uint32_t composite_blur_height(void *data);
 static void composite_blur_update(void *data, obs_data_t *settings);
 static void composite_blur_video_render(void *data, gs_effect_t *effect);
 static void composite_blur_video_tick(void *data, float seconds);
+static void composite_blur_source_renamed(void *data, calldata_t *cd);
+static void composite_blur_source_removed(void *data, calldata_t *cd);
+static void composite_blur_source_created(void *data, calldata_t *cd);
+static enum gs_color_space
+composite_blur_get_color_space(void *data, size_t count,
+			       const enum gs_color_space *preferred_spaces);
 static obs_properties_t *composite_blur_properties(void *data);
+static void composite_blur_defaults(obs_data_t *settings);
 static void
 composite_blur_reload_effect(struct composite_blur_filter_data *filter);
 static void load_composite_effect(struct composite_blur_filter_data *filter);
-extern gs_texture_t *blend_composite(gs_texture_t *texture,
-				     struct composite_blur_filter_data *data);
+static bool frame_unchanged(struct composite_blur_filter_data *filter);
+static enum gs_color_space
+source_color_space(const struct composite_blur_filter_data *filter);
+static enum gs_color_space intermediate_space(int precision,
+					      enum gs_color_space source_space);
+static void negotiate_format(struct composite_blur_filter_data *filter);
+static void publish_settings(struct composite_blur_filter_data *filter);
+static void apply_settings(struct composite_blur_filter_data *filter);
+extern gs_texture_t *
+composite_background(struct composite_blur_filter_data *filter);
+extern void composite_bind(struct effect_params *params,
+			   gs_texture_t *background, gs_texture_t *input);
+extern gs_effect_t *
+composite_copy_effect(struct composite_blur_filter_data *data,
+		      gs_texture_t *texture, gs_texture_t *background);
+static bool output_kept(const struct composite_blur_filter_data *filter);
+extern gs_texrender_t *output_target(struct composite_blur_filter_data *data);
+extern bool target_begin(gs_texrender_t *target, uint32_t width,
+			 uint32_t height);
+extern void target_end(gs_texrender_t *target);
 
 static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 					    obs_property_t *p,
@@ -116,7 +247,10 @@ static bool setting_blur_types_modified(void *data, obs_properties_t *props,
 					obs_data_t *settings);
 static void setting_visibility(const char *prop_name, bool visible,
 			       obs_properties_t *props);
+static void setting_downsample_visibility(obs_properties_t *props,
+					  obs_data_t *settings);
 static bool settings_blur_area(obs_properties_t *props);
 static bool settings_blur_directional(obs_properties_t *props);
 static bool settings_blur_zoom(obs_properties_t *props);
-static bool settings_blur_tilt_shift(obs_properties_t *props);
\ No newline at end of file
+static bool settings_blur_tilt_shift(obs_properties_t *props);
+static bool settings_blur_temporal(obs_properties_t *props);
\ No newline at end of file
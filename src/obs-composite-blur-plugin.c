@@ -1,5 +1,10 @@
 #include <obs-module.h>
 #include <plugin-support.h>
+#include "blur/kernel-cache.h"
+#include "background-cache.h"
+#include "effect-cache.h"
+#include "shader-preprocessor.h"
+#include "texrender-pool.h"
 
 extern struct obs_source_info obs_composite_blur;
 
@@ -14,9 +19,20 @@ bool obs_module_load(void)
 	const char *root_path = obs_get_module_data_path(obs_current_module());
 	obs_log(LOG_INFO, "Loaded- Composite Blur Plugin (version %s)",
 		PLUGIN_VERSION);
+	char *shader_cache_dir = obs_module_config_path("shader-cache");
+	shader_preprocessor_init(shader_cache_dir);
+	bfree(shader_cache_dir);
+
 	obs_register_source(&obs_composite_blur);
 
 	return true;
 }
 
-void obs_module_unload(void) {}
+void obs_module_unload(void)
+{
+	effect_cache_free();
+	texrender_pool_free();
+	background_cache_free();
+	shader_preprocessor_free();
+	kernel_cache_clear();
+}
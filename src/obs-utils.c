@@ -1,15 +1,43 @@
 #include <obs-utils.h>
+#include "effect-cache.h"
+#include "shader-preprocessor.h"
 
-gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render)
+gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render,
+					  enum gs_color_format format)
 {
+	if (render && gs_texrender_get_format(render) != format) {
+		gs_texrender_destroy(render);
+		render = NULL;
+	}
 	if (!render) {
-		render = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+		render = gs_texrender_create(format, GS_ZS_NONE);
 	} else {
 		gs_texrender_reset(render);
 	}
 	return render;
 }
 
+bool update_int(int *field, int value)
+{
+	const bool changed = *field != value;
+	*field = value;
+	return changed;
+}
+
+bool update_float(float *field, float value)
+{
+	const bool changed = *field != value;
+	*field = value;
+	return changed;
+}
+
+bool update_bool(bool *field, bool value)
+{
+	const bool changed = *field != value;
+	*field = value;
+	return changed;
+}
+
 void set_blending_parameters()
 {
 	gs_blend_state_push();
@@ -45,82 +73,26 @@ bool add_source_to_list(void *data, obs_source_t *source)
 	return true;
 }
 
-// Loads the shader file at `effect_file_path` into *effect
+// Swaps `effect` for the shared effect compiled from `effect_file_path`
 gs_effect_t *load_shader_effect(gs_effect_t *effect,
 				const char *effect_file_path)
 {
-	if (effect != NULL) {
-		obs_enter_graphics();
-		gs_effect_destroy(effect);
-		effect = NULL;
-		obs_leave_graphics();
-	}
-	char *shader_text = NULL;
-	struct dstr filename = {0};
-	dstr_cat(&filename, obs_get_module_data_path(obs_current_module()));
-	dstr_cat(&filename, effect_file_path);
-	shader_text = load_shader_from_file(filename.array);
-	char *errors = NULL;
-
-	obs_enter_graphics();
-	effect = gs_effect_create(shader_text, NULL, &errors);
-	obs_leave_graphics();
-
-	bfree(shader_text);
-
-	if (effect == NULL) {
-		obs_log(LOG_WARNING,
-			"[obs-composite-blur] Unable to load .effect file.  Errors:\n%s",
-			(errors == NULL || strlen(errors) == 0 ? "(None)"
-							       : errors));
-		bfree(errors);
-	}
+	return load_shader_effect_defines(effect, effect_file_path, NULL);
+}
 
-	return effect;
+// Same, with `defines` prepended as for effect_cache_acquire.
+gs_effect_t *load_shader_effect_defines(gs_effect_t *effect,
+					const char *effect_file_path,
+					const char *defines)
+{
+	// Acquire before releasing, so reloading the same file reuses it.
+	gs_effect_t *loaded = effect_cache_acquire(effect_file_path, defines);
+	effect_cache_release(effect);
+	return loaded;
 }
 
 // Performs loading of shader from file.  Properly includes #include directives.
 char *load_shader_from_file(const char *file_name)
 {
-	char *file_ptr = os_quick_read_utf8_file(file_name);
-	if (file_ptr == NULL)
-		return NULL;
-	char *file = bstrdup(os_quick_read_utf8_file(file_name));
-	char **lines = strlist_split(file, '\n', true);
-	struct dstr shader_file;
-	dstr_init(&shader_file);
-
-	size_t line_i = 0;
-	while (lines[line_i] != NULL) {
-		char *line = lines[line_i];
-		line_i++;
-		if (strncmp(line, "#include", 8) == 0) {
-			// Open the included file, place contents here.
-			char *pos = strrchr(file_name, '/');
-			const size_t length = pos - file_name + 1;
-			struct dstr include_path = {0};
-			dstr_ncopy(&include_path, file_name, length);
-			char *start = strchr(line, '"') + 1;
-			char *end = strrchr(line, '"');
-
-			dstr_ncat(&include_path, start, end - start);
-			char *abs_include_path =
-				os_get_abs_path_ptr(include_path.array);
-			char *file_contents =
-				load_shader_from_file(abs_include_path);
-			dstr_cat(&shader_file, file_contents);
-			dstr_cat(&shader_file, "\n");
-			bfree(abs_include_path);
-			bfree(file_contents);
-			dstr_free(&include_path);
-		} else {
-			// else place current line here.
-			dstr_cat(&shader_file, line);
-			dstr_cat(&shader_file, "\n");
-		}
-	}
-
-	bfree(file);
-	strlist_free(lines);
-	return shader_file.array;
-}
\ No newline at end of file
+	return shader_preprocess(file_name, NULL);
+}
@@ -8,10 +8,20 @@
 
 #include <stdio.h>
 
-extern gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render);
+// Resets `render`, or replaces it with a new texrender when it is NULL or
+// of another format.
+extern gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render,
+						 enum gs_color_format format);
+// Store a setting and return whether it differs from the value before.
+extern bool update_int(int *field, int value);
+extern bool update_float(float *field, float value);
+extern bool update_bool(bool *field, bool value);
 extern void set_blending_parameters();
 extern void set_render_parameters();
 extern bool add_source_to_list(void *data, obs_source_t *source);
 gs_effect_t *load_shader_effect(gs_effect_t *effect,
 				const char *effect_file_path);
+gs_effect_t *load_shader_effect_defines(gs_effect_t *effect,
+					const char *effect_file_path,
+					const char *defines);
 extern char *load_shader_from_file(const char *file_name);
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CPU reference implementations of the blur shaders.  These mirror the
+// sampling behavior of the .effect files (linear filtering, clamped
+// addressing, texel centers at 0.5) so that GPU output can be checked
+// without a graphics device.
+
+// Algorithm and type values match ALGO_* and TYPE_* in
+// obs-composite-blur-filter.h, so filter settings pass straight through.
+enum blur_reference_algorithm {
+	BLUR_ALGO_GAUSSIAN = 1,
+	BLUR_ALGO_BOX = 2,
+	BLUR_ALGO_KAWASE = 3,
+	BLUR_ALGO_RECURSIVE = 4,
+	BLUR_ALGO_TEMPORAL = 5,
+};
+
+enum blur_reference_type {
+	BLUR_TYPE_AREA = 1,
+	BLUR_TYPE_DIRECTIONAL = 2,
+	BLUR_TYPE_ZOOM = 3,
+	BLUR_TYPE_MOTION = 4,
+	BLUR_TYPE_TILTSHIFT = 5,
+};
+
+// Same fields, units and ranges as the filter settings.
+struct blur_reference_params {
+	int blur_algorithm;
+	int blur_type;
+	float radius;
+	int passes;
+	float angle;
+	float center_x;
+	float center_y;
+	float tilt_shift_top;
+	float tilt_shift_bottom;
+	// DOWNSAMPLE_QUALITY_* from blur/downsample-kernel.h, area blurs
+	// only.  0 blurs at full resolution.
+	int downsample_quality;
+	// Temporal trails: frames in the trail, TEMPORAL_MODE_* from
+	// blur/temporal-kernel.h, and the ring memory limit in MB, 0 for
+	// the default.
+	int temporal_frames;
+	int temporal_mode;
+	int temporal_memory;
+	// Zoom blurs as one pass gathering every tap of the kernel, the way
+	// the filter rendered them before zoom_pass.effect.  Only used to
+	// measure the passes against.
+	bool zoom_gather;
+	// Box passes sampling every whole texel tap, the way box_1d.effect
+	// and box_tiltshift.effect did before pairing them.  Only used to
+	// measure the paired taps against.
+	bool box_unpaired;
+};
+
+// Estimated GPU cost of one filter frame.
+struct blur_reference_cost {
+	// Texture fetches per output pixel, summed across all passes.
+	double samples_per_pixel;
+	// Render target passes done by the blur itself.
+	int blur_passes;
+	// blur_passes plus the input capture, less the last blur pass when
+	// it draws straight into the parent target.
+	int texrender_passes;
+	// One per texrender pass, plus the final draw to the parent target
+	// and the second draw of passes split around a tilt-shift band.
+	int draws;
+};
+
+// RGBA image with 4 floats per pixel, stored row-major.
+struct blur_image {
+	uint32_t width;
+	uint32_t height;
+	float *data;
+};
+
+extern bool blur_image_init(struct blur_image *image, uint32_t width,
+			    uint32_t height);
+extern void blur_image_free(struct blur_image *image);
+extern bool blur_image_copy(struct blur_image *dst,
+			    const struct blur_image *src);
+extern void blur_image_sample(const struct blur_image *image, float u,
+			      float v, float *color);
+extern bool blur_image_from_rgba8(struct blur_image *image,
+				  const uint8_t *pixels, uint32_t width,
+				  uint32_t height, uint32_t linesize);
+extern void blur_image_to_rgba8(const struct blur_image *image,
+				uint8_t *pixels, uint32_t linesize);
+extern double blur_image_max_error(const struct blur_image *a,
+				   const struct blur_image *b);
+extern double blur_image_rms_error(const struct blur_image *a,
+				   const struct blur_image *b);
+
+// Renders `src` through the algorithm/type selected in `params`, the same
+// way the filter would.  `dst` is resized to match `src` and must not alias
+// it.  Returns false for unsupported combinations or allocation failure.
+// A temporal trail of a single frame is a copy of it, see
+// temporal_reference_push for sequences.
+extern bool blur_reference_render(struct blur_image *dst,
+				  const struct blur_image *src,
+				  const struct blur_reference_params *params);
+extern bool blur_reference_render_rgba8(
+	uint8_t *dst, const uint8_t *src, uint32_t width, uint32_t height,
+	uint32_t linesize, const struct blur_reference_params *params);
+
+extern bool blur_reference_cost(const struct blur_reference_params *params,
+				uint32_t width, uint32_t height,
+				struct blur_reference_cost *cost);
+
+// Gaussian kernel, same passes as gaussian_1d.effect, gaussian_motion.effect
+// and zoom_pass.effect.  Tilt-shift builds the same pyramid as the filter
+// and collapses it like gaussian_tiltshift.effect.
+extern bool gaussian_reference_blur(struct blur_image *dst,
+				    const struct blur_image *src,
+				    const struct blur_reference_params *params);
+
+// Box kernel, same passes as box_1d.effect and box_tiltshift.effect,
+// repeated `passes` times.  Motion is the one-sided version of the
+// directional pass.  Zoom runs the zoom_pass.effect passes standing in
+// for all of the repeats.
+extern bool box_reference_blur(struct blur_image *dst,
+			       const struct blur_image *src,
+			       const struct blur_reference_params *params);
+
+// Gaussian or box area blur at reduced resolution, as picked by
+// params->downsample_quality, then b-spline upsampled back to full size.
+extern bool downsample_reference_blur(struct blur_image *dst,
+				      const struct blur_image *src,
+				      const struct blur_reference_params *params);
+
+// Dual-kawase pyramid, same passes as kawase_down.effect/kawase_up.effect.
+extern bool kawase_reference_blur(struct blur_image *dst,
+				  const struct blur_image *src, float radius);
+extern bool kawase_reference_blur_levels(struct blur_image *dst,
+					 const struct blur_image *src,
+					 int levels, float offset);
+
+// Young-van Vliet recursive gaussian with sigma = radius, the same
+// recursion recursive_gaussian.effect evaluates as scan passes.
+extern bool recursive_reference_blur(struct blur_image *dst,
+				     const struct blur_image *src,
+				     float radius);
+
+// Temporal trail over a sequence of frames, with the same ring policy
+// and accumulation as temporal_accumulate.effect.  Push the frames in
+// order, each writes the trail up to it to `dst`.  A change of frame size
+// starts a new trail, like it does in the filter.
+struct temporal_reference;
+extern struct temporal_reference *
+temporal_reference_create(const struct blur_reference_params *params);
+extern bool temporal_reference_push(struct temporal_reference *trail,
+				    struct blur_image *dst,
+				    const struct blur_image *src);
+extern void temporal_reference_destroy(struct temporal_reference *trail);
+
+// Worker threads used for row tiles.  0 (the default) uses one thread per
+// online CPU.
+extern void blur_reference_set_threads(int threads);
+extern int blur_reference_get_threads(void);
+// Instruction set the kernels were built for: "avx2", "sse2", "neon" or
+// "scalar".
+extern const char *blur_reference_simd_name(void);
+
+#ifdef __cplusplus
+}
+#endif
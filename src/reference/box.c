@@ -0,0 +1,355 @@
+#include "reference-internal.h"
+#include "blur/box-kernel.h"
+#include "blur/zoom-kernel.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+enum box_pass_type {
+	BOX_PASS_1D,
+	BOX_PASS_MOTION,
+	BOX_PASS_RADIAL,
+	BOX_PASS_TILTSHIFT,
+};
+
+struct box_pass {
+	enum box_pass_type type;
+	const struct blur_image *src;
+	struct blur_image *dst;
+	float radius;
+	float step_u;
+	float step_v;
+	float center_u;
+	float center_v;
+	float top;
+	float bottom;
+	bool unpaired;
+	size_t size;
+	float weight[BOX_KERNEL_MAX_SIZE];
+	float offset[BOX_KERNEL_MAX_SIZE];
+};
+
+// box_1d.effect, and box_tiltshift.effect which scales the taps by the
+// distance from the in-focus band.  Paired taps come from
+// box_sample_kernel, unpaired ones sample every whole texel.
+static void box_1d_row(void *ctx, uint32_t y)
+{
+	const struct box_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float radius = pass->radius;
+	const int taps = (int)radius;
+	const float residual = radius - floorf(radius);
+	float scale = 1.0f;
+
+	if (pass->type == BOX_PASS_TILTSHIFT) {
+		if (v < pass->bottom && v > pass->top) {
+			for (uint32_t x = 0; x < pass->dst->width; x++) {
+				const float u = pixel_u(pass->dst, x);
+				rv4_store(pixel_ptr(pass->dst, x, y),
+					  rv4_sample(pass->src, u, v));
+			}
+			return;
+		}
+		const float dist_top = pass->top - v;
+		const float dist_bot = v - pass->bottom;
+		scale = dist_top > dist_bot ? dist_top : dist_bot;
+	}
+
+	const float step_u = pass->step_u * scale;
+	const float step_v = pass->step_v * scale;
+	const float norm = 1.0f / (2.0f * radius + 1.0f);
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		rv4 col = rv4_sample(pass->src, u, v);
+		if (!pass->unpaired) {
+			for (size_t i = 1; i < pass->size; i++) {
+				const float offset = pass->offset[i];
+				const rv4 pos = rv4_sample(pass->src,
+							   u + offset * step_u,
+							   v + offset * step_v);
+				const rv4 neg = rv4_sample(pass->src,
+							   u - offset * step_u,
+							   v - offset * step_v);
+				col = rv4_madd(col, rv4_add(pos, neg),
+					       pass->weight[i]);
+			}
+			rv4_store(pixel_ptr(pass->dst, x, y),
+				  rv4_scale(col, norm));
+			continue;
+		}
+		for (int i = 1; i <= taps; i++) {
+			const float offset = (float)i;
+			col = rv4_add(col, rv4_sample(pass->src,
+						      u + offset * step_u,
+						      v + offset * step_v));
+			col = rv4_add(col, rv4_sample(pass->src,
+						      u - offset * step_u,
+						      v - offset * step_v));
+		}
+		if (residual > 0.0f) {
+			const rv4 pos = rv4_sample(pass->src,
+						   u + radius * step_u,
+						   v + radius * step_v);
+			const rv4 neg = rv4_sample(pass->src,
+						   u - radius * step_u,
+						   v - radius * step_v);
+			col = rv4_madd(col, rv4_add(pos, neg), residual);
+		}
+		rv4_store(pixel_ptr(pass->dst, x, y), rv4_scale(col, norm));
+	}
+}
+
+// The single pass zoom gather, and the one-sided directional motion pass.
+static void box_one_sided_row(void *ctx, uint32_t y)
+{
+	const struct box_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float radius = pass->radius;
+	const int taps = (int)radius;
+	const float residual = radius - floorf(radius);
+	const float norm = 1.0f / (radius + 1.0f);
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		float step_u = pass->step_u;
+		float step_v = pass->step_v;
+		if (pass->type == BOX_PASS_RADIAL) {
+			step_u = 4.0f * (u - pass->center_u) /
+				 (float)pass->dst->width;
+			step_v = 4.0f * (v - pass->center_v) /
+				 (float)pass->dst->height;
+		}
+		rv4 col = rv4_sample(pass->src, u, v);
+		for (int i = 1; i <= taps; i++) {
+			const float offset = (float)i;
+			col = rv4_add(col, rv4_sample(pass->src,
+						      u - offset * step_u,
+						      v - offset * step_v));
+		}
+		if (residual > 0.0f) {
+			col = rv4_madd(col,
+				       rv4_sample(pass->src,
+						  u - radius * step_u,
+						  v - radius * step_v),
+				       residual);
+		}
+		rv4_store(pixel_ptr(pass->dst, x, y), rv4_scale(col, norm));
+	}
+}
+
+static void run_pass(struct box_pass *pass, const struct blur_image *src,
+		     struct blur_image *dst)
+{
+	const bool one_sided = pass->type == BOX_PASS_MOTION ||
+			       pass->type == BOX_PASS_RADIAL;
+	pass->src = src;
+	pass->dst = dst;
+	blur_reference_parallel_rows(dst->height,
+				     one_sided ? box_one_sided_row
+					       : box_1d_row,
+				     pass);
+}
+
+struct box_prefix_sum_pass {
+	const struct blur_image *src;
+	struct blur_image *dst;
+	float radius;
+	bool vertical;
+};
+
+// Bias box_prefix_sum.effect subtracts before summing.
+#define PREFIX_SUM_BIAS 0.5f
+
+struct prefix_sum_line {
+	const float *sums;
+	int last;
+	rv4 first_texel;
+	rv4 last_texel;
+	rv4 total;
+};
+
+static inline rv4 prefix_at(const struct prefix_sum_line *line, int k)
+{
+	if (k < 0)
+		return rv4_scale(line->first_texel, (float)(k + 1));
+	if (k > line->last)
+		return rv4_madd(line->total, line->last_texel,
+				(float)(k - line->last));
+	return rv4_load(line->sums + (size_t)k * 4);
+}
+
+// box_prefix_sum.effect over one row, or one column for the vertical
+// pass.  Same result as box_1d_row on an axis aligned step.
+static void box_prefix_sum_line(void *ctx, uint32_t index)
+{
+	const struct box_prefix_sum_pass *pass = ctx;
+	const uint32_t count = pass->vertical ? pass->dst->height
+					      : pass->dst->width;
+	float *sums = malloc((size_t)count * 4 * sizeof(float));
+	if (!sums)
+		return;
+
+	// 1. Biased running sum along the line.
+	static const float bias_texel[4] = {PREFIX_SUM_BIAS, PREFIX_SUM_BIAS,
+					    PREFIX_SUM_BIAS, PREFIX_SUM_BIAS};
+	const rv4 bias = rv4_load(bias_texel);
+	rv4 sum = rv4_zero();
+	for (uint32_t i = 0; i < count; i++) {
+		const float *texel = pass->vertical
+					     ? pixel_ptr(pass->src, index, i)
+					     : pixel_ptr(pass->src, i, index);
+		sum = rv4_add(sum, rv4_sub(rv4_load(texel), bias));
+		rv4_store(sums + (size_t)i * 4, sum);
+	}
+
+	struct prefix_sum_line line = {.sums = sums, .last = (int)count - 1};
+	line.first_texel = rv4_load(sums);
+	line.total = rv4_load(sums + (size_t)line.last * 4);
+	line.last_texel = line.last >= 1
+				  ? rv4_sub(line.total,
+					    rv4_load(sums +
+						     (size_t)(line.last - 1) *
+							     4))
+				  : line.total;
+
+	// 2. Window sums, with the residual taps blended between texel n
+	// and n + 1 on each side.
+	const int n = (int)floorf(pass->radius);
+	const float residual = pass->radius - (float)n;
+	const float norm = 1.0f / (2.0f * pass->radius + 1.0f);
+	for (int x = 0; x < (int)count; x++) {
+		rv4 col = rv4_sub(prefix_at(&line, x + n),
+				  prefix_at(&line, x - n - 1));
+		if (residual > 0.0f) {
+			const rv4 p_n = rv4_sub(prefix_at(&line, x + n),
+						prefix_at(&line, x + n - 1));
+			const rv4 p_n1 = rv4_sub(prefix_at(&line, x + n + 1),
+						 prefix_at(&line, x + n));
+			const rv4 m_n = rv4_sub(prefix_at(&line, x - n),
+						prefix_at(&line, x - n - 1));
+			const rv4 m_n1 = rv4_sub(prefix_at(&line, x - n - 1),
+						 prefix_at(&line, x - n - 2));
+			col = rv4_madd(col,
+				       rv4_add(rv4_lerp(p_n, p_n1, residual),
+					       rv4_lerp(m_n, m_n1, residual)),
+				       residual);
+		}
+		float *out = pass->vertical ? pixel_ptr(pass->dst, index, x)
+					    : pixel_ptr(pass->dst, x, index);
+		rv4_store(out, rv4_add(rv4_scale(col, norm), bias));
+	}
+
+	free(sums);
+}
+
+// One axis of an area blur, switching to the prefix sum where box.c
+// does.
+static void run_area_pass(struct box_pass *pass, const struct blur_image *src,
+			  struct blur_image *dst, bool vertical)
+{
+	const uint32_t size = vertical ? src->height : src->width;
+	if (box_use_prefix_sum(pass->radius, size)) {
+		struct box_prefix_sum_pass prefix = {
+			.src = src,
+			.dst = dst,
+			.radius = pass->radius,
+			.vertical = vertical,
+		};
+		blur_reference_parallel_rows(vertical ? dst->width
+						      : dst->height,
+					     box_prefix_sum_line, &prefix);
+		return;
+	}
+	pass->step_u = vertical ? 0.0f : 1.0f / (float)src->width;
+	pass->step_v = vertical ? 1.0f / (float)src->height : 0.0f;
+	run_pass(pass, src, dst);
+}
+
+bool box_reference_blur(struct blur_image *dst, const struct blur_image *src,
+			const struct blur_reference_params *params)
+{
+	struct blur_image ping = {0};
+	struct blur_image pong = {0};
+	struct box_pass pass = {0};
+	const float width = (float)src->width;
+	const float height = (float)src->height;
+	const float rads = -params->angle * (float)(M_PI / 180.0);
+	const int passes = params->passes > 0 ? params->passes : 1;
+	bool two_d = false;
+
+	pass.radius = params->radius;
+	pass.unpaired = params->box_unpaired;
+	pass.size = box_sample_kernel(params->radius, pass.weight, pass.offset,
+				      BOX_KERNEL_MAX_SIZE);
+	switch (params->blur_type) {
+	case BLUR_TYPE_AREA:
+		pass.type = BOX_PASS_1D;
+		two_d = true;
+		break;
+	case BLUR_TYPE_TILTSHIFT:
+		pass.type = BOX_PASS_TILTSHIFT;
+		pass.top = params->tilt_shift_top;
+		pass.bottom = 1.0f - params->tilt_shift_bottom;
+		two_d = true;
+		break;
+	case BLUR_TYPE_DIRECTIONAL:
+	case BLUR_TYPE_MOTION:
+		pass.type = params->blur_type == BLUR_TYPE_DIRECTIONAL
+				    ? BOX_PASS_1D
+				    : BOX_PASS_MOTION;
+		pass.step_u = cosf(rads) / width;
+		pass.step_v = sinf(rads) / height;
+		break;
+	case BLUR_TYPE_ZOOM:
+		if (!params->zoom_gather) {
+			struct zoom_params zoom;
+			zoom_params_for_box(params->radius, passes, src->width,
+					    src->height, &zoom);
+			return zoom_reference_blur(dst, src, &zoom,
+						   params->center_x / width,
+						   params->center_y / height);
+		}
+		pass.type = BOX_PASS_RADIAL;
+		pass.center_u = params->center_x / width;
+		pass.center_v = params->center_y / height;
+		break;
+	default:
+		return false;
+	}
+
+	if (!blur_image_match(&ping, src) || !blur_image_match(&pong, src)) {
+		blur_image_free(&ping);
+		blur_image_free(&pong);
+		return false;
+	}
+
+	// Each pass reads the output of the last one, like the texrender
+	// ping-pong in box.c.
+	const struct blur_image *input = src;
+	for (int i = 0; i < passes; i++) {
+		if (params->blur_type == BLUR_TYPE_AREA) {
+			run_area_pass(&pass, input, &ping, false);
+			run_area_pass(&pass, &ping, &pong, true);
+			input = &pong;
+		} else if (two_d) {
+			pass.step_u = 1.0f / width;
+			pass.step_v = 0.0f;
+			run_pass(&pass, input, &ping);
+			pass.step_u = 0.0f;
+			pass.step_v = 1.0f / height;
+			run_pass(&pass, &ping, &pong);
+			input = &pong;
+		} else {
+			struct blur_image *output = input == &ping ? &pong
+								   : &ping;
+			run_pass(&pass, input, output);
+			input = output;
+		}
+	}
+
+	const bool ok = blur_image_copy(dst, input);
+	blur_image_free(&ping);
+	blur_image_free(&pong);
+	return ok;
+}
@@ -0,0 +1,372 @@
+#include "reference-internal.h"
+#include "blur/gaussian-kernel.h"
+#include "blur/box-kernel.h"
+#include "blur/kawase-kernel.h"
+#include "blur/recursive-kernel.h"
+#include "blur/downsample-kernel.h"
+#include "blur/tiltshift-kernel.h"
+#include "blur/zoom-kernel.h"
+
+#include <math.h>
+
+// Fraction of rows outside the in-focus band of a tilt-shift.  Rows in
+// the band return after the center fetch.
+static double tilt_shift_blurred_fraction(const struct blur_reference_params *p)
+{
+	const double top = p->tilt_shift_top;
+	const double bottom = 1.0 - p->tilt_shift_bottom;
+	const double band = bottom > top ? bottom - top : 0.0;
+	return band >= 1.0 ? 0.0 : 1.0 - band;
+}
+
+// Fraction of a level's rows one tilt-shift pass shades.  Adds the draws
+// past the first when the pass is split around the band.
+static double tiltshift_pass_cost(const struct tiltshift_params *ts,
+				  enum tiltshift_pass pass, int level,
+				  struct blur_reference_cost *cost)
+{
+	const uint32_t height = kawase_level_size(ts->height, level);
+	uint32_t top_end;
+	uint32_t bottom_start;
+	tiltshift_pass_rows(ts, pass, level, &top_end, &bottom_start);
+	const int draws = (top_end > 0 ? 1 : 0) +
+			  (bottom_start < height ? 1 : 0);
+	cost->draws += draws - 1;
+	return (double)(top_end + height - bottom_start) / (double)height;
+}
+
+// Fetches per pixel of a gaussian_1d.effect pass over a kernel of
+// `size` linear taps.  The variant covering the kernel fetches its
+// zero-weight padding taps too.
+static double gaussian_1d_taps(size_t size)
+{
+	const size_t variant = gaussian_kernel_variant(size);
+	return 1.0 + 2.0 * (double)((variant ? variant : size) - 1);
+}
+
+// Per level, the halving and horizontal blur, the vertical blur, and
+// the collapse of the level below into it- one center fetch, plus four
+// for the b-spline upsample on rows past the level.  Each pass is
+// limited to the rows tiltshift_pass_rows picks.
+static bool gaussian_tiltshift_cost(const struct blur_reference_params *p,
+				    uint32_t width, uint32_t height,
+				    struct blur_reference_cost *cost)
+{
+	struct tiltshift_params ts;
+	tiltshift_params_for_radius(p->radius, p->tilt_shift_top,
+				    1.0f - p->tilt_shift_bottom, width, height,
+				    &ts);
+	if (ts.levels == 0) {
+		cost->samples_per_pixel = 1.0;
+		cost->blur_passes = 1;
+		return true;
+	}
+
+	float weight[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offset[GAUSSIAN_KERNEL_MAX_SIZE];
+	const size_t size = gaussian_sample_kernel(TILTSHIFT_LEVEL_RADIUS,
+						   weight, offset,
+						   GAUSSIAN_KERNEL_MAX_SIZE);
+	const double taps_1d = gaussian_1d_taps(size);
+	const double frame = (double)width * (double)height;
+	double samples = 0.0;
+	for (int i = 1; i <= ts.levels; i++) {
+		const double level =
+			(double)kawase_level_size(width, i) *
+			(double)kawase_level_size(height, i);
+		samples += taps_1d * level *
+			   (tiltshift_pass_cost(&ts, TILTSHIFT_PASS_DOWN, i,
+						cost) +
+			    tiltshift_pass_cost(&ts, TILTSHIFT_PASS_BLUR, i,
+						cost));
+		if (i < ts.levels)
+			samples += 5.0 * level *
+				   tiltshift_pass_cost(&ts,
+						       TILTSHIFT_PASS_COLLAPSE,
+						       i, cost);
+	}
+	cost->samples_per_pixel =
+		samples / frame + 1.0 + 4.0 * tilt_shift_blurred_fraction(p);
+	cost->blur_passes = 3 * ts.levels;
+	return true;
+}
+
+// ZOOM_TAPS taps in each zoom pass and the cross taps of the last, or a
+// straight copy through the default effect.
+static bool zoom_cost(const struct zoom_params *zoom,
+		      struct blur_reference_cost *cost)
+{
+	if (zoom->passes == 0) {
+		cost->samples_per_pixel = 1.0;
+		cost->blur_passes = 1;
+		return true;
+	}
+	cost->samples_per_pixel =
+		(double)ZOOM_TAPS * (zoom->passes + (zoom->crosses ? 1 : 0));
+	cost->blur_passes = zoom->passes;
+	return true;
+}
+
+static bool gaussian_cost(const struct blur_reference_params *p,
+			  uint32_t width, uint32_t height,
+			  struct blur_reference_cost *cost)
+{
+	float weight[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offset[GAUSSIAN_KERNEL_MAX_SIZE];
+	const size_t size = gaussian_sample_kernel(p->radius, weight, offset,
+						   GAUSSIAN_KERNEL_MAX_SIZE);
+	const double taps_1d = gaussian_1d_taps(size);
+
+	switch (p->blur_type) {
+	case BLUR_TYPE_AREA:
+		cost->samples_per_pixel = 2.0 * taps_1d;
+		cost->blur_passes = 2;
+		return true;
+	case BLUR_TYPE_DIRECTIONAL:
+		cost->samples_per_pixel = taps_1d;
+		cost->blur_passes = 1;
+		return true;
+	case BLUR_TYPE_ZOOM:
+		if (!p->zoom_gather) {
+			struct zoom_params zoom;
+			zoom_params_for_taps(weight, offset, size, 1, width,
+					     height, &zoom);
+			return zoom_cost(&zoom, cost);
+		}
+		cost->samples_per_pixel = (double)size;
+		cost->blur_passes = 1;
+		return true;
+	case BLUR_TYPE_MOTION:
+		cost->samples_per_pixel = (double)size;
+		cost->blur_passes = 1;
+		return true;
+	case BLUR_TYPE_TILTSHIFT:
+		return gaussian_tiltshift_cost(p, width, height, cost);
+	}
+	return false;
+}
+
+// One axis of a box area blur, looped or as a prefix sum the way box.c
+// picks it.  Returns the taps per pixel and adds the render passes.
+static double box_area_axis_cost(const struct blur_reference_params *p,
+				 double loop_taps, uint32_t size,
+				 struct blur_reference_cost *cost)
+{
+	if (box_use_prefix_sum(p->radius, size)) {
+		cost->blur_passes += 1 + box_scan_passes(size);
+		return (double)box_prefix_sum_taps(size);
+	}
+	cost->blur_passes += 1;
+	return loop_taps;
+}
+
+static bool box_cost(const struct blur_reference_params *p, uint32_t width,
+		     uint32_t height, struct blur_reference_cost *cost)
+{
+	const double radius = p->radius;
+	const double residual = radius - floor(radius);
+	const double taps = floor(radius) + (residual > 0.0 ? 1.0 : 0.0);
+	const int passes = p->passes > 0 ? p->passes : 1;
+	const double taps_1d = p->box_unpaired
+				       ? 1.0 + 2.0 * taps
+				       : (double)box_loop_taps(p->radius);
+
+	switch (p->blur_type) {
+	case BLUR_TYPE_AREA:
+		cost->blur_passes = 0;
+		cost->samples_per_pixel =
+			(box_area_axis_cost(p, taps_1d, width, cost) +
+			 box_area_axis_cost(p, taps_1d, height, cost)) *
+			passes;
+		cost->blur_passes *= passes;
+		return true;
+	case BLUR_TYPE_DIRECTIONAL:
+		cost->samples_per_pixel = taps_1d * passes;
+		cost->blur_passes = passes;
+		return true;
+	case BLUR_TYPE_ZOOM:
+		if (!p->zoom_gather) {
+			struct zoom_params zoom;
+			zoom_params_for_box(p->radius, passes, width, height,
+					    &zoom);
+			return zoom_cost(&zoom, cost);
+		}
+		cost->samples_per_pixel = (1.0 + taps) * passes;
+		cost->blur_passes = passes;
+		return true;
+	case BLUR_TYPE_TILTSHIFT: {
+		const double blurred = tilt_shift_blurred_fraction(p);
+		cost->samples_per_pixel =
+			2.0 * passes * (1.0 + blurred * (taps_1d - 1.0));
+		cost->blur_passes = 2 * passes;
+		return true;
+	}
+	}
+	return false;
+}
+
+static bool kawase_cost(const struct blur_reference_params *p,
+			uint32_t width, uint32_t height,
+			struct blur_reference_cost *cost)
+{
+	struct kawase_params params;
+
+	if (p->blur_type != BLUR_TYPE_AREA)
+		return false;
+
+	kawase_params_for_radius(p->radius, width, height, &params);
+	if (params.levels == 0) {
+		// Straight copy through the default effect.
+		cost->samples_per_pixel = 1.0;
+		cost->blur_passes = 1;
+		return true;
+	}
+
+	// Down pass into level i is 5 taps over that level's pixels, up pass
+	// into level i is 8 taps.  Both are normalized to the full frame.
+	const double frame = (double)width * (double)height;
+	double samples = 0.0;
+	for (int i = 1; i <= params.levels; i++) {
+		const double down = (double)kawase_level_size(width, i) *
+				    (double)kawase_level_size(height, i);
+		const double up = (double)kawase_level_size(width, i - 1) *
+				  (double)kawase_level_size(height, i - 1);
+		samples += 5.0 * down + 8.0 * up;
+	}
+	cost->samples_per_pixel = samples / frame;
+	cost->blur_passes = 2 * params.levels;
+	return true;
+}
+
+// Each axis runs the recursion forward then backward.  A direction is
+// three scans (real pole, complex pole for red/green and blue/alpha),
+// then a pass that reads the edge texel and the three sums.
+static bool recursive_cost(const struct blur_reference_params *p,
+			   uint32_t width, uint32_t height,
+			   struct blur_reference_cost *cost)
+{
+	struct recursive_gaussian c;
+
+	if (p->blur_type != BLUR_TYPE_AREA)
+		return false;
+
+	recursive_gaussian_coefficients(p->radius, &c);
+	if (!c.enabled) {
+		cost->samples_per_pixel = 1.0;
+		cost->blur_passes = 1;
+		return true;
+	}
+
+	const uint32_t sizes[2] = {width, height};
+	for (int axis = 0; axis < 2; axis++) {
+		const int scans = 3 * recursive_scan_passes(&c, sizes[axis]);
+		cost->samples_per_pixel +=
+			2.0 * (RECURSIVE_SCAN_RADIX * scans + 4.0);
+		cost->blur_passes += 2 * (scans + 1);
+	}
+	return true;
+}
+
+// One accumulation pass reading the frame, the accumulator and the
+// frame leaving the trail, however many frames the trail holds.
+static bool temporal_cost(const struct blur_reference_params *p,
+			  struct blur_reference_cost *cost)
+{
+	if (p->blur_type != BLUR_TYPE_MOTION)
+		return false;
+
+	cost->samples_per_pixel = 3.0;
+	cost->blur_passes = 1;
+	return true;
+}
+
+// Area blurs with downsample_quality set run at reduced size- one tap
+// per pixel of each halving, the blur itself over the reduced frame, and
+// 4 taps per full size pixel for the b-spline upsample.
+static bool downsampled_cost(const struct blur_reference_params *p,
+			     uint32_t width, uint32_t height,
+			     struct blur_reference_cost *cost)
+{
+	const enum downsample_kernel kernel =
+		p->blur_algorithm == BLUR_ALGO_GAUSSIAN
+			? DOWNSAMPLE_KERNEL_GAUSSIAN
+			: DOWNSAMPLE_KERNEL_BOX;
+	struct downsample_params ds;
+	downsample_params_for_radius(p->radius, p->downsample_quality, kernel,
+				     width, height, &ds);
+
+	struct blur_reference_params reduced = *p;
+	reduced.radius = ds.radius;
+	const bool ok =
+		kernel == DOWNSAMPLE_KERNEL_GAUSSIAN
+			? gaussian_cost(&reduced, width, height, cost)
+			: box_cost(&reduced,
+				   kawase_level_size(width, ds.levels),
+				   kawase_level_size(height, ds.levels),
+				   cost);
+	if (!ok || ds.levels == 0)
+		return ok;
+
+	const double frame = (double)width * (double)height;
+	double resample = 4.0 * frame;
+	double reduced_pixels = frame;
+	for (int i = 1; i <= ds.levels; i++) {
+		reduced_pixels = (double)kawase_level_size(width, i) *
+				 (double)kawase_level_size(height, i);
+		resample += reduced_pixels;
+	}
+	cost->samples_per_pixel =
+		(cost->samples_per_pixel * reduced_pixels + resample) / frame;
+	cost->blur_passes += ds.levels + 1;
+	return true;
+}
+
+/*
+ *  Estimates the GPU work the filter does for one frame with the given
+ *  settings- texture fetches per output pixel summed across all passes,
+ *  and the number of render target passes.  Returns false for the
+ *  algorithm/type pairs the filter does not offer.
+ */
+bool blur_reference_cost(const struct blur_reference_params *params,
+			 uint32_t width, uint32_t height,
+			 struct blur_reference_cost *cost)
+{
+	bool ok = false;
+
+	cost->samples_per_pixel = 0.0;
+	cost->blur_passes = 0;
+	cost->draws = 0;
+
+	const bool downsample = params->downsample_quality > 0 &&
+				params->blur_type == BLUR_TYPE_AREA;
+
+	switch (params->blur_algorithm) {
+	case BLUR_ALGO_GAUSSIAN:
+		ok = downsample ? downsampled_cost(params, width, height, cost)
+				: gaussian_cost(params, width, height, cost);
+		break;
+	case BLUR_ALGO_BOX:
+		ok = downsample ? downsampled_cost(params, width, height, cost)
+				: box_cost(params, width, height, cost);
+		break;
+	case BLUR_ALGO_KAWASE:
+		ok = kawase_cost(params, width, height, cost);
+		break;
+	case BLUR_ALGO_RECURSIVE:
+		ok = recursive_cost(params, width, height, cost);
+		break;
+	case BLUR_ALGO_TEMPORAL:
+		ok = temporal_cost(params, cost);
+		break;
+	}
+
+	// Input capture into input_texrender, plus the blur passes but the
+	// last, which draws straight into the parent target.  Only the
+	// temporal trail keeps its output in a texrender and draws it with
+	// draw_output_to_source.  Passes split around a tilt-shift band have
+	// already added their extra draws.
+	const int direct = params->blur_algorithm != BLUR_ALGO_TEMPORAL ? 1 : 0;
+	cost->texrender_passes = ok ? 1 + cost->blur_passes - direct : 0;
+	cost->draws = ok ? cost->texrender_passes + 1 + cost->draws : 0;
+	return ok;
+}
@@ -0,0 +1,121 @@
+#include "reference-internal.h"
+#include "blur/downsample-kernel.h"
+
+struct resample_pass {
+	const struct blur_image *src;
+	struct blur_image *dst;
+};
+
+// One bilinear tap per output pixel, like drawing `src` into a smaller
+// target with OBS_EFFECT_DEFAULT.  At half size that is a 2x2 box.
+static void downsample_row(void *ctx, uint32_t y)
+{
+	const struct resample_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	for (uint32_t x = 0; x < pass->dst->width; x++)
+		rv4_store(pixel_ptr(pass->dst, x, y),
+			  rv4_sample(pass->src, pixel_u(pass->dst, x), v));
+}
+
+static void bspline_weights(float p, float *h0, float *h1, float *g0,
+			    float *g1)
+{
+	const float i = floorf(p);
+	const float t = p - i;
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+	const float w0 = (1.0f - 3.0f * t + 3.0f * t2 - t3) / 6.0f;
+	const float w1 = (4.0f - 6.0f * t2 + 3.0f * t3) / 6.0f;
+	const float w2 = (1.0f + 3.0f * t + 3.0f * t2 - 3.0f * t3) / 6.0f;
+	const float w3 = t3 / 6.0f;
+	*g0 = w0 + w1;
+	*g1 = w2 + w3;
+	*h0 = i - 0.5f + w1 / *g0;
+	*h1 = i + 1.5f + w3 / *g1;
+}
+
+// Matches mainImage in bspline_upsample.effect.
+rv4 bspline_sample(const struct blur_image *src, float u, float v)
+{
+	const float sw = (float)src->width;
+	const float sh = (float)src->height;
+	float h0x, h1x, g0x, g1x;
+	float h0y, h1y, g0y, g1y;
+	bspline_weights(u * sw - 0.5f, &h0x, &h1x, &g0x, &g1x);
+	bspline_weights(v * sh - 0.5f, &h0y, &h1y, &g0y, &g1y);
+	h0x /= sw;
+	h1x /= sw;
+	h0y /= sh;
+	h1y /= sh;
+
+	rv4 col = rv4_scale(rv4_sample(src, h0x, h0y), g0x * g0y);
+	col = rv4_madd(col, rv4_sample(src, h1x, h0y), g1x * g0y);
+	col = rv4_madd(col, rv4_sample(src, h0x, h1y), g0x * g1y);
+	col = rv4_madd(col, rv4_sample(src, h1x, h1y), g1x * g1y);
+	return col;
+}
+
+static void upsample_row(void *ctx, uint32_t y)
+{
+	const struct resample_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	for (uint32_t x = 0; x < pass->dst->width; x++)
+		rv4_store(pixel_ptr(pass->dst, x, y),
+			  bspline_sample(pass->src, pixel_u(pass->dst, x), v));
+}
+
+static void run_pass(blur_row_fn fn, const struct blur_image *src,
+		     struct blur_image *dst)
+{
+	struct resample_pass pass = {.src = src, .dst = dst};
+	blur_reference_parallel_rows(dst->height, fn, &pass);
+}
+
+/*
+ *  Area blur through the reduced resolution path- halve `levels` times,
+ *  blur with the reduced radius, then b-spline upsample back to the
+ *  size of `src`.  Mirrors downsample.c in the filter.
+ */
+bool downsample_reference_blur(struct blur_image *dst,
+			       const struct blur_image *src,
+			       const struct blur_reference_params *params)
+{
+	const enum downsample_kernel kernel =
+		params->blur_algorithm == BLUR_ALGO_GAUSSIAN
+			? DOWNSAMPLE_KERNEL_GAUSSIAN
+			: DOWNSAMPLE_KERNEL_BOX;
+	struct downsample_params ds;
+	downsample_params_for_radius(params->radius,
+				     params->downsample_quality, kernel,
+				     src->width, src->height, &ds);
+
+	struct blur_reference_params reduced = *params;
+	reduced.radius = ds.radius;
+	reduced.downsample_quality = DOWNSAMPLE_QUALITY_OFF;
+	if (ds.levels == 0)
+		return blur_reference_render(dst, src, &reduced);
+
+	struct blur_image levels[DOWNSAMPLE_MAX_LEVELS + 1] = {0};
+	struct blur_image blurred = {0};
+	bool ok = true;
+
+	levels[0] = *src;
+	for (int i = 1; i <= ds.levels && ok; i++) {
+		ok = blur_image_init(&levels[i],
+				     kawase_level_size(src->width, i),
+				     kawase_level_size(src->height, i));
+		if (ok)
+			run_pass(downsample_row, &levels[i - 1], &levels[i]);
+	}
+
+	ok = ok && blur_reference_render(&blurred, &levels[ds.levels],
+					 &reduced) &&
+	     blur_image_match(dst, src);
+	if (ok)
+		run_pass(upsample_row, &blurred, dst);
+
+	for (int i = 1; i <= ds.levels; i++)
+		blur_image_free(&levels[i]);
+	blur_image_free(&blurred);
+	return ok;
+}
@@ -0,0 +1,284 @@
+#include "reference-internal.h"
+#include "blur/gaussian-kernel.h"
+#include "blur/downsample-kernel.h"
+#include "blur/tiltshift-kernel.h"
+#include "blur/zoom-kernel.h"
+
+enum gaussian_pass_type {
+	GAUSSIAN_PASS_1D,
+	GAUSSIAN_PASS_MOTION,
+	GAUSSIAN_PASS_RADIAL,
+};
+
+struct gaussian_pass {
+	enum gaussian_pass_type type;
+	const struct blur_image *src;
+	struct blur_image *dst;
+	const float *weight;
+	const float *offset;
+	size_t kernel_size;
+	float step_u;
+	float step_v;
+	float center_u;
+	float center_v;
+};
+
+// gaussian_1d.effect, into a target of any size.
+static void gaussian_1d_row(void *ctx, uint32_t y)
+{
+	const struct gaussian_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float step_u = pass->step_u;
+	const float step_v = pass->step_v;
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		float total_weight = pass->weight[0];
+		rv4 col = rv4_scale(rv4_sample(pass->src, u, v),
+				    pass->weight[0]);
+		for (size_t i = 1; i < pass->kernel_size; i++) {
+			const float weight = pass->weight[i];
+			const float offset = pass->offset[i];
+			total_weight += 2.0f * weight;
+			const rv4 pos = rv4_sample(pass->src,
+						   u + offset * step_u,
+						   v + offset * step_v);
+			const rv4 neg = rv4_sample(pass->src,
+						   u - offset * step_u,
+						   v - offset * step_v);
+			col = rv4_madd(col, rv4_add(pos, neg), weight);
+		}
+		rv4_store(pixel_ptr(pass->dst, x, y),
+			  rv4_scale(col, 1.0f / total_weight));
+	}
+}
+
+// gaussian_motion.effect, and the single pass zoom gather- one sided
+// kernels.
+static void gaussian_one_sided_row(void *ctx, uint32_t y)
+{
+	const struct gaussian_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		float step_u = pass->step_u;
+		float step_v = pass->step_v;
+		if (pass->type == GAUSSIAN_PASS_RADIAL) {
+			// normalize(uv - center) / uv_size * dist * 4 reduces
+			// to (uv - center) / uv_size * 4.
+			step_u = 4.0f * (u - pass->center_u) /
+				 (float)pass->dst->width;
+			step_v = 4.0f * (v - pass->center_v) /
+				 (float)pass->dst->height;
+		}
+		float total_weight = pass->weight[0];
+		rv4 col = rv4_scale(rv4_sample(pass->src, u, v),
+				    pass->weight[0]);
+		for (size_t i = 1; i < pass->kernel_size; i++) {
+			const float weight = pass->weight[i];
+			const float offset = pass->offset[i];
+			total_weight += weight;
+			col = rv4_madd(col,
+				       rv4_sample(pass->src,
+						  u - offset * step_u,
+						  v - offset * step_v),
+				       weight);
+		}
+		rv4_store(pixel_ptr(pass->dst, x, y),
+			  rv4_scale(col, 1.0f / total_weight));
+	}
+}
+
+static void run_pass(struct gaussian_pass *pass)
+{
+	const bool one_sided = pass->type == GAUSSIAN_PASS_MOTION ||
+			       pass->type == GAUSSIAN_PASS_RADIAL;
+	blur_reference_parallel_rows(pass->dst->height,
+				     one_sided ? gaussian_one_sided_row
+					       : gaussian_1d_row,
+				     pass);
+}
+
+struct collapse_pass {
+	const struct tiltshift_params *ts;
+	const struct blur_image *image;
+	const struct blur_image *upper;
+	struct blur_image *dst;
+	float level;
+};
+
+// gaussian_tiltshift.effect
+static void collapse_row(void *ctx, uint32_t y)
+{
+	const struct collapse_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float dist_top = pass->ts->top - v;
+	const float dist_bot = v - pass->ts->bottom;
+	const float dist = dist_top > dist_bot ? dist_top : dist_bot;
+	const float sigma = pass->ts->radius * (dist > 0.0f ? dist : 0.0f);
+	float t = tiltshift_lod(sigma) - pass->level;
+	t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		rv4 col = rv4_sample(pass->image, u, v);
+		if (t > 0.0f)
+			col = rv4_lerp(col, bspline_sample(pass->upper, u, v),
+				       t);
+		rv4_store(pixel_ptr(pass->dst, x, y), col);
+	}
+}
+
+/*
+ *  Tilt-shift through the filter's pyramid- each level is the one above
+ *  halved and blurred with the TILTSHIFT_LEVEL_RADIUS kernel, then every
+ *  row blends the levels around its sigma on the way back up.  Computes
+ *  whole levels, where the filter only shades the rows that are read.
+ */
+static bool tiltshift_reference_blur(struct blur_image *dst,
+				     const struct blur_image *src,
+				     const struct blur_reference_params *params)
+{
+	struct tiltshift_params ts;
+	tiltshift_params_for_radius(params->radius, params->tilt_shift_top,
+				    1.0f - params->tilt_shift_bottom,
+				    src->width, src->height, &ts);
+	if (ts.levels == 0)
+		return blur_image_copy(dst, src);
+
+	float weight[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offset[GAUSSIAN_KERNEL_MAX_SIZE];
+	struct gaussian_pass pass = {.type = GAUSSIAN_PASS_1D};
+	pass.weight = weight;
+	pass.offset = offset;
+	pass.kernel_size = gaussian_sample_kernel(TILTSHIFT_LEVEL_RADIUS,
+						  weight, offset,
+						  GAUSSIAN_KERNEL_MAX_SIZE);
+
+	struct blur_image levels[TILTSHIFT_MAX_LEVELS + 1] = {0};
+	struct blur_image scratch[TILTSHIFT_MAX_LEVELS + 1] = {0};
+	bool ok = blur_image_match(dst, src);
+
+	// 1. Halve and blur horizontally, then blur vertically.
+	levels[0] = *src;
+	for (int i = 1; i <= ts.levels && ok; i++) {
+		const uint32_t width = kawase_level_size(src->width, i);
+		const uint32_t height = kawase_level_size(src->height, i);
+		ok = blur_image_init(&scratch[i], width, height) &&
+		     blur_image_init(&levels[i], width, height);
+		if (!ok)
+			break;
+		pass.src = &levels[i - 1];
+		pass.dst = &scratch[i];
+		pass.step_u = 1.0f / (float)width;
+		pass.step_v = 0.0f;
+		run_pass(&pass);
+		pass.src = &scratch[i];
+		pass.dst = &levels[i];
+		pass.step_u = 0.0f;
+		pass.step_v = 1.0f / (float)height;
+		run_pass(&pass);
+	}
+
+	// 2. Collapse into each level's scratch image, then into dst.
+	const struct blur_image *upper = &levels[ts.levels];
+	for (int i = ts.levels - 1; i >= 0 && ok; i--) {
+		struct collapse_pass collapse = {
+			.ts = &ts,
+			.image = &levels[i],
+			.upper = upper,
+			.dst = i > 0 ? &scratch[i] : dst,
+			.level = (float)i,
+		};
+		blur_reference_parallel_rows(collapse.dst->height,
+					     collapse_row, &collapse);
+		upper = collapse.dst;
+	}
+
+	for (int i = 1; i <= ts.levels; i++) {
+		blur_image_free(&scratch[i]);
+		blur_image_free(&levels[i]);
+	}
+	return ok;
+}
+
+bool gaussian_reference_blur(struct blur_image *dst,
+			     const struct blur_image *src,
+			     const struct blur_reference_params *params)
+{
+	float weight[GAUSSIAN_KERNEL_MAX_SIZE];
+	float offset[GAUSSIAN_KERNEL_MAX_SIZE];
+	struct blur_image tmp = {0};
+	struct gaussian_pass pass = {0};
+	bool ok = true;
+
+	pass.weight = weight;
+	pass.offset = offset;
+	pass.kernel_size = gaussian_sample_kernel(params->radius, weight,
+						  offset,
+						  GAUSSIAN_KERNEL_MAX_SIZE);
+
+	if (!blur_image_match(dst, src))
+		return false;
+
+	const float rads = -params->angle * (float)(M_PI / 180.0);
+	const float width = (float)src->width;
+	const float height = (float)src->height;
+
+	switch (params->blur_type) {
+	case BLUR_TYPE_AREA:
+		// Horizontal pass into tmp, then vertical pass into dst.
+		if (!blur_image_match(&tmp, src))
+			return false;
+		pass.type = GAUSSIAN_PASS_1D;
+		pass.src = src;
+		pass.dst = &tmp;
+		pass.step_u = 1.0f / width;
+		pass.step_v = 0.0f;
+		run_pass(&pass);
+		pass.src = &tmp;
+		pass.dst = dst;
+		pass.step_u = 0.0f;
+		pass.step_v = 1.0f / height;
+		run_pass(&pass);
+		break;
+	case BLUR_TYPE_DIRECTIONAL:
+	case BLUR_TYPE_MOTION:
+		pass.type = params->blur_type == BLUR_TYPE_DIRECTIONAL
+				    ? GAUSSIAN_PASS_1D
+				    : GAUSSIAN_PASS_MOTION;
+		pass.src = src;
+		pass.dst = dst;
+		pass.step_u = cosf(rads) / width;
+		pass.step_v = sinf(rads) / height;
+		run_pass(&pass);
+		break;
+	case BLUR_TYPE_TILTSHIFT:
+		ok = tiltshift_reference_blur(dst, src, params);
+		break;
+	case BLUR_TYPE_ZOOM:
+		if (!params->zoom_gather) {
+			struct zoom_params zoom;
+			zoom_params_for_taps(weight, offset, pass.kernel_size,
+					     1, src->width, src->height, &zoom);
+			ok = zoom_reference_blur(dst, src, &zoom,
+						 params->center_x / width,
+						 params->center_y / height);
+			break;
+		}
+		pass.type = GAUSSIAN_PASS_RADIAL;
+		pass.src = src;
+		pass.dst = dst;
+		pass.center_u = params->center_x / width;
+		pass.center_v = params->center_y / height;
+		run_pass(&pass);
+		break;
+	default:
+		ok = false;
+		break;
+	}
+
+	blur_image_free(&tmp);
+	return ok;
+}
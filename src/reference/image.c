@@ -0,0 +1,108 @@
+#include "reference-internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool blur_image_init(struct blur_image *image, uint32_t width, uint32_t height)
+{
+	image->width = width;
+	image->height = height;
+	image->data = calloc((size_t)width * height * 4, sizeof(float));
+	return image->data != NULL;
+}
+
+void blur_image_free(struct blur_image *image)
+{
+	free(image->data);
+	image->data = NULL;
+	image->width = 0;
+	image->height = 0;
+}
+
+bool blur_image_match(struct blur_image *dst, const struct blur_image *src)
+{
+	if (dst->data && dst->width == src->width &&
+	    dst->height == src->height)
+		return true;
+	blur_image_free(dst);
+	return blur_image_init(dst, src->width, src->height);
+}
+
+bool blur_image_copy(struct blur_image *dst, const struct blur_image *src)
+{
+	if (!blur_image_match(dst, src))
+		return false;
+	memcpy(dst->data, src->data,
+	       (size_t)src->width * src->height * 4 * sizeof(float));
+	return true;
+}
+
+void blur_image_sample(const struct blur_image *image, float u, float v,
+		       float *color)
+{
+	rv4_store(color, rv4_sample(image, u, v));
+}
+
+bool blur_image_from_rgba8(struct blur_image *image, const uint8_t *pixels,
+			   uint32_t width, uint32_t height, uint32_t linesize)
+{
+	if (!image->data || image->width != width ||
+	    image->height != height) {
+		blur_image_free(image);
+		if (!blur_image_init(image, width, height))
+			return false;
+	}
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *row = pixels + (size_t)y * linesize;
+		float *out = pixel_ptr(image, 0, y);
+		for (uint32_t i = 0; i < width * 4; i++)
+			out[i] = (float)row[i] / 255.0f;
+	}
+	return true;
+}
+
+void blur_image_to_rgba8(const struct blur_image *image, uint8_t *pixels,
+			 uint32_t linesize)
+{
+	for (uint32_t y = 0; y < image->height; y++) {
+		uint8_t *row = pixels + (size_t)y * linesize;
+		const float *in = pixel_ptr(image, 0, y);
+		for (uint32_t i = 0; i < image->width * 4; i++) {
+			float v = in[i] * 255.0f + 0.5f;
+			v = v < 0.0f ? 0.0f : v > 255.0f ? 255.0f : v;
+			row[i] = (uint8_t)v;
+		}
+	}
+}
+
+double blur_image_max_error(const struct blur_image *a,
+			    const struct blur_image *b)
+{
+	if (a->width != b->width || a->height != b->height)
+		return INFINITY;
+	const size_t count = (size_t)a->width * a->height * 4;
+	double error = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const double diff = fabs((double)a->data[i] - b->data[i]);
+		if (diff > error)
+			error = diff;
+	}
+	return error;
+}
+
+double blur_image_rms_error(const struct blur_image *a,
+			    const struct blur_image *b)
+{
+	if (a->width != b->width || a->height != b->height)
+		return INFINITY;
+	const size_t count = (size_t)a->width * a->height * 4;
+	if (count == 0)
+		return 0.0;
+	double sum = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const double diff = (double)a->data[i] - b->data[i];
+		sum += diff * diff;
+	}
+	return sqrt(sum / (double)count);
+}
@@ -0,0 +1,112 @@
+#include "reference-internal.h"
+#include "blur/kawase-kernel.h"
+
+struct kawase_pass {
+	const struct blur_image *src;
+	struct blur_image *dst;
+	float hp_u;
+	float hp_v;
+};
+
+// Matches mainImage in kawase_down.effect.  `hp` is half a source texel
+// scaled by the kawase offset.
+static void kawase_down_row(void *ctx, uint32_t y)
+{
+	const struct kawase_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float hp_u = pass->hp_u;
+	const float hp_v = pass->hp_v;
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		rv4 col = rv4_scale(rv4_sample(pass->src, u, v), 4.0f);
+		col = rv4_add(col, rv4_sample(pass->src, u - hp_u, v - hp_v));
+		col = rv4_add(col, rv4_sample(pass->src, u + hp_u, v + hp_v));
+		col = rv4_add(col, rv4_sample(pass->src, u + hp_u, v - hp_v));
+		col = rv4_add(col, rv4_sample(pass->src, u - hp_u, v + hp_v));
+		rv4_store(pixel_ptr(pass->dst, x, y), rv4_scale(col, 0.125f));
+	}
+}
+
+// Matches mainImage in kawase_up.effect.
+static void kawase_up_row(void *ctx, uint32_t y)
+{
+	const struct kawase_pass *pass = ctx;
+	const float v = pixel_v(pass->dst, y);
+	const float taps[8][3] = {
+		{-2.0f, 0.0f, 1.0f}, {-1.0f, 1.0f, 2.0f}, {0.0f, 2.0f, 1.0f},
+		{1.0f, 1.0f, 2.0f},  {2.0f, 0.0f, 1.0f},  {1.0f, -1.0f, 2.0f},
+		{0.0f, -2.0f, 1.0f}, {-1.0f, -1.0f, 2.0f},
+	};
+
+	for (uint32_t x = 0; x < pass->dst->width; x++) {
+		const float u = pixel_u(pass->dst, x);
+		rv4 col = rv4_zero();
+		for (int t = 0; t < 8; t++) {
+			const rv4 s = rv4_sample(pass->src,
+						 u + taps[t][0] * pass->hp_u,
+						 v + taps[t][1] * pass->hp_v);
+			col = rv4_madd(col, s, taps[t][2]);
+		}
+		rv4_store(pixel_ptr(pass->dst, x, y),
+			  rv4_scale(col, 1.0f / 12.0f));
+	}
+}
+
+static void run_pass(blur_row_fn fn, const struct blur_image *src,
+		     struct blur_image *dst, float offset)
+{
+	struct kawase_pass pass = {
+		.src = src,
+		.dst = dst,
+		.hp_u = 0.5f / (float)src->width * offset,
+		.hp_v = 0.5f / (float)src->height * offset,
+	};
+	blur_reference_parallel_rows(dst->height, fn, &pass);
+}
+
+bool kawase_reference_blur_levels(struct blur_image *dst,
+				  const struct blur_image *src, int levels,
+				  float offset)
+{
+	struct blur_image pyramid[KAWASE_MAX_LEVELS + 1] = {0};
+	bool ok = true;
+
+	if (levels > KAWASE_MAX_LEVELS)
+		levels = KAWASE_MAX_LEVELS;
+	if (levels <= 0)
+		return blur_image_copy(dst, src);
+
+	pyramid[0] = *src;
+	for (int i = 1; i <= levels && ok; i++) {
+		ok = blur_image_init(&pyramid[i],
+				     kawase_level_size(src->width, i),
+				     kawase_level_size(src->height, i));
+		if (ok)
+			run_pass(kawase_down_row, &pyramid[i - 1],
+				 &pyramid[i], offset);
+	}
+
+	// Upsample back through the pyramid, re-using each level's buffer
+	// the same way the GPU path re-uses its texrenders.
+	for (int i = levels; i > 1 && ok; i--)
+		run_pass(kawase_up_row, &pyramid[i], &pyramid[i - 1], offset);
+
+	if (ok)
+		ok = blur_image_match(dst, src);
+	if (ok)
+		run_pass(kawase_up_row, &pyramid[1], dst, offset);
+
+	for (int i = 1; i <= levels; i++)
+		blur_image_free(&pyramid[i]);
+	return ok;
+}
+
+bool kawase_reference_blur(struct blur_image *dst,
+			   const struct blur_image *src, float radius)
+{
+	struct kawase_params params;
+	kawase_params_for_radius(radius, src->width, src->height, &params);
+	return kawase_reference_blur_levels(dst, src, params.levels,
+					    params.offset);
+}
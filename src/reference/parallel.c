@@ -0,0 +1,145 @@
+#include "reference-internal.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+
+// Rows are handed out in fixed tiles, interleaved across threads so the
+// expensive parts of an image (e.g. the blurred bands of a tilt-shift)
+// are spread evenly without any shared counter.
+#define ROW_TILE_SIZE 16
+#define MAX_THREADS 64
+
+static int thread_count = 0;
+
+struct row_job {
+	blur_row_fn fn;
+	void *ctx;
+	uint32_t rows;
+	int index;
+	int stride;
+};
+
+static void run_rows(const struct row_job *job)
+{
+	const uint32_t tiles = (job->rows + ROW_TILE_SIZE - 1) / ROW_TILE_SIZE;
+	for (uint32_t tile = (uint32_t)job->index; tile < tiles;
+	     tile += (uint32_t)job->stride) {
+		uint32_t end = (tile + 1) * ROW_TILE_SIZE;
+		if (end > job->rows)
+			end = job->rows;
+		for (uint32_t y = tile * ROW_TILE_SIZE; y < end; y++)
+			job->fn(job->ctx, y);
+	}
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI row_thread(LPVOID param)
+{
+	run_rows(param);
+	return 0;
+}
+#else
+static void *row_thread(void *param)
+{
+	run_rows(param);
+	return NULL;
+}
+#endif
+
+static int default_thread_count(void)
+{
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+void blur_reference_set_threads(int threads)
+{
+	thread_count = threads < 0 ? 0 : threads;
+}
+
+int blur_reference_get_threads(void)
+{
+	int threads = thread_count ? thread_count : default_thread_count();
+	return threads > MAX_THREADS ? MAX_THREADS : threads;
+}
+
+void blur_reference_parallel_rows(uint32_t rows, blur_row_fn fn, void *ctx)
+{
+	const uint32_t tiles = (rows + ROW_TILE_SIZE - 1) / ROW_TILE_SIZE;
+	int threads = blur_reference_get_threads();
+	if ((uint32_t)threads > tiles)
+		threads = (int)tiles;
+
+	struct row_job jobs[MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		jobs[i].fn = fn;
+		jobs[i].ctx = ctx;
+		jobs[i].rows = rows;
+		jobs[i].index = i;
+		jobs[i].stride = threads;
+	}
+	if (threads <= 1) {
+		struct row_job job = {fn, ctx, rows, 0, 1};
+		run_rows(&job);
+		return;
+	}
+
+	// The calling thread takes the first share of tiles itself.
+#if defined(_WIN32)
+	HANDLE handles[MAX_THREADS];
+	int started = 0;
+	for (int i = 1; i < threads; i++) {
+		handles[started] =
+			CreateThread(NULL, 0, row_thread, &jobs[i], 0, NULL);
+		if (!handles[started])
+			run_rows(&jobs[i]);
+		else
+			started++;
+	}
+	run_rows(&jobs[0]);
+	for (int i = 0; i < started; i++) {
+		WaitForSingleObject(handles[i], INFINITE);
+		CloseHandle(handles[i]);
+	}
+#else
+	pthread_t handles[MAX_THREADS];
+	bool started[MAX_THREADS] = {false};
+	for (int i = 1; i < threads; i++) {
+		started[i] = pthread_create(&handles[i], NULL, row_thread,
+					    &jobs[i]) == 0;
+		if (!started[i])
+			run_rows(&jobs[i]);
+	}
+	run_rows(&jobs[0]);
+	for (int i = 1; i < threads; i++) {
+		if (started[i])
+			pthread_join(handles[i], NULL);
+	}
+#endif
+}
+
+const char *blur_reference_simd_name(void)
+{
+#if defined(BLUR_REFERENCE_AVX2)
+	return "avx2";
+#elif defined(BLUR_REFERENCE_SSE)
+	return "sse2";
+#elif defined(BLUR_REFERENCE_NEON)
+	return "neon";
+#else
+	return "scalar";
+#endif
+}
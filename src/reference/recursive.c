@@ -0,0 +1,126 @@
+#include "reference-internal.h"
+#include "blur/recursive-kernel.h"
+
+// Columns per task of the vertical pass.  Neighbouring columns share
+// cache lines, so one task walks a strip of them.
+#define STRIP_WIDTH 16
+
+struct recursive_pass {
+	const struct blur_image *src;
+	struct blur_image *dst;
+	const struct recursive_gaussian *c;
+};
+
+/*
+ *  One direction of the recursion over `count` texels, `stride` floats
+ *  apart.  Past the start the line is taken to repeat its first texel,
+ *  so each pole starts from its steady state x[0] / (1 - p).  The sum
+ *  of the poles is added to dst, scaled texel by texel, and the center
+ *  tap that both directions include is subtracted from the forward one.
+ */
+static void recursive_direction(const struct recursive_gaussian *c,
+				const float *src, float *dst, uint32_t count,
+				ptrdiff_t stride, bool forward)
+{
+	const float p0 = c->real_pole;
+	const float r0 = c->real_residue;
+	const float pr = c->complex_pole[0];
+	const float pi = c->complex_pole[1];
+	const float rr = 2.0f * c->complex_residue[0];
+	const float ri = 2.0f * c->complex_residue[1];
+	const float center = r0 + rr;
+
+	// 1 / (1 - p) for both poles.
+	const float real_gain = 1.0f / (1.0f - p0);
+	const float d = (1.0f - pr) * (1.0f - pr) + pi * pi;
+	const float gain_re = (1.0f - pr) / d;
+	const float gain_im = pi / d;
+
+	const rv4 first = rv4_load(src);
+	rv4 z0 = rv4_scale(first, real_gain);
+	rv4 z_re = rv4_scale(first, gain_re);
+	rv4 z_im = rv4_scale(first, gain_im);
+	for (uint32_t i = 0; i < count; i++) {
+		const ptrdiff_t offset = (ptrdiff_t)i * stride;
+		const rv4 x = rv4_load(src + offset);
+		z0 = rv4_madd(x, z0, p0);
+		const rv4 re = rv4_madd(rv4_madd(x, z_re, pr), z_im, -pi);
+		z_im = rv4_madd(rv4_scale(z_re, pi), z_im, pr);
+		z_re = re;
+
+		// real_residue * z0 + 2 * Re(complex_residue * z)
+		rv4 y = rv4_scale(z0, r0);
+		y = rv4_madd(y, z_re, rr);
+		y = rv4_madd(y, z_im, -ri);
+		if (forward)
+			y = rv4_madd(y, x, -center);
+		else
+			y = rv4_add(y, rv4_load(dst + offset));
+		rv4_store(dst + offset, y);
+	}
+}
+
+// Both directions over the same input line.  src and dst must not
+// alias.
+static void recursive_line(const struct recursive_gaussian *c,
+			   const float *src, float *dst, uint32_t count,
+			   ptrdiff_t stride)
+{
+	const ptrdiff_t last = (ptrdiff_t)(count - 1) * stride;
+	recursive_direction(c, src, dst, count, stride, true);
+	recursive_direction(c, src + last, dst + last, count, -stride, false);
+}
+
+static void recursive_row(void *ctx, uint32_t y)
+{
+	const struct recursive_pass *pass = ctx;
+	recursive_line(pass->c, pixel_ptr(pass->src, 0, y),
+		       pixel_ptr(pass->dst, 0, y), pass->dst->width, 4);
+}
+
+static void recursive_strip(void *ctx, uint32_t strip)
+{
+	const struct recursive_pass *pass = ctx;
+	const uint32_t first = strip * STRIP_WIDTH;
+	uint32_t last = first + STRIP_WIDTH;
+	if (last > pass->dst->width)
+		last = pass->dst->width;
+	const ptrdiff_t stride = (ptrdiff_t)pass->dst->width * 4;
+
+	for (uint32_t x = first; x < last; x++)
+		recursive_line(pass->c, pixel_ptr(pass->src, x, 0),
+			       pixel_ptr(pass->dst, x, 0), pass->dst->height,
+			       stride);
+}
+
+/*
+ *  Young-van Vliet recursive gaussian, rows then columns.  Cost per
+ *  pixel is the same for any radius.  The GPU evaluates the same
+ *  recursion as scan passes, see recursive.c in the filter.
+ */
+bool recursive_reference_blur(struct blur_image *dst,
+			      const struct blur_image *src, float radius)
+{
+	struct recursive_gaussian c;
+	recursive_gaussian_coefficients(radius, &c);
+	if (!c.enabled)
+		return blur_image_copy(dst, src);
+
+	struct blur_image rows = {0};
+	if (!blur_image_match(&rows, src) || !blur_image_match(dst, src)) {
+		blur_image_free(&rows);
+		return false;
+	}
+
+	struct recursive_pass pass = {.src = src, .dst = &rows, .c = &c};
+	blur_reference_parallel_rows(src->height, recursive_row, &pass);
+
+	pass.src = &rows;
+	pass.dst = dst;
+	blur_reference_parallel_rows((src->width + STRIP_WIDTH - 1) /
+					     STRIP_WIDTH,
+				     recursive_strip, &pass);
+
+	blur_image_free(&rows);
+	return true;
+}
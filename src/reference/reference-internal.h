@@ -0,0 +1,47 @@
+#pragma once
+
+#include "blur-reference.h"
+#include "simd.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef void (*blur_row_fn)(void *ctx, uint32_t y);
+
+// Runs fn(ctx, y) for every y in [0, rows), split across worker threads
+// in tiles of rows.  Returns once every row is done.
+extern void blur_reference_parallel_rows(uint32_t rows, blur_row_fn fn,
+					 void *ctx);
+
+// Makes sure dst has the same size as src, reallocating if needed.
+extern bool blur_image_match(struct blur_image *dst,
+			     const struct blur_image *src);
+
+// Cubic b-spline sample of `src`, like bspline_upsample.effect.
+extern rv4 bspline_sample(const struct blur_image *src, float u, float v);
+
+// Zoom passes toward (center_u, center_v), like zoom_pass.effect.
+struct zoom_params;
+extern bool zoom_reference_blur(struct blur_image *dst,
+				const struct blur_image *src,
+				const struct zoom_params *zoom, float center_u,
+				float center_v);
+
+// Per-pixel uv of an output image, matching the interpolated TEXCOORD0 a
+// full-target gs_draw_sprite produces.
+static inline float pixel_u(const struct blur_image *image, uint32_t x)
+{
+	return ((float)x + 0.5f) / (float)image->width;
+}
+
+static inline float pixel_v(const struct blur_image *image, uint32_t y)
+{
+	return ((float)y + 0.5f) / (float)image->height;
+}
+
+static inline float *pixel_ptr(const struct blur_image *image, uint32_t x,
+			       uint32_t y)
+{
+	return image->data + ((size_t)y * image->width + x) * 4;
+}
@@ -0,0 +1,54 @@
+#include "reference-internal.h"
+
+#include <stdlib.h>
+
+bool blur_reference_render(struct blur_image *dst,
+			   const struct blur_image *src,
+			   const struct blur_reference_params *params)
+{
+	const bool downsample = params->downsample_quality > 0 &&
+				params->blur_type == BLUR_TYPE_AREA;
+
+	switch (params->blur_algorithm) {
+	case BLUR_ALGO_GAUSSIAN:
+		if (downsample)
+			return downsample_reference_blur(dst, src, params);
+		return gaussian_reference_blur(dst, src, params);
+	case BLUR_ALGO_BOX:
+		if (downsample)
+			return downsample_reference_blur(dst, src, params);
+		return box_reference_blur(dst, src, params);
+	case BLUR_ALGO_KAWASE:
+		if (params->blur_type != BLUR_TYPE_AREA)
+			return false;
+		return kawase_reference_blur(dst, src, params->radius);
+	case BLUR_ALGO_RECURSIVE:
+		if (params->blur_type != BLUR_TYPE_AREA)
+			return false;
+		return recursive_reference_blur(dst, src, params->radius);
+	case BLUR_ALGO_TEMPORAL:
+		if (params->blur_type != BLUR_TYPE_MOTION)
+			return false;
+		return blur_image_copy(dst, src);
+	}
+	return false;
+}
+
+bool blur_reference_render_rgba8(uint8_t *dst, const uint8_t *src,
+				 uint32_t width, uint32_t height,
+				 uint32_t linesize,
+				 const struct blur_reference_params *params)
+{
+	struct blur_image input = {0};
+	struct blur_image output = {0};
+
+	bool ok = blur_image_from_rgba8(&input, src, width, height,
+					linesize) &&
+		  blur_reference_render(&output, &input, params);
+	if (ok)
+		blur_image_to_rgba8(&output, dst, linesize);
+
+	blur_image_free(&input);
+	blur_image_free(&output);
+	return ok;
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "blur-reference.h"
+
+#include <math.h>
+
+// Minimal RGBA vector abstraction for the reference kernels.  One rv4
+// holds all four channels of a pixel, so every kernel is written once
+// and vectorized across channels.  The instruction set is picked at
+// compile time; define BLUR_REFERENCE_FORCE_SCALAR to build the plain C
+// fallback on any platform.
+
+#if defined(BLUR_REFERENCE_FORCE_SCALAR)
+#define BLUR_REFERENCE_SCALAR 1
+#elif defined(__AVX2__)
+#define BLUR_REFERENCE_AVX2 1
+#define BLUR_REFERENCE_SSE 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLUR_REFERENCE_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define BLUR_REFERENCE_NEON 1
+#include <arm_neon.h>
+#else
+#define BLUR_REFERENCE_SCALAR 1
+#endif
+
+#if defined(BLUR_REFERENCE_SSE)
+typedef __m128 rv4;
+
+static inline rv4 rv4_zero(void)
+{
+	return _mm_setzero_ps();
+}
+
+static inline rv4 rv4_load(const float *p)
+{
+	return _mm_loadu_ps(p);
+}
+
+static inline void rv4_store(float *p, rv4 a)
+{
+	_mm_storeu_ps(p, a);
+}
+
+static inline rv4 rv4_add(rv4 a, rv4 b)
+{
+	return _mm_add_ps(a, b);
+}
+
+static inline rv4 rv4_sub(rv4 a, rv4 b)
+{
+	return _mm_sub_ps(a, b);
+}
+
+static inline rv4 rv4_scale(rv4 a, float s)
+{
+	return _mm_mul_ps(a, _mm_set1_ps(s));
+}
+
+// acc + a * s
+static inline rv4 rv4_madd(rv4 acc, rv4 a, float s)
+{
+	return _mm_add_ps(acc, _mm_mul_ps(a, _mm_set1_ps(s)));
+}
+
+// a + (b - a) * t
+static inline rv4 rv4_lerp(rv4 a, rv4 b, float t)
+{
+	return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+}
+#elif defined(BLUR_REFERENCE_NEON)
+typedef float32x4_t rv4;
+
+static inline rv4 rv4_zero(void)
+{
+	return vdupq_n_f32(0.0f);
+}
+
+static inline rv4 rv4_load(const float *p)
+{
+	return vld1q_f32(p);
+}
+
+static inline void rv4_store(float *p, rv4 a)
+{
+	vst1q_f32(p, a);
+}
+
+static inline rv4 rv4_add(rv4 a, rv4 b)
+{
+	return vaddq_f32(a, b);
+}
+
+static inline rv4 rv4_sub(rv4 a, rv4 b)
+{
+	return vsubq_f32(a, b);
+}
+
+static inline rv4 rv4_scale(rv4 a, float s)
+{
+	return vmulq_n_f32(a, s);
+}
+
+static inline rv4 rv4_madd(rv4 acc, rv4 a, float s)
+{
+	return vmlaq_n_f32(acc, a, s);
+}
+
+static inline rv4 rv4_lerp(rv4 a, rv4 b, float t)
+{
+	return vmlaq_n_f32(a, vsubq_f32(b, a), t);
+}
+#else
+typedef struct {
+	float v[4];
+} rv4;
+
+static inline rv4 rv4_zero(void)
+{
+	rv4 r = {{0.0f, 0.0f, 0.0f, 0.0f}};
+	return r;
+}
+
+static inline rv4 rv4_load(const float *p)
+{
+	rv4 r = {{p[0], p[1], p[2], p[3]}};
+	return r;
+}
+
+static inline void rv4_store(float *p, rv4 a)
+{
+	for (int c = 0; c < 4; c++)
+		p[c] = a.v[c];
+}
+
+static inline rv4 rv4_add(rv4 a, rv4 b)
+{
+	for (int c = 0; c < 4; c++)
+		a.v[c] += b.v[c];
+	return a;
+}
+
+static inline rv4 rv4_sub(rv4 a, rv4 b)
+{
+	for (int c = 0; c < 4; c++)
+		a.v[c] -= b.v[c];
+	return a;
+}
+
+static inline rv4 rv4_scale(rv4 a, float s)
+{
+	for (int c = 0; c < 4; c++)
+		a.v[c] *= s;
+	return a;
+}
+
+static inline rv4 rv4_madd(rv4 acc, rv4 a, float s)
+{
+	for (int c = 0; c < 4; c++)
+		acc.v[c] += a.v[c] * s;
+	return acc;
+}
+
+static inline rv4 rv4_lerp(rv4 a, rv4 b, float t)
+{
+	for (int c = 0; c < 4; c++)
+		a.v[c] += (b.v[c] - a.v[c]) * t;
+	return a;
+}
+#endif
+
+static inline const float *rv4_texel(const struct blur_image *image, int x,
+				     int y)
+{
+	return image->data + ((size_t)y * image->width + (size_t)x) * 4;
+}
+
+/*
+ *  Bilinear sample at normalized coordinates with clamped addressing,
+ *  equivalent to `Filter = Linear; AddressU = Clamp; AddressV = Clamp;`
+ *  Coordinates are folded so the 2x2 footprint always lies inside the
+ *  image, which lets the two texels of a row be fetched together.
+ */
+static inline rv4 rv4_sample(const struct blur_image *image, float u, float v)
+{
+	const int w = (int)image->width;
+	const int h = (int)image->height;
+	float x = u * (float)w - 0.5f;
+	float y = v * (float)h - 0.5f;
+	float fx = floorf(x);
+	float fy = floorf(y);
+	int x0 = (int)fx;
+	int y0 = (int)fy;
+	float ax = x - fx;
+	float ay = y - fy;
+
+	if (x0 < 0 || w < 2) {
+		x0 = 0;
+		ax = 0.0f;
+	} else if (x0 > w - 2) {
+		x0 = w - 2;
+		ax = 1.0f;
+	}
+	if (y0 < 0 || h < 2) {
+		y0 = 0;
+		ay = 0.0f;
+	} else if (y0 > h - 2) {
+		y0 = h - 2;
+		ay = 1.0f;
+	}
+
+	const int x1 = w < 2 ? x0 : x0 + 1;
+	const int y1 = h < 2 ? y0 : y0 + 1;
+
+#if defined(BLUR_REFERENCE_AVX2)
+	if (x1 == x0 + 1) {
+		// Both texels of each row in one 256-bit load, lerp the rows
+		// together, then lerp the two halves.
+		const __m256 r0 = _mm256_loadu_ps(rv4_texel(image, x0, y0));
+		const __m256 r1 = _mm256_loadu_ps(rv4_texel(image, x0, y1));
+		const __m256 col = _mm256_add_ps(
+			r0, _mm256_mul_ps(_mm256_sub_ps(r1, r0),
+					  _mm256_set1_ps(ay)));
+		return rv4_lerp(_mm256_castps256_ps128(col),
+				_mm256_extractf128_ps(col, 1), ax);
+	}
+#endif
+	const rv4 top = rv4_lerp(rv4_load(rv4_texel(image, x0, y0)),
+				 rv4_load(rv4_texel(image, x1, y0)), ax);
+	const rv4 bottom = rv4_lerp(rv4_load(rv4_texel(image, x0, y1)),
+				    rv4_load(rv4_texel(image, x1, y1)), ax);
+	return rv4_lerp(top, bottom, ay);
+}
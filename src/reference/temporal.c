@@ -0,0 +1,79 @@
+#include "reference-internal.h"
+#include "blur/temporal-kernel.h"
+
+#include <stdlib.h>
+
+struct temporal_reference {
+	struct blur_reference_params params;
+	struct temporal_params trail;
+	struct blur_image accumulator;
+	// The last trail.slots frames, newest at `head`.
+	struct blur_image ring[TEMPORAL_MAX_FRAMES];
+	int head;
+	int count;
+};
+
+struct temporal_reference *
+temporal_reference_create(const struct blur_reference_params *params)
+{
+	struct temporal_reference *trail = calloc(1, sizeof(*trail));
+	if (trail)
+		trail->params = *params;
+	return trail;
+}
+
+void temporal_reference_destroy(struct temporal_reference *trail)
+{
+	if (!trail)
+		return;
+	blur_image_free(&trail->accumulator);
+	for (int i = 0; i < TEMPORAL_MAX_FRAMES; i++)
+		blur_image_free(&trail->ring[i]);
+	free(trail);
+}
+
+bool temporal_reference_push(struct temporal_reference *trail,
+			     struct blur_image *dst,
+			     const struct blur_image *src)
+{
+	if (trail->count == 0 || trail->accumulator.width != src->width ||
+	    trail->accumulator.height != src->height) {
+		temporal_params_for_frames(
+			trail->params.temporal_frames,
+			(enum temporal_mode)trail->params.temporal_mode,
+			trail->params.temporal_memory, src->width, src->height,
+			&trail->trail);
+		trail->head = 0;
+		trail->count = 0;
+		if (!blur_image_match(&trail->accumulator, src))
+			return false;
+	}
+
+	bool subtract_oldest;
+	const float weight =
+		temporal_weight(&trail->trail, trail->count, &subtract_oldest);
+	const int next = trail->trail.slots > 0
+				 ? (trail->head + 1) % trail->trail.slots
+				 : 0;
+	const float *old = subtract_oldest ? trail->ring[next].data
+		       : trail->count > 0  ? trail->accumulator.data
+					   : src->data;
+
+	// Same arithmetic as temporal_accumulate.effect, the first frame
+	// averages with itself.
+	const size_t count = (size_t)src->width * src->height * 4;
+	float *acc = trail->accumulator.data;
+	for (size_t i = 0; i < count; i++) {
+		const float a = trail->count > 0 ? acc[i] : src->data[i];
+		acc[i] = a + (src->data[i] - old[i]) * weight;
+	}
+
+	if (trail->trail.slots > 0) {
+		trail->head = next;
+		if (!blur_image_copy(&trail->ring[next], src))
+			return false;
+	}
+	if (trail->count < trail->trail.frames)
+		trail->count++;
+	return blur_image_copy(dst, &trail->accumulator);
+}
@@ -0,0 +1,77 @@
+#include "reference-internal.h"
+#include "blur/zoom-kernel.h"
+
+struct zoom_pass_ctx {
+	const struct zoom_pass *pass;
+	// The cross taps on the last pass, else NULL.
+	const struct zoom_pass *cross;
+	const struct blur_image *src;
+	struct blur_image *dst;
+	float center_u;
+	float center_v;
+};
+
+static rv4 zoom_taps(const struct zoom_pass_ctx *z,
+		     const struct zoom_pass *pass, float du, float dv, rv4 col)
+{
+	for (int i = 0; i < ZOOM_TAPS; i++) {
+		col = rv4_madd(col,
+			       rv4_sample(z->src,
+					  z->center_u + du * pass->scale_x[i],
+					  z->center_v + dv * pass->scale_y[i]),
+			       pass->weight[i]);
+	}
+	return col;
+}
+
+// zoom_pass.effect, Draw and DrawCross
+static void zoom_pass_row(void *ctx, uint32_t y)
+{
+	const struct zoom_pass_ctx *z = ctx;
+	const float dv = pixel_v(z->dst, y) - z->center_v;
+
+	for (uint32_t x = 0; x < z->dst->width; x++) {
+		const float du = pixel_u(z->dst, x) - z->center_u;
+		rv4 col = zoom_taps(z, z->pass, du, dv, rv4_zero());
+		if (z->cross)
+			col = zoom_taps(z, z->cross, du, dv, col);
+		rv4_store(pixel_ptr(z->dst, x, y), col);
+	}
+}
+
+bool zoom_reference_blur(struct blur_image *dst, const struct blur_image *src,
+			 const struct zoom_params *zoom, float center_u,
+			 float center_v)
+{
+	struct blur_image ping = {0};
+	struct blur_image pong = {0};
+	struct zoom_pass_ctx ctx = {
+		.center_u = center_u,
+		.center_v = center_v,
+	};
+
+	if (!blur_image_match(&ping, src) || !blur_image_match(&pong, src)) {
+		blur_image_free(&ping);
+		blur_image_free(&pong);
+		return false;
+	}
+
+	const struct blur_image *input = src;
+	for (int i = 0; i < zoom->passes; i++) {
+		struct blur_image *output = input == &ping ? &pong : &ping;
+		ctx.pass = &zoom->pass[i];
+		ctx.cross = zoom->crosses && i == zoom->passes - 1
+				    ? &zoom->cross
+				    : NULL;
+		ctx.src = input;
+		ctx.dst = output;
+		blur_reference_parallel_rows(output->height, zoom_pass_row,
+					     &ctx);
+		input = output;
+	}
+
+	const bool ok = blur_image_copy(dst, input);
+	blur_image_free(&ping);
+	blur_image_free(&pong);
+	return ok;
+}
@@ -0,0 +1,245 @@
+#include "roi.h"
+
+#include "blur/box-kernel.h"
+#include "blur/downsample-kernel.h"
+#include "blur/gaussian-kernel.h"
+#include "blur/kawase-kernel.h"
+#include "blur/tiltshift-kernel.h"
+
+#include <math.h>
+
+int roi_update(struct composite_blur_filter_data *filter,
+	       obs_data_t *settings)
+{
+	struct blur_settings *s = &filter->updated;
+	int changed = 0;
+	changed += update_bool(&s->roi_enabled,
+			       obs_data_get_bool(settings, "roi_enabled"));
+	changed += update_int(&s->roi.x,
+			      (int)obs_data_get_int(settings, "roi_x"));
+	changed += update_int(&s->roi.y,
+			      (int)obs_data_get_int(settings, "roi_y"));
+	changed += update_int(&s->roi.cx,
+			      (int)obs_data_get_int(settings, "roi_width"));
+	changed += update_int(&s->roi.cy,
+			      (int)obs_data_get_int(settings, "roi_height"));
+	changed += update_float(
+		&s->roi_mask_threshold,
+		(float)obs_data_get_double(settings, "roi_mask_threshold"));
+	const char *mask = obs_data_get_string(settings, "roi_mask");
+	changed += update_bool(&s->roi_masked, mask && *mask);
+	changed += source_ref_set_name(&filter->roi_mask, mask);
+	return changed;
+}
+
+void roi_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "roi_width", ROI_MAX_WIDTH);
+	obs_data_set_default_int(settings, "roi_height", ROI_MAX_HEIGHT);
+}
+
+void load_roi_effect(struct composite_blur_filter_data *filter)
+{
+	filter->roi_effect =
+		load_shader_effect(filter->roi_effect, "/shaders/roi.effect");
+	filter->roi_params = effect_cache_get_params(filter->roi_effect);
+}
+
+// Extra reach of the halving and B-spline upsampling around a blur run
+// at `levels` reductions, in full size pixels.
+static int downsample_halo(int levels)
+{
+	return levels > 0 ? 3 * (1 << levels) + 1 : 0;
+}
+
+/*
+ *  How far, in full size pixels, the blur reads from an output pixel,
+ *  summed over all of its passes, or -1 when it is not bounded by the
+ *  radius.  Zoom blurs reach further the further a pixel is from the
+ *  center, and prefix sums and the recursive gaussian scan whole rows.
+ *  The gaussian tilt-shift is bounded by its pyramid, and intersects
+ *  the scissor with the rows each level needs.  Taken from the applied
+ *  settings, not from which effects are loaded- those of an algorithm
+ *  or type used before stay loaded.
+ */
+static int roi_halo(const struct composite_blur_filter_data *filter)
+{
+	const float radius = filter->radius;
+	const int passes = filter->passes > 0 ? filter->passes : 1;
+	if (filter->blur_type == TYPE_ZOOM)
+		return -1;
+	if (filter->blur_algorithm == ALGO_GAUSSIAN &&
+	    filter->blur_type == TYPE_TILTSHIFT) {
+		// Each level reads up to 9 of its texels beyond what the
+		// level above needs, see tiltshift_pass_rows, and the
+		// smallest 2 more.  12 leaves a texel of rounding per level.
+		struct tiltshift_params ts;
+		tiltshift_params_for_radius(radius, filter->tilt_shift_top,
+					    1.0f - filter->tilt_shift_bottom,
+					    filter->width, filter->height,
+					    &ts);
+		return ts.levels > 0 ? 12 * (1 << ts.levels) : 0;
+	}
+
+	switch (filter->blur_algorithm) {
+	case ALGO_GAUSSIAN:
+	case ALGO_BOX: {
+		const bool box = filter->blur_algorithm == ALGO_BOX;
+		struct downsample_params ds = {0};
+		if (filter->blur_type == TYPE_AREA)
+			downsample_params_for_radius(
+				radius, filter->downsample_quality,
+				box ? DOWNSAMPLE_KERNEL_BOX
+				    : DOWNSAMPLE_KERNEL_GAUSSIAN,
+				filter->width, filter->height, &ds);
+		const float reduced = ds.levels > 0 ? ds.radius : radius;
+		const float scale = (float)(1 << ds.levels);
+		if (!box) {
+			const float extent = fminf(3.0f * reduced * scale,
+						   GAUSSIAN_KERNEL_MAX_RADIUS);
+			return (int)ceilf(extent) + 1 +
+			       downsample_halo(ds.levels);
+		}
+		const uint32_t level_width =
+			kawase_level_size(filter->width, ds.levels);
+		const uint32_t level_height =
+			kawase_level_size(filter->height, ds.levels);
+		if (filter->blur_type == TYPE_AREA &&
+		    (box_use_prefix_sum(reduced, level_width) ||
+		     box_use_prefix_sum(reduced, level_height)))
+			return -1;
+		return passes * ((int)ceilf(reduced * scale) + (int)scale) +
+		       downsample_halo(ds.levels);
+	}
+	case ALGO_KAWASE: {
+		// Each level down reads half an offset and each level up a
+		// full offset of its source level, plus the bilinear tap.
+		struct kawase_params params;
+		kawase_params_for_radius(radius, filter->width, filter->height,
+					 &params);
+		const float levels = (float)(1 << params.levels);
+		return (int)ceilf(3.0f * (params.offset + 1.0f) * levels) + 1;
+	}
+	default:
+		return -1;
+	}
+}
+
+static int clamp_int(int value, int low, int high)
+{
+	return value < low ? low : (value > high ? high : value);
+}
+
+void roi_begin_frame(struct composite_blur_filter_data *filter)
+{
+	filter->roi_scissor = false;
+	if (!filter->roi_enabled)
+		return;
+
+	const int width = (int)filter->width;
+	const int height = (int)filter->height;
+	struct gs_rect region = filter->roi;
+	if (filter->roi_masked && (region.cx <= 0 || region.cy <= 0)) {
+		region.x = 0;
+		region.y = 0;
+		region.cx = width;
+		region.cy = height;
+	}
+	const int left = clamp_int(region.x, 0, width);
+	const int top = clamp_int(region.y, 0, height);
+	const int right = clamp_int(region.x + region.cx, left, width);
+	const int bottom = clamp_int(region.y + region.cy, top, height);
+	filter->roi_frame.x = left;
+	filter->roi_frame.y = top;
+	filter->roi_frame.cx = right - left;
+	filter->roi_frame.cy = bottom - top;
+
+	const int halo = roi_halo(filter);
+	if (halo < 0)
+		return;
+	const int scissor_left = clamp_int(left - halo, 0, width);
+	const int scissor_top = clamp_int(top - halo, 0, height);
+	filter->roi_scissor_rect.x = scissor_left;
+	filter->roi_scissor_rect.y = scissor_top;
+	filter->roi_scissor_rect.cx =
+		clamp_int(right + halo, 0, width) - scissor_left;
+	filter->roi_scissor_rect.cy =
+		clamp_int(bottom + halo, 0, height) - scissor_top;
+	filter->roi_scissor = true;
+}
+
+bool roi_target_rect(const struct composite_blur_filter_data *filter,
+		     uint32_t width, uint32_t height, struct gs_rect *rect)
+{
+	if (!filter->roi_scissor || !filter->width || !filter->height)
+		return false;
+
+	// Scaled to the target, rounded out by a texel for reduced levels.
+	const struct gs_rect *r = &filter->roi_scissor_rect;
+	const double sx = (double)width / (double)filter->width;
+	const double sy = (double)height / (double)filter->height;
+	const int pad = width < filter->width || height < filter->height;
+	const int left = clamp_int((int)floor(r->x * sx) - pad, 0, (int)width);
+	const int top = clamp_int((int)floor(r->y * sy) - pad, 0, (int)height);
+	rect->x = left;
+	rect->y = top;
+	rect->cx = clamp_int((int)ceil((r->x + r->cx) * sx) + pad, left,
+			     (int)width) -
+		   left;
+	rect->cy = clamp_int((int)ceil((r->y + r->cy) * sy) + pad, top,
+			     (int)height) -
+		   top;
+	return true;
+}
+
+void roi_draw_sprite(struct composite_blur_filter_data *filter,
+		     gs_texture_t *texture, uint32_t width, uint32_t height)
+{
+	struct gs_rect rect;
+	if (!roi_target_rect(filter, width, height, &rect)) {
+		gs_draw_sprite(texture, 0, width, height);
+		return;
+	}
+
+	gs_set_scissor_rect(&rect);
+	gs_draw_sprite(texture, 0, width, height);
+	gs_set_scissor_rect(NULL);
+}
+
+bool roi_draw_output(struct composite_blur_filter_data *filter,
+		     gs_texture_t *texture)
+{
+	gs_effect_t *effect = filter->roi_effect;
+	gs_texture_t *original =
+		gs_texrender_get_texture(filter->input_texrender);
+	if (!filter->roi_enabled || !effect || !original)
+		return false;
+
+	obs_source_t *mask_source = source_ref_get(&filter->roi_mask);
+	gs_texture_t *mask =
+		mask_source ? background_cache_render(mask_source,
+						      filter->space)
+			    : NULL;
+	obs_source_release(mask_source);
+
+	const float width = (float)filter->width;
+	const float height = (float)filter->height;
+	struct vec4 roi;
+	vec4_set(&roi, (float)filter->roi_frame.x / width,
+		 (float)filter->roi_frame.y / height,
+		 (float)(filter->roi_frame.x + filter->roi_frame.cx) / width,
+		 (float)(filter->roi_frame.y + filter->roi_frame.cy) / height);
+
+	struct effect_params *params = filter->roi_params;
+	effect_params_set_texture(params, EFFECT_PARAM_IMAGE, texture);
+	effect_params_set_texture(params, EFFECT_PARAM_ORIGINAL, original);
+	effect_params_set_texture(params, EFFECT_PARAM_MASK, mask);
+	effect_params_set_vec4(params, EFFECT_PARAM_ROI, &roi);
+	effect_params_set_float(params, EFFECT_PARAM_MASK_THRESHOLD,
+				filter->roi_mask_threshold);
+
+	const char *technique = mask ? "DrawMask" : "Draw";
+	while (gs_effect_loop(effect, technique))
+		gs_draw_sprite(texture, 0, filter->width, filter->height);
+	return true;
+}
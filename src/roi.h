@@ -0,0 +1,39 @@
+#pragma once
+
+#include <obs-module.h>
+#include <obs-utils.h>
+#include <obs-composite-blur-filter.h>
+
+struct composite_blur_filter_data;
+
+// Largest region the settings offer.  The defaults, clamped to the
+// frame, cover the whole source.
+#define ROI_MAX_WIDTH 7680
+#define ROI_MAX_HEIGHT 4320
+
+// Reads the region settings into filter->updated.  Returns the number
+// of them that changed.
+extern int roi_update(struct composite_blur_filter_data *filter,
+		      obs_data_t *settings);
+extern void roi_defaults(obs_data_t *settings);
+extern void load_roi_effect(struct composite_blur_filter_data *filter);
+// Clamps the region to this frame's size and picks the scissor rect of
+// the blur passes.  With a mask, an empty region is the whole frame, so
+// the mask selects on its own.  Call once per frame before the blur.
+extern void roi_begin_frame(struct composite_blur_filter_data *filter);
+// Scissor rect of a blur pass into a width x height target- the region
+// and the pixels it reads from, scaled to the target.  False when the
+// pass shades the whole target.
+extern bool roi_target_rect(const struct composite_blur_filter_data *filter,
+			    uint32_t width, uint32_t height,
+			    struct gs_rect *rect);
+// Draws one blur pass into a width x height target.  With a region set
+// and a blur of bounded reach, only the region and the pixels it reads
+// from are shaded.
+extern void roi_draw_sprite(struct composite_blur_filter_data *filter,
+			    gs_texture_t *texture, uint32_t width,
+			    uint32_t height);
+// Draws `texture` inside the region and the filter input outside it.
+// Returns false without drawing when no region is set.
+extern bool roi_draw_output(struct composite_blur_filter_data *filter,
+			    gs_texture_t *texture);
@@ -0,0 +1,56 @@
+#include "settings-buffer.h"
+
+#include <string.h>
+
+#include "effect-cache.h"
+
+#define SETTINGS_BUFFER_FRESH 4
+#define SETTINGS_BUFFER_INDEX 3
+
+void settings_buffer_init(struct settings_buffer *buffer)
+{
+	memset(buffer->slots, 0, sizeof(buffer->slots));
+	buffer->front = 0;
+	buffer->middle = 1;
+	buffer->back = 2;
+}
+
+void settings_buffer_free(struct settings_buffer *buffer)
+{
+	for (size_t i = 0; i < OBS_COUNTOF(buffer->slots); i++) {
+		kernel_cache_release(buffer->slots[i].kernel);
+		buffer->slots[i].kernel = NULL;
+		for (size_t j = 0; j < GAUSSIAN_HELD_VARIANTS; j++) {
+			effect_cache_release(buffer->slots[i].variants[j]);
+			buffer->slots[i].variants[j] = NULL;
+		}
+	}
+}
+
+struct settings_snapshot *settings_buffer_back(struct settings_buffer *buffer)
+{
+	return &buffer->slots[buffer->back];
+}
+
+void settings_buffer_publish(struct settings_buffer *buffer)
+{
+	// A snapshot published before and not taken yet comes back as the
+	// next one to write, the render thread never saw it.
+	const long middle = os_atomic_exchange_long(
+		&buffer->middle, buffer->back | SETTINGS_BUFFER_FRESH);
+	buffer->back = middle & SETTINGS_BUFFER_INDEX;
+}
+
+const struct settings_snapshot *
+settings_buffer_take(struct settings_buffer *buffer, bool *fresh)
+{
+	*fresh = (os_atomic_load_long(&buffer->middle) &
+		  SETTINGS_BUFFER_FRESH) != 0;
+	if (*fresh) {
+		// Whatever was published last by now, the swap takes it.
+		const long middle = os_atomic_exchange_long(&buffer->middle,
+							    buffer->front);
+		buffer->front = middle & SETTINGS_BUFFER_INDEX;
+	}
+	return &buffer->slots[buffer->front];
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <obs-module.h>
+#include <util/threading.h>
+
+#include "blur/downsample-kernel.h"
+#include "blur/kernel-cache.h"
+#include "blur/recursive-kernel.h"
+
+// The settings a frame is rendered with, as composite_blur_update reads
+// them.
+struct blur_settings {
+	int blur_algorithm;
+	int blur_type;
+	float radius;
+	int passes;
+	int downsample_quality;
+	float center_x;
+	float center_y;
+	float angle;
+	float tilt_shift_bottom;
+	float tilt_shift_top;
+	int temporal_frames;
+	int temporal_mode;
+	int temporal_memory;
+	bool skip_unchanged;
+	int precision;
+	bool roi_enabled;
+	struct gs_rect roi;
+	// A mask source is named, which selects on its own when the
+	// rectangle is empty.
+	bool roi_masked;
+	float roi_mask_threshold;
+};
+
+// A gaussian_1d.effect variant for the full radius and one for each
+// downsampled level count.
+#define GAUSSIAN_HELD_VARIANTS (DOWNSAMPLE_MAX_LEVELS + 1)
+
+// Settings with what is derived from them off the render thread.  The
+// snapshot holds a reference to its kernel and to the 1D gaussian
+// effects it can be drawn with, NULL where unused.
+struct settings_snapshot {
+	struct blur_settings settings;
+	const struct kernel_cache_entry *kernel;
+	gs_effect_t *variants[GAUSSIAN_HELD_VARIANTS];
+	struct recursive_gaussian recursive;
+};
+
+/*
+ *  Snapshots passed from the thread calling update to the render thread
+ *  without a lock.  Of the three, the update side writes `back` and
+ *  swaps it with the middle one to publish it, the render side swaps
+ *  its `front` with the middle one when that was published since.  Each
+ *  swap is one atomic exchange of `middle`, so neither side waits, and
+ *  neither ever touches a snapshot the other one holds- the render
+ *  thread never sees a snapshot being written, and a kernel is only
+ *  released when its snapshot is written again.
+ */
+struct settings_buffer {
+	struct settings_snapshot slots[3];
+	// Index of the middle snapshot, with SETTINGS_BUFFER_FRESH set while
+	// it was published and not taken yet.
+	volatile long middle;
+	long back;
+	long front;
+};
+
+extern void settings_buffer_init(struct settings_buffer *buffer);
+// Releases the kernels and effects, once neither side uses the buffer
+// any more.
+extern void settings_buffer_free(struct settings_buffer *buffer);
+
+// Update side: the snapshot to write, then publish it.
+extern struct settings_snapshot *
+settings_buffer_back(struct settings_buffer *buffer);
+extern void settings_buffer_publish(struct settings_buffer *buffer);
+
+// Render side: the newest published snapshot, valid until the next call.
+// `fresh` is set when it was published since the last call.
+extern const struct settings_snapshot *
+settings_buffer_take(struct settings_buffer *buffer, bool *fresh);
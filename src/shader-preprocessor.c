@@ -0,0 +1,433 @@
+#include "shader-preprocessor.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#define CACHE_MAGIC "// composite-blur shader cache"
+
+// What os_stat said about a file when it was read.
+struct file_stamp {
+	long long mtime;
+	long long size;
+};
+
+struct source_file {
+	char *path;
+	char *text;
+	struct file_stamp stamp;
+};
+
+struct source_dep {
+	const char *path;
+	struct file_stamp stamp;
+};
+
+struct expand_state {
+	struct dstr out;
+	// Files currently being expanded, outermost first.
+	DARRAY(const char *) stack;
+	// Every file the output depends on, stamped as it was read.
+	DARRAY(struct source_dep) deps;
+	// Names injected through `defines`.
+	DARRAY(char *) define_names;
+};
+
+static pthread_mutex_t preprocessor_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct source_file) source_files;
+static char *cache_dir;
+static struct shader_preprocessor_stats stats;
+
+void shader_preprocessor_init(const char *dir)
+{
+	pthread_mutex_lock(&preprocessor_mutex);
+	bfree(cache_dir);
+	cache_dir = dir ? bstrdup(dir) : NULL;
+	pthread_mutex_unlock(&preprocessor_mutex);
+}
+
+void shader_preprocessor_free(void)
+{
+	pthread_mutex_lock(&preprocessor_mutex);
+	for (size_t i = 0; i < source_files.num; i++) {
+		bfree(source_files.array[i].path);
+		bfree(source_files.array[i].text);
+	}
+	da_free(source_files);
+	bfree(cache_dir);
+	cache_dir = NULL;
+	pthread_mutex_unlock(&preprocessor_mutex);
+}
+
+void shader_preprocessor_get_stats(struct shader_preprocessor_stats *out)
+{
+	pthread_mutex_lock(&preprocessor_mutex);
+	*out = stats;
+	pthread_mutex_unlock(&preprocessor_mutex);
+}
+
+static bool stat_file(const char *path, struct file_stamp *stamp)
+{
+	struct stat st;
+	if (os_stat(path, &st) != 0)
+		return false;
+	stamp->mtime = (long long)st.st_mtime;
+	stamp->size = (long long)st.st_size;
+	return true;
+}
+
+// Returns the contents of `path`, owned by the file cache.  A cached
+// file is read again once its stamp changed, so an edited shader is
+// picked up by the next effect compiled.
+static const struct source_file *read_source(const char *path)
+{
+	// Stamped before reading, so a write in between shows up as a
+	// change next time rather than being missed.
+	struct file_stamp stamp;
+	if (!stat_file(path, &stamp))
+		return NULL;
+
+	struct source_file *file = NULL;
+	for (size_t i = 0; i < source_files.num && !file; i++) {
+		if (strcmp(source_files.array[i].path, path) == 0)
+			file = &source_files.array[i];
+	}
+	if (file && file->stamp.mtime == stamp.mtime &&
+	    file->stamp.size == stamp.size) {
+		stats.include_hits++;
+		return file;
+	}
+
+	char *text = os_quick_read_utf8_file(path);
+	if (!text)
+		return NULL;
+	stats.file_reads++;
+
+	if (!file) {
+		file = da_push_back_new(source_files);
+		file->path = bstrdup(path);
+	}
+	bfree(file->text);
+	file->text = text;
+	file->stamp = stamp;
+	return file;
+}
+
+static uint64_t fnv1a64(uint64_t hash, const char *str)
+{
+	for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+		hash ^= *p;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+
+static const char *skip_space(const char *p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+static bool is_directive(const char *p, const char *end, const char *name,
+			 const char **after)
+{
+	const size_t len = strlen(name);
+	if ((size_t)(end - p) < len || strncmp(p, name, len) != 0)
+		return false;
+	p += len;
+	if (p < end && !isspace((unsigned char)*p))
+		return false;
+	*after = skip_space(p, end);
+	return true;
+}
+
+static size_t identifier_length(const char *p, const char *end)
+{
+	const char *start = p;
+	while (p < end && (isalnum((unsigned char)*p) || *p == '_'))
+		p++;
+	return (size_t)(p - start);
+}
+
+static bool is_injected(const struct expand_state *state, const char *name,
+			size_t len)
+{
+	for (size_t i = 0; i < state->define_names.num; i++) {
+		const char *injected = state->define_names.array[i];
+		if (strlen(injected) == len && strncmp(injected, name, len) == 0)
+			return true;
+	}
+	return false;
+}
+
+static void parse_define_names(struct expand_state *state, const char *defines)
+{
+	const char *p = defines;
+	while (p && *p) {
+		const char *end = strchr(p, '\n');
+		if (!end)
+			end = p + strlen(p);
+		const char *after;
+		const char *line = skip_space(p, end);
+		if (is_directive(line, end, "#define", &after)) {
+			const size_t len = identifier_length(after, end);
+			if (len) {
+				char *name = bstrdup_n(after, len);
+				da_push_back(state->define_names, &name);
+			}
+		}
+		p = *end ? end + 1 : end;
+	}
+}
+
+static void log_cycle(const struct expand_state *state, const char *path)
+{
+	struct dstr chain = {0};
+	for (size_t i = 0; i < state->stack.num; i++) {
+		dstr_cat(&chain, state->stack.array[i]);
+		dstr_cat(&chain, " -> ");
+	}
+	dstr_cat(&chain, path);
+	obs_log(LOG_WARNING, "[obs-composite-blur] Include cycle: %s",
+		chain.array);
+	dstr_free(&chain);
+}
+
+static bool expand_file(struct expand_state *state, const char *path);
+
+static bool expand_include(struct expand_state *state, const char *path,
+			   const char *arg, const char *end)
+{
+	const char *start = arg < end && *arg == '"' ? arg + 1 : NULL;
+	const char *close = start ? memchr(start, '"', end - start) : NULL;
+	if (!close) {
+		obs_log(LOG_WARNING,
+			"[obs-composite-blur] Malformed #include in %s", path);
+		return false;
+	}
+
+	struct dstr include_path = {0};
+	const char *slash = strrchr(path, '/');
+	if (slash)
+		dstr_ncopy(&include_path, path, slash - path + 1);
+	dstr_ncat(&include_path, start, close - start);
+	char *abs_path = os_get_abs_path_ptr(include_path.array);
+	dstr_free(&include_path);
+
+	const bool ok = abs_path && expand_file(state, abs_path);
+	bfree(abs_path);
+	return ok;
+}
+
+static bool expand_file(struct expand_state *state, const char *path)
+{
+	for (size_t i = 0; i < state->stack.num; i++) {
+		if (strcmp(state->stack.array[i], path) == 0) {
+			log_cycle(state, path);
+			return false;
+		}
+	}
+
+	const struct source_file *file = read_source(path);
+	if (!file) {
+		obs_log(LOG_WARNING, "[obs-composite-blur] Unable to read %s",
+			path);
+		return false;
+	}
+
+	// Includes may grow the file cache, keep the strings rather than the
+	// entry.  Both outlive the state: a file on the stack is not read
+	// again before it is popped, as that would be a cycle.
+	const char *file_path = file->path;
+	const char *text = file->text;
+
+	da_push_back(state->stack, &file_path);
+	bool known = false;
+	for (size_t i = 0; i < state->deps.num && !known; i++)
+		known = state->deps.array[i].path == file_path;
+	if (!known) {
+		struct source_dep dep = {file_path, file->stamp};
+		da_push_back(state->deps, &dep);
+	}
+
+	bool ok = true;
+	const char *p = text;
+	while (ok && *p) {
+		const char *end = strchr(p, '\n');
+		if (!end)
+			end = p + strlen(p);
+		const char *line = skip_space(p, end);
+		const char *after;
+
+		if (is_directive(line, end, "#include", &after)) {
+			ok = expand_include(state, file_path, after, end);
+		} else if (is_directive(line, end, "#define", &after) &&
+			   is_injected(state, after,
+				       identifier_length(after, end))) {
+			// Overridden by the caller, keep the line count.
+			dstr_cat(&state->out, "\n");
+		} else {
+			dstr_ncat(&state->out, p, end - p);
+			dstr_cat(&state->out, "\n");
+		}
+		p = *end ? end + 1 : end;
+	}
+
+	da_pop_back(state->stack);
+	return ok;
+}
+
+static void cache_file_path(struct dstr *out, const char *file_name,
+			    const char *defines)
+{
+	uint64_t hash = fnv1a64(FNV_OFFSET, file_name);
+	hash = fnv1a64(hash, "\n");
+	hash = fnv1a64(hash, defines ? defines : "");
+	dstr_printf(out, "%s/%016llx.effect", cache_dir,
+		    (unsigned long long)hash);
+}
+
+static bool dep_matches(const char *line)
+{
+	long long mtime = 0;
+	long long size = 0;
+	int path_offset = 0;
+	if (sscanf(line, "// dep %lld %lld %n", &mtime, &size,
+		   &path_offset) != 2 ||
+	    !path_offset)
+		return false;
+
+	const char *end = strchr(line, '\n');
+	char *path = bstrdup_n(line + path_offset,
+			       end ? (size_t)(end - line) - path_offset
+				   : strlen(line + path_offset));
+	struct file_stamp stamp;
+	const bool match = stat_file(path, &stamp) && stamp.mtime == mtime &&
+			   stamp.size == size;
+	bfree(path);
+	return match;
+}
+
+/*
+ *  Cache files are a header of `// ` lines followed by the expanded
+ *  source:
+ *      // composite-blur shader cache <plugin version>
+ *      // hash <fnv1a of the body>
+ *      // dep <mtime> <size> <path>     one per file the body came from
+ *      // end
+ */
+static char *read_disk_cache(const char *cache_path)
+{
+	char *text = os_quick_read_utf8_file(cache_path);
+	if (!text)
+		return NULL;
+
+	struct dstr magic = {0};
+	dstr_printf(&magic, "%s %s\n", CACHE_MAGIC, PLUGIN_VERSION);
+	bool valid = strncmp(text, magic.array, magic.len) == 0;
+	const char *p = text + (valid ? magic.len : 0);
+	dstr_free(&magic);
+
+	unsigned long long hash = 0;
+	valid = valid && sscanf(p, "// hash %llx", &hash) == 1;
+	p = valid ? strchr(p, '\n') : NULL;
+	while (p && strncmp(++p, "// dep ", 7) == 0) {
+		if (!dep_matches(p)) {
+			p = NULL;
+			break;
+		}
+		p = strchr(p, '\n');
+	}
+	valid = p && strncmp(p, "// end\n", 7) == 0;
+
+	char *body = NULL;
+	if (valid) {
+		p += 7;
+		if (fnv1a64(FNV_OFFSET, p) == hash)
+			body = bstrdup(p);
+	}
+	bfree(text);
+	return body;
+}
+
+// The deps are stamped as they were read, not as they are now, so a file
+// edited since does not vouch for the stale body.
+static void write_disk_cache(const char *cache_path,
+			     const struct expand_state *state)
+{
+	struct dstr text = {0};
+	dstr_printf(&text, "%s %s\n// hash %016llx\n", CACHE_MAGIC,
+		    PLUGIN_VERSION,
+		    (unsigned long long)fnv1a64(FNV_OFFSET, state->out.array));
+	for (size_t i = 0; i < state->deps.num; i++) {
+		const struct source_dep *dep = &state->deps.array[i];
+		dstr_catf(&text, "// dep %lld %lld %s\n", dep->stamp.mtime,
+			  dep->stamp.size, dep->path);
+	}
+	dstr_cat(&text, "// end\n");
+	dstr_cat(&text, state->out.array);
+
+	if (os_mkdirs(cache_dir) != MKDIR_ERROR &&
+	    os_quick_write_utf8_file(cache_path, text.array, text.len, false))
+		stats.disk_writes++;
+
+	dstr_free(&text);
+}
+
+char *shader_preprocess(const char *file_name, const char *defines)
+{
+	char *abs_path = os_get_abs_path_ptr(file_name);
+	if (!abs_path)
+		return NULL;
+
+	struct dstr cache_path = {0};
+	char *result = NULL;
+
+	pthread_mutex_lock(&preprocessor_mutex);
+	if (cache_dir) {
+		cache_file_path(&cache_path, abs_path, defines);
+		result = read_disk_cache(cache_path.array);
+		if (result)
+			stats.disk_hits++;
+	}
+
+	if (!result) {
+		struct expand_state state = {0};
+		parse_define_names(&state, defines);
+		if (defines && *defines) {
+			dstr_copy(&state.out, defines);
+			dstr_cat(&state.out, "\n");
+		}
+
+		if (expand_file(&state, abs_path)) {
+			if (cache_dir)
+				write_disk_cache(cache_path.array, &state);
+			result = state.out.array ? state.out.array
+						 : bstrdup("");
+			state.out.array = NULL;
+		}
+
+		for (size_t i = 0; i < state.define_names.num; i++)
+			bfree(state.define_names.array[i]);
+		da_free(state.define_names);
+		da_free(state.stack);
+		da_free(state.deps);
+		dstr_free(&state.out);
+	}
+	pthread_mutex_unlock(&preprocessor_mutex);
+
+	dstr_free(&cache_path);
+	bfree(abs_path);
+	return result;
+}
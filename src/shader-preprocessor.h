@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ *  Expands effect files before they are handed to gs_effect_create.
+ *
+ *  - `#include "file"` is replaced by the contents of file, resolved
+ *    relative to the including file.  Files are kept in memory and read
+ *    from disk again only when their mtime or size changed, and include
+ *    cycles are reported instead of recursing.
+ *  - `defines` holds newline separated `#define NAME VALUE` lines.  They
+ *    are placed ahead of the source, and any `#define NAME` of the same
+ *    name inside the source is dropped, so a define in an effect file is
+ *    a default that callers can override (e.g. WEIGHT_SIZE).
+ *  - With a cache directory set, expanded sources are also written there
+ *    and reused on later launches until one of their files changes.
+ *
+ *  Only needs libobs/util, no graphics context.
+ */
+
+struct shader_preprocessor_stats {
+	// Effect files read from disk.
+	uint64_t file_reads;
+	// Includes served from memory.
+	uint64_t include_hits;
+	// Expansions skipped thanks to the on-disk cache, and cache writes.
+	uint64_t disk_hits;
+	uint64_t disk_writes;
+};
+
+// `cache_dir` may be NULL to keep everything in memory.
+extern void shader_preprocessor_init(const char *cache_dir);
+extern void shader_preprocessor_free(void);
+// Returns the expanded source of `file_name` as a bmalloc'd string, or
+// NULL if a file is missing or the includes form a cycle.
+extern char *shader_preprocess(const char *file_name, const char *defines);
+extern void
+shader_preprocessor_get_stats(struct shader_preprocessor_stats *stats);
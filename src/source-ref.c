@@ -0,0 +1,108 @@
+#include "source-ref.h"
+
+#include <util/bmem.h>
+
+#include <string.h>
+
+void source_ref_init(struct source_ref *ref)
+{
+	pthread_mutex_init(&ref->mutex, NULL);
+	ref->name = NULL;
+	ref->source = NULL;
+	ref->lookups = 0;
+}
+
+void source_ref_free(struct source_ref *ref)
+{
+	obs_weak_source_release(ref->source);
+	bfree(ref->name);
+	ref->source = NULL;
+	ref->name = NULL;
+	pthread_mutex_destroy(&ref->mutex);
+}
+
+// Caller holds the lock.
+static bool ref_live(const struct source_ref *ref)
+{
+	return ref->source && !obs_weak_source_expired(ref->source);
+}
+
+bool source_ref_set_name(struct source_ref *ref, const char *name)
+{
+	if (!name)
+		name = "";
+
+	pthread_mutex_lock(&ref->mutex);
+	const bool changed = strcmp(ref->name ? ref->name : "", name) != 0;
+	if (changed) {
+		bfree(ref->name);
+		ref->name = *name ? bstrdup(name) : NULL;
+		obs_weak_source_release(ref->source);
+		ref->source = NULL;
+	}
+	pthread_mutex_unlock(&ref->mutex);
+	if (!changed || !*name)
+		return changed;
+
+	// Looked up without the lock, obs_get_source_by_name takes the
+	// global source lock.  A rename or another update in between wins.
+	obs_source_t *source = obs_get_source_by_name(name);
+	pthread_mutex_lock(&ref->mutex);
+	ref->lookups++;
+	if (source && !ref->source && ref->name &&
+	    strcmp(ref->name, name) == 0)
+		ref->source = obs_source_get_weak_source(source);
+	pthread_mutex_unlock(&ref->mutex);
+	obs_source_release(source);
+	return changed;
+}
+
+obs_source_t *source_ref_get(struct source_ref *ref)
+{
+	pthread_mutex_lock(&ref->mutex);
+	obs_source_t *source =
+		ref->source ? obs_weak_source_get_source(ref->source) : NULL;
+	pthread_mutex_unlock(&ref->mutex);
+	return source;
+}
+
+bool source_ref_renamed(struct source_ref *ref, obs_source_t *source,
+			const char *new_name)
+{
+	pthread_mutex_lock(&ref->mutex);
+	const bool named = ref->source && new_name &&
+			   obs_weak_source_references_source(ref->source,
+							     source);
+	if (named) {
+		bfree(ref->name);
+		ref->name = bstrdup(new_name);
+	}
+	pthread_mutex_unlock(&ref->mutex);
+	return named;
+}
+
+// The name stays, a source created under it later is picked up.
+void source_ref_removed(struct source_ref *ref, obs_source_t *source)
+{
+	pthread_mutex_lock(&ref->mutex);
+	if (ref->source &&
+	    obs_weak_source_references_source(ref->source, source)) {
+		obs_weak_source_release(ref->source);
+		ref->source = NULL;
+	}
+	pthread_mutex_unlock(&ref->mutex);
+}
+
+void source_ref_created(struct source_ref *ref, obs_source_t *source)
+{
+	const char *name = obs_source_get_name(source);
+	if (!name)
+		return;
+
+	pthread_mutex_lock(&ref->mutex);
+	if (ref->name && !ref_live(ref) && strcmp(ref->name, name) == 0) {
+		obs_weak_source_release(ref->source);
+		ref->source = obs_source_get_weak_source(source);
+	}
+	pthread_mutex_unlock(&ref->mutex);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <obs-module.h>
+#include <util/threading.h>
+
+/*
+ *  A source a setting names, held weakly.  The name is only looked up
+ *  when it changes, the global source signals keep the reference current
+ *  afterwards- a rename carries the name along, a removal drops the
+ *  source, and a source created under the name is picked up, which also
+ *  covers backgrounds loaded after the filter.  The lock lets the render
+ *  thread get the source while signals and updates change it.
+ */
+struct source_ref {
+	pthread_mutex_t mutex;
+	char *name;
+	obs_weak_source_t *source;
+	// obs_get_source_by_name calls made for this reference.
+	uint64_t lookups;
+};
+
+extern void source_ref_init(struct source_ref *ref);
+extern void source_ref_free(struct source_ref *ref);
+// Points `ref` at the source called `name`, none for NULL or "".
+// Returns true when the name differs from the previous one.
+extern bool source_ref_set_name(struct source_ref *ref, const char *name);
+// The source, with a reference the caller releases, or NULL.
+extern obs_source_t *source_ref_get(struct source_ref *ref);
+
+// Signal handlers' share of the work.  source_ref_renamed returns true
+// when `ref` named the source, whose setting should then be renamed too.
+extern bool source_ref_renamed(struct source_ref *ref, obs_source_t *source,
+			       const char *new_name);
+extern void source_ref_removed(struct source_ref *ref, obs_source_t *source);
+extern void source_ref_created(struct source_ref *ref, obs_source_t *source);
@@ -0,0 +1,137 @@
+#include "texrender-pool.h"
+
+#include <plugin-support.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+// Free texrenders not handed out for this long are destroyed, so a size
+// or format change does not keep the old targets alive.
+#define TEXRENDER_POOL_IDLE_NS 2000000000ULL
+
+struct texrender_pool_entry {
+	gs_texrender_t *render;
+	enum gs_color_format format;
+	enum gs_color_space space;
+	uint32_t width;
+	uint32_t height;
+	bool in_use;
+	uint64_t last_used;
+};
+
+// Rendering is single threaded, the lock only guards the stats and
+// module unload.
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct texrender_pool_entry) pool_entries;
+static struct texrender_pool_stats pool_stats;
+
+static uint64_t entry_bytes(const struct texrender_pool_entry *entry)
+{
+	return (uint64_t)entry->width * entry->height *
+	       gs_get_format_bpp(entry->format) / 8;
+}
+
+static void evict_idle(uint64_t now)
+{
+	for (size_t i = pool_entries.num; i > 0; i--) {
+		struct texrender_pool_entry *entry = &pool_entries.array[i - 1];
+		if (entry->in_use ||
+		    now - entry->last_used < TEXRENDER_POOL_IDLE_NS)
+			continue;
+		gs_texrender_destroy(entry->render);
+		pool_stats.resident--;
+		pool_stats.resident_bytes -= entry_bytes(entry);
+		pool_stats.evictions++;
+		da_erase(pool_entries, i - 1);
+	}
+}
+
+gs_texrender_t *texrender_pool_acquire(enum gs_color_format format,
+				       uint32_t width, uint32_t height,
+				       enum gs_color_space space)
+{
+	const uint64_t now = os_gettime_ns();
+	gs_texrender_t *render = NULL;
+
+	pthread_mutex_lock(&pool_mutex);
+	evict_idle(now);
+	for (size_t i = 0; i < pool_entries.num; i++) {
+		struct texrender_pool_entry *entry = &pool_entries.array[i];
+		if (!entry->in_use && entry->format == format &&
+		    entry->width == width && entry->height == height &&
+		    entry->space == space) {
+			entry->in_use = true;
+			entry->last_used = now;
+			render = entry->render;
+			pool_stats.hits++;
+			break;
+		}
+	}
+
+	if (render) {
+		gs_texrender_reset(render);
+	} else {
+		render = gs_texrender_create(format, GS_ZS_NONE);
+		struct texrender_pool_entry *entry =
+			da_push_back_new(pool_entries);
+		entry->render = render;
+		entry->format = format;
+		entry->space = space;
+		entry->width = width;
+		entry->height = height;
+		entry->in_use = true;
+		entry->last_used = now;
+		pool_stats.misses++;
+		pool_stats.resident++;
+		pool_stats.resident_bytes += entry_bytes(entry);
+	}
+	pool_stats.in_use++;
+	pthread_mutex_unlock(&pool_mutex);
+
+	return render;
+}
+
+void texrender_pool_release(gs_texrender_t *render)
+{
+	if (!render)
+		return;
+
+	pthread_mutex_lock(&pool_mutex);
+	for (size_t i = 0; i < pool_entries.num; i++) {
+		struct texrender_pool_entry *entry = &pool_entries.array[i];
+		if (entry->render == render && entry->in_use) {
+			entry->in_use = false;
+			entry->last_used = os_gettime_ns();
+			pool_stats.in_use--;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+void texrender_pool_get_stats(struct texrender_pool_stats *stats)
+{
+	pthread_mutex_lock(&pool_mutex);
+	*stats = pool_stats;
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+void texrender_pool_free(void)
+{
+	pthread_mutex_lock(&pool_mutex);
+	obs_log(LOG_INFO,
+		"Texrender pool: %llu hits, %llu misses, %llu evictions",
+		(unsigned long long)pool_stats.hits,
+		(unsigned long long)pool_stats.misses,
+		(unsigned long long)pool_stats.evictions);
+
+	obs_enter_graphics();
+	for (size_t i = 0; i < pool_entries.num; i++)
+		gs_texrender_destroy(pool_entries.array[i].render);
+	obs_leave_graphics();
+	da_free(pool_entries);
+	pool_stats.resident = 0;
+	pool_stats.in_use = 0;
+	pool_stats.resident_bytes = 0;
+	pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <obs-module.h>
+
+struct texrender_pool_stats {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	// Texrenders alive in the pool, handed out right now, and the
+	// memory held by their textures.
+	size_t resident;
+	size_t in_use;
+	uint64_t resident_bytes;
+};
+
+// Returns a reset texrender for one use of `format` at width x height in
+// `space`, shared with every other filter.  Begin it with that size and
+// space, and give it back with texrender_pool_release once its texture is
+// no longer read, normally before the end of the same video_render.
+// Graphics thread only.
+extern gs_texrender_t *texrender_pool_acquire(enum gs_color_format format,
+					      uint32_t width, uint32_t height,
+					      enum gs_color_space space);
+extern void texrender_pool_release(gs_texrender_t *render);
+extern void texrender_pool_get_stats(struct texrender_pool_stats *stats);
+// Destroys every pooled texrender.
+extern void texrender_pool_free(void);
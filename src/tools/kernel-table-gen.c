@@ -0,0 +1,64 @@
+/*
+ *  composite-blur-kernel-gen
+ *
+ *  Writes the gaussian lookup table gaussian_sample_kernel samples from
+ *  as a C source file.  Run by the build, not installed.
+ *
+ *  Usage: composite-blur-kernel-gen OUTPUT.c
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+// Bins from the center of the kernel to 3 sigma.  The table holds one
+// more, the sampler reads one bin past the last it weights.
+#define TABLE_SIZE 1024
+
+int main(int argc, char **argv)
+{
+	static double kernel[TABLE_SIZE + 1];
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s OUTPUT.c\n", argv[0]);
+		return 1;
+	}
+
+	// Normalized over both sides, the center bin counted once.
+	const double sigma = TABLE_SIZE / 3.0;
+	double total = 0.0;
+	for (int i = 0; i <= TABLE_SIZE; i++) {
+		kernel[i] = exp(-(double)i * i / (2.0 * sigma * sigma));
+		total += i == 0 ? kernel[i] : 2.0 * kernel[i];
+	}
+
+	FILE *out = fopen(argv[1], "w");
+	if (!out) {
+		perror(argv[1]);
+		return 1;
+	}
+	fprintf(out, "// Generated by composite-blur-kernel-gen, do not edit.\n"
+		     "\n"
+		     "#include <stddef.h>\n"
+		     "\n"
+		     "// Center-right half of a normalized gaussian, sigma = "
+		     "%d / 3 bins.\n"
+		     "extern const size_t gaussian_kernel_size;\n"
+		     "extern const float gaussian_kernel[];\n"
+		     "\n"
+		     "const size_t gaussian_kernel_size = %d;\n"
+		     "const float gaussian_kernel[] = {\n",
+		TABLE_SIZE, TABLE_SIZE);
+	// Full double precision, so the compiler rounds each value to float
+	// once.
+	for (int i = 0; i <= TABLE_SIZE; i++) {
+		fprintf(out, "%s%.17gf,%s", i % 2 == 0 ? "\t" : " ",
+			kernel[i] / total, i % 2 == 1 ? "\n" : "");
+	}
+	fprintf(out, "\n};\n");
+
+	if (fclose(out) != 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	return 0;
+}